@@ -81,6 +81,13 @@ if (PostgreSQL_FOUND)
     set(HAVE_POSTGRESQL 1)
 endif()
 
+# zlib (optional, used for compression of rotated log files)
+find_package(ZLIB)
+
+if (ZLIB_FOUND)
+    set(HAVE_ZLIB 1)
+endif()
+
 # Optional: Stack trace pretty printer library for C++
 # https://github.com/bombela/backward-cpp
 if (EXISTS ${CMAKE_CURRENT_LIST_DIR}/../3rdparty/backward-cpp/backward.hpp)
@@ -2,7 +2,7 @@
 #include <pfs/type_traits.hpp>
 #include <pfs/memory.hpp>
 #include <pfs/mutex.hpp>
-#include <pfs/cxx/cxx98/binder.hpp>
+#include <pfs/inplace_binder.hpp>
 #include <pfs/map.hpp>
 
 namespace pfs {
@@ -18,7 +18,7 @@ public:
     typedef R   result_type;
 
 protected:
-    typedef pfs::shared_ptr<binder_base<void> >        value_type;
+    typedef inplace_binder<result_type>                value_type;
     typedef BasicLockable                              mutex_type;
     typedef AssociativeContainer<key_type, value_type> map_type;
     typedef typename map_type::size_type               size_type;
@@ -29,10 +29,11 @@ protected:
     mutable mutex_type _mutex;
 
 protected:
-    void insert_helper (key_type const & key, shared_ptr<binder_base<void> > ptr)
+    template <typename Binder>
+    void insert_helper (key_type const & key, Binder const & b)
     {
         unique_lock<mutex_type> locker(_mutex);
-        _map.insert(key, ptr);
+        _map.insert(key, value_type(b));
     }
 
 public:
@@ -57,73 +58,73 @@ public:
 
     void insert_function (key_type const & key, result_type (* f) ())
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_function0<result_type>(f)));
+        insert_helper(key, binder_function0<result_type>(f));
     }
 
     template <typename Arg1>
     void insert_function (key_type const & key, result_type (*f) (Arg1), Arg1 a1)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_function1<result_type, Arg1>(f, a1)));
+        insert_helper(key, binder_function1<result_type, Arg1>(f, a1));
     }
 
     template <typename Arg1, typename Arg2>
     void insert_function (key_type const & key, result_type (*f) (Arg1, Arg2), Arg1 a1, Arg2 a2)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_function2<result_type, Arg1, Arg2>(f, a1, a2)));
+        insert_helper(key, binder_function2<result_type, Arg1, Arg2>(f, a1, a2));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3>
     void insert_function (key_type const & key, result_type (*f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_function3<result_type, Arg1, Arg2, Arg3>(f, a1, a2, a3)));
+        insert_helper(key, binder_function3<result_type, Arg1, Arg2, Arg3>(f, a1, a2, a3));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4>
     void insert_function (key_type const & key, result_type (*f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_function4<result_type, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4)));
+        insert_helper(key, binder_function4<result_type, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
     void insert_function (key_type const & key, result_type (*f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_function5<result_type, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5)));
+        insert_helper(key, binder_function5<result_type, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5));
     }
 
     template <typename Class>
     void insert_method (key_type const & key, result_type (Class::* f) (), Class * p)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_method0<Class, result_type>(f, p)));
+        insert_helper(key, binder_method0<Class, result_type>(f, p));
     }
 
     template <typename Class, typename Arg1>
     void insert_method (key_type const & key, result_type (Class::*f) (Arg1), Class * p, Arg1 a1)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_method1<Class, result_type, Arg1>(f, p, a1)));
+        insert_helper(key, binder_method1<Class, result_type, Arg1>(f, p, a1));
     }
 
     template <typename Class, typename Arg1, typename Arg2>
     void insert_method (key_type const & key, result_type (Class::*f) (Arg1, Arg2), Class * p, Arg1 a1, Arg2 a2)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_method2<Class, result_type, Arg1, Arg2>(f, p, a1, a2)));
+        insert_helper(key, binder_method2<Class, result_type, Arg1, Arg2>(f, p, a1, a2));
     }
 
     template <typename Class, typename Arg1, typename Arg2, typename Arg3>
     void insert_method (key_type const & key, result_type (Class::*f) (Arg1, Arg2, Arg3), Class * p, Arg1 a1, Arg2 a2, Arg3 a3)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_method3<Class, result_type, Arg1, Arg2, Arg3>(f, p, a1, a2, a3)));
+        insert_helper(key, binder_method3<Class, result_type, Arg1, Arg2, Arg3>(f, p, a1, a2, a3));
     }
 
     template <typename Class, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
     void insert_method (key_type const & key, result_type (Class::*f) (Arg1, Arg2, Arg3), Class * p, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_method4<Class, result_type, Arg1, Arg2, Arg3, Arg4>(f, p, a1, a2, a3, a4)));
+        insert_helper(key, binder_method4<Class, result_type, Arg1, Arg2, Arg3, Arg4>(f, p, a1, a2, a3, a4));
     }
 
     template <typename Class, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
     void insert_method (key_type const & key, result_type (Class::*f) (Arg1, Arg2, Arg3), Class * p, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
     {
-        insert_helper(key, shared_ptr<binder_base<void> >(new binder_method5<Class, result_type, Arg1, Arg2, Arg3, Arg4, Arg5>(f, p, a1, a2, a3, a4, a5)));
+        insert_helper(key, binder_method5<Class, result_type, Arg1, Arg2, Arg3, Arg4, Arg5>(f, p, a1, a2, a3, a4, a5));
     }
 
     void clear ()
@@ -166,7 +167,7 @@ public:
         if (pos != this->_map.end()) {
             locker.unlock();
 
-            result = (*map_type::mapped_reference(pos).p)();
+            result = map_type::mapped_reference(pos)();
 
             if (called)
                 *called = true;
@@ -213,7 +214,7 @@ public:
         if (pos != this->_map.end()) {
             locker.unlock();
 
-            (*this->_map.mapped_reference(pos))();
+            map_type::mapped_reference(pos)();
 
             if (called)
                 *called = true;
@@ -1,11 +1,15 @@
 #pragma once
 #include <pfs/mutex.hpp>
-#include <pfs/memory.hpp>
-#include <pfs/cxx/cxx98/binder.hpp>
+#include <pfs/inplace_binder.hpp>
 #include <pfs/deque.hpp>
 #include <pfs/utility.hpp>
 #include <pfs/memory.hpp>
 
+#if __cplusplus >= 201103L
+#   include <pfs/atomic.hpp>
+#   include <pfs/mpmc_queue.hpp>
+#endif
+
 namespace pfs {
 
 template <template <typename> class SequenceContainer = pfs::deque
@@ -22,11 +26,13 @@ private:
     };
 
 public:
-    typedef pfs::pair<int8_t, pfs::shared_ptr<binder_base<void> > > value_type;
+    typedef inplace_binder<void> callable_type;
+    typedef pfs::pair<int8_t, callable_type> value_type;
     typedef BasicLockable mutex_type;
     typedef SequenceContainer<value_type> sequence_container_type;
     typedef typename sequence_container_type::size_type size_type;
     typedef typename sequence_container_type::iterator  iterator;
+    typedef void (* notifier_type) (void *);
 
     static size_type const GC_THRESHOLD = GcThreshold;
 
@@ -34,22 +40,32 @@ private:
     sequence_container_type _sequence;
     size_type               _count;
     mutable mutex_type      _mutex;
+    notifier_type           _notifier;
+    void *                  _notifier_context;
 
 private:
     /* @brief Creates (using default constructor) and inserts element of type T at the end.
      */
-    void push_helper (shared_ptr<binder_base<void> > ptr)
+    template <typename Binder>
+    void push_helper (Binder const & b)
     {
-        unique_lock<mutex_type> locker(_mutex);
+        {
+            unique_lock<mutex_type> locker(_mutex);
 
-        if (_sequence.size() > GC_THRESHOLD
-                && _sequence.begin()->first == FREE) {
-            gc();
-        }
+            if (_sequence.size() > GC_THRESHOLD
+                    && _sequence.begin()->first == FREE) {
+                gc();
+            }
 
-        _sequence.push_back(pfs::make_pair(BUSY, ptr));
+            // Construct callable in place to avoid extra copies
+            _sequence.push_back(value_type(BUSY, callable_type()));
+            _sequence.back().second.assign(b);
 
-        ++_count;
+            ++_count;
+        }
+
+        if (_notifier)
+            _notifier(_notifier_context);
     }
 
     iterator front_busy ()
@@ -83,7 +99,11 @@ private:
     }
 
 public:
-    active_queue () : _count(0) {}
+    active_queue ()
+        : _count(0)
+        , _notifier(0)
+        , _notifier_context(0)
+    {}
 
     virtual ~active_queue ()
     {
@@ -118,143 +138,153 @@ public:
         _sequence.clear();
     }
 
+    /**
+     * @brief Sets function to be called (outside of the queue's lock)
+     *        after each push (e.g. to wake up consumer waiting for events).
+     */
+    void set_notifier (notifier_type f, void * context)
+    {
+        _notifier = f;
+        _notifier_context = context;
+    }
+
 //#if __cplusplus >= 201103L
 //#   error Implement using variadic templates
 //#else
     void push_function (void (* f) ())
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function0<void>(f)));
+        push_helper(binder_function0<void>(f));
     }
 
     template <typename Arg1>
     void push_function (void (* f) (Arg1), Arg1 a1)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function1<void, Arg1>(f, a1)));
+        push_helper(binder_function1<void, Arg1>(f, a1));
     }
 
     template <typename Arg1, typename Arg2>
     void push_function (void (* f) (Arg1, Arg2), Arg1 a1, Arg2 a2)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function2<void, Arg1, Arg2>(f, a1, a2)));
+        push_helper(binder_function2<void, Arg1, Arg2>(f, a1, a2));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3>
     void push_function (void (* f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function3<void, Arg1, Arg2, Arg3>(f, a1, a2, a3)));
+        push_helper(binder_function3<void, Arg1, Arg2, Arg3>(f, a1, a2, a3));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4>
     void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function4<void, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4)));
+        push_helper(binder_function4<void, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
     void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function5<void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5)));
+        push_helper(binder_function5<void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
     void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function6<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, a1, a2, a3, a4, a5, a6)));
+        push_helper(binder_function6<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, a1, a2, a3, a4, a5, a6));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
     void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function7<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, a1, a2, a3, a4, a5, a6, a7)));
+        push_helper(binder_function7<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, a1, a2, a3, a4, a5, a6, a7));
     }
 
     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
     void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_function8<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, a1, a2, a3, a4, a5, a6, a7, a8)));
+        push_helper(binder_function8<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, a1, a2, a3, a4, a5, a6, a7, a8));
     }
 
     template <typename C>
     void push_method (void (C::* f) (), C * c)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method0<C, void>(f, c)));
+        push_helper(binder_method0<C, void>(f, c));
     }
 
     template <typename C, typename Arg1>
     void push_method (void (C::* f) (Arg1), C * c, Arg1 a1)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method1<C, void, Arg1>(f, c, a1)));
+        push_helper(binder_method1<C, void, Arg1>(f, c, a1));
     }
 
     template <typename C, typename Arg1, typename Arg2>
     void push_method (void (C::* f) (Arg1, Arg2), C * c, Arg1 a1, Arg2 a2)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method2<C, void, Arg1, Arg2>(f, c, a1, a2)));
+        push_helper(binder_method2<C, void, Arg1, Arg2>(f, c, a1, a2));
     }
 
     template <typename C, typename Arg1, typename Arg2, typename Arg3>
     void push_method (void (C::* f) (Arg1, Arg2, Arg3), C * c, Arg1 a1, Arg2 a2, Arg3 a3)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method3<C, void, Arg1, Arg2, Arg3>(f, c, a1, a2, a3)));
+        push_helper(binder_method3<C, void, Arg1, Arg2, Arg3>(f, c, a1, a2, a3));
     }
 
     template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
     void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method4<C, void, Arg1, Arg2, Arg3, Arg4>(f, c, a1, a2, a3, a4)));
+        push_helper(binder_method4<C, void, Arg1, Arg2, Arg3, Arg4>(f, c, a1, a2, a3, a4));
     }
 
     template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
     void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method5<C, void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, c, a1, a2, a3, a4, a5)));
+        push_helper(binder_method5<C, void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, c, a1, a2, a3, a4, a5));
     }
 
     template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
     void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method6<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, c, a1, a2, a3, a4, a5, a6)));
+        push_helper(binder_method6<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, c, a1, a2, a3, a4, a5, a6));
     }
 
     template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
     void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method7<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, c, a1, a2, a3, a4, a5, a6, a7)));
+        push_helper(binder_method7<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, c, a1, a2, a3, a4, a5, a6, a7));
     }
 
     template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
     void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
     {
-        push_helper(shared_ptr<binder_base<void> >(new binder_method8<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, c, a1, a2, a3, a4, a5, a6, a7, a8)));
+        push_helper(binder_method8<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, c, a1, a2, a3, a4, a5, a6, a7, a8));
     }
 
 //     void push_signal (signal0<> * sig)
 //     {
-//         push_helper(shared_ptr<binder_base<void> >(new binder_signal0(sig)));
+//         push_helper(binder_signal0(sig));
 //     }
 //
 //     template <typename Arg1>
 //     void push_signal (signal1<Arg1> * sig, Arg1 a1)
 //     {
-//         push_helper(shared_ptr<binder_base<void> >(new binder_signal1<Arg1>(sig, a1)));
+//         push_helper(binder_signal1<Arg1>(sig, a1));
 //     }
 //
 //     template <typename Arg1, typename Arg2>
 //     void push_signal (signal1<Arg1> * sig, Arg1 a1, Arg2 a2)
 //     {
-//         push_helper(shared_ptr<binder_base<void> >(new binder_signal2<Arg1, Arg2>(sig, a1, a2)));
+//         push_helper(binder_signal2<Arg1, Arg2>(sig, a1, a2));
 //     }
 //
 //     template <typename Arg1, typename Arg2, typename Arg3>
 //     void push_signal (signal1<Arg1> * sig, Arg1 a1, Arg2 a2, Arg3 a3)
 //     {
-//         push_helper(shared_ptr<binder_base<void> >(new binder_signal3<Arg1, Arg2, Arg3>(sig, a1, a2, a3)));
+//         push_helper(binder_signal3<Arg1, Arg2, Arg3>(sig, a1, a2, a3));
 //     }
 //
 //     template <typename Arg1, typename Arg2, typename Arg3, typename Arg4>
 //     void push_signal (signal1<Arg1> * sig, Arg1 a1, Arg2 a2, Arg3 a3, Arg3 a4)
 //     {
-//         push_helper(shared_ptr<binder_base<void> >(new binder_signal4<Arg1, Arg2, Arg3, Arg4>(sig, a1, a2, a3, a4)));
+//         push_helper(binder_signal4<Arg1, Arg2, Arg3, Arg4>(sig, a1, a2, a3, a4));
 //     }
 //#endif
 
@@ -268,11 +298,10 @@ public:
             --_count;
             locker.unlock();
 
-            (*(pos->second))();
+            pos->second();
 
             // Destroy item
-            pfs::shared_ptr<binder_base<void> > tmp;
-            tmp.swap(pos->second);
+            pos->second.reset();
 
             locker.lock();
 
@@ -295,4 +324,274 @@ public:
     }
 };
 
+
+#if __cplusplus >= 201103L
+
+/**
+ * @brief Active queue backed by bounded lock-free MPMC ring
+ *        (selected by `pfs::mpmc_queue` as SequenceContainer).
+ *
+ * @details Push and call take O(1) and do not lock in common case.
+ *          When ring is full callables are stored into overflow deque
+ *          protected by @a BasicLockable, they are called after ring is
+ *          drained. GcThreshold is not used (there is nothing to collect).
+ */
+template <typename BasicLockable, int GcThreshold>
+class active_queue<pfs::mpmc_queue, BasicLockable, GcThreshold>
+{
+public:
+    typedef inplace_binder<void> value_type;
+    typedef BasicLockable mutex_type;
+    typedef pfs::mpmc_queue<value_type> ring_type;
+    typedef pfs::deque<value_type> overflow_container_type;
+    typedef size_t size_type;
+    typedef void (* notifier_type) (void *);
+
+    static size_type const GC_THRESHOLD = GcThreshold;
+    static size_type const DEFAULT_CAPACITY = 4096;
+
+private:
+    ring_type               _ring;
+    atomic<size_type>       _count;
+    atomic<size_type>       _overflow_count;
+    overflow_container_type _overflow;
+    mutable mutex_type      _mutex;
+    notifier_type           _notifier;
+    void *                  _notifier_context;
+
+private:
+    void enqueue (value_type && callable)
+    {
+        ++_count;
+
+        // Preserve order: while overflow is not drained new callables go to it
+        if (_overflow_count.load() == 0 && _ring.try_push(std::move(callable)))
+            return;
+
+        unique_lock<mutex_type> locker(_mutex);
+        _overflow.push_back(std::move(callable));
+        ++_overflow_count;
+    }
+
+    template <typename Binder>
+    void push_helper (Binder const & b)
+    {
+        enqueue(value_type(b));
+
+        if (_notifier)
+            _notifier(_notifier_context);
+    }
+
+    bool pop (value_type & ptr)
+    {
+        if (_ring.try_pop(ptr))
+            return true;
+
+        if (_overflow_count.load() == 0)
+            return false;
+
+        unique_lock<mutex_type> locker(_mutex);
+
+        if (_overflow.empty())
+            return false;
+
+        ptr = std::move(_overflow.front());
+        _overflow.pop_front();
+        --_overflow_count;
+        return true;
+    }
+
+public:
+    explicit active_queue (size_type capacity = DEFAULT_CAPACITY)
+        : _ring(capacity)
+        , _count(0)
+        , _overflow_count(0)
+        , _notifier(0)
+        , _notifier_context(0)
+    {}
+
+    virtual ~active_queue ()
+    {
+        clear();
+    }
+
+    bool empty () const
+    {
+        return _count.load() == 0;
+    }
+
+    /**
+     * @return Number of elements ready to call.
+     */
+    size_type count () const
+    {
+        return _count.load();
+    }
+
+    size_type size () const
+    {
+        return _count.load();
+    }
+
+    size_type capacity () const
+    {
+        return _ring.capacity();
+    }
+
+    void clear ()
+    {
+        value_type ptr;
+
+        while (pop(ptr))
+            --_count;
+    }
+
+    /**
+     * @brief Sets function to be called (outside of the queue's lock)
+     *        after each push (e.g. to wake up consumer waiting for events).
+     */
+    void set_notifier (notifier_type f, void * context)
+    {
+        _notifier = f;
+        _notifier_context = context;
+    }
+
+//#if __cplusplus >= 201103L
+//#   error Implement using variadic templates
+//#else
+    void push_function (void (* f) ())
+    {
+        push_helper(binder_function0<void>(f));
+    }
+
+    template <typename Arg1>
+    void push_function (void (* f) (Arg1), Arg1 a1)
+    {
+        push_helper(binder_function1<void, Arg1>(f, a1));
+    }
+
+    template <typename Arg1, typename Arg2>
+    void push_function (void (* f) (Arg1, Arg2), Arg1 a1, Arg2 a2)
+    {
+        push_helper(binder_function2<void, Arg1, Arg2>(f, a1, a2));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3>
+    void push_function (void (* f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push_helper(binder_function3<void, Arg1, Arg2, Arg3>(f, a1, a2, a3));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
+    {
+        push_helper(binder_function4<void, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
+    {
+        push_helper(binder_function5<void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
+    {
+        push_helper(binder_function6<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, a1, a2, a3, a4, a5, a6));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
+    {
+        push_helper(binder_function7<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, a1, a2, a3, a4, a5, a6, a7));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
+    {
+        push_helper(binder_function8<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, a1, a2, a3, a4, a5, a6, a7, a8));
+    }
+
+    template <typename C>
+    void push_method (void (C::* f) (), C * c)
+    {
+        push_helper(binder_method0<C, void>(f, c));
+    }
+
+    template <typename C, typename Arg1>
+    void push_method (void (C::* f) (Arg1), C * c, Arg1 a1)
+    {
+        push_helper(binder_method1<C, void, Arg1>(f, c, a1));
+    }
+
+    template <typename C, typename Arg1, typename Arg2>
+    void push_method (void (C::* f) (Arg1, Arg2), C * c, Arg1 a1, Arg2 a2)
+    {
+        push_helper(binder_method2<C, void, Arg1, Arg2>(f, c, a1, a2));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3), C * c, Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push_helper(binder_method3<C, void, Arg1, Arg2, Arg3>(f, c, a1, a2, a3));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
+    {
+        push_helper(binder_method4<C, void, Arg1, Arg2, Arg3, Arg4>(f, c, a1, a2, a3, a4));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
+    {
+        push_helper(binder_method5<C, void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, c, a1, a2, a3, a4, a5));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
+    {
+        push_helper(binder_method6<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, c, a1, a2, a3, a4, a5, a6));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
+    {
+        push_helper(binder_method7<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, c, a1, a2, a3, a4, a5, a6, a7));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
+    {
+        push_helper(binder_method8<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, c, a1, a2, a3, a4, a5, a6, a7, a8));
+    }
+//#endif
+
+    void call ()
+    {
+        value_type callable;
+
+        if (pop(callable)) {
+            --_count;
+            callable();
+        }
+    }
+
+    void call (int max_count)
+    {
+        if (max_count > 0) {
+            while (!this->empty() && max_count--)
+                call();
+        }
+    }
+
+    void call_all ()
+    {
+        while (!this->empty())
+            call();
+    }
+};
+
+#endif
+
 } // pfs
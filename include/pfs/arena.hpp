@@ -0,0 +1,284 @@
+#pragma once
+#include <cstdlib>
+#include <new>
+#include <pfs/types.hpp>
+#include <pfs/assert.hpp>
+#include <pfs/noncopyable.hpp>
+
+#if __cplusplus < 201103L
+#   error "pfs::arena requires C++11"
+#endif
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace pfs {
+
+/**
+ * @brief Monotonic (arena) memory resource.
+ *
+ * @details Memory is allocated from the chunks (each next chunk is twice
+ *          larger than previous one) by bumping the pointer, deallocation
+ *          of separate blocks is not supported, all memory is released
+ *          at once by release() or destructor.
+ *
+ *          Arena can be made current for the calling thread (see scope),
+ *          so arena_allocator instances constructed while scope is active
+ *          allocate memory from this arena.
+ */
+class arena : noncopyable
+{
+    struct chunk
+    {
+        chunk * prev;
+        size_t  size;   // Size of chunk's data (excluding header)
+    };
+
+    chunk *  _head;
+    byte_t * _cursor;
+    byte_t * _limit;
+    size_t   _initial_size;
+    size_t   _next_size;
+    size_t   _allocated;
+
+private:
+    static arena *& current_ref ()
+    {
+        static thread_local arena * a = 0;
+        return a;
+    }
+
+    static size_t align_up (size_t n, size_t align)
+    {
+        return (n + align - 1) & ~(align - 1);
+    }
+
+    void add_chunk (size_t min_size)
+    {
+        size_t size = _next_size;
+
+        while (size < min_size)
+            size *= 2;
+
+        chunk * c = static_cast<chunk *>(std::malloc(sizeof(chunk) + size));
+
+        if (!c)
+            throw std::bad_alloc();
+
+        c->prev = _head;
+        c->size = size;
+        _head   = c;
+        _cursor = reinterpret_cast<byte_t *>(c + 1);
+        _limit  = _cursor + size;
+        _next_size = size * 2;
+    }
+
+public:
+    /**
+     * @brief Makes arena current for the calling thread during
+     *        scope's lifetime.
+     */
+    class scope : noncopyable
+    {
+        arena * _saved;
+
+    public:
+        explicit scope (arena & a)
+            : _saved(arena::current())
+        {
+            current_ref() = & a;
+        }
+
+        ~scope ()
+        {
+            current_ref() = _saved;
+        }
+    };
+
+public:
+    /**
+     * @param initial_size Size of the first chunk.
+     */
+    explicit arena (size_t initial_size = 4096)
+        : _head(0)
+        , _cursor(0)
+        , _limit(0)
+        , _initial_size(initial_size > 64 ? initial_size : 64)
+        , _next_size(_initial_size)
+        , _allocated(0)
+    {}
+
+    ~arena ()
+    {
+        release();
+    }
+
+    /**
+     * @return Arena current for the calling thread or @c null.
+     */
+    static arena * current ()
+    {
+        return current_ref();
+    }
+
+    void * allocate (size_t n, size_t align = alignof(std::max_align_t))
+    {
+        byte_t * p = reinterpret_cast<byte_t *>(
+                align_up(reinterpret_cast<uintptr_t>(_cursor), align));
+
+        if (!_head || p + n > _limit) {
+            add_chunk(n + align);
+            p = reinterpret_cast<byte_t *>(
+                    align_up(reinterpret_cast<uintptr_t>(_cursor), align));
+        }
+
+        _cursor = p + n;
+        _allocated += n;
+        return p;
+    }
+
+    /**
+     * @brief Releases all memory allocated by arena.
+     */
+    void release ()
+    {
+        while (_head) {
+            chunk * prev = _head->prev;
+            std::free(_head);
+            _head = prev;
+        }
+
+        _cursor = 0;
+        _limit = 0;
+        _next_size = _initial_size;
+        _allocated = 0;
+    }
+
+    /**
+     * @return Number of bytes allocated from arena.
+     */
+    size_t allocated () const
+    {
+        return _allocated;
+    }
+
+    /**
+     * @return Total size of arena chunks.
+     */
+    size_t capacity () const
+    {
+        size_t result = 0;
+
+        for (chunk * c = _head; c; c = c->prev)
+            result += c->size;
+
+        return result;
+    }
+};
+
+/**
+ * @brief Allocator that allocates memory from the arena current
+ *        at the moment of allocator construction (see arena::scope),
+ *        or from the heap if there is no current arena.
+ *
+ * @details Deallocation of arena memory does nothing.
+ *          Copy of container gets allocator of the current arena (or heap
+ *          allocator), not the allocator of the source container.
+ */
+template <typename T>
+class arena_allocator
+{
+    template <typename U> friend class arena_allocator;
+
+    arena * _arena;
+
+public:
+    typedef T         value_type;
+    typedef T *       pointer;
+    typedef T const * const_pointer;
+    typedef T &       reference;
+    typedef T const & const_reference;
+    typedef size_t    size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef arena_allocator<U> other;
+    };
+
+public:
+    arena_allocator ()
+        : _arena(arena::current())
+    {}
+
+    explicit arena_allocator (arena * a)
+        : _arena(a)
+    {}
+
+    template <typename U>
+    arena_allocator (arena_allocator<U> const & other)
+        : _arena(other._arena)
+    {}
+
+    arena * get_arena () const
+    {
+        return _arena;
+    }
+
+    pointer allocate (size_type n, void const * = 0)
+    {
+        if (_arena)
+            return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignof(T)));
+
+        return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate (pointer p, size_type)
+    {
+        if (!_arena)
+            ::operator delete(p);
+    }
+
+    size_type max_size () const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    template <typename U, typename... Args>
+    void construct (U * p, Args &&... args)
+    {
+        ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy (U * p)
+    {
+        p->~U();
+    }
+
+    arena_allocator select_on_container_copy_construction () const
+    {
+        return arena_allocator();
+    }
+
+    template <typename U>
+    bool operator == (arena_allocator<U> const & rhs) const
+    {
+        return _arena == rhs._arena;
+    }
+
+    template <typename U>
+    bool operator != (arena_allocator<U> const & rhs) const
+    {
+        return _arena != rhs._arena;
+    }
+};
+
+} // pfs
@@ -17,6 +17,7 @@ public:
     inline ssize_t write (char const * s, size_t n)
     {
         _buffer.append(s, n);
+        return static_cast<ssize_t>(n);
     }
 
     template <typename T>
@@ -1,2 +1,464 @@
 #pragma once
 #include <pfs/cxx/cxx98/sigslot.hpp>
+#include <vector>
+#include <pfs/atomic.hpp>
+#include <pfs/thread.hpp>
+
+#ifndef PFS_CACHE_LINE_SIZE
+#   define PFS_CACHE_LINE_SIZE 64
+#endif
+
+namespace pfs {
+
+/**
+ * @brief Signals/slots with lock-free emission.
+ *
+ * @details Interface is the same as of pfs::sigslot (has_slots,
+ *          has_async_slots, has_slave_slots, signal0 ... signal8), but
+ *          signal's connections are stored in immutable snapshot.
+ *          Emission loads current snapshot and calls slots without locking
+ *          the signal. Connect and disconnect (serialized by the signal's
+ *          mutex) copy the snapshot, publish the new one and wait until
+ *          emitters that may still use the previous snapshot leave it
+ *          (RCU-like grace period). Then the previous snapshot and
+ *          disconnected connections are deleted. So after disconnect()
+ *          (and has_slots destruction) no slot of the disconnected object
+ *          is called or being called.
+ *
+ *          Emitters are counted by two counters (one per grace period
+ *          phase), waiting does not starve writers when signal is emitted
+ *          continuously.
+ *
+ *          Slots may be called while the destination object is being
+ *          destroyed until basic_has_slots destructor disconnects it, so
+ *          objects which slots are called from other threads should call
+ *          disconnect_all() in their own destructor.
+ *
+ *          As in pfs::sigslot with non-recursive mutex, connecting to or
+ *          disconnecting from the signal inside its own slot called
+ *          synchronously is not allowed (deadlock).
+ */
+template <typename ActiveQueue = fake_active_queue, typename BasicLockable = pfs::mutex>
+struct snapshot_sigslot
+{
+    typedef ActiveQueue   callback_queue_type;
+    typedef BasicLockable mutex_type;
+
+    class basic_has_slots;
+
+    template <typename... Args>
+    class connection_base
+    {
+    public:
+        virtual ~connection_base () {}
+        virtual basic_has_slots * getdest () const = 0;
+        virtual void emit_ (Args... args) = 0;
+        virtual connection_base * clone () const = 0;
+    };
+
+    template <typename DestType, typename... Args>
+    class connection : public connection_base<Args...>
+    {
+        typedef void (DestType::* memfun_type) (Args...);
+
+    public:
+        // Queue for async (and slave) slots is resolved at connection time,
+        // so emission does not call virtual methods of the destination.
+        connection (DestType * pobject, memfun_type pmemfun)
+            : _pobject(pobject)
+            , _pmemfun(pmemfun)
+            , _queue(0)
+        {
+            if (pobject->use_async_slots())
+                _queue = & pobject->callback_queue();
+            else if (pobject->is_slave())
+                _queue = & pobject->master()->callback_queue();
+        }
+
+        virtual connection_base<Args...> * clone () const override
+        {
+            return new connection(*this);
+        }
+
+        virtual void emit_ (Args... args) override
+        {
+            if (_queue)
+                _queue->template push_method<DestType, Args...>(_pmemfun, _pobject, args...);
+            else
+                (_pobject->*_pmemfun)(args...);
+        }
+
+        virtual basic_has_slots * getdest () const override
+        {
+            return _pobject;
+        }
+
+    private:
+        DestType *            _pobject;
+        memfun_type           _pmemfun;
+        callback_queue_type * _queue;
+    };
+
+    class signal_base
+    {
+    public:
+        virtual ~signal_base () {}
+        virtual void slot_disconnect (basic_has_slots * pslot) = 0;
+    };
+
+    class basic_has_slots : public mutex_type
+    {
+    protected:
+        typedef pfs::set<signal_base *> sender_set;
+        typedef typename sender_set::const_iterator const_iterator;
+
+        sender_set _senders;
+        unique_ptr<callback_queue_type> _queue_ptr;
+        unique_ptr<callback_queue_type> _priority_queue_ptr;
+
+    public:
+        basic_has_slots ()
+        {}
+
+        virtual bool use_async_slots () const = 0;
+        virtual bool is_slave () const { return false; }
+        virtual basic_has_slots * master () const { PFS_ASSERT(this->is_slave()); return 0; }
+
+        void signal_connect (signal_base * sender)
+        {
+            lock_guard<mutex_type> lock(*this);
+            _senders.insert(sender);
+        }
+
+        void signal_disconnect (signal_base * sender)
+        {
+            lock_guard<mutex_type> lock(*this);
+            _senders.erase(sender);
+        }
+
+        virtual ~basic_has_slots ()
+        {
+            disconnect_all();
+        }
+
+        void disconnect_all ()
+        {
+            // Senders are detached before the signals are notified:
+            // signal's disconnect_all() calls signal_disconnect() for
+            // this object too.
+            sender_set senders;
+
+            {
+                lock_guard<mutex_type> lock(*this);
+                senders.swap(_senders);
+            }
+
+            const_iterator it = senders.begin();
+            const_iterator itEnd = senders.end();
+
+            for (; it != itEnd; ++it)
+                (*it)->slot_disconnect(this);
+        }
+
+        size_t count () const
+        {
+            return _senders.size();
+        }
+
+        callback_queue_type & callback_queue () { return *_queue_ptr; }
+        callback_queue_type const & callback_queue () const { return *_queue_ptr; }
+        callback_queue_type & priority_callback_queue () { return *_priority_queue_ptr; }
+        callback_queue_type const & priority_callback_queue () const { return *_priority_queue_ptr; }
+    };
+
+    class has_slots : public basic_has_slots
+    {
+    public:
+        has_slots () : basic_has_slots () {}
+        virtual bool use_async_slots () const override { return false; }
+    };
+
+    class has_async_slots : public basic_has_slots
+    {
+    public:
+        has_async_slots () : basic_has_slots ()
+        {
+            this->_priority_queue_ptr = make_unique<callback_queue_type>();
+            this->_queue_ptr = make_unique<callback_queue_type>();
+        }
+
+        virtual bool use_async_slots () const override { return true; }
+    };
+
+    class has_slave_slots : public basic_has_slots
+    {
+        basic_has_slots * _master;
+
+    public:
+        has_slave_slots (basic_has_slots * master) : _master(master) {}
+        virtual bool use_async_slots () const override { return false; }
+        virtual bool is_slave () const override { return true; }
+        virtual basic_has_slots * master () const override { return _master; }
+    };
+
+    template <typename... Args>
+    class signal : public signal_base
+    {
+    public:
+        typedef connection_base<Args...>       connection_type;
+        typedef std::vector<connection_type *> connections_list;
+
+    private:
+        typedef char cache_line_pad[PFS_CACHE_LINE_SIZE];
+
+        // Serializes writers (connect/disconnect).
+        mutable mutex_type _mutex;
+
+        // Current snapshot, never modified after publishing.
+        atomic<connections_list const *> _slots;
+
+        // Grace period phase and emitters counters per phase
+        // (counters are modified by each emission, so they are placed
+        // apart from read-mostly members).
+        atomic<unsigned int> _phase;
+        cache_line_pad       _pad0;
+        atomic<int>          _readers[2];
+        cache_line_pad       _pad1;
+
+        class reader_guard
+        {
+            atomic<int> & _counter;
+
+        public:
+            reader_guard (signal const & sig)
+                : _counter(const_cast<signal &>(sig)._readers[sig._phase.load() & 1])
+            {
+                ++_counter;
+            }
+
+            ~reader_guard ()
+            {
+                --_counter;
+            }
+        };
+
+    private:
+        /**
+         * @brief Waits until emitters entered before this call leave.
+         *
+         * @details Two phase flips are required: emitter may read
+         *          phase before the first flip but increment its counter
+         *          after the wait for that counter is completed.
+         */
+        void synchronize ()
+        {
+            for (int i = 0; i < 2; ++i) {
+                unsigned int phase = _phase.load() & 1;
+                _phase.store(phase ^ 1);
+
+                while (_readers[phase].load() != 0)
+                    this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Publishes @a slots and releases the previous snapshot
+         *        and connections @a garbage after grace period.
+         *        Must be called by the mutex owner.
+         */
+        void publish (connections_list * slots, connections_list & garbage)
+        {
+            connections_list const * prev = _slots.exchange(slots);
+
+            synchronize();
+
+            typename connections_list::iterator it = garbage.begin();
+            typename connections_list::iterator itEnd = garbage.end();
+
+            for (; it != itEnd; ++it)
+                delete *it;
+
+            delete prev;
+        }
+
+        /**
+         * @return @c true if @a pclass is still connected to the signal.
+         */
+        bool remove (basic_has_slots * pclass, bool first_only)
+        {
+            connections_list const * current = _slots.load();
+            connections_list * slots = new connections_list;
+            connections_list garbage;
+            bool connected = false;
+
+            slots->reserve(current->size());
+
+            typename connections_list::const_iterator it = current->begin();
+            typename connections_list::const_iterator itEnd = current->end();
+
+            for (; it != itEnd; ++it) {
+                if ((*it)->getdest() != pclass) {
+                    slots->push_back(*it);
+                } else if (!first_only || garbage.empty()) {
+                    garbage.push_back(*it);
+                } else {
+                    slots->push_back(*it);
+                    connected = true;
+                }
+            }
+
+            if (garbage.empty())
+                delete slots;
+            else
+                publish(slots, garbage);
+
+            return connected;
+        }
+
+    public:
+        signal ()
+            : _slots(new connections_list)
+            , _phase(0)
+        {
+            _readers[0].store(0);
+            _readers[1].store(0);
+        }
+
+        signal (signal const & s)
+            : signal_base()
+            , _slots(0)
+            , _phase(0)
+        {
+            _readers[0].store(0);
+            _readers[1].store(0);
+
+            lock_guard<mutex_type> lock(s._mutex);
+            connections_list const * other = s._slots.load();
+            connections_list * slots = new connections_list;
+
+            slots->reserve(other->size());
+
+            typename connections_list::const_iterator it = other->begin();
+            typename connections_list::const_iterator itEnd = other->end();
+
+            for (; it != itEnd; ++it) {
+                (*it)->getdest()->signal_connect(this);
+                slots->push_back((*it)->clone());
+            }
+
+            _slots.store(slots);
+        }
+
+        ~signal ()
+        {
+            disconnect_all();
+            delete _slots.load();
+        }
+
+        template <typename DestType>
+        void connect (DestType * pclass, void (DestType::* pmemfun) (Args...))
+        {
+            lock_guard<mutex_type> lock(_mutex);
+            connections_list const * current = _slots.load();
+            connections_list * slots = new connections_list;
+            connections_list garbage;
+
+            slots->reserve(current->size() + 1);
+            slots->assign(current->begin(), current->end());
+            slots->push_back(new connection<DestType, Args...>(pclass, pmemfun));
+
+            publish(slots, garbage);
+            pclass->signal_connect(this);
+        }
+
+        /**
+         * @brief Disconnects first connection of @a pclass.
+         */
+        void disconnect (basic_has_slots * pclass)
+        {
+            lock_guard<mutex_type> lock(_mutex);
+
+            if (!remove(pclass, true))
+                pclass->signal_disconnect(this);
+        }
+
+        void disconnect_all ()
+        {
+            lock_guard<mutex_type> lock(_mutex);
+            connections_list const * current = _slots.load();
+
+            if (current->empty())
+                return;
+
+            connections_list garbage(*current);
+
+            typename connections_list::const_iterator it = garbage.begin();
+            typename connections_list::const_iterator itEnd = garbage.end();
+
+            for (; it != itEnd; ++it)
+                (*it)->getdest()->signal_disconnect(this);
+
+            publish(new connections_list, garbage);
+        }
+
+        virtual void slot_disconnect (basic_has_slots * pslot) override
+        {
+            lock_guard<mutex_type> lock(_mutex);
+            remove(pslot, false);
+        }
+
+        bool isConnected () const
+        {
+            reader_guard guard(*this);
+            return !_slots.load()->empty();
+        }
+
+        void emit_ (Args... args)
+        {
+            reader_guard guard(*this);
+            connections_list const * slots = _slots.load();
+
+            typename connections_list::const_iterator it = slots->begin();
+            typename connections_list::const_iterator itEnd = slots->end();
+
+            for (; it != itEnd; ++it)
+                (*it)->emit_(args...);
+        }
+
+        void operator () (Args... args)
+        {
+            emit_(args...);
+        }
+    };
+
+    typedef signal<> signal0;
+
+    template <typename A1>
+    using signal1 = signal<A1>;
+
+    template <typename A1, typename A2>
+    using signal2 = signal<A1, A2>;
+
+    template <typename A1, typename A2, typename A3>
+    using signal3 = signal<A1, A2, A3>;
+
+    template <typename A1, typename A2, typename A3, typename A4>
+    using signal4 = signal<A1, A2, A3, A4>;
+
+    template <typename A1, typename A2, typename A3, typename A4, typename A5>
+    using signal5 = signal<A1, A2, A3, A4, A5>;
+
+    template <typename A1, typename A2, typename A3, typename A4, typename A5
+            , typename A6>
+    using signal6 = signal<A1, A2, A3, A4, A5, A6>;
+
+    template <typename A1, typename A2, typename A3, typename A4, typename A5
+            , typename A6, typename A7>
+    using signal7 = signal<A1, A2, A3, A4, A5, A6, A7>;
+
+    template <typename A1, typename A2, typename A3, typename A4, typename A5
+            , typename A6, typename A7, typename A8>
+    using signal8 = signal<A1, A2, A3, A4, A5, A6, A7, A8>;
+}; // struct snapshot_sigslot
+
+} // pfs
@@ -1,7 +1,7 @@
 #pragma once
 #include <pfs/cxxlang.hpp>
 #include <pfs/operationsystem.hpp>
-#include <pfs/bits/timer.h>
+#include <pfs/timer_wheel.hpp>
 #include <pfs/type_traits.hpp>
 #include <pfs/atomic.hpp>
 #include <pfs/list.hpp>
@@ -18,6 +18,9 @@
 #include <pfs/datetime.hpp>
 #include <pfs/chrono.hpp>
 #include <pfs/thread.hpp>
+#if __cplusplus >= 201103L
+#   include <pfs/condition_variable.hpp>
+#endif
 #include <pfs/io/file.hpp>
 #include <pfs/io/iterator.hpp>
 
@@ -89,7 +92,10 @@ struct modulus
         , BasicLockable
         , GcThreshold>  callback_queue_type;
 
-    typedef pfs::active_map<int // timer id type
+    typedef pfs::timer_wheel<>          timer_pool_type;
+    typedef timer_pool_type::id_type    timer_id_type;
+
+    typedef pfs::active_map<timer_id_type
         , void
         , AssociativeContainer
         , BasicLockable> timer_callback_map;
@@ -191,6 +197,11 @@ struct modulus
             _pdispatcher->print_error(this, s);
         }
 
+        void stop_timer (timer_id_type id)
+        {
+            _pdispatcher->stop_timer(id);
+        }
+
     protected:
         string_type  _name;
         dispatcher * _pdispatcher;
@@ -290,15 +301,15 @@ struct modulus
         module (dispatcher * pdisp) : basic_module(pdisp) {}
         virtual bool use_async_slots () const override { return false; }
 
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
         {
-            this->get_dispatcher()->start_timer(timer_type, seconds, f);
+            return this->get_dispatcher()->start_timer(timer_type, seconds, f);
         }
 
         template <typename Arg1>
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
         {
-            this->get_dispatcher()->start_timer(timer_type, seconds, f, a1);
+            return this->get_dispatcher()->start_timer(timer_type, seconds, f, a1);
         }
     };
 
@@ -347,15 +358,15 @@ struct modulus
                     && this->callback_queue().empty());
         }
 
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
         {
-            this->get_dispatcher()->start_timer(timer_type, seconds, *this, f);
+            return this->get_dispatcher()->start_timer(timer_type, seconds, *this, f);
         }
 
         template <typename Arg1>
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
         {
-            this->get_dispatcher()->template start_timer<Arg1>(timer_type, seconds, *this, f, a1);
+            return this->get_dispatcher()->template start_timer<Arg1>(timer_type, seconds, *this, f, a1);
         }
     };
 
@@ -370,15 +381,15 @@ struct modulus
         virtual typename sigslot_ns::basic_has_slots * master () const { return _master; }
         void set_master (async_module * master) { _master = master; }
 
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
         {
-            this->get_dispatcher()->start_timer(timer_type, seconds, *_master, f);
+            return this->get_dispatcher()->start_timer(timer_type, seconds, *_master, f);
         }
 
         template <typename Arg1>
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
         {
-            this->get_dispatcher()->start_timer(timer_type, seconds, *_master, f, a1);
+            return this->get_dispatcher()->start_timer(timer_type, seconds, *_master, f, a1);
         }
     };
 
@@ -559,6 +570,7 @@ struct modulus
         virtual void quit () override
         {
             _quitfl.store(1);
+            wakeup();
         }
 
         bool is_quit () const
@@ -568,32 +580,48 @@ struct modulus
 
         int exec ();
 
-        void start_timer (timer_type_enum timer_type, double seconds, async_module & m, void (* f) ())
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, async_module & m, void (* f) ())
         {
-            start_timer(timer_type, seconds, & m.priority_callback_queue(), f);
+            return start_timer(timer_type, seconds, & m.priority_callback_queue(), f);
         }
 
         template <typename Arg1>
-        void start_timer (timer_type_enum timer_type, double seconds, async_module & m, void (* f) (Arg1), Arg1 a1)
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, async_module & m, void (* f) (Arg1), Arg1 a1)
         {
-            start_timer<Arg1>(timer_type, seconds, & m.priority_callback_queue(), f, a1);
+            return start_timer<Arg1>(timer_type, seconds, & m.priority_callback_queue(), f, a1);
         }
 
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) ())
         {
-            start_timer(timer_type, seconds, & this->priority_callback_queue(), f);
+            return start_timer(timer_type, seconds, & this->priority_callback_queue(), f);
         }
 
         template <typename Arg1>
-        void start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, void (* f) (Arg1), Arg1 a1)
+        {
+            return start_timer<Arg1>(timer_type, seconds, & this->priority_callback_queue(), f, a1);
+        }
+
+        /**
+         * @brief Wakes up dispatcher loop (it is waiting for callbacks or
+         *        the nearest timer expiration).
+         */
+        void wakeup ()
         {
-            start_timer<Arg1>(timer_type, seconds, & this->priority_callback_queue(), f, a1);
+#if __cplusplus >= 201103L
+            {
+                pfs::lock_guard<pfs::mutex> locker(_wakeup_mutex);
+                _wakeup_flag = true;
+            }
+
+            _wakeup_cond.notify_one();
+#endif
         }
 
-        void stop_timer (timer_id_t id)
+        void stop_timer (timer_id_type id)
         {
             pfs::unique_lock<BasicLockable> locker(_timer_mutex);
-            timer_unset(id);
+            _timers.stop(id);
             _timer_callbacks.erase(id);
         }
 
@@ -781,6 +809,34 @@ struct modulus
 
         basic_module * find_registered_module (string_type const & name);
 
+        static void wakeup_notifier (void * d)
+        {
+            static_cast<dispatcher *>(d)->wakeup();
+        }
+
+        struct timer_expiration_handler
+        {
+            dispatcher * d;
+
+            timer_expiration_handler (dispatcher * x) : d(x) {}
+
+            void operator () (timer_id_type id, int)
+            {
+                // One-shot timer is already released
+                if (d->_timers.is_active(id))
+                    d->_timer_callbacks.call(id);
+                else
+                    d->_timer_callbacks.call_and_erase(id);
+            }
+        };
+
+        /**
+         * @brief Processes passed timers.
+         * @return Time in seconds until the nearest timer expiration
+         *         or negative value if there are no armed timers.
+         */
+        double process_timers ();
+
         static void deferred_caller (callback_queue_type * q, void (* f) ())
         {
             q->push_function(f);
@@ -792,19 +848,27 @@ struct modulus
             q->template push_function<Arg1>(f, a1);
         }
 
-        void start_timer (timer_type_enum timer_type, double seconds, callback_queue_type * q, void (* f) ())
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, callback_queue_type * q, void (* f) ())
         {
             pfs::unique_lock<BasicLockable> locker(_timer_mutex);
-            timer_id_t id = timer_set(timer_type, seconds);
+            timer_id_type id = _timers.start(timer_type, seconds);
             _timer_callbacks.insert_function(id, deferred_caller, q, f);
+            locker.unlock();
+
+            // Dispatcher must recalculate the nearest deadline
+            wakeup();
+            return id;
         }
 
         template <typename Arg1>
-        void start_timer (timer_type_enum timer_type, double seconds, callback_queue_type * q, void (* f) (Arg1), Arg1 a1)
+        timer_id_type start_timer (timer_type_enum timer_type, double seconds, callback_queue_type * q, void (* f) (Arg1), Arg1 a1)
         {
             pfs::unique_lock<BasicLockable> locker(_timer_mutex);
-            timer_id_t id = timer_set(timer_type, seconds);
+            timer_id_type id = _timers.start(timer_type, seconds);
             _timer_callbacks.template insert_function<callback_queue_type *, void (*) (Arg1), Arg1>(id, deferred_caller, q, f, a1);
+            locker.unlock();
+            wakeup();
+            return id;
         }
 
     private:
@@ -823,8 +887,15 @@ struct modulus
         logger_type            _logger;
 
         BasicLockable       _timer_mutex;
+        timer_pool_type     _timers;
         timer_callback_map  _timer_callbacks;
 
+#if __cplusplus >= 201103L
+        pfs::mutex              _wakeup_mutex;
+        pfs::condition_variable _wakeup_cond;
+        bool                    _wakeup_flag;
+#endif
+
         // Console appenders
         typename log_ns::appender * _cout_appender_ptr;
         typename log_ns::appender * _cerr_appender_ptr;
@@ -842,7 +913,15 @@ modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::dispatcher (
     , error_printer(& dispatcher::sync_print_error)
     , _master_module_ptr(0)
     , _quitfl(0)
+#if __cplusplus >= 201103L
+    , _wakeup_flag(false)
+#endif
 {
+    // Callbacks pushed into dispatcher's queues (by async slots and timers)
+    // wake up dispatcher loop
+    this->_queue_ptr->set_notifier(& dispatcher::wakeup_notifier, this);
+    this->_priority_queue_ptr->set_notifier(& dispatcher::wakeup_notifier, this);
+
     // Initialize default logger
     _cout_appender_ptr = & _logger.template add_appender<typename log_ns::stdout_appender>();
     _cerr_appender_ptr = & _logger.template add_appender<typename log_ns::stderr_appender>();
@@ -893,33 +972,52 @@ void modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::connect_all ()
     }
 }
 
+template <PFS_MODULUS_TEMPLETE_SIGNATURE>
+double modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::process_timers ()
+{
+    pfs::unique_lock<BasicLockable> locker(_timer_mutex);
+
+    timer_expiration_handler handler(this);
+    _timers.expire(handler);
+
+    return _timers.next_timeout();
+}
+
 template <PFS_MODULUS_TEMPLETE_SIGNATURE>
 void modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::run ()
 {
-    pfs::unique_lock<BasicLockable> locker(_timer_mutex, DEFER_LOCK);
+#if __cplusplus >= 201103L
+    // Condition variable may wake up a bit earlier than the timer tick
+    // changes, so limit waiting time from below to avoid busy loop
+    static double const min_timeout = 0.0001;
 
     while (! _quitfl) {
-        locker.lock();
+        double timeout = process_timers();
 
-        int ntimers = timer_count();
+        this->_priority_queue_ptr->call_all();
+        this->_queue_ptr->call_all();
 
-        if (ntimers > 0) {
-            for (int i = 0; i < ntimers; ++i) {
-                if (timer_passed(i)) {
-                    if (timer_is_periodic(i)) {
-                        _timer_callbacks.call(i);
-                    } else {
-                        _timer_callbacks.call_and_erase(i);
-                    }
+        pfs::unique_lock<pfs::mutex> locker(_wakeup_mutex);
 
-                    timer_reset(i);
-                }
+        // Wait for new callbacks, quit or the nearest timer expiration
+        if (!_wakeup_flag && !_quitfl) {
+            if (timeout < 0) {
+                _wakeup_cond.wait(locker);
+            } else {
+                if (timeout < min_timeout)
+                    timeout = min_timeout;
+
+                _wakeup_cond.wait_for(locker, pfs::chrono::duration<double>(timeout));
             }
         }
 
-        locker.unlock();
+        _wakeup_flag = false;
+    }
+#else
+    while (! _quitfl) {
+        process_timers();
 
-        // FIXME Use condition_variable to wait until _callback_queue will not be empty.
+        // There is no condition variable in C++98 implementation, so poll
         if (this->_queue_ptr->empty()) {
             pfs::this_thread::sleep_for(pfs::chrono::microseconds(100));
             continue;
@@ -927,7 +1025,9 @@ void modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::run ()
 
         this->_queue_ptr->call(5);
     }
+#endif
 
+    this->_priority_queue_ptr->call_all();
     this->_queue_ptr->call_all();
 }
 
@@ -970,17 +1070,6 @@ bool modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::start ()
         error_printer = & dispatcher::async_print_error;
     }
 
-    //
-    // Start timer
-    //
-    if (ok) {
-        if (timer_init() != 0) {
-            print_error(fmt("failed to initialize timer: %s")
-                    % pfs::to_string(pfs::get_last_system_error()));
-            ok = false;
-        }
-    }
-
     return ok;
 }
 
@@ -990,7 +1079,7 @@ void modulus<PFS_MODULUS_TEMPLETE_ARGS>::dispatcher::finalize ()
     this->_queue_ptr->call_all();
 
     _timer_callbacks.clear();
-    timer_done();
+    _timers.clear();
 
     info_printer  = & dispatcher::sync_print_info;
     debug_printer = & dispatcher::sync_print_debug;
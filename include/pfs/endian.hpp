@@ -120,6 +120,37 @@ public:
         return _value != native_order().type() ? bswap(i) : i;
     }
 
+    /**
+     * @brief Converts array of @a n values in place.
+     */
+    template <typename T>
+    void convert (T * p, size_t n) const
+    {
+        if (_value != native_order().type())
+            bswap_array(p, n);
+    }
+
+    /**
+     * @brief Reverses byte order of each of @a n values of array @a p.
+     *
+     * @details Inner loop has constant trip count, so the whole loop
+     *          is unrolled and vectorized by optimizing compiler.
+     */
+    template <typename T>
+    static void bswap_array (T * p, size_t n)
+    {
+        byte_t * b = reinterpret_cast<byte_t *>(p);
+        byte_t * e = b + n * sizeof(T);
+
+        for (; b != e; b += sizeof(T)) {
+            for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+                byte_t t = b[i];
+                b[i] = b[sizeof(T) - 1 - i];
+                b[sizeof(T) - 1 - i] = t;
+            }
+        }
+    }
+
     static char           bswap (char i);
     static signed char    bswap (signed char i);
     static unsigned char  bswap (unsigned char i);
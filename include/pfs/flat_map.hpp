@@ -0,0 +1,242 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <pfs/utility.hpp>
+
+namespace pfs {
+
+/**
+ * @brief Associative container implemented as sorted vector
+ *        of key/value pairs.
+ *
+ * @details Has the same interface as pfs::map (that is required by
+ *          pfs::json for object container), but stores elements
+ *          contiguously: lookup is a binary search over the vector,
+ *          insertion and erasure shift elements and invalidate iterators.
+ *          Suitable for small and mostly read-only maps (e.g. JSON objects).
+ */
+template <typename Key
+        , typename T
+        , typename Allocator = std::allocator<std::pair<Key, T> > >
+class basic_flat_map
+{
+public:
+    typedef Key                                      key_type;
+    typedef T                                        mapped_type;
+    typedef std::pair<Key, T>                        value_type;
+    typedef Allocator                                allocator_type;
+    typedef std::vector<value_type, allocator_type>  container_type;
+    typedef typename container_type::size_type       size_type;
+    typedef typename container_type::difference_type difference_type;
+    typedef value_type &                             reference;
+    typedef value_type const &                       const_reference;
+    typedef typename container_type::pointer         pointer;
+    typedef typename container_type::const_pointer   const_pointer;
+    typedef typename container_type::iterator        iterator;
+    typedef typename container_type::const_iterator  const_iterator;
+    typedef typename container_type::reverse_iterator       reverse_iterator;
+    typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+private:
+    struct key_less
+    {
+        bool operator () (value_type const & a, key_type const & key) const
+        {
+            return a.first < key;
+        }
+    };
+
+    container_type _d;
+
+private:
+    iterator mutable_iterator (const_iterator pos)
+    {
+        return _d.begin() + (pos - cbegin());
+    }
+
+public:
+    basic_flat_map () {}
+
+    explicit basic_flat_map (allocator_type const & alloc)
+        : _d(alloc)
+    {}
+
+    template <typename InputIt>
+    basic_flat_map (InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            insert(first->first, first->second);
+    }
+
+    allocator_type get_allocator () const
+    {
+        return _d.get_allocator();
+    }
+
+    iterator begin ()              { return _d.begin(); }
+    const_iterator begin () const  { return _d.begin(); }
+    const_iterator cbegin () const { return _d.begin(); }
+    iterator end ()                { return _d.end(); }
+    const_iterator end () const    { return _d.end(); }
+    const_iterator cend () const   { return _d.end(); }
+
+    reverse_iterator rbegin ()              { return _d.rbegin(); }
+    const_reverse_iterator rbegin () const  { return _d.rbegin(); }
+    const_reverse_iterator crbegin () const { return _d.rbegin(); }
+    reverse_iterator rend ()                { return _d.rend(); }
+    const_reverse_iterator rend () const    { return _d.rend(); }
+    const_reverse_iterator crend () const   { return _d.rend(); }
+
+    bool empty () const
+    {
+        return _d.empty();
+    }
+
+    size_type size () const
+    {
+        return _d.size();
+    }
+
+    size_type max_size () const
+    {
+        return _d.max_size();
+    }
+
+    void reserve (size_type n)
+    {
+        _d.reserve(n);
+    }
+
+    void clear ()
+    {
+        _d.clear();
+    }
+
+    iterator lower_bound (key_type const & key)
+    {
+        return std::lower_bound(_d.begin(), _d.end(), key, key_less());
+    }
+
+    const_iterator lower_bound (key_type const & key) const
+    {
+        return std::lower_bound(_d.begin(), _d.end(), key, key_less());
+    }
+
+    iterator find (key_type const & key)
+    {
+        iterator it = lower_bound(key);
+        return (it != _d.end() && !(key < it->first)) ? it : _d.end();
+    }
+
+    const_iterator find (key_type const & key) const
+    {
+        const_iterator it = lower_bound(key);
+        return (it != _d.end() && !(key < it->first)) ? it : _d.end();
+    }
+
+    size_type count (key_type const & key) const
+    {
+        return find(key) != _d.end() ? 1 : 0;
+    }
+
+    pfs::pair<iterator,bool> insert (key_type const & key, mapped_type const & value)
+    {
+        iterator it = lower_bound(key);
+
+        if (it != _d.end() && !(key < it->first))
+            return pfs::make_pair(it, false);
+
+        // Appending in key order (most common case for parsed documents)
+        // does not shift elements
+        it = _d.insert(it, value_type(key, value));
+        return pfs::make_pair(it, true);
+    }
+
+    pfs::pair<iterator,bool> insert (value_type const & value)
+    {
+        return insert(value.first, value.second);
+    }
+
+    mapped_type & operator [] (key_type const & key)
+    {
+        return insert(key, mapped_type()).first->second;
+    }
+
+    iterator erase (const_iterator pos)
+    {
+        return _d.erase(mutable_iterator(pos));
+    }
+
+    iterator erase (const_iterator first, const_iterator last)
+    {
+        return _d.erase(mutable_iterator(first), mutable_iterator(last));
+    }
+
+    size_type erase (key_type const & key)
+    {
+        iterator it = find(key);
+
+        if (it == _d.end())
+            return 0;
+
+        _d.erase(it);
+        return 1;
+    }
+
+    void swap (basic_flat_map & rhs)
+    {
+        _d.swap(rhs._d);
+    }
+
+    static inline mapped_type & mapped_reference (iterator it)
+    {
+        return it->second;
+    }
+
+    static inline mapped_type const & mapped_reference (const_iterator it)
+    {
+        return it->second;
+    }
+
+    static inline key_type const & key_reference (const_iterator it)
+    {
+        return it->first;
+    }
+
+    bool operator == (basic_flat_map const & rhs) const
+    {
+        return _d == rhs._d;
+    }
+
+    bool operator != (basic_flat_map const & rhs) const
+    {
+        return _d != rhs._d;
+    }
+};
+
+#if __cplusplus >= 201103L
+
+template <typename Key, typename T>
+using flat_map = basic_flat_map<Key, T>;
+
+#else
+
+template <typename Key, typename T>
+class flat_map : public basic_flat_map<Key, T>
+{
+    typedef basic_flat_map<Key, T> base_class;
+
+public:
+    flat_map () : base_class() {}
+
+    template <typename InputIt>
+    flat_map (InputIt first, InputIt last)
+        : base_class(first, last)
+    {}
+};
+
+#endif
+
+} // pfs
@@ -0,0 +1,739 @@
+#pragma once
+#include <cstring>
+#include <pfs/types.hpp>
+#include <pfs/limits.hpp>
+#include <pfs/vector.hpp>
+#include <pfs/map.hpp>
+#include <pfs/mutex.hpp>
+#include <pfs/fsm/fsm.hpp>
+
+namespace pfs {
+
+namespace unicode {
+struct char_t;
+}
+
+namespace fsm {
+
+/**
+ * @brief Converts character to integer code used as index
+ *        of character class.
+ */
+template <typename CharT>
+struct char_code
+{
+    static uint32_t code (CharT c)
+    {
+        return static_cast<uint32_t>(c);
+    }
+};
+
+template <>
+struct char_code<char>
+{
+    static uint32_t code (char c)
+    {
+        return static_cast<unsigned char>(c);
+    }
+};
+
+template <>
+struct char_code<signed char>
+{
+    static uint32_t code (signed char c)
+    {
+        return static_cast<unsigned char>(c);
+    }
+};
+
+template <>
+struct char_code<unicode::char_t>
+{
+    template <typename CharT>
+    static uint32_t code (CharT const & c)
+    {
+        return c.value;
+    }
+};
+
+/**
+ * @brief Transition tables lowered into flat program.
+ *
+ * @details Table can be lowered if its transitions have no actions
+ *          and match characters only: nothing, length, eq, one_of, range,
+ *          seq, rpt of these and tr referencing tables which can be lowered
+ *          too. Each match becomes an instruction of the program,
+ *          characters sets (eq, one_of, range) become byte classes
+ *          (bitmap for codes below 256 and ranges for others).
+ *          Chains of single-character alternatives (linked by
+ *          state_fail) get jump tables indexed by the input byte,
+ *          so the matching alternative is found by one lookup.
+ *
+ *          Control flow of the interpreter (fsm::exec()) is kept as is:
+ *          alternatives are ordered and failed transition returns
+ *          to the last accepted position, so tables are not merged into
+ *          one automaton.
+ *
+ *          Tables which can not be lowered (with actions or match_func)
+ *          are still interpreted, but their tr() references to lowered
+ *          tables are executed by the program.
+ */
+template <typename Iterator, typename AtomicInt = int>
+class dfa
+{
+public:
+    typedef fsm<Iterator, AtomicInt>         fsm_type;
+    typedef match<Iterator, AtomicInt>       match_type;
+    typedef transition<Iterator, AtomicInt>  transition_type;
+    typedef context<Iterator, AtomicInt>     context_type;
+    typedef typename match_type::iterator    iterator;
+    typedef typename match_type::char_type   char_type;
+    typedef typename match_type::size_type   size_type;
+    typedef typename match_type::result_type result_type;
+    typedef typename match_type::atomic_type atomic_type;
+
+private:
+    typedef typename match_type::match_base   match_base;
+    typedef typename match_type::match_length match_length;
+    typedef typename match_type::match_seq    match_seq;
+    typedef typename match_type::match_eq     match_eq;
+    typedef typename match_type::match_one_of match_one_of;
+    typedef typename match_type::match_range  match_range;
+    typedef typename match_type::match_tr     match_tr;
+    typedef typename match_type::match_rpt    match_rpt;
+    typedef typename match_type::match_nothing match_nothing;
+    typedef char_code<char_type>              char_code_type;
+
+    enum opcode_enum {
+          op_nothing
+        , op_length
+        , op_class
+        , op_seq
+        , op_rpt
+        , op_tr
+    };
+
+    // Instruction, arg is length, index of class, sequence, repeated
+    // instruction or table depending on opcode.
+    struct instruction
+    {
+        int opcode;
+        int arg;
+        int from;
+        int to;
+    };
+
+    struct char_class
+    {
+        uint32_t bits[8];
+        pfs::vector<pfs::pair<uint32_t, uint32_t> > wide;
+
+        char_class ()
+        {
+            std::memset(bits, 0, sizeof(bits));
+        }
+
+        void set (uint32_t from, uint32_t to)
+        {
+            for (; from <= to && from < 256; ++from)
+                bits[from >> 5] |= uint32_t(1) << (from & 31);
+
+            if (from <= to)
+                wide.push_back(pfs::make_pair(from, to));
+        }
+
+        bool test (uint32_t c) const
+        {
+            if (c < 256)
+                return (bits[c >> 5] & (uint32_t(1) << (c & 31))) != 0;
+
+            for (size_t i = 0, n = wide.size(); i < n; ++i) {
+                if (c >= wide[i].first && c <= wide[i].second)
+                    return true;
+            }
+
+            return false;
+        }
+    };
+
+    struct state
+    {
+        int next;
+        int fail;
+        int status;
+        int instr;
+        int jump; // index of jump table or -1
+    };
+
+    // Chain of single-character alternatives started from the state.
+    struct jump_table
+    {
+        unsigned char alt[256];      // index in chain or chain size if none
+        pfs::vector<int> states;     // chain states
+        pfs::vector<char> accepted;  // accepted flag survives failures before alternative
+        int fail;                    // state after failure of all alternatives
+        char all_accepted;
+    };
+
+    struct table
+    {
+        transition_type const * tr;
+        int size;        // number of transitions
+        int first;       // index of the first state in _states
+        bool lowered;
+        pfs::vector<char> reachable;
+        pfs::vector<transition_type const *> refs;
+    };
+
+    // Match which executes lowered table, assigned to match_tr.
+    class match_dfa : public match_base
+    {
+        dfa * _dfa;
+        int   _table;
+
+    public:
+        match_dfa (dfa * d, int table)
+            : _dfa(d)
+            , _table(table)
+        {
+            ++_dfa->_ref;
+        }
+
+        virtual ~match_dfa ()
+        {
+            if (!--_dfa->_ref)
+                delete _dfa;
+        }
+
+        virtual result_type do_match (context_type *
+                , iterator begin
+                , iterator end) const
+        {
+            return _dfa->exec(_table, begin, end);
+        }
+    };
+
+    typedef pfs::map<transition_type const *, int> table_map;
+
+    atomic_type                   _ref;
+    pfs::vector<table>            _tables;
+    pfs::vector<state>            _states;
+    pfs::vector<instruction>      _instrs;
+    pfs::vector<char_class>       _classes;
+    pfs::vector<pfs::vector<uint32_t> > _seqs;
+    pfs::vector<jump_table>       _jumps;
+    table_map                     _index;
+
+private:
+    dfa ()
+        : _ref(0)
+    {}
+
+    static void normalize_rpt (match_rpt const * rpt, int & from, int & to)
+    {
+        from = rpt->_from >= 0 ? rpt->_from : 0;
+        to = rpt->_to >= 0 ? rpt->_to : pfs::numeric_limits<int>::max();
+    }
+
+    /**
+     * @brief Checks if match can be lowered, collects referenced tables.
+     */
+    static bool inspect (match_base const * p
+            , pfs::vector<transition_type const *> & refs)
+    {
+        if (dynamic_cast<match_nothing const *>(p)
+                || dynamic_cast<match_length const *>(p)
+                || dynamic_cast<match_seq const *>(p)
+                || dynamic_cast<match_eq const *>(p)
+                || dynamic_cast<match_range const *>(p))
+            return true;
+
+        if (match_one_of const * m = dynamic_cast<match_one_of const *>(p))
+            return m->_seq_begin != m->_seq_end; // empty one_of matches end only
+
+        if (match_tr const * m = dynamic_cast<match_tr const *>(p)) {
+            refs.push_back(m->_tr);
+            return true;
+        }
+
+        if (match_rpt const * m = dynamic_cast<match_rpt const *>(p)) {
+            int from, to;
+            normalize_rpt(m, from, to);
+
+            // Let interpreter throw out_of_range
+            return from <= to && inspect(m->_match._p, refs);
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Adds @a tr and all tables referenced by it into the graph.
+     */
+    int collect (transition_type const * tr)
+    {
+        typename table_map::const_iterator it = _index.find(tr);
+
+        if (it != _index.end())
+            return table_map::mapped_reference(it);
+
+        int index = static_cast<int>(_tables.size());
+        _index.insert(tr, index);
+        _tables.push_back(table());
+
+        // Transitions count is unknown, so find the maximum reachable state
+        pfs::vector<char> visited;
+        pfs::vector<int> stack;
+        int size = 0;
+        bool lowered = true;
+        pfs::vector<transition_type const *> refs;
+
+        stack.push_back(0);
+
+        while (!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+
+            if (i < 0)
+                continue;
+
+            if (static_cast<size_t>(i) >= visited.size())
+                visited.resize(i + 1, 0);
+
+            if (visited[i])
+                continue;
+
+            visited[i] = 1;
+
+            if (i + 1 > size)
+                size = i + 1;
+
+            // Inspect anyway to collect referenced tables
+            if (!inspect(tr[i].m._p, refs) || tr[i].action)
+                lowered = false;
+
+            stack.push_back(tr[i].state_next);
+            stack.push_back(tr[i].state_fail);
+        }
+
+        {
+            table & t = _tables[index];
+            t.tr = tr;
+            t.size = size;
+            t.first = -1;
+            t.lowered = lowered;
+            t.reachable = visited;
+            t.refs = refs;
+        }
+
+        for (size_t i = 0, n = refs.size(); i < n; ++i)
+            collect(refs[i]);
+
+        return index;
+    }
+
+    int table_index (transition_type const * tr) const
+    {
+        return table_map::mapped_reference(_index.find(tr));
+    }
+
+    int add_class (char_class const & cls)
+    {
+        _classes.push_back(cls);
+        return static_cast<int>(_classes.size()) - 1;
+    }
+
+    int add_instr (int opcode, int arg, int from = 0, int to = 0)
+    {
+        instruction instr;
+        instr.opcode = opcode;
+        instr.arg = arg;
+        instr.from = from;
+        instr.to = to;
+        _instrs.push_back(instr);
+        return static_cast<int>(_instrs.size()) - 1;
+    }
+
+    static void range_class (char_class & cls, char_type min, char_type max)
+    {
+        if (sizeof(char_type) == 1) {
+            // Keep interpreter's comparison semantics for signed chars
+            for (int i = 0; i < 256; ++i) {
+                char_type ch = static_cast<char_type>(i);
+
+                if (ch >= min && ch <= max)
+                    cls.set(char_code_type::code(ch), char_code_type::code(ch));
+            }
+        } else {
+            cls.set(char_code_type::code(min), char_code_type::code(max));
+        }
+    }
+
+    int lower (match_base const * p)
+    {
+        if (dynamic_cast<match_nothing const *>(p))
+            return add_instr(op_nothing, 0);
+
+        if (match_length const * m = dynamic_cast<match_length const *>(p))
+            return add_instr(op_length, static_cast<int>(m->_len));
+
+        if (match_eq const * m = dynamic_cast<match_eq const *>(p)) {
+            char_class cls;
+            uint32_t c = char_code_type::code(m->_ch);
+            cls.set(c, c);
+            return add_instr(op_class, add_class(cls));
+        }
+
+        if (match_one_of const * m = dynamic_cast<match_one_of const *>(p)) {
+            char_class cls;
+
+            for (iterator it = m->_seq_begin; it != m->_seq_end; ++it) {
+                uint32_t c = char_code_type::code(*it);
+                cls.set(c, c);
+            }
+
+            return add_instr(op_class, add_class(cls));
+        }
+
+        if (match_range const * m = dynamic_cast<match_range const *>(p)) {
+            char_class cls;
+            range_class(cls, m->_min, m->_max);
+            return add_instr(op_class, add_class(cls));
+        }
+
+        if (match_seq const * m = dynamic_cast<match_seq const *>(p)) {
+            pfs::vector<uint32_t> seq;
+
+            for (iterator it = m->_seq_begin; it != m->_seq_end; ++it)
+                seq.push_back(char_code_type::code(*it));
+
+            _seqs.push_back(seq);
+            return add_instr(op_seq, static_cast<int>(_seqs.size()) - 1);
+        }
+
+        if (match_tr const * m = dynamic_cast<match_tr const *>(p))
+            return add_instr(op_tr, table_index(m->_tr));
+
+        match_rpt const * m = dynamic_cast<match_rpt const *>(p);
+        PFS_ASSERT(m);
+
+        int from, to;
+        normalize_rpt(m, from, to);
+        int sub = lower(m->_match._p);
+        return add_instr(op_rpt, sub, from, to);
+    }
+
+    void build_jump (int first, int s)
+    {
+        pfs::vector<int> chain;
+
+        for (int i = s; i >= 0 && chain.size() < 255; i = _states[first + i].fail) {
+            bool seen = false;
+
+            for (size_t j = 0; j < chain.size(); ++j)
+                seen = seen || chain[j] == i;
+
+            if (seen || _instrs[_states[first + i].instr].opcode != op_class)
+                break;
+
+            chain.push_back(i);
+        }
+
+        if (chain.size() < 2)
+            return;
+
+        jump_table jt;
+        unsigned char none = static_cast<unsigned char>(chain.size());
+
+        std::memset(jt.alt, none, sizeof(jt.alt));
+        jt.states = chain;
+        jt.fail = _states[first + chain.back()].fail;
+        jt.all_accepted = 1;
+
+        for (size_t j = 0; j < chain.size(); ++j) {
+            state const & st = _states[first + chain[j]];
+            char_class const & cls = _classes[_instrs[st.instr].arg];
+
+            jt.accepted.push_back(jt.all_accepted);
+
+            for (int c = 0; c < 256; ++c) {
+                if (jt.alt[c] == none && cls.test(c))
+                    jt.alt[c] = static_cast<unsigned char>(j);
+            }
+
+            if (st.status != fsm_type::accept)
+                jt.all_accepted = 0;
+        }
+
+        _jumps.push_back(jt);
+        _states[first + s].jump = static_cast<int>(_jumps.size()) - 1;
+    }
+
+    void build ()
+    {
+        // Tables referencing not lowered tables can't be lowered too
+        bool changed = true;
+
+        while (changed) {
+            changed = false;
+
+            for (size_t i = 0, n = _tables.size(); i < n; ++i) {
+                table & t = _tables[i];
+
+                if (!t.lowered)
+                    continue;
+
+                for (size_t j = 0, k = t.refs.size(); j < k; ++j) {
+                    if (!_tables[table_index(t.refs[j])].lowered) {
+                        t.lowered = false;
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0, n = _tables.size(); i < n; ++i) {
+            table & t = _tables[i];
+
+            if (!t.lowered)
+                continue;
+
+            t.first = static_cast<int>(_states.size());
+
+            for (int j = 0; j < t.size; ++j) {
+                transition_type const & tr = t.tr[j];
+                state st;
+                st.next = tr.state_next;
+                st.fail = tr.state_fail;
+                st.status = tr.status;
+                st.instr = -1;
+                st.jump = -1;
+                _states.push_back(st);
+            }
+        }
+
+        // States not reachable from the initial one are left
+        // uninitialized (instr == -1), they are never executed.
+        for (size_t i = 0, n = _tables.size(); i < n; ++i) {
+            table const & t = _tables[i];
+
+            if (!t.lowered)
+                continue;
+
+            for (int j = 0; j < t.size; ++j) {
+                if (j < static_cast<int>(t.reachable.size()) && t.reachable[j])
+                    _states[t.first + j].instr = lower(t.tr[j].m._p);
+            }
+        }
+
+        for (size_t i = 0, n = _tables.size(); i < n; ++i) {
+            table const & t = _tables[i];
+
+            if (!t.lowered)
+                continue;
+
+            for (int j = 0; j < t.size; ++j) {
+                if (_states[t.first + j].instr >= 0)
+                    build_jump(t.first, j);
+            }
+        }
+    }
+
+    /**
+     * @brief Assigns lowered tables to match_tr objects found
+     *        in all collected tables.
+     */
+    void attach (match_base const * p)
+    {
+        if (match_tr const * m = dynamic_cast<match_tr const *>(p)) {
+            if (!m->_lowered) {
+                int index = table_index(m->_tr);
+
+                if (_tables[index].lowered)
+                    m->_lowered = new match_dfa(this, index);
+            }
+        } else if (match_rpt const * m = dynamic_cast<match_rpt const *>(p)) {
+            attach(m->_match._p);
+        }
+    }
+
+    result_type exec_instr (int index, iterator begin, iterator end) const
+    {
+        instruction const & instr = _instrs[index];
+
+        switch (instr.opcode) {
+        case op_nothing:
+            return result_type(true, begin);
+
+        case op_length:
+            return match_type::match_traits_type::xmatch_length(begin, end
+                    , static_cast<size_type>(instr.arg));
+
+        case op_class:
+            if (begin != end && _classes[instr.arg].test(char_code_type::code(*begin)))
+                return result_type(true, ++begin);
+            return result_type(false, end);
+
+        case op_seq: {
+            pfs::vector<uint32_t> const & seq = _seqs[instr.arg];
+            size_t i = 0;
+            size_t n = seq.size();
+
+            if (begin == end)
+                return n == 0 ? result_type(true, end) : result_type(false, end);
+
+            while (begin != end && i < n && char_code_type::code(*begin) == seq[i]) {
+                ++begin;
+                ++i;
+            }
+
+            return i == n ? result_type(true, begin) : result_type(false, end);
+        }
+
+        case op_rpt: {
+            int i = 0;
+
+            for (i = 0; i < instr.to && begin != end; i++) {
+                result_type r = exec_instr(instr.arg, begin, end);
+
+                if (!r.first)
+                    break;
+
+                begin = r.second;
+            }
+
+            return i < instr.from ? result_type(false, end) : result_type(true, begin);
+        }
+
+        case op_tr:
+        default:
+            return exec(instr.arg, begin, end);
+        }
+    }
+
+public:
+    /**
+     * @brief Executes lowered table @a t the same way as fsm::exec() does.
+     */
+    result_type exec (int t, iterator begin, iterator end) const
+    {
+        state const * states = & _states[_tables[t].first];
+        iterator ptr = begin;
+        iterator ptr_accepted = begin;
+        bool accepted = false;
+        int state_cur = 0;
+
+        do {
+            state const * st = & states[state_cur];
+
+            if (st->jump >= 0 && ptr == ptr_accepted && ptr != end) {
+                uint32_t c = char_code_type::code(*ptr);
+
+                if (c < 256) {
+                    jump_table const & jt = _jumps[st->jump];
+                    size_t alt = jt.alt[c];
+
+                    if (alt == jt.states.size()) {
+                        // No alternative matches
+                        if (!jt.all_accepted)
+                            accepted = false;
+
+                        state_cur = jt.fail;
+
+                        if (state_cur < 0)
+                            break;
+
+                        continue;
+                    }
+
+                    if (!jt.accepted[alt])
+                        accepted = false;
+
+                    st = & states[jt.states[alt]];
+                }
+            }
+
+            result_type r = exec_instr(st->instr, ptr, end);
+
+            if (r.first) {
+                if (st->status == fsm_type::accept)
+                    accepted = true;
+
+                ptr = r.second;
+
+                if (st->status == fsm_type::accept)
+                    ptr_accepted = ptr;
+
+                if (st->status == fsm_type::reject) {
+                    state_cur = -1;
+                    accepted = false;
+                } else {
+                    state_cur = st->next;
+                }
+            } else {
+                state_cur = st->fail;
+
+                if (st->status != fsm_type::accept)
+                    accepted = false;
+
+                ptr = ptr_accepted;
+            }
+        } while (state_cur >= 0);
+
+        return accepted
+                ? result_type(true, ptr_accepted)
+                : result_type(false, end);
+    }
+
+    static pfs::mutex & compile_mutex ()
+    {
+        static pfs::mutex m;
+        return m;
+    }
+
+    /**
+     * @brief Lowers transition tables referenced (directly or not) by
+     *        @a initial and makes match_tr() of these tables use them.
+     *
+     * @details Must be called before the tables are used (e.g. in
+     *          grammar's constructor). Calls are serialized, so grammars
+     *          sharing the same static tables may be constructed in
+     *          different threads: tables are lowered by the first call,
+     *          repeated calls for the same tables do not modify them.
+     *
+     * @return @c true if @a initial table itself can be lowered
+     *         (it is still executed by fsm::exec() when used as
+     *         initial table).
+     */
+    static bool compile (transition_type const * initial)
+    {
+        pfs::lock_guard<pfs::mutex> locker(compile_mutex());
+
+        dfa * d = new dfa;
+        d->collect(initial);
+        d->build();
+
+        for (size_t i = 0, n = d->_tables.size(); i < n; ++i) {
+            table const & t = d->_tables[i];
+
+            for (int j = 0; j < t.size; ++j)
+                d->attach(t.tr[j].m._p);
+        }
+
+        bool result = d->_tables[0].lowered;
+
+        if (!d->_ref)
+            delete d;
+
+        return result;
+    }
+};
+
+template <typename Iterator, typename AtomicInt>
+inline bool fsm<Iterator, AtomicInt>::compile (transition_type const * initial)
+{
+    return dfa<Iterator, AtomicInt>::compile(initial);
+}
+
+}} // pfs::fsm
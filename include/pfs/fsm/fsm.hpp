@@ -98,6 +98,12 @@ public:
         return result;
     }
 
+    /**
+     * @brief Compiles transition tables referenced by @a initial
+     *        (see dfa::compile()).
+     */
+    static bool compile (transition_type const * initial);
+
     static match_type nothing ()
     {
         return match_type::template make<typename match_type::match_nothing>();
@@ -329,6 +335,9 @@ match<Iterator, AtomicInt>::match_tr::do_match (context<Iterator, AtomicInt> * c
         , iterator begin
         , iterator end) const
 {
+    if (_lowered)
+        return _lowered->do_match(ctx, begin, end);
+
     fsm<Iterator, AtomicInt> f(_tr, ctx->user_context);
     return f.exec(fsm<Iterator, AtomicInt>::normal, begin, end);
 }
@@ -370,3 +379,5 @@ match<Iterator, AtomicInt>::match_rpt::do_match (context<Iterator, AtomicInt> *
 }
 
 }} // pfs::fsm
+
+#include <pfs/fsm/dfa.hpp>
@@ -11,6 +11,12 @@ struct transition;
 template <typename Iterator, typename AtomicInt>
 struct context;
 
+template <typename Iterator, typename AtomicInt>
+class dfa;
+
+template <typename I, typename S, typename A>
+class stream;
+
 template <typename Iterator, typename AtomicInt = int>
 class match
 {
@@ -23,6 +29,10 @@ public:
     typedef typename match_traits_type::result_type    result_type;
     typedef typename match_traits_type::func_type      func_type;
 
+    template <typename, typename> friend class dfa;
+
+    template <typename, typename, typename> friend class stream;
+
 protected:
     struct match_base
     {
@@ -96,6 +106,9 @@ public:
 
     class match_length : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         size_type _len;
 
         virtual result_type do_match (context<Iterator, AtomicInt> * /*ctx*/
@@ -113,6 +126,9 @@ public:
 
     class match_seq : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         iterator _seq_begin;
         iterator _seq_end;
 
@@ -132,6 +148,9 @@ public:
 
     class match_eq : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         char_type _ch;
 
         virtual result_type do_match (context<Iterator, AtomicInt> * /*ctx*/
@@ -150,6 +169,9 @@ public:
 
     class match_one_of : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         iterator _seq_begin;
         iterator _seq_end;
 
@@ -169,6 +191,9 @@ public:
 
     class match_range : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         char_type _min;
         char_type _max;
 
@@ -207,8 +232,15 @@ public:
 
     class match_tr : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         transition<Iterator, AtomicInt> const * _tr;
 
+        // Compiled transition table (see dfa::compile()), used instead of
+        // interpreting _tr if set.
+        mutable match_base * _lowered;
+
         virtual result_type do_match (context<Iterator, AtomicInt> * ctx
                 , iterator begin
                 , iterator end) const;
@@ -216,11 +248,21 @@ public:
     public:
         match_tr (transition<Iterator, AtomicInt> const * tr)
                 : _tr(tr)
+                , _lowered(0)
         {}
+
+        virtual ~match_tr ()
+        {
+            if (_lowered && !--_lowered->ref)
+                delete _lowered;
+        }
     };
 
     class match_rpt : public match_base
     {
+        template <typename, typename> friend class dfa;
+        template <typename, typename, typename> friend class stream;
+
         match<Iterator, AtomicInt> _match;
         int _from;
         int _to;
@@ -0,0 +1,499 @@
+#pragma once
+#include <pfs/vector.hpp>
+#include <pfs/limits.hpp>
+#include <pfs/exception.hpp>
+#include <pfs/unicode/u8_iterator.hpp>
+#include <pfs/fsm/fsm.hpp>
+
+namespace pfs {
+namespace fsm {
+
+/**
+ * @brief Conversion between fsm iterators and iterators of the stream's
+ *        buffer.
+ */
+template <typename Iterator, typename BaseIterator>
+struct stream_traits
+{
+    static Iterator make (BaseIterator p)
+    {
+        return Iterator(p);
+    }
+
+    static BaseIterator base (Iterator it)
+    {
+        return it.base();
+    }
+
+    /**
+     * @return End of the data which can be iterated by Iterator.
+     */
+    static BaseIterator complete (BaseIterator /*first*/, BaseIterator last)
+    {
+        return last;
+    }
+};
+
+template <typename Iterator>
+struct stream_traits<Iterator, Iterator>
+{
+    static Iterator make (Iterator p)
+    {
+        return p;
+    }
+
+    static Iterator base (Iterator it)
+    {
+        return it;
+    }
+
+    static Iterator complete (Iterator /*first*/, Iterator last)
+    {
+        return last;
+    }
+};
+
+template <typename BaseIterator>
+struct stream_traits<unicode::utf8_iterator<BaseIterator>, BaseIterator>
+{
+    typedef unicode::utf8_iterator<BaseIterator> iterator;
+
+    static iterator make (BaseIterator p)
+    {
+        return iterator(p);
+    }
+
+    static BaseIterator base (iterator it)
+    {
+        return it.base();
+    }
+
+    /**
+     * @return End of the last complete UTF-8 sequence.
+     */
+    static BaseIterator complete (BaseIterator first, BaseIterator last)
+    {
+        BaseIterator p = last;
+
+        for (int i = 0; i < 6 && p != first; ++i) {
+            --p;
+            uint8_t c = static_cast<uint8_t>(*p);
+
+            if ((c & 0xC0) == 0x80)
+                continue;
+
+            int n = 1;
+
+            if ((c & 0xE0) == 0xC0)      n = 2;
+            else if ((c & 0xF0) == 0xE0) n = 3;
+            else if ((c & 0xF8) == 0xF0) n = 4;
+            else if ((c & 0xFC) == 0xF8) n = 5;
+            else if ((c & 0xFE) == 0xFC) n = 6;
+
+            return last - p < n ? p : last;
+        }
+
+        return last;
+    }
+};
+
+/**
+ * @brief Resumable execution of transition table over input fed by chunks.
+ *
+ * @details Input is accumulated in the buffer of StringT type, fsm
+ *          iterators are made from buffer's iterators. Transition tables
+ *          referenced by tr() (including repetitions of them) are executed
+ *          using explicit stack of frames instead of recursive fsm::exec()
+ *          calls, so execution can be suspended when some match reaches
+ *          the end of available input and resumed by the next feed().
+ *          Matches of characters (eq, one_of, range, seq, length, nothing)
+ *          are retried on resumption. Other matches (func) are considered
+ *          incomplete if they fail or stop at the end of available input.
+ *          Result is the same as of fsm::exec() for the whole input.
+ *
+ *          Actions are called once. Iterators passed to actions are valid
+ *          during the call only: buffer can be reallocated or compacted
+ *          (data before the oldest backtracking position is discarded)
+ *          when more input is fed.
+ *
+ * @code
+ * stream_type s(grammar.p_json_tr, & context);
+ *
+ * while (s.status() == stream_type::need_more && read(chunk))
+ *     s.feed(chunk.begin(), chunk.end());
+ *
+ * if (s.finish() == stream_type::accepted) {
+ *     ...
+ * }
+ * @endcode
+ */
+template <typename Iterator, typename StringT, typename AtomicInt = int>
+class stream
+{
+public:
+    typedef fsm<Iterator, AtomicInt>                fsm_type;
+    typedef match<Iterator, AtomicInt>              match_type;
+    typedef transition<Iterator, AtomicInt>         transition_type;
+    typedef context<Iterator, AtomicInt>            context_type;
+    typedef typename match_type::iterator           iterator;
+    typedef typename match_type::result_type        result_type;
+    typedef StringT                                 string_type;
+    typedef typename string_type::const_iterator    base_iterator;
+    typedef typename string_type::size_type         size_type;
+
+    enum status_enum {
+          need_more
+        , accepted
+        , rejected
+    };
+
+private:
+    typedef stream_traits<Iterator, base_iterator> traits_type;
+    typedef typename match_type::match_base    match_base;
+    typedef typename match_type::match_nothing match_nothing;
+    typedef typename match_type::match_length  match_length;
+    typedef typename match_type::match_seq     match_seq;
+    typedef typename match_type::match_eq      match_eq;
+    typedef typename match_type::match_one_of  match_one_of;
+    typedef typename match_type::match_range   match_range;
+    typedef typename match_type::match_tr      match_tr;
+    typedef typename match_type::match_rpt     match_rpt;
+
+    // Table execution (tab != 0) or repetition of match m (tab == 0).
+    struct frame
+    {
+        transition_type const * tab;
+        match_base const * m;
+        int       state_cur;
+        size_type ptr;
+        size_type ptr_accepted;
+        bool      accepted;
+        int       count;
+        int       from;
+        int       to;
+    };
+
+    transition_type const * _initial;
+    context_type            _ctx;
+    string_type             _buffer;
+    size_type               _base;     // absolute position of the buffer's beginning
+    size_type               _avail;    // size of iterable data
+    size_type               _result;   // absolute end of accepted input
+    bool                    _finished;
+    status_enum             _status;
+    pfs::vector<frame>      _stack;
+
+private:
+    iterator make (size_type pos) const
+    {
+        return traits_type::make(_buffer.begin() + pos);
+    }
+
+    size_type offset (iterator it) const
+    {
+        return static_cast<size_type>(traits_type::base(it) - _buffer.begin());
+    }
+
+    void push_table (transition_type const * tab, size_type pos)
+    {
+        frame f;
+        f.tab = tab;
+        f.m = 0;
+        f.state_cur = 0;
+        f.ptr = pos;
+        f.ptr_accepted = pos;
+        f.accepted = false;
+        f.count = f.from = f.to = 0;
+        _stack.push_back(f);
+    }
+
+    void push_rpt (match_rpt const * m, size_type pos)
+    {
+        frame f;
+        f.tab = 0;
+        f.m = m->_match._p;
+        f.state_cur = 0;
+        f.ptr = pos;
+        f.ptr_accepted = pos;
+        f.accepted = false;
+        f.count = 0;
+        f.from = m->_from >= 0 ? m->_from : 0;
+        f.to = m->_to >= 0 ? m->_to : pfs::numeric_limits<int>::max();
+
+        if (f.from > f.to)
+            PFS_THROW(out_of_range("match_rpt::do_match()"));
+
+        _stack.push_back(f);
+    }
+
+    /**
+     * @return @c true if result of the match @a m at @a pos can be changed
+     *         by more input.
+     */
+    bool incomplete (match_base const * m, size_type pos, result_type const & r) const
+    {
+        if (dynamic_cast<match_nothing const *>(m))
+            return false;
+
+        if (dynamic_cast<match_eq const *>(m)
+                || dynamic_cast<match_one_of const *>(m)
+                || dynamic_cast<match_range const *>(m))
+            return pos == _avail;
+
+        if (dynamic_cast<match_length const *>(m))
+            return !r.first;
+
+        if (match_seq const * s = dynamic_cast<match_seq const *>(m)) {
+            if (r.first)
+                return false;
+
+            iterator it = make(pos);
+            iterator end = make(_avail);
+            iterator sit = s->_seq_begin;
+
+            while (it != end && sit != s->_seq_end && *it == *sit) {
+                ++it;
+                ++sit;
+            }
+
+            return it == end && sit != s->_seq_end;
+        }
+
+        return !r.first || offset(r.second) == _avail;
+    }
+
+    /**
+     * @brief Passes result of the match to the top frame, pops completed
+     *        frames.
+     */
+    void complete (bool ok, size_type end)
+    {
+        while (!_stack.empty()) {
+            frame & f = _stack.back();
+
+            if (!f.tab) {
+                if (ok) {
+                    f.ptr = end;
+                    ++f.count;
+                    return;
+                }
+
+                // Repetition is over
+                ok = f.count >= f.from;
+                end = f.ptr;
+                _stack.pop_back();
+                continue;
+            }
+
+            transition_type const & t = f.tab[f.state_cur];
+
+            if (ok) {
+                if (t.action && !t.action(make(f.ptr), make(end)
+                        , _ctx.user_context, t.action_args)) {
+
+                    if (t.status == fsm_type::accept && t.state_fail >= 0) {
+                        f.state_cur = t.state_fail;
+                        return;
+                    }
+
+                    ok = false;
+                    _stack.pop_back();
+                    continue;
+                }
+
+                if (t.status == fsm_type::accept)
+                    f.accepted = true;
+
+                f.ptr = end;
+
+                if (t.status == fsm_type::accept)
+                    f.ptr_accepted = f.ptr;
+
+                if (t.status == fsm_type::reject) {
+                    f.state_cur = -1;
+                    f.accepted = false;
+                } else {
+                    f.state_cur = t.state_next;
+                }
+            } else {
+                f.state_cur = t.state_fail;
+
+                if (t.status != fsm_type::accept)
+                    f.accepted = false;
+
+                f.ptr = f.ptr_accepted;
+            }
+
+            if (f.state_cur >= 0)
+                return;
+
+            ok = f.accepted;
+            end = f.ptr_accepted;
+            _stack.pop_back();
+        }
+
+        _status = ok ? accepted : rejected;
+        _result = _base + (ok ? end : 0);
+    }
+
+    status_enum run ()
+    {
+        while (!_stack.empty()) {
+            frame & f = _stack.back();
+            size_type pos = f.ptr;
+            match_base const * m = f.m;
+
+            if (f.tab) {
+                m = f.tab[f.state_cur].m._p;
+            } else if (f.count >= f.to || pos == _avail) {
+                if (f.count < f.to && !_finished)
+                    return need_more;
+
+                complete(false, pos);
+                continue;
+            }
+
+            if (match_tr const * tr = dynamic_cast<match_tr const *>(m)) {
+                push_table(tr->_tr, pos);
+                continue;
+            }
+
+            if (match_rpt const * rpt = dynamic_cast<match_rpt const *>(m)) {
+                push_rpt(rpt, pos);
+                continue;
+            }
+
+            result_type r = m->do_match(& _ctx, make(pos), make(_avail));
+
+            if (!_finished && incomplete(m, pos, r))
+                return need_more;
+
+            complete(r.first, r.first ? offset(r.second) : pos);
+        }
+
+        return _status;
+    }
+
+    /**
+     * @brief Discards data which can't be referenced anymore.
+     */
+    void compact ()
+    {
+        size_type keep = _avail;
+
+        for (size_t i = 0, n = _stack.size(); i < n; ++i) {
+            frame const & f = _stack[i];
+            size_type pos = f.tab ? f.ptr_accepted : f.ptr;
+
+            if (pos < keep)
+                keep = pos;
+        }
+
+        if (keep == 0 || keep < _buffer.size() / 2)
+            return;
+
+        for (size_t i = 0, n = _stack.size(); i < n; ++i) {
+            _stack[i].ptr -= keep;
+            _stack[i].ptr_accepted -= keep;
+        }
+
+        _buffer.erase(0, keep);
+        _base += keep;
+        _avail -= keep;
+    }
+
+public:
+    stream (transition_type const * initial, void * user_context = 0)
+        : _initial(initial)
+        , _ctx(initial, user_context)
+        , _base(0)
+        , _avail(0)
+        , _result(0)
+        , _finished(false)
+        , _status(need_more)
+    {
+        push_table(initial, 0);
+    }
+
+    status_enum status () const
+    {
+        return _status;
+    }
+
+    /**
+     * @return Number of accepted characters (in terms of buffer, i.e.
+     *         octets for UTF-8 encoded input) from the beginning
+     *         of the input (or from the beginning of the last input
+     *         started by next()).
+     */
+    size_type position () const
+    {
+        return _result;
+    }
+
+    /**
+     * @brief Appends input and continues execution.
+     *
+     * @return @c need_more if the result depends on the input not fed yet.
+     */
+    template <typename InputIt>
+    status_enum feed (InputIt first, InputIt last)
+    {
+        if (_status != need_more || _finished)
+            return _status;
+
+        compact();
+        _buffer.append(first, last);
+        _avail = static_cast<size_type>(traits_type::complete(_buffer.begin()
+                , _buffer.end()) - _buffer.begin());
+
+        return run();
+    }
+
+    status_enum feed (string_type const & s)
+    {
+        return feed(s.begin(), s.end());
+    }
+
+    /**
+     * @brief Marks the end of input and completes execution.
+     *
+     * @return @c accepted or @c rejected.
+     */
+    status_enum finish ()
+    {
+        if (_status != need_more)
+            return _status;
+
+        _finished = true;
+        _avail = _buffer.size();
+
+        return run();
+    }
+
+    /**
+     * @brief Restarts execution on the input following the accepted one
+     *        (e.g. next message in the stream).
+     *
+     * @return Status of execution on the input already buffered.
+     */
+    status_enum next ()
+    {
+        size_type pos = _status == accepted ? _result - _base : _buffer.size();
+
+        _buffer.erase(0, pos);
+        _base = 0;
+        _result = 0;
+        _avail = _finished
+                ? _buffer.size()
+                : static_cast<size_type>(traits_type::complete(_buffer.begin()
+                        , _buffer.end()) - _buffer.begin());
+        _status = need_more;
+        _stack.clear();
+        push_table(_initial, 0);
+
+        return _buffer.empty() && !_finished ? _status : run();
+    }
+};
+
+}} // pfs::fsm
@@ -0,0 +1,222 @@
+#pragma once
+#include <new>
+#include <pfs/types.hpp>
+#include <pfs/utility.hpp>
+#include <pfs/cxx/cxx98/binder.hpp>
+
+#ifndef PFS_INPLACE_BINDER_CAPACITY
+#   define PFS_INPLACE_BINDER_CAPACITY 64
+#endif
+
+namespace pfs {
+
+/**
+ * @brief Value holder for binders (binder_functionN/binder_methodN)
+ *        with small buffer optimization.
+ *
+ * @details Binder is copied into internal buffer if it fits into
+ *          @a Capacity bytes, otherwise it is allocated on the heap.
+ *          Typical function/method binders with a few scalar arguments
+ *          fit into default capacity (64 bytes), so storing them into
+ *          active containers does not require heap allocation nor
+ *          reference counting.
+ */
+template <typename ReturnType, size_t Capacity = PFS_INPLACE_BINDER_CAPACITY>
+class inplace_binder
+{
+public:
+    typedef ReturnType                  return_type;
+    typedef binder_base<return_type>    binder_type;
+
+    static size_t const CAPACITY = Capacity;
+
+private:
+    enum operation_enum { clone_op, move_op, destroy_op };
+
+    // Returns pointer to binder placed at `dest`
+    typedef binder_type * (* manager_type) (operation_enum op
+            , void * dest
+            , binder_type * src);
+
+    union storage_type
+    {
+        char        bytes[Capacity];
+        void *      align_ptr;
+        long double align_ld;
+        long long   align_ll;
+        void (*     align_fptr) ();
+    };
+
+    storage_type  _storage;
+    binder_type * _ptr;
+    manager_type  _manager;
+
+private:
+    template <typename Binder>
+    static binder_type * inplace_manager (operation_enum op
+            , void * dest
+            , binder_type * src)
+    {
+        Binder * b = static_cast<Binder *>(src);
+
+        switch (op) {
+        case clone_op:
+            return new (dest) Binder(*b);
+
+        case move_op: {
+#if __cplusplus >= 201103L
+            binder_type * result = new (dest) Binder(std::move(*b));
+#else
+            binder_type * result = new (dest) Binder(*b);
+#endif
+            b->~Binder();
+            return result;
+        }
+
+        case destroy_op:
+        default:
+            b->~Binder();
+            break;
+        }
+
+        return 0;
+    }
+
+    template <typename Binder>
+    static binder_type * heap_manager (operation_enum op
+            , void * /*dest*/
+            , binder_type * src)
+    {
+        Binder * b = static_cast<Binder *>(src);
+
+        switch (op) {
+        case clone_op:
+            return new Binder(*b);
+
+        case move_op:
+            return b; // Steal pointer
+
+        case destroy_op:
+        default:
+            delete b;
+            break;
+        }
+
+        return 0;
+    }
+
+    void move_from (inplace_binder & other)
+    {
+        if (other._ptr) {
+            _manager = other._manager;
+            _ptr = _manager(move_op, _storage.bytes, other._ptr);
+            other._ptr = 0;
+            other._manager = 0;
+        }
+    }
+
+public:
+    inplace_binder ()
+        : _ptr(0)
+        , _manager(0)
+    {}
+
+    template <typename Binder>
+    explicit inplace_binder (Binder const & b)
+        : _ptr(0)
+        , _manager(0)
+    {
+        assign(b);
+    }
+
+    inplace_binder (inplace_binder const & other)
+        : _ptr(0)
+        , _manager(other._manager)
+    {
+        if (other._ptr)
+            _ptr = _manager(clone_op, _storage.bytes, other._ptr);
+    }
+
+    inplace_binder & operator = (inplace_binder const & other)
+    {
+        if (this != & other) {
+            reset();
+
+            if (other._ptr) {
+                _manager = other._manager;
+                _ptr = _manager(clone_op, _storage.bytes, other._ptr);
+            }
+        }
+        return *this;
+    }
+
+#if __cplusplus >= 201103L
+    inplace_binder (inplace_binder && other)
+        : _ptr(0)
+        , _manager(0)
+    {
+        move_from(other);
+    }
+
+    inplace_binder & operator = (inplace_binder && other)
+    {
+        if (this != & other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+#endif
+
+    ~inplace_binder ()
+    {
+        reset();
+    }
+
+    /**
+     * @brief Destroys current binder (if any) and stores copy of @a b.
+     */
+    template <typename Binder>
+    void assign (Binder const & b)
+    {
+        reset();
+
+        if (sizeof(Binder) <= Capacity) {
+            _ptr = new (_storage.bytes) Binder(b);
+            _manager = & inplace_manager<Binder>;
+        } else {
+            _ptr = new Binder(b);
+            _manager = & heap_manager<Binder>;
+        }
+    }
+
+    void reset ()
+    {
+        if (_ptr) {
+            _manager(destroy_op, 0, _ptr);
+            _ptr = 0;
+            _manager = 0;
+        }
+    }
+
+    bool empty () const
+    {
+        return _ptr == 0;
+    }
+
+    /**
+     * @return @c true if binder is stored in internal buffer.
+     */
+    bool is_inplace () const
+    {
+        return _ptr != 0
+                && static_cast<void const *>(_ptr) == static_cast<void const *>(_storage.bytes);
+    }
+
+    return_type operator () () const
+    {
+        return (*_ptr)();
+    }
+};
+
+} // pfs
@@ -17,6 +17,7 @@ enum open_mode_enum
     , write_read   = read_write              /**< Synonym for read_write */
     , non_blocking = 0x0004                  /**< Open device in non-blocking mode */
     , truncate     = 0x0010                  /**< Create device (only for regular file device) */
+    , append       = 0x0020                  /**< Write to the end of device (only for regular file device) */
 };
 
 enum device_type
@@ -44,6 +45,56 @@ namespace details {
 //
 typedef int native_handle_type;
 
+/**
+ * @brief Non-owning reference to the contiguous chunk of bytes
+ *        (element of vectored I/O).
+ */
+struct const_buffer
+{
+    byte_t const * data;
+    size_t         size;
+
+    const_buffer ()
+        : data(0)
+        , size(0)
+    {}
+
+    const_buffer (byte_t const * d, size_t n)
+        : data(d)
+        , size(n)
+    {}
+
+    const_buffer (char const * d, size_t n)
+        : data(reinterpret_cast<byte_t const *>(d))
+        , size(n)
+    {}
+};
+
+/**
+ * @brief Non-owning reference to the contiguous writable chunk of bytes
+ *        (element of vectored/batched input).
+ */
+struct mutable_buffer
+{
+    byte_t * data;
+    size_t   size;
+
+    mutable_buffer ()
+        : data(0)
+        , size(0)
+    {}
+
+    mutable_buffer (byte_t * d, size_t n)
+        : data(d)
+        , size(n)
+    {}
+
+    mutable_buffer (char * d, size_t n)
+        : data(reinterpret_cast<byte_t *>(d))
+        , size(n)
+    {}
+};
+
 class basic_device
 {
 public:
@@ -287,6 +338,135 @@ public:
         return this->write(bytes.data(), bytes.size());
     }
 
+    /**
+     * @brief Writes @a count buffers (gather output).
+     *
+     * @details Default implementation writes buffers one by one
+     *          and stops on the first partial write.
+     *          Devices that support native gather output
+     *          (e.g. @c writev) override this method.
+     *
+     * @return The number of bytes written, or -1 if an error occurred.
+     */
+    virtual ssize_t write_v (const_buffer const * bufs, size_t count, error_code & ec) noexcept;
+
+    ssize_t write_v (const_buffer const * bufs, size_t count)
+    {
+        error_code ec;
+        ssize_t r = write_v(bufs, count, ec);
+        if (r < 0)
+            PFS_THROW(io_exception(ec));
+        return r;
+    }
+
+    /**
+     * @brief Reads data into @a count buffers (scatter input).
+     *
+     * @details Default implementation reads buffers one by one
+     *          and stops on the first partial read.
+     *          Devices that support native scatter input
+     *          (e.g. @c readv) override this method.
+     *
+     * @return The number of bytes read, or -1 if an error occurred.
+     */
+    virtual ssize_t read_v (mutable_buffer const * bufs, size_t count, error_code & ec) noexcept;
+
+    ssize_t read_v (mutable_buffer const * bufs, size_t count)
+    {
+        error_code ec;
+        ssize_t r = read_v(bufs, count, ec);
+        if (r < 0)
+            PFS_THROW(io_exception(ec));
+        return r;
+    }
+
+    /**
+     * @brief Receives up to @a count messages (datagrams), each into its own
+     *        buffer, @a sizes receives length of each received message.
+     *
+     * @details Default implementation calls read() for each buffer while
+     *          data is available. Datagram sockets override this method
+     *          to receive a batch by single system call (@c recvmmsg).
+     *
+     * @return The number of messages received (zero if no data available),
+     *         or -1 if an error occurred.
+     */
+    virtual ssize_t recv_batch (mutable_buffer const * bufs
+            , size_t * sizes
+            , size_t count
+            , error_code & ec) noexcept;
+
+    ssize_t recv_batch (mutable_buffer const * bufs, size_t * sizes, size_t count)
+    {
+        error_code ec;
+        ssize_t r = recv_batch(bufs, sizes, count, ec);
+        if (r < 0)
+            PFS_THROW(io_exception(ec));
+        return r;
+    }
+
+    /**
+     * @brief Sends @a count buffers, each as a separate message (datagram).
+     *
+     * @details Default implementation calls write() for each buffer.
+     *          Datagram sockets override this method to send a batch
+     *          by single system call (@c sendmmsg).
+     *
+     * @return The number of messages sent, or -1 if an error occurred.
+     */
+    virtual ssize_t send_batch (const_buffer const * bufs, size_t count, error_code & ec) noexcept;
+
+    ssize_t send_batch (const_buffer const * bufs, size_t count)
+    {
+        error_code ec;
+        ssize_t r = send_batch(bufs, count, ec);
+        if (r < 0)
+            PFS_THROW(io_exception(ec));
+        return r;
+    }
+
+    /**
+     * @brief Enables outbound queue (non-blocking write mode).
+     *
+     * @details In this mode write() never waits for device readiness:
+     *          bytes that can not be sent immediately are stored into
+     *          outbound queue and sent later by flush_pending()
+     *          (device_manager calls it when device becomes writable).
+     *          Device is considered congested when number of pending bytes
+     *          reaches @a high_watermark and until it drops to
+     *          @a low_watermark.
+     *
+     * @return @c false if device does not support outbound queue.
+     */
+    virtual bool enable_write_queue (size_t /*high_watermark*/, size_t /*low_watermark*/)
+    {
+        return false;
+    }
+
+    /**
+     * @return Number of bytes accepted by write() but not sent yet.
+     */
+    virtual size_t pending () const
+    {
+        return 0;
+    }
+
+    virtual bool congested () const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Sends pending bytes (as many as device can accept without
+     *        waiting).
+     *
+     * @return The number of bytes sent, or -1 if an error occurred.
+     */
+    virtual ssize_t flush_pending (error_code & /*ec*/) noexcept
+    {
+        return 0;
+    }
+
     virtual error_code close () = 0;
 
     virtual bool opened () const = 0;
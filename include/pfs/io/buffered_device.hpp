@@ -1,13 +1,114 @@
 #pragma once
 #include <cstdlib>
+#include <cstring>
 #include <pfs/cxxlang.hpp>
+#include <pfs/noncopyable.hpp>
 #include <pfs/io/exception.hpp>
 #include <pfs/io/device.hpp>
+#include <pfs/io/ring_buffer.hpp>
 
 namespace pfs {
 namespace io {
 
-template <typename DevicePtr>
+namespace details {
+
+/**
+ * @brief Unbounded buffer for buffered_device (default).
+ *
+ * @details Grows (using realloc) when there is no enough space to cache
+ *          requested bytes.
+ */
+class growing_buffer : noncopyable
+{
+    byte_t * _data;
+    size_t   _capacity;
+    size_t   _pos;
+    size_t   _size;
+
+public:
+    explicit growing_buffer (size_t initial_size)
+        : _data(static_cast<byte_t *>(std::malloc(initial_size * sizeof(byte_t))))
+        , _capacity(initial_size)
+        , _pos(0)
+        , _size(0)
+    {}
+
+    ~growing_buffer ()
+    {
+        if (_data)
+            std::free(_data);
+    }
+
+    size_t size () const
+    {
+        return _size;
+    }
+
+    bool full () const
+    {
+        return false;
+    }
+
+    byte_t const * data () const
+    {
+        return _data + _pos;
+    }
+
+    size_t contiguous_size () const
+    {
+        return _size;
+    }
+
+    byte_t const * linearize (size_t)
+    {
+        return data();
+    }
+
+    /**
+     * @brief Returns region for writing of @a n bytes (grows if needed).
+     */
+    byte_t * prepare (size_t & n)
+    {
+        if (n > _capacity - _size) {
+            _capacity += n - (_capacity - _size);
+            byte_t * tmp = static_cast<byte_t *> (std::realloc(_data, _capacity));
+            PFS_ASSERT(tmp);
+            _data = tmp;
+        }
+
+        if (n > _capacity - (_pos + _size)) {
+            std::memmove(_data, _data + _pos, _size);
+            _pos = 0;
+        }
+
+        return _data + _pos + _size;
+    }
+
+    void commit (size_t n)
+    {
+        _size += n;
+    }
+
+    void consume (size_t n)
+    {
+        _size -= n;
+        _pos = _size == 0 ? 0 : _pos + n;
+    }
+};
+
+} // details
+
+/**
+ * @brief Buffered (read-cached) device.
+ *
+ * @details Buffer policy may be details::growing_buffer (default, caches
+ *          as many bytes as requested) or io::ring_buffer (fixed
+ *          capacity, device is not read while buffer is full or high
+ *          watermark is reached, see backpressure()).
+ *          Framed protocol parsers can use peek()/consume() pair to parse
+ *          data in place instead of copying it by read().
+ */
+template <typename DevicePtr, typename Buffer = details::growing_buffer>
 class buffered_device
 {
     //
@@ -17,20 +118,19 @@ class buffered_device
     //
     ssize_t ensure_available (size_t count, error_code & ec)
     {
-        if (count <= _count)
-            return integral_cast_check<ssize_t>(count);
-
-        ssize_t n = cache_bytes(count < 256 ? count * 2 : count, ec);
+        while (count > _buf.size()) {
+            ssize_t n = cache_bytes(count < 256 ? count * 2 : count, ec);
 
-        // Error
-        if (n < 0)
-            return -1;
+            // Error
+            if (n < 0)
+                return -1;
 
-        // Enough bytes available
-        if (count <= _count)
-            return integral_cast_check<ssize_t>(count);
+            // No more data or no more space
+            if (n == 0)
+                break;
+        }
 
-        return integral_cast_check<ssize_t>(_count);
+        return integral_cast_check<ssize_t>(pfs::min(count, _buf.size()));
     }
 
     ssize_t cache_bytes (size_t max_size, error_code & ec)
@@ -38,48 +138,103 @@ class buffered_device
         if (max_size == 0)
             return 0;
 
-        if (max_size > _bufsz - _count) {
-            _bufsz += max_size - (_bufsz - _count);
-            byte_t * tmp = static_cast<byte_t *> (std::realloc(_buffer, _bufsz));
-            PFS_ASSERT(tmp);
-            _buffer = tmp;
-        }
+        size_t n = max_size;
+        byte_t * p = _buf.prepare(n);
 
-        if (max_size > _bufsz - (_pos + _count)) {
-            std::memmove(_buffer, _buffer + _pos, _count);
-            _pos = 0;
-        }
+        if (_high_watermark > 0)
+            n = _buf.size() < _high_watermark
+                    ? pfs::min(n, _high_watermark - _buf.size())
+                    : 0;
 
-        ssize_t r = _d->read(_buffer + (_pos + _count), max_size, ec);
+        if (n == 0)
+            return 0;
 
-        if (r > 0) {
-            _count += r;
-        }
+        ssize_t r = _d->read(p, n, ec);
+
+        if (r > 0)
+            _buf.commit(integral_cast_check<size_t>(r));
 
         return r;
     }
 
 public:
+    /**
+     * @param initial_size Initial size of growing buffer or capacity
+     *        of fixed-capacity buffer.
+     */
     buffered_device (DevicePtr d, size_t initial_size = 256)
         : _d (d)
-        , _pos(0)
-        , _count(0)
+        , _buf(initial_size)
+        , _high_watermark(0)
+    {}
+
+    ssize_t available () const
     {
-        _buffer = static_cast<byte_t *>(std::malloc(initial_size * sizeof(byte_t)));
-        _bufsz = initial_size;
+        return integral_cast_check<ssize_t>(_buf.size()) + _d->available();
     }
 
+    /**
+     * @return Number of bytes cached (read from device but not consumed).
+     */
+    size_t cached () const
+    {
+        return _buf.size();
+    }
 
-    ~buffered_device ()
+    /**
+     * @brief Limits number of cached bytes by @a n (zero means no limit
+     *        except buffer capacity).
+     */
+    void set_high_watermark (size_t n)
     {
-        if (_buffer)
-            std::free(_buffer);
+        _high_watermark = n;
     }
 
+    /**
+     * @return @c true if device will not be read until cached data
+     *         is consumed (high watermark is reached or buffer is full).
+     */
+    bool backpressure () const
+    {
+        return _buf.full()
+                || (_high_watermark > 0 && _buf.size() >= _high_watermark);
+    }
 
-    ssize_t available () const
+    /**
+     * @brief Returns view of up to @a n first cached bytes
+     *        without copying (reads device if needed).
+     *
+     * @details View is valid until the next non-const call.
+     *          Size of view is less than @a n if there is no enough data
+     *          available or requested size exceeds limits
+     *          (see backpressure()).
+     */
+    const_buffer peek (size_t n, error_code & ec) noexcept
+    {
+        ssize_t r = ensure_available(n, ec);
+
+        if (r <= 0)
+            return const_buffer();
+
+        size_t k = integral_cast_check<size_t>(r);
+        return const_buffer(_buf.linearize(k), k);
+    }
+
+    const_buffer peek (size_t n)
+    {
+        error_code ec;
+        const_buffer r = this->peek(n, ec);
+        if (is_error(ec))
+            PFS_THROW(io_exception(ec));
+        return r;
+    }
+
+    /**
+     * @brief Discards first @a n cached bytes (usually after peek()).
+     */
+    void consume (size_t n)
     {
-        return _count + _d->available();
+        _buf.consume(pfs::min(n, _buf.size()));
     }
 
     bool at_end () const
@@ -97,9 +252,17 @@ public:
         if (result <= 0)
             return result;
 
-        std::memcpy(bytes, _buffer + _pos, integral_cast_check<size_t>(result));
-        _pos += integral_cast_check<size_t>(result);
-        _count -= integral_cast_check<size_t>(result);
+        size_t total = integral_cast_check<size_t>(result);
+        size_t copied = 0;
+
+        // Cached bytes may wrap around the end of the ring buffer
+        while (copied < total) {
+            size_t k = pfs::min(total - copied, _buf.contiguous_size());
+            std::memcpy(bytes + copied, _buf.data(), k);
+            _buf.consume(k);
+            copied += k;
+        }
+
         return result;
     }
 
@@ -187,8 +350,10 @@ public:
      */
     bool read_byte (byte_t & c, error_code & ec) noexcept
     {
-        if (ensure_available(1, ec) > 0)
-            c = _buffer[_pos++];
+        if (ensure_available(1, ec) > 0) {
+            c = *_buf.data();
+            _buf.consume(1);
+        }
         return !is_error(ec);
     }
 
@@ -204,7 +369,7 @@ public:
     bool peek_byte (byte_t & c, error_code & ec) noexcept
     {
         if (ensure_available(1, ec) > 0)
-            c = _buffer[_pos];
+            c = *_buf.data();
         return !is_error(ec);
     }
 
@@ -296,10 +461,8 @@ public:
 
 private:
     DevicePtr _d;
-    byte_t *  _buffer;
-    size_t    _bufsz;
-    size_t    _pos;
-    size_t    _count;
+    Buffer    _buf;
+    size_t    _high_watermark;
 };
 
 }} // pfs::io
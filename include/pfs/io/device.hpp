@@ -12,6 +12,8 @@ namespace pfs {
 namespace io {
 
 typedef details::device::open_mode_flags open_mode_flags;
+typedef details::const_buffer const_buffer;
+typedef details::mutable_buffer mutable_buffer;
 
 template <typename DeviceTag>
 struct open_params;
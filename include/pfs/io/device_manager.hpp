@@ -2,8 +2,8 @@
 #include <ctime>
 #include <pfs/cxxlang.hpp>
 #include <pfs/sigslot.hpp>
-#include <pfs/multiset.hpp>
 #include <pfs/vector.hpp>
+#include <pfs/timer_wheel.hpp>
 #include <pfs/io/device_notifier_pool.hpp>
 
 namespace pfs {
@@ -11,24 +11,11 @@ namespace io {
 
 template <typename SigslotNS = pfs::sigslot<>
         , template <typename> class ContigousContainer = pfs::vector
-        , typename BasicLockable = pfs::mutex
-        , template <typename> class PriorityContainer = pfs::multiset>
+        , typename BasicLockable = pfs::mutex>
 class device_manager : SigslotNS::has_slots
 {
-    struct reopen_item
-    {
-        device_ptr d;
-        time_t timeout; // reconnection timeout in seconds
-        time_t start;   // start time point counting timeout from
-
-        bool operator < (reopen_item const & x) const
-        {
-            return (start + timeout) < (x.start + x.timeout);
-        }
-    };
-
     typedef device_notifier_pool<ContigousContainer, BasicLockable> pool_type;
-    typedef PriorityContainer<reopen_item> reopen_queue;
+    typedef pfs::timer_wheel<device_ptr> reopen_queue;
 
     class event_handler1 : public default_event_handler
     {
@@ -61,12 +48,31 @@ class device_manager : SigslotNS::has_slots
             _m->disconnected(d);
         }
 
+        // Only devices with pending outbound data are polled for write
+        void can_write (device_ptr const & d)
+        {
+            _m->flush_pending(d);
+        }
+
         void on_error (error_code const & ex)
         {
             _m->error(ex);
         }
     };
 
+    struct reopen_handler
+    {
+        device_manager * m;
+
+        reopen_handler (device_manager * x) : m(x) {}
+
+        void operator () (typename reopen_queue::id_type, device_ptr & d)
+        {
+            error_code ec = d->reopen();
+            m->insert_device(d, ec);
+        }
+    };
+
     class event_handler2 : public default_event_handler
     {
         friend class device_manager;
@@ -96,7 +102,7 @@ class device_manager : SigslotNS::has_slots
             // call inside dispatcher that already lock mutex
             // so need to call version of erase without locking.
             _p2->erase(d);
-            _p1->insert(d);
+            _p1->insert(d, notify_read);
             _m->opened(d);
         }
 
@@ -107,13 +113,17 @@ class device_manager : SigslotNS::has_slots
     };
 
 private:
-    // Main device pool (for valid (operational) devices)
+    // Main device pool (for valid (operational) devices),
+    // devices are inserted with notify_read only, so idle (but writable)
+    // devices do not wake up dispatcher. Write notification is enabled
+    // only while device has pending outbound data (see write()).
     pool_type _p1;
 
     // Device pool for partially-operational devices: usually in 'connection in progress...' state)
     pool_type _p2;
 
     // Reconnection queue, contains devices waiting reconnection by timeout
+    // (one-shot timers of timing wheel)
     reopen_queue _rq;
 
     event_handler1 _evh1;
@@ -127,7 +137,7 @@ private:
     void insert_device (device_ptr const & d, pfs::error_code & ec)
     {
         if (!ec) {
-            _p1.insert(d);
+            _p1.insert(d, notify_read);
             opened(d);
         } else {
             if (ec == pfs::make_error_code(io_errc::operation_in_progress)) {
@@ -142,7 +152,7 @@ private:
     void insert_server (server_ptr const & s, pfs::error_code & ec)
     {
         if (!ec) {
-            _p1.insert(s);
+            _p1.insert(s, notify_read);
             server_opened(s);
         } else {
             if (ec == pfs::make_error_code(io_errc::operation_in_progress)) {
@@ -154,6 +164,36 @@ private:
         }
     }
 
+    void flush_pending (device_ptr const & d)
+    {
+        bool was_congested = d->congested();
+        error_code ec;
+
+        if (d->flush_pending(ec) < 0)
+            error(ec);
+
+        update_write_state(d, true, was_congested);
+    }
+
+    void update_write_state (device_ptr const & d, bool had_pending, bool was_congested)
+    {
+        bool has_pending = d->pending() > 0;
+
+        // Called from dispatcher (inside pool's lock) or from
+        // the dispatching thread, so use non-locking version
+        if (!had_pending && has_pending)
+            _p1.modify_deferred(d, notify_read | notify_write);
+        else if (had_pending && !has_pending)
+            _p1.modify_deferred(d, notify_read);
+
+        bool is_congested = d->congested();
+
+        if (!was_congested && is_congested)
+            write_high_watermark(d);
+        else if (was_congested && !is_congested)
+            write_low_watermark(d);
+    }
+
 public:
     /**
      * @brief Construct device manager.
@@ -163,7 +203,10 @@ public:
     device_manager ()
         : _evh1(this, & _p1, & _p2)
         , _evh2(this, & _p1, & _p2)
-    {}
+    {
+        // Main pool handlers do not process write events
+        _p1.set_accepted_events(notify_read);
+    }
 
     template <typename DeviceTag>
     device_ptr new_device (open_params<DeviceTag> const & op, pfs::error_code & ec)
@@ -184,12 +227,7 @@ public:
     void push_deferred (device_ptr const & d, time_t reconn_timeout)
     {
         //PFS_ASSERT(d.set_nonblocking(true));
-        reopen_item item;
-        item.d       = d;
-        item.timeout = reconn_timeout;
-        item.start   = ::time(0); // TODO may be need to use monotonic clock
-
-        _rq.insert(item);
+        _rq.start(Timer_OneShot, static_cast<double>(reconn_timeout), d);
     }
 
     /**
@@ -197,18 +235,7 @@ public:
      */
     bool ready_deferred () const
     {
-        if (_rq.empty())
-            return false;
-
-        // Create temporary item to compare (device field does not matter in comparison)
-        reopen_item item;
-        item.timeout = 0;
-        item.start   = ::time(0); // TODO may be need to use monotonic clock
-
-        // Checking first item will be enough.
-        bool result = *_rq.begin() < item;
-
-        return result;
+        return _rq.next_timeout() == 0;
     }
 
     /**
@@ -219,23 +246,8 @@ public:
         if (_rq.empty())
             return;
 
-        // Create temporary item to compare (device field does not matter in comparison)
-        reopen_item item;
-        item.timeout = 0;
-        item.start   = ::time(0); // TODO may be need to use monotonic clock
-
-        typename reopen_queue::const_iterator it = _rq.cbegin();
-        typename reopen_queue::const_iterator last = _rq.cend();
-
-        while (*it < item && it != last) {
-            device_ptr d = it->d;
-            error_code ec = d->reopen();
-            insert_device(d, ec);
-
-            ++it;
-        }
-
-        _rq.erase(_rq.cbegin(), it);
+        reopen_handler handler(this);
+        _rq.expire(handler);
     }
 
     void close (device_ptr const & d)
@@ -302,15 +314,46 @@ public:
         return _p1.front_server();
     }
 
+    /**
+     * @brief Writes data to the device managed by this manager.
+     *
+     * @details If device's outbound queue is enabled
+     *          (see details::device::enable_write_queue()) the data that can
+     *          not be sent immediately is queued and flushed when device
+     *          becomes writable, write_high_watermark/write_low_watermark
+     *          signals are emitted on congestion state changes.
+     *          Must be called from the dispatching thread.
+     */
+    ssize_t write (device_ptr const & d, byte_t const * bytes, size_t n, error_code & ec)
+    {
+        bool had_pending = d->pending() > 0;
+        bool was_congested = d->congested();
+        ssize_t r = d->write(bytes, n, ec);
+        update_write_state(d, had_pending, was_congested);
+        return r;
+    }
+
+    ssize_t write (device_ptr const & d, byte_string const & bytes, error_code & ec)
+    {
+        return write(d, bytes.data(), bytes.size(), ec);
+    }
+
     void dispatch (int millis = 0)
     {
+        // Do not sleep longer than the nearest reopen timeout
+        if (!_rq.empty()) {
+            double timeout = _rq.next_timeout() * 1000;
+
+            if (millis < 0 || timeout < millis)
+                millis = static_cast<int>(timeout) + 1;
+        }
+
         _p1.dispatch(_evh1, millis);
 
         //if (_p2.device_count() > 0)
         _p2.dispatch(_evh2, 0); //millis / 2 > 50 ? millis / 2 : 50);
 
-        if (ready_deferred())
-            reopen_deferred();
+        reopen_deferred();
     }
 
 public: // signals
@@ -324,6 +367,8 @@ public: // signals
     typename SigslotNS::template signal1<server_ptr>                     server_opening;
     typename SigslotNS::template signal2<server_ptr, error_code const &> server_open_failed;
     typename SigslotNS::template signal1<error_code const &>             error;
+    typename SigslotNS::template signal1<device_ptr>                     write_high_watermark; ///<! outbound queue reached high watermark
+    typename SigslotNS::template signal1<device_ptr>                     write_low_watermark;  ///<! outbound queue drained to low watermark
 };
 
 }} // pfs::io
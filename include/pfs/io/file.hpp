@@ -1,4 +1,5 @@
 #pragma once
+#include <pfs/config.h>
 #include <pfs/string.hpp>
 #include <pfs/filesystem.hpp>
 #include <pfs/io/device.hpp>
@@ -78,4 +79,13 @@ device_ptr open_device<file_stderr> (open_params<file_stderr> const & op, error_
 
 string u8_read_all (filesystem::path const & path, error_code & ec);
 
+#if HAVE_ZLIB
+/**
+ * @brief Compresses file @a src into gzip file @a dest.
+ *
+ * @return Error code.
+ */
+error_code gzip (filesystem::path const & src, filesystem::path const & dest);
+#endif
+
 }} // pfs::io
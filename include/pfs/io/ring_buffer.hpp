@@ -0,0 +1,237 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <pfs/types.hpp>
+#include <pfs/assert.hpp>
+#include <pfs/algorithm.hpp>
+#include <pfs/noncopyable.hpp>
+
+#if defined(__linux__)
+#   include <sys/mman.h>
+#   include <unistd.h>
+#   if defined(MFD_CLOEXEC)
+#       define PFS_HAVE_MIRRORED_RING_BUFFER 1
+#   endif
+#endif
+
+#ifndef PFS_HAVE_MIRRORED_RING_BUFFER
+#   define PFS_HAVE_MIRRORED_RING_BUFFER 0
+#endif
+
+namespace pfs {
+namespace io {
+
+/**
+ * @brief Fixed-capacity byte ring buffer.
+ *
+ * @details If supported by platform (Linux) the buffer's memory is mapped
+ *          twice into adjacent virtual address ranges (mirrored buffer),
+ *          so any @c size() bytes starting at data() are contiguous
+ *          even if they wrap around the end of the ring.
+ *          Otherwise linearize() rotates the buffer when required.
+ *          Capacity of mirrored buffer is rounded up to the page size.
+ */
+class ring_buffer : noncopyable
+{
+    byte_t * _data;
+    size_t   _capacity;
+    size_t   _head;     // Read position
+    size_t   _size;     // Number of stored bytes
+    bool     _mirrored;
+
+private:
+#if PFS_HAVE_MIRRORED_RING_BUFFER
+    bool map_mirrored (size_t capacity)
+    {
+        size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        capacity = ((capacity + page_size - 1) / page_size) * page_size;
+
+        int fd = ::memfd_create("pfs-ring_buffer", MFD_CLOEXEC);
+
+        if (fd < 0)
+            return false;
+
+        if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        // Reserve address range for both copies
+        void * base = ::mmap(0, 2 * capacity, PROT_NONE
+                , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (base == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+
+        byte_t * p = static_cast<byte_t *>(base);
+
+        void * first = ::mmap(p, capacity, PROT_READ | PROT_WRITE
+                , MAP_SHARED | MAP_FIXED, fd, 0);
+        void * second = ::mmap(p + capacity, capacity, PROT_READ | PROT_WRITE
+                , MAP_SHARED | MAP_FIXED, fd, 0);
+
+        ::close(fd);
+
+        if (first == MAP_FAILED || second == MAP_FAILED) {
+            ::munmap(base, 2 * capacity);
+            return false;
+        }
+
+        _data = p;
+        _capacity = capacity;
+        _mirrored = true;
+        return true;
+    }
+#endif
+
+    size_t tail () const
+    {
+        return (_head + _size) % _capacity;
+    }
+
+public:
+    /**
+     * @param capacity Buffer capacity.
+     * @param mirrored Try to map memory twice (see class description).
+     */
+    explicit ring_buffer (size_t capacity, bool mirrored = true)
+        : _data(0)
+        , _capacity(0)
+        , _head(0)
+        , _size(0)
+        , _mirrored(false)
+    {
+        if (capacity == 0)
+            capacity = 1;
+
+#if PFS_HAVE_MIRRORED_RING_BUFFER
+        if (mirrored && map_mirrored(capacity))
+            return;
+#else
+        (void)mirrored;
+#endif
+
+        _data = static_cast<byte_t *>(std::malloc(capacity));
+        PFS_ASSERT(_data);
+        _capacity = capacity;
+    }
+
+    ~ring_buffer ()
+    {
+#if PFS_HAVE_MIRRORED_RING_BUFFER
+        if (_mirrored) {
+            ::munmap(_data, 2 * _capacity);
+            return;
+        }
+#endif
+        std::free(_data);
+    }
+
+    size_t capacity () const
+    {
+        return _capacity;
+    }
+
+    size_t size () const
+    {
+        return _size;
+    }
+
+    size_t free_space () const
+    {
+        return _capacity - _size;
+    }
+
+    bool empty () const
+    {
+        return _size == 0;
+    }
+
+    bool full () const
+    {
+        return _size == _capacity;
+    }
+
+    bool is_mirrored () const
+    {
+        return _mirrored;
+    }
+
+    /**
+     * @return Pointer to the first stored byte.
+     */
+    byte_t const * data () const
+    {
+        return _data + _head;
+    }
+
+    /**
+     * @return Number of bytes that can be accessed contiguously
+     *         starting from data().
+     */
+    size_t contiguous_size () const
+    {
+        return _mirrored
+                ? _size
+                : pfs::min(_size, _capacity - _head);
+    }
+
+    /**
+     * @brief Makes first @a n (not greater than size()) stored bytes
+     *        contiguous.
+     *
+     * @details Does nothing for mirrored buffer or if bytes do not wrap.
+     */
+    byte_t const * linearize (size_t n)
+    {
+        if (n > contiguous_size()) {
+            std::rotate(_data, _data + _head, _data + _capacity);
+            _head = 0;
+        }
+
+        return data();
+    }
+
+    /**
+     * @brief Returns region for writing (after the last stored byte)
+     *        and stores its size into @a n.
+     */
+    byte_t * prepare (size_t & n)
+    {
+        size_t t = tail();
+        n = _mirrored
+                ? free_space()
+                : pfs::min(free_space(), _capacity - t);
+        return _data + t;
+    }
+
+    /**
+     * @brief Appends @a n bytes written into region returned by prepare().
+     */
+    void commit (size_t n)
+    {
+        PFS_ASSERT(n <= free_space());
+        _size += n;
+    }
+
+    /**
+     * @brief Discards first @a n stored bytes.
+     */
+    void consume (size_t n)
+    {
+        PFS_ASSERT(n <= _size);
+        _size -= n;
+        _head = _size == 0 ? 0 : (_head + n) % _capacity;
+    }
+
+    void clear ()
+    {
+        _head = 0;
+        _size = 0;
+    }
+};
+
+}} // pfs::io
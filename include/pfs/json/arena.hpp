@@ -0,0 +1,198 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <pfs/arena.hpp>
+#include <pfs/flat_map.hpp>
+#include <pfs/unicode/unicode_iterator.hpp>
+#include <pfs/unicode/u8_iterator.hpp>
+#include <pfs/json/json.hpp>
+
+namespace pfs {
+namespace json {
+
+namespace details {
+
+/**
+ * @brief Nodes of value representation are allocated from the current
+ *        arena and deallocated by the allocator of the node itself
+ *        (the arena in which node was allocated or heap).
+ */
+template <>
+struct rep_allocator<pfs::arena_allocator>
+{
+    template <typename T>
+    static T * create (T const & v)
+    {
+        pfs::arena_allocator<T> alloc;
+        T * p = alloc.allocate(1);
+        alloc.construct(p, v);
+        return p;
+    }
+
+    template <typename T>
+    static T * create (T && v)
+    {
+        pfs::arena_allocator<T> alloc;
+        T * p = alloc.allocate(1);
+        alloc.construct(p, std::move(v));
+        return p;
+    }
+
+    template <typename T>
+    static void destroy (T * p)
+    {
+        pfs::arena_allocator<T> alloc(p->get_allocator());
+        alloc.destroy(p);
+        alloc.deallocate(p, 1);
+    }
+};
+
+} // details
+
+typedef std::basic_string<char
+        , std::char_traits<char>
+        , pfs::arena_allocator<char> > arena_string;
+
+}} // pfs::json
+
+namespace pfs {
+namespace unicode {
+
+template <>
+struct unicode_iterator_traits<pfs::json::arena_string::iterator>
+    :  unicode_iterator_limits<pfs::json::arena_string::iterator, char *>
+{
+    typedef utf8_iterator<pfs::json::arena_string::iterator> iterator;
+    typedef u8_output_iterator<pfs::back_insert_iterator<pfs::json::arena_string> > output_iterator;
+    typedef u8_input_iterator<pfs::json::arena_string::iterator> input_iterator;
+};
+
+template <>
+struct unicode_iterator_traits<pfs::json::arena_string::const_iterator>
+    :  unicode_iterator_limits<pfs::json::arena_string::const_iterator, char const *>
+{
+    typedef utf8_iterator<pfs::json::arena_string::const_iterator> iterator;
+    typedef u8_input_iterator<pfs::json::arena_string::const_iterator> input_iterator;
+};
+
+} // unicode
+
+namespace json {
+
+template <typename T>
+using arena_vector = std::vector<T, pfs::arena_allocator<T> >;
+
+template <typename Key, typename T>
+using arena_map = pfs::basic_flat_map<Key, T
+        , pfs::arena_allocator<std::pair<Key, T> > >;
+
+/**
+ * @brief JSON value which strings, arrays and objects are allocated
+ *        from the arena current at the moment of allocation
+ *        (see pfs::arena::scope). Objects are sorted vectors of key/value
+ *        pairs. Short strings are stored inline (inside the string object
+ *        allocated from the arena).
+ */
+typedef json<bool
+        , intmax_t
+        , double
+        , arena_string
+        , arena_vector
+        , arena_map
+        , pfs::arena_allocator> arena_json;
+
+/**
+ * @brief JSON document which owns the arena all document's values
+ *        are allocated from.
+ *
+ * @details Document memory is released at once, values tree is not
+ *          traversed on destruction. So values stored into document
+ *          must be created while document's scope is active:
+ *
+ * @code
+ * pfs::json::document<> doc;
+ * doc.parse(text);
+ *
+ * {
+ *     pfs::json::document<>::scope s(doc);
+ *     doc.root()["key"] = pfs::json::arena_json("value");
+ * }
+ * @endcode
+ */
+template <typename JsonType = arena_json>
+class document : noncopyable
+{
+public:
+    typedef JsonType                         json_type;
+    typedef typename json_type::string_type  string_type;
+
+    class scope : public pfs::arena::scope
+    {
+    public:
+        explicit scope (document & doc)
+            : pfs::arena::scope(doc._arena)
+        {}
+    };
+
+private:
+    pfs::arena _arena;
+
+    // Root value is created in the arena too to avoid its destruction
+    // (tree is released with the arena).
+    json_type * _root;
+
+private:
+    void reset_root ()
+    {
+        pfs::arena::scope s(_arena);
+        _root = new (_arena.allocate(sizeof(json_type), alignof(json_type))) json_type;
+    }
+
+public:
+    /**
+     * @param initial_size Size of the first arena's chunk.
+     */
+    explicit document (size_t initial_size = 4096)
+        : _arena(initial_size)
+        , _root(0)
+    {
+        reset_root();
+    }
+
+    json_type & root ()
+    {
+        return *_root;
+    }
+
+    json_type const & root () const
+    {
+        return *_root;
+    }
+
+    /**
+     * @brief Releases all document's memory and resets root to null value.
+     */
+    void clear ()
+    {
+        _arena.release();
+        reset_root();
+    }
+
+    /**
+     * @brief Parses document, previous content is released.
+     */
+    error_code parse (string_type const & s)
+    {
+        clear();
+
+        pfs::arena::scope sc(_arena);
+        return _root->parse(s);
+    }
+
+    pfs::arena const & get_arena () const
+    {
+        return _arena;
+    }
+};
+
+}} // pfs::json
@@ -21,7 +21,8 @@ class scalar_iterator
         , typename RealT
         , typename StringT
         , template <typename> class SequenceContainer
-        , template <typename, typename> class AssociativeContainer>
+        , template <typename, typename> class AssociativeContainer
+        , template <typename> class Allocator>
     friend class json;
 
 public:
@@ -128,7 +129,8 @@ class basic_iterator
         , typename RealT
         , typename StringT
         , template <typename> class SequenceContainer
-        , template <typename, typename> class AssociativeContainer>
+        , template <typename, typename> class AssociativeContainer
+        , template <typename> class Allocator>
     friend class json;
 
 public:
@@ -12,6 +12,7 @@
 #include <pfs/json/exception.hpp>
 #include <pfs/json/cast.hpp>
 #include <pfs/json/rfc7159.hpp>
+#include <pfs/json/parser.hpp>
 
 namespace pfs {
 namespace json {
@@ -21,21 +22,68 @@ namespace json {
     , typename RealT                                                           \
     , typename StringT                                                         \
     , template <typename> class SequenceContainer                              \
-    , template <typename, typename> class AssociativeContainer
+    , template <typename, typename> class AssociativeContainer                 \
+    , template <typename> class Allocator
 
 #define PFS_JSON_TEMPLETE_ARGS BoolT                                           \
     , IntT                                                                     \
     , RealT                                                                    \
     , StringT                                                                  \
     , SequenceContainer                                                        \
-    , AssociativeContainer
+    , AssociativeContainer                                                     \
+    , Allocator
+
+namespace details {
+
+/**
+ * @brief Creates and destroys heap-allocated parts of value representation
+ *        (strings, arrays and objects).
+ *
+ * @details Specialize it for allocators that need to be obtained from
+ *          the allocated object (see pfs/json/arena.hpp).
+ */
+template <template <typename> class Allocator>
+struct rep_allocator
+{
+    template <typename T>
+    static T * create (T const & v)
+    {
+        Allocator<T> alloc;
+        T * p = alloc.allocate(1);
+        alloc.construct(p, v);
+        return p;
+    }
+
+#if __cplusplus >= 201103L
+    // Selected for rvalues only (`T *` is ill-formed for lvalue reference T)
+    template <typename T>
+    static T * create (T && v)
+    {
+        Allocator<T> alloc;
+        T * p = alloc.allocate(1);
+        alloc.construct(p, std::move(v));
+        return p;
+    }
+#endif
+
+    template <typename T>
+    static void destroy (T * p)
+    {
+        Allocator<T> alloc;
+        alloc.destroy(p);
+        alloc.deallocate(p, 1);
+    }
+};
+
+} // details
 
 template <typename BoolT = bool
         , typename IntT = intmax_t
         , typename RealT = double
         , typename StringT = pfs::string
         , template <typename> class SequenceContainer = pfs::vector
-        , template <typename, typename> class AssociativeContainer = pfs::map>
+        , template <typename, typename> class AssociativeContainer = pfs::map
+        , template <typename> class Allocator = pfs::allocator>
 class json
 {
 public:
@@ -50,6 +98,7 @@ public:
     typedef SequenceContainer<json>                 array_type;
     typedef AssociativeContainer<string_type, json> object_type;
     typedef typename object_type::key_type          key_type;
+    typedef details::rep_allocator<Allocator>       rep_allocator;
 
     struct value_rep
     {
@@ -92,25 +141,35 @@ public:
         value_rep (string_type const & v)
             : type(data_type::string)
         {
-            pfs::allocator<string_type> alloc;
-            string = alloc.allocate(1);
-            alloc.construct(string, v);
+            string = rep_allocator::create(v);
+        }
+
+#if __cplusplus >= 201103L
+        value_rep (string_type && v)
+            : type(data_type::string)
+        {
+            string = rep_allocator::create(std::move(v));
         }
+#endif
 
         value_rep (array_type const & v)
             : type(data_type::array)
         {
-            pfs::allocator<array_type> alloc;
-            array = alloc.allocate(1);
-            alloc.construct(array, v);
+            array = rep_allocator::create(v);
+        }
+
+#if __cplusplus >= 201103L
+        value_rep (array_type && v)
+            : type(data_type::array)
+        {
+            array = rep_allocator::create(std::move(v));
         }
+#endif
 
         value_rep (object_type const & v)
             : type(data_type::object)
         {
-            pfs::allocator<object_type> alloc;
-            object = alloc.allocate(1);
-            alloc.construct(object, v);
+            object = rep_allocator::create(v);
         }
     };
 
@@ -257,6 +316,15 @@ public:
         : _d(v)
     {}
 
+#if __cplusplus >= 201103L
+    /**
+     * @brief Constructs string value moving content of @a v.
+     */
+    json (string_type && v)
+        : _d(std::move(v))
+    {}
+#endif
+
     /**
      * @brief Constructs string value from C-string.
      */
@@ -271,6 +339,15 @@ public:
         : _d(v)
     {}
 
+#if __cplusplus >= 201103L
+    /**
+     * @brief Constructs array value moving elements of @a v.
+     */
+    json (array_type && v)
+        : _d(std::move(v))
+    {}
+#endif
+
     /**
      * @brief Constructs object value from other type_object value.
      */
@@ -303,37 +380,43 @@ public:
 
 #if __cplusplus >= 201103L
 
-    // TODO Need to implement
-    //json (json && other);
+    /**
+     * @brief Move constructor, steals value representation
+     *        (containers reallocation does not copy nested values).
+     */
+    json (json && other) noexcept
+        : _d(other._d)
+    {
+        other._d = rep_type();
+    }
 
-    // TODO Need to implement
-    //json & operator = (json && other);
+    json & operator = (json && other) noexcept
+    {
+        if (this != & other) {
+            this->~json();
+            _d = other._d;
+            other._d = rep_type();
+        }
+
+        return *this;
+    }
 
 #endif
 
     ~json ()
     {
         switch (_d.type) {
-        case data_type::string: {
-            std::allocator<string_type> alloc;
-            alloc.destroy(_d.string);
-            alloc.deallocate(_d.string, 1);
+        case data_type::string:
+            rep_allocator::destroy(_d.string);
             break;
-        }
 
-        case data_type::array: {
-            std::allocator<array_type> alloc;
-            alloc.destroy(_d.array);
-            alloc.deallocate(_d.array, 1);
+        case data_type::array:
+            rep_allocator::destroy(_d.array);
             break;
-        }
 
-        case data_type::object: {
-            std::allocator<object_type> alloc;
-            alloc.destroy(_d.object);
-            alloc.deallocate(_d.object, 1);
+        case data_type::object:
+            rep_allocator::destroy(_d.object);
             break;
-        }
 
         default:
             break;
@@ -497,6 +580,27 @@ public:
         return *it;
     }
 
+    /**
+     * @brief Inserts member into object (null value is converted to object).
+     *
+     * @return Pair of iterator to the inserted member (or to the member
+     *         with the same key that prevented insertion) and @c true
+     *         if insertion took place.
+     */
+    pfs::pair<iterator, bool> insert (key_type const & key, json const & value)
+    {
+        if (_d.type == data_type::null)
+            _d = object_type();
+
+        if (_d.type != data_type::object)
+            PFS_THROW(json_exception(make_error_code(json_errc::object_expected)));
+
+        pfs::pair<typename object_type::iterator, bool> result
+                = _d.object->insert(key, value);
+
+        return pfs::make_pair(iterator(this, result.first), result.second);
+    }
+
     reference operator [] (key_type const & key)
     {
         if (_d.type == data_type::null)
@@ -549,7 +653,7 @@ public:
 
     void erase (size_type index)
     {
-        if (_d.type() != data_type::array)
+        if (_d.type != data_type::array)
             PFS_THROW(json_exception(make_error_code(json_errc::array_expected)));
         if (index >= _d.array->size())
             PFS_THROW(json_exception(make_error_code(json_errc::range)));
@@ -558,7 +662,7 @@ public:
 
     void erase (key_type const & key)
     {
-        if (_d.type() != data_type::object)
+        if (_d.type != data_type::object)
             PFS_THROW(json_exception(make_error_code(json_errc::object_expected)));
 
         _d.object->erase(key);
@@ -781,38 +885,36 @@ public:
      */
     error_code parse (string_type const & s)
     {
-        return parse(s.cbegin(), s.cend());
+        return parse(s.data(), s.data() + s.size());
     }
 
     error_code parse (typename string_type::const_iterator first
             , typename string_type::const_iterator last)
     {
-        typedef grammar<json> grammar_type;
-        typedef typename grammar_type::fsm_type fsm_type;
-
-        // Initialize grammar's static members
-        static grammar_type grammar;
-
-        dom_builder_context<json> sax(*this);
-        typename grammar_type::parse_context context;
+        if (first == last)
+            return parse(static_cast<char const *>(0), static_cast<char const *>(0));
 
-        //context.is_json_begin = true;
-        context.sax           = & sax;
-
-//        sax.s.push(this);
+        char const * begin = & *first;
+        return parse(begin, begin + (last - first));
+    }
 
-        fsm_type fsm(grammar.p_json_tr, & context);
-        typename fsm_type::result_type r = fsm.exec(0, first, last);
+    /**
+     * @brief Deserializer of UTF-8 encoded JSON text in range
+     *        [@a first, @a last).
+     */
+    error_code parse (char const * first, char const * last)
+    {
+        dom_builder<json> builder(*this);
+        parser<dom_builder<json> > p;
 
-        if (r.first && r.second == last)
-            return error_code();
+        error_code ec = p.parse(builder, first, last);
 
-        if (r.first && r.second != last)
-            context.ec = make_error_code(json_errc::excess_source);
+        if (ec) {
+            json j;
+            this->swap(j);
+        }
 
-        json j;
-        this->swap(j);
-        return context.ec;
+        return ec;
     }
 
 //    error_code write (string_type & s);
@@ -0,0 +1,914 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <pfs/types.hpp>
+#include <pfs/real.hpp>
+#include <pfs/json/exception.hpp>
+#include <pfs/json/rfc7159.hpp>
+#include <pfs/json/string_view.hpp>
+
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
+namespace pfs {
+namespace json {
+
+/**
+ * @brief RFC 7159 parser.
+ *
+ * @details Hand-written replacement of FSM-based grammar (see rfc7159.hpp).
+ *          Parser works directly on the UTF-8 encoded bytes of the source,
+ *          does not use recursion (nesting depth is limited by available
+ *          memory only) and reports values to the @a Handler.
+ *
+ *          Names and string values are passed to the handler as string_view
+ *          referencing the source itself (if string contains no escape
+ *          sequences) or the parser's internal buffer, so parsing does not
+ *          copy strings nor allocate memory after warming up. Handler must
+ *          copy referenced data if it needs it after the callback returns.
+ *
+ *          Handler must provide the following methods (returning @c false
+ *          stops parsing with json_errc::bad_json error):
+ * @code
+ *      bool on_begin_json     ();
+ *      bool on_end_json       (bool success);
+ *      bool on_begin_object   (string_view name);
+ *      bool on_end_object     (string_view name);
+ *      bool on_begin_array    (string_view name);
+ *      bool on_end_array      (string_view name);
+ *      bool on_null_value     (string_view name);
+ *      bool on_boolean_value  (string_view name, bool);
+ *      bool on_integer_value  (string_view name, intmax_t);
+ *      bool on_uinteger_value (string_view name, uintmax_t);
+ *      bool on_real_value     (string_view name, real_t);
+ *      bool on_string_value   (string_view name, string_view value);
+ * @endcode
+ *          where @a name is the member name for object's members and empty
+ *          for array elements and top-level value. See dom_builder and
+ *          sax_context_adapter (for handlers derived from sax_context).
+ *
+ *          Plain string content is scanned by 16 bytes at a time
+ *          if SSE2 is available. UTF-8 sequences of string content
+ *          are validated.
+ *
+ *          Error codes:
+ *          @arg json_errc::bad_json - syntax error or SAX callback
+ *               returned @c false;
+ *          @arg json_errc::bad_number - malformed number;
+ *          @arg json_errc::excess_source - valid JSON text followed
+ *               by non-whitespace characters.
+ */
+template <typename Handler>
+class parser
+{
+public:
+    typedef Handler handler_type;
+
+private:
+    struct frame
+    {
+        bool        is_object;
+        bool        has_values;
+
+        // Member name of the container in the parent: references
+        // the source or, if name was unescaped, is stored in `_names`
+        // at `names_offset`.
+        string_view name;
+        bool        owns_name;
+        size_t      names_offset;
+    };
+
+    handler_type *     _h;
+    char const *       _pos;
+    char const *       _end;
+    error_code         _ec;
+    string_view        _name;      // Name of the current member
+    std::string        _name_buf;  // Buffer for unescaped member names
+    std::string        _value_buf; // Buffer for unescaped string values
+    std::string        _names;     // Unescaped names of open containers
+    std::vector<frame> _frames;
+    size_t             _depth;
+
+private:
+    static bool is_ws (char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    static bool is_digit (char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    static int hex_digit (char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool fail (json_errc e)
+    {
+        if (!_ec)
+            _ec = make_error_code(e);
+        return false;
+    }
+
+    void skip_ws ()
+    {
+        while (_pos != _end && is_ws(*_pos))
+            ++_pos;
+    }
+
+    /**
+     * @return Position of the first byte that requires attention
+     *         inside string (quotation mark, reverse solidus, control
+     *         character or non-ASCII byte) or end of source.
+     */
+    char const * scan_plain (char const * p) const
+    {
+#if defined(__SSE2__)
+        __m128i const quote     = _mm_set1_epi8('"');
+        __m128i const backslash = _mm_set1_epi8('\\');
+        __m128i const space     = _mm_set1_epi8(0x20);
+
+        while (_end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+
+            // Signed comparison: bytes >= 0x80 are negative, so
+            // `chunk < 0x20` catches control and non-ASCII bytes
+            __m128i special = _mm_or_si128(
+                      _mm_or_si128(_mm_cmpeq_epi8(chunk, quote)
+                            , _mm_cmpeq_epi8(chunk, backslash))
+                    , _mm_cmplt_epi8(chunk, space));
+
+            int mask = _mm_movemask_epi8(special);
+
+            if (mask != 0) {
+#   if defined(__GNUC__)
+                return p + __builtin_ctz(static_cast<unsigned int>(mask));
+#   else
+                while (!(mask & 1)) {
+                    mask >>= 1;
+                    ++p;
+                }
+                return p;
+#   endif
+            }
+
+            p += 16;
+        }
+#endif
+        while (p != _end) {
+            unsigned char c = static_cast<unsigned char>(*p);
+
+            if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80)
+                break;
+
+            ++p;
+        }
+
+        return p;
+    }
+
+    /**
+     * @brief Validates UTF-8 sequence started at @a p.
+     * @return Position next to the sequence or @c null if sequence is invalid.
+     */
+    char const * skip_utf8 (char const * p) const
+    {
+        unsigned char c = static_cast<unsigned char>(*p);
+        int n = 0;
+        uint32_t min = 0;
+
+        if (c >= 0xC2 && c <= 0xDF) {
+            n = 1; min = 0x80;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            n = 2; min = 0x800;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            n = 3; min = 0x10000;
+        } else {
+            return 0;
+        }
+
+        if (_end - p <= n)
+            return 0;
+
+        uint32_t uc = c & (0x3F >> n);
+
+        for (int i = 1; i <= n; ++i) {
+            unsigned char cc = static_cast<unsigned char>(p[i]);
+
+            if ((cc & 0xC0) != 0x80)
+                return 0;
+
+            uc = (uc << 6) | (cc & 0x3F);
+        }
+
+        // Overlong form, surrogate or out of range
+        if (uc < min || (uc >= 0xD800 && uc <= 0xDFFF) || uc > 0x10FFFF)
+            return 0;
+
+        return p + n + 1;
+    }
+
+    static void append_utf8 (std::string & s, uint32_t uc)
+    {
+        char buf[4];
+        size_t n = 0;
+
+        if (uc < 0x80) {
+            buf[n++] = static_cast<char>(uc);
+        } else if (uc < 0x800) {
+            buf[n++] = static_cast<char>(0xC0 | (uc >> 6));
+            buf[n++] = static_cast<char>(0x80 | (uc & 0x3F));
+        } else if (uc < 0x10000) {
+            buf[n++] = static_cast<char>(0xE0 | (uc >> 12));
+            buf[n++] = static_cast<char>(0x80 | ((uc >> 6) & 0x3F));
+            buf[n++] = static_cast<char>(0x80 | (uc & 0x3F));
+        } else {
+            buf[n++] = static_cast<char>(0xF0 | (uc >> 18));
+            buf[n++] = static_cast<char>(0x80 | ((uc >> 12) & 0x3F));
+            buf[n++] = static_cast<char>(0x80 | ((uc >> 6) & 0x3F));
+            buf[n++] = static_cast<char>(0x80 | (uc & 0x3F));
+        }
+
+        s.append(buf, n);
+    }
+
+    bool parse_hex4 (uint32_t & uc)
+    {
+        if (_end - _pos < 4)
+            return false;
+
+        uc = 0;
+
+        for (int i = 0; i < 4; ++i) {
+            int d = hex_digit(_pos[i]);
+
+            if (d < 0)
+                return false;
+
+            uc = (uc << 4) | static_cast<uint32_t>(d);
+        }
+
+        _pos += 4;
+        return true;
+    }
+
+    /**
+     * @brief Parses string, current position is next to the opening
+     *        quotation mark.
+     *
+     * @param result References string content: the source if string has
+     *        no escape sequences or @a buf otherwise.
+     */
+    bool parse_string (string_view & result, std::string & buf)
+    {
+        char const * run = _pos; // Start of the not yet copied content
+        bool copied = false;
+
+        for (;;) {
+            _pos = scan_plain(_pos);
+
+            if (_pos == _end)
+                return fail(json_errc::bad_json);
+
+            unsigned char c = static_cast<unsigned char>(*_pos);
+
+            if (c == '"') {
+                if (copied) {
+                    buf.append(run, static_cast<size_t>(_pos - run));
+                    result = string_view(buf.data(), buf.size());
+                } else {
+                    result = string_view(run, static_cast<size_t>(_pos - run));
+                }
+
+                ++_pos;
+                return true;
+            }
+
+            if (c < 0x20)
+                return fail(json_errc::bad_json);
+
+            if (c >= 0x80) {
+                char const * p = skip_utf8(_pos);
+
+                if (!p)
+                    return fail(json_errc::bad_json);
+
+                _pos = p;
+                continue;
+            }
+
+            // Escape sequence
+            if (!copied) {
+                buf.clear();
+                copied = true;
+            }
+
+            buf.append(run, static_cast<size_t>(_pos - run));
+            ++_pos;
+
+            if (_pos == _end)
+                return fail(json_errc::bad_json);
+
+            switch (*_pos++) {
+            case '"':  buf.push_back('"');  break;
+            case '\\': buf.push_back('\\'); break;
+            case '/':  buf.push_back('/');  break;
+            case 'b':  buf.push_back('\b'); break;
+            case 'f':  buf.push_back('\f'); break;
+            case 'n':  buf.push_back('\n'); break;
+            case 'r':  buf.push_back('\r'); break;
+            case 't':  buf.push_back('\t'); break;
+            case 'u':
+            case 'U': {
+                uint32_t uc = 0;
+
+                if (!parse_hex4(uc))
+                    return fail(json_errc::bad_json);
+
+                // Surrogate pair
+                if (uc >= 0xD800 && uc <= 0xDBFF
+                        && _end - _pos >= 6
+                        && _pos[0] == '\\'
+                        && (_pos[1] == 'u' || _pos[1] == 'U')) {
+                    char const * saved = _pos;
+                    uint32_t low = 0;
+
+                    _pos += 2;
+
+                    if (parse_hex4(low) && low >= 0xDC00 && low <= 0xDFFF)
+                        uc = 0x10000 + ((uc - 0xD800) << 10) + (low - 0xDC00);
+                    else
+                        _pos = saved;
+                }
+
+                append_utf8(buf, uc);
+                break;
+            }
+
+            default:
+                return fail(json_errc::bad_json);
+            }
+
+            run = _pos;
+        }
+    }
+
+    bool parse_literal (char const * literal, size_t n)
+    {
+        if (static_cast<size_t>(_end - _pos) < n)
+            return fail(json_errc::bad_json);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (_pos[i] != literal[i])
+                return fail(json_errc::bad_json);
+        }
+
+        _pos += n;
+        return true;
+    }
+
+    /**
+     * @brief Parses number.
+     *
+     * @details Integers are reported by on_integer_value (negative)
+     *          or on_uinteger_value, integers out of range and numbers
+     *          with fraction or exponent part - by on_real_value.
+     */
+    bool parse_number ()
+    {
+        static real_t const powers_of_10[] = {
+              1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7
+            , 1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+            , 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        char const * first = _pos;
+        bool negative = false;
+        bool overflow = false;
+        uintmax_t mantissa = 0;
+        int digits = 0;
+        int exp10 = 0;
+
+        if (*_pos == '-') {
+            negative = true;
+            ++_pos;
+        }
+
+        // int = zero / ( digit1-9 *DIGIT )
+        if (_pos == _end || !is_digit(*_pos))
+            return fail(json_errc::bad_number);
+
+        if (*_pos == '0') {
+            ++_pos;
+        } else {
+            while (_pos != _end && is_digit(*_pos)) {
+                unsigned d = static_cast<unsigned>(*_pos - '0');
+
+                if (mantissa > (pfs::numeric_limits<uintmax_t>::max() - d) / 10)
+                    overflow = true;
+                else
+                    mantissa = mantissa * 10 + d;
+
+                if (mantissa != 0)
+                    ++digits;
+
+                ++_pos;
+            }
+        }
+
+        bool is_integer = true;
+
+        // frac = decimal-point 1*DIGIT
+        if (_pos != _end && *_pos == '.') {
+            is_integer = false;
+            ++_pos;
+
+            if (_pos == _end || !is_digit(*_pos))
+                return fail(json_errc::bad_number);
+
+            while (_pos != _end && is_digit(*_pos)) {
+                if (!overflow && digits < 19) {
+                    mantissa = mantissa * 10 + static_cast<unsigned>(*_pos - '0');
+                    --exp10;
+
+                    if (mantissa != 0)
+                        ++digits;
+                } else {
+                    overflow = true;
+                }
+
+                ++_pos;
+            }
+        }
+
+        // exp = e [ minus / plus ] 1*DIGIT
+        if (_pos != _end && (*_pos == 'e' || *_pos == 'E')) {
+            is_integer = false;
+            ++_pos;
+
+            int exp_sign = 1;
+            int exp = 0;
+
+            if (_pos != _end && (*_pos == '-' || *_pos == '+')) {
+                exp_sign = *_pos == '-' ? -1 : 1;
+                ++_pos;
+            }
+
+            if (_pos == _end || !is_digit(*_pos))
+                return fail(json_errc::bad_number);
+
+            while (_pos != _end && is_digit(*_pos)) {
+                if (exp < 10000)
+                    exp = exp * 10 + (*_pos - '0');
+                ++_pos;
+            }
+
+            exp10 += exp_sign * exp;
+        }
+
+        if (is_integer && !overflow) {
+            if (!negative)
+                return _h->on_uinteger_value(_name, mantissa)
+                        || fail(json_errc::bad_json);
+
+            if (mantissa <= static_cast<uintmax_t>(pfs::numeric_limits<intmax_t>::max()) + 1) {
+                intmax_t n = mantissa == 0 ? 0 : -static_cast<intmax_t>(mantissa - 1) - 1;
+                return _h->on_integer_value(_name, n)
+                        || fail(json_errc::bad_json);
+            }
+        }
+
+        real_t r = 0;
+
+        // Exact conversion: mantissa and power of 10 are both
+        // exactly representable as double
+        if (!overflow && mantissa < (uintmax_t(1) << 53)
+                && exp10 >= -22 && exp10 <= 22) {
+            r = static_cast<real_t>(mantissa);
+
+            if (exp10 < 0)
+                r /= powers_of_10[-exp10];
+            else
+                r *= powers_of_10[exp10];
+
+            if (negative)
+                r = -r;
+        } else {
+            error_code ec;
+            char const * badpos = 0;
+
+            r = to_real<real_t, char const *>(first, _pos, ec, '.', & badpos);
+
+            if (badpos != _pos)
+                return fail(json_errc::bad_number);
+        }
+
+        return _h->on_real_value(_name, r) || fail(json_errc::bad_json);
+    }
+
+    /**
+     * @brief Parses scalar value or opens container.
+     * @return @c false on error.
+     */
+    bool parse_value ()
+    {
+        if (_pos == _end)
+            return fail(json_errc::bad_json);
+
+        bool ok = false;
+
+        switch (*_pos) {
+        case '{':
+        case '[': {
+            bool is_object = *_pos == '{';
+            ++_pos;
+
+            ok = is_object
+                    ? _h->on_begin_object(_name)
+                    : _h->on_begin_array(_name);
+
+            if (!ok)
+                return fail(json_errc::bad_json);
+
+            if (_depth == _frames.size())
+                _frames.push_back(frame());
+
+            frame & f = _frames[_depth++];
+            f.is_object    = is_object;
+            f.has_values   = false;
+            f.name         = _name;
+            f.owns_name    = false;
+            f.names_offset = _names.size();
+
+            // Unescaped name will be overwritten by the next member name
+            if (!_name.empty() && _name.data() == _name_buf.data()) {
+                _names.append(_name.data(), _name.size());
+                f.owns_name = true;
+            }
+
+            _name = string_view();
+            return true;
+        }
+
+        case '"': {
+            string_view value;
+            ++_pos;
+            ok = parse_string(value, _value_buf)
+                    && (_h->on_string_value(_name, value) || fail(json_errc::bad_json));
+            break;
+        }
+
+        case 't':
+            ok = parse_literal("true", 4)
+                    && (_h->on_boolean_value(_name, true) || fail(json_errc::bad_json));
+            break;
+
+        case 'f':
+            ok = parse_literal("false", 5)
+                    && (_h->on_boolean_value(_name, false) || fail(json_errc::bad_json));
+            break;
+
+        case 'n':
+            ok = parse_literal("null", 4)
+                    && (_h->on_null_value(_name) || fail(json_errc::bad_json));
+            break;
+
+        default:
+            if (*_pos == '-' || is_digit(*_pos))
+                ok = parse_number();
+            else
+                fail(json_errc::bad_json);
+            break;
+        }
+
+        _name = string_view();
+        return ok;
+    }
+
+    /**
+     * @brief Parses member name and name separator.
+     */
+    bool parse_member_name ()
+    {
+        if (_pos == _end || *_pos != '"')
+            return fail(json_errc::bad_json);
+
+        ++_pos;
+
+        if (!parse_string(_name, _name_buf))
+            return false;
+
+        skip_ws();
+
+        if (_pos == _end || *_pos != ':')
+            return fail(json_errc::bad_json);
+
+        ++_pos;
+        return true;
+    }
+
+    bool close_container ()
+    {
+        frame & f = _frames[--_depth];
+        string_view name = f.owns_name
+                ? string_view(_names.data() + f.names_offset, f.name.size())
+                : f.name;
+
+        ++_pos;
+
+        bool ok = f.is_object
+                ? _h->on_end_object(name)
+                : _h->on_end_array(name);
+
+        _names.resize(f.names_offset);
+
+        return ok || fail(json_errc::bad_json);
+    }
+
+    bool parse_text ()
+    {
+        skip_ws();
+
+        if (!parse_value())
+            return false;
+
+        while (_depth > 0) {
+            frame & f = _frames[_depth - 1];
+            bool is_object = f.is_object;
+
+            skip_ws();
+
+            if (_pos == _end)
+                return fail(json_errc::bad_json);
+
+            // Empty container or the last value
+            if (*_pos == (is_object ? '}' : ']')) {
+                if (!close_container())
+                    return false;
+                continue;
+            }
+
+            // Values are separated by comma
+            if (f.has_values) {
+                if (*_pos != ',')
+                    return fail(json_errc::bad_json);
+
+                ++_pos;
+                skip_ws();
+            }
+
+            f.has_values = true;
+
+            if (is_object) {
+                if (!parse_member_name())
+                    return false;
+
+                skip_ws();
+            }
+
+            if (!parse_value())
+                return false;
+        }
+
+        return true;
+    }
+
+public:
+    parser ()
+        : _h(0)
+        , _pos(0)
+        , _end(0)
+        , _depth(0)
+    {}
+
+    /**
+     * @brief Parses JSON text in range [@a first, @a last) reporting
+     *        values to @a h.
+     */
+    error_code parse (handler_type & h, char const * first, char const * last)
+    {
+        _h     = & h;
+        _pos   = first;
+        _end   = last;
+        _ec    = error_code();
+        _depth = 0;
+        _name  = string_view();
+        _names.clear();
+
+        if (!_h->on_begin_json())
+            return make_error_code(json_errc::bad_json);
+
+        bool ok = parse_text();
+
+        _h->on_end_json(ok);
+
+        if (!ok) {
+            if (!_ec)
+                _ec = make_error_code(json_errc::bad_json);
+            return _ec;
+        }
+
+        skip_ws();
+
+        if (_pos != _end)
+            return make_error_code(json_errc::excess_source);
+
+        return error_code();
+    }
+};
+
+/**
+ * @brief Parser's handler that builds JSON value.
+ *
+ * @details Values are constructed in place: object member is inserted
+ *          by single lookup, scalar values and containers are swapped
+ *          into the inserted element (no deep copies).
+ */
+template <typename JsonType>
+class dom_builder
+{
+public:
+    typedef JsonType                        json_type;
+    typedef typename json_type::string_type string_type;
+    typedef typename json_type::key_type    key_type;
+
+private:
+    json_type &              _root;
+    bool                     _is_begin;
+    std::vector<json_type *> _stack;
+    key_type                 _key;   // Reused buffer for member names
+
+private:
+    json_type * slot (string_view name)
+    {
+        if (_is_begin) {
+            _is_begin = false;
+            return & _root;
+        }
+
+        PFS_ASSERT(!_stack.empty());
+
+        json_type * parent = _stack.back();
+
+        if (parent->is_object()) {
+            name.assign_to(_key);
+            return & *parent->insert(_key, json_type()).first;
+        }
+
+        parent->push_back(json_type());
+        return & (*parent)[parent->size() - 1];
+    }
+
+    bool set (string_view name, json_type & v)
+    {
+        slot(name)->swap(v);
+        return true;
+    }
+
+    bool begin_container (string_view name, json_type & v)
+    {
+        json_type * p = slot(name);
+        p->swap(v);
+        _stack.push_back(p);
+        return true;
+    }
+
+    bool end_container ()
+    {
+        PFS_ASSERT(!_stack.empty());
+        _stack.pop_back();
+        return true;
+    }
+
+public:
+    dom_builder (json_type & root)
+        : _root(root)
+        , _is_begin(true)
+    {}
+
+    bool on_begin_json ()
+    {
+        return true;
+    }
+
+    bool on_end_json (bool)
+    {
+        return true;
+    }
+
+    bool on_begin_object (string_view name)
+    {
+        json_type v = json_type::make_object();
+        return begin_container(name, v);
+    }
+
+    bool on_end_object (string_view)
+    {
+        return end_container();
+    }
+
+    bool on_begin_array (string_view name)
+    {
+        json_type v = json_type::make_array();
+        return begin_container(name, v);
+    }
+
+    bool on_end_array (string_view)
+    {
+        return end_container();
+    }
+
+    bool on_null_value (string_view name)
+    {
+        json_type v;
+        return set(name, v);
+    }
+
+    bool on_boolean_value (string_view name, bool b)
+    {
+        json_type v(b);
+        return set(name, v);
+    }
+
+    bool on_integer_value (string_view name, intmax_t n)
+    {
+        json_type v(n);
+        return set(name, v);
+    }
+
+    bool on_uinteger_value (string_view name, uintmax_t n)
+    {
+        json_type v(n);
+        return set(name, v);
+    }
+
+    bool on_real_value (string_view name, real_t r)
+    {
+        json_type v(r);
+        return set(name, v);
+    }
+
+    bool on_string_value (string_view name, string_view s)
+    {
+        json_type v(string_type(s.data(), s.size()));
+        return set(name, v);
+    }
+};
+
+/**
+ * @brief Adapts handler derived from sax_context to the parser's
+ *        handler interface.
+ *
+ * @details Names and string values are copied into the adapter's buffers
+ *          (reused between callbacks).
+ */
+template <typename JsonType>
+class sax_context_adapter
+{
+public:
+    typedef sax_context<JsonType>               sax_type;
+    typedef typename sax_type::sequence_type    sequence_type;
+
+private:
+    sax_type &    _sax;
+    sequence_type _name;
+    sequence_type _value;
+
+private:
+    sequence_type const & name (string_view v)
+    {
+        v.assign_to(_name);
+        return _name;
+    }
+
+public:
+    sax_context_adapter (sax_type & sax)
+        : _sax(sax)
+    {}
+
+    bool on_begin_json ()                        { return _sax.on_begin_json(); }
+    bool on_end_json (bool success)              { return _sax.on_end_json(success); }
+    bool on_begin_object (string_view n)         { return _sax.on_begin_object(name(n)); }
+    bool on_end_object (string_view n)           { return _sax.on_end_object(name(n)); }
+    bool on_begin_array (string_view n)          { return _sax.on_begin_array(name(n)); }
+    bool on_end_array (string_view n)            { return _sax.on_end_array(name(n)); }
+    bool on_null_value (string_view n)           { return _sax.on_null_value(name(n)); }
+    bool on_boolean_value (string_view n, bool v)       { return _sax.on_boolean_value(name(n), v); }
+    bool on_integer_value (string_view n, intmax_t v)   { return _sax.on_integer_value(name(n), v); }
+    bool on_uinteger_value (string_view n, uintmax_t v) { return _sax.on_uinteger_value(name(n), v); }
+    bool on_real_value (string_view n, real_t v)        { return _sax.on_real_value(name(n), v); }
+
+    bool on_string_value (string_view n, string_view v)
+    {
+        v.assign_to(_value);
+        return _sax.on_string_value(name(n), _value);
+    }
+};
+
+}} // pfs::json
@@ -359,12 +359,14 @@ struct grammar
     typedef typename fsm_type::transition_type transition_type;
     typedef typename fsm_type::char_type       value_type;
 
+    // Iterators are not stored to allow incremental parsing
+    // (see pfs::fsm::stream) where input buffer can be reallocated
+    // between actions calls.
     struct number_context
     {
-        struct { iterator first, last; } sign;
-        struct { iterator first, last; } integral_part;
-        struct { iterator first, last; } frac_part;
-        struct { iterator first, last; } exp_part;
+        bool negative;
+        bool has_frac;
+        bool has_exp;
     };
 
     struct parse_context
@@ -409,7 +411,7 @@ struct grammar
                         error_code ec;
 
                         pfs::advance(ulast, 4);
-                        uint32_t uc = to_integral<uint32_t>(ufirst, ulast, ec, 0, 16);
+                        uint32_t uc = to_integral<uint32_t, iterator>(ufirst, ulast, ec, 0, 16);
 
                         if (ec)
                             PFS_THROW(json_exception(make_error_code(json_errc::bad_number)));
@@ -468,18 +470,7 @@ struct grammar
         if (!context) return true;
 
         parse_context * ctx = static_cast<parse_context *>(context);
-        ctx->number_ctx.sign.first = first;
-        ctx->number_ctx.sign.last = last;
-        return true;
-    }
-
-    static bool number_integral_part (iterator first, iterator last, void * context, void const * /*action_args*/)
-    {
-        if (!context) return true;
-
-        parse_context * ctx = static_cast<parse_context *>(context);
-        ctx->number_ctx.integral_part.first = first;
-        ctx->number_ctx.integral_part.last = last;
+        ctx->number_ctx.negative = first != last;
         return true;
     }
 
@@ -488,8 +479,7 @@ struct grammar
         if (!context) return true;
 
         parse_context * ctx = static_cast<parse_context *>(context);
-        ctx->number_ctx.frac_part.first = first;
-        ctx->number_ctx.frac_part.last = last;
+        ctx->number_ctx.has_frac = first != last;
         return true;
     }
 
@@ -498,28 +488,24 @@ struct grammar
         if (!context) return true;
 
         parse_context * ctx = static_cast<parse_context *>(context);
-        ctx->number_ctx.exp_part.first = first;
-        ctx->number_ctx.exp_part.last = last;
+        ctx->number_ctx.has_exp = first != last;
         return true;
     }
 
-    static bool number_value (iterator /*first*/, iterator /*last*/, void * context, void const * /*action_args*/)
+    static bool number_value (iterator first, iterator last, void * context, void const * /*action_args*/)
     {
         if (!context) return true;
 
         parse_context * ctx = static_cast<parse_context *>(context);
         bool result = false;
-        iterator first = ctx->number_ctx.sign.first;
-        iterator last  = ctx->number_ctx.integral_part.last;
         iterator badpos;
         error_code ec;
 
         // Integer number
-        if ((ctx->number_ctx.frac_part.first == ctx->number_ctx.frac_part.last)
-                && (ctx->number_ctx.exp_part.first == ctx->number_ctx.exp_part.last)) {
+        if (!ctx->number_ctx.has_frac && !ctx->number_ctx.has_exp) {
 
             // Negative
-            if (ctx->number_ctx.sign.first != ctx->number_ctx.sign.last) {
+            if (ctx->number_ctx.negative) {
                 intmax_t n = to_integral<intmax_t>(first, last, ec, & badpos, 10);
 
                 // Ok
@@ -534,8 +520,6 @@ struct grammar
         }
 
         if (badpos != last) {
-            last = ctx->number_ctx.exp_part.last;
-
             real_t d = to_real<real_t>(first, last, ec, '.', & badpos);
 
             if (badpos == last)
@@ -753,7 +737,7 @@ grammar<ValueT>::grammar ()
      */
     static transition_type const number_tr[] = {
           { 1,  1, FSM_OPT_ONE_OF(MINUS), fsm_type::normal, number_sign, 0}
-        , { 2, -1, FSM_TR(int_tr)       , fsm_type::normal, number_integral_part, 0}
+        , { 2, -1, FSM_TR(int_tr)       , fsm_type::normal, 0, 0}
         , { 3, -1, FSM_OPT_TR(frac_tr)  , fsm_type::normal, number_frac_part, 0}
         , {-1, -1, FSM_OPT_TR(exp_tr)   , fsm_type::accept, number_exp_part, 0}
     };
@@ -964,6 +948,9 @@ grammar<ValueT>::grammar ()
 
     p_json_tr = json_tr;
 
+    // Lower action-free subtables (numbers, strings, whitespaces)
+    fsm_type::compile(json_tr);
+
 } // grammar
 
 }} // pfs::json
@@ -5,10 +5,22 @@
 #include <pfs/byte_string_ostream.hpp>
 #include <pfs/byte_string_istream.hpp>
 #include <pfs/rpc.hpp>
+#include <pfs/vector.hpp>
+#include <pfs/functional.hpp>
+#include <pfs/noncopyable.hpp>
 #include <pfs/json/json.hpp>
 #include "pfs/json/ubjson_ostream.hpp"
+#include "pfs/json/ubjson_encoder.hpp"
 #include "pfs/json/ubjson_istream.hpp"
 
+#if __cplusplus >= 201103L
+#   include <future>
+#   include <pfs/atomic.hpp>
+#   include <pfs/mutex.hpp>
+#   include <pfs/condition_variable.hpp>
+#   include <pfs/thread_pool.hpp>
+#endif
+
 //
 // [JSON-RPC 2.0 Specification](http://www.jsonrpc.org/specification)
 //
@@ -125,10 +137,24 @@ struct ubjson_serializer
 
     pfs::byte_string operator () (json_type const & value) const
     {
-        pfs::byte_string result = to_ubjson(value, Optimization);
+        pfs::byte_string result;
+        pfs::error_code ec = (*this)(value, result);
+
+        if (ec)
+            PFS_THROW(json_exception(ec));
+
         return result;
     }
 
+    /**
+     * @brief Serializes @a value into @a result (buffer can be reused
+     *        for subsequent messages to avoid reallocations).
+     */
+    pfs::error_code operator () (json_type const & value, pfs::byte_string & result) const
+    {
+        return ubjson_encoder<json_type>(Optimization).encode(value, result);
+    }
+
     pfs::error_code operator () (pfs::byte_string const & bytes, json_type & result) const
     {
         pfs::error_code ec;
@@ -232,6 +258,8 @@ struct rpc
 
     class entity
     {
+        friend struct rpc;
+
     protected:
         json_type _j;
 
@@ -401,7 +429,6 @@ struct rpc
             if (r._j.contains("id"))
                 r._j.erase("id");
             r._j["method"] = name;
-            return r;
         }
 
         static void make_method (request & r, IdGenerator & idgen, method_type const & name)
@@ -418,6 +445,12 @@ struct rpc
             return r;
         }
 
+        static pfs::error_code serialize (request const & rq, pfs::byte_string & out)
+        {
+            serializer_type ar;
+            return ar(rq._j, out);
+        }
+
         static pfs::error_code deserialize (pfs::byte_string const & bytes
                 , request & rq)
         {
@@ -543,6 +576,19 @@ struct rpc
             return r;
         }
 
+        /**
+         * @brief Failure for request which id could not be detected
+         *        (e.g. invalid request), id is null.
+         */
+        static response make_failure (int code, string_type const & message)
+        {
+            response r(id_type(0));
+            r._j["id"] = json_type();
+            r._j["error"]["code"] = code;
+            r._j["error"]["message"] = message;
+            return r;
+        }
+
         static response make_failure (int code
                 , string_type const & message
                 , request const & rq)
@@ -573,6 +619,12 @@ struct rpc
             return r;
         }
 
+        static pfs::error_code serialize (response const & rp, pfs::byte_string & out)
+        {
+            serializer_type ar;
+            return ar(rp._j, out);
+        }
+
         static pfs::error_code deserialize (pfs::byte_string const & bytes
                 , response & rp)
         {
@@ -590,6 +642,719 @@ struct rpc
             return ec;
         }
     };
+
+    /**
+     * @brief Serializes entities (requests or responses) in range
+     *        [@a first, @a last) into @a out: single entity is serialized
+     *        as is, several entities are serialized as batch (array).
+     *
+     * @note Entities are moved into the batch (left empty).
+     */
+    template <typename ForwardIt>
+    static pfs::error_code serialize_batch (ForwardIt first
+            , ForwardIt last
+            , pfs::byte_string & out)
+    {
+        serializer_type ar;
+
+        if (first == last)
+            return make_error_code(rpc_errc::invalid_request);
+
+        ForwardIt next = first;
+
+        if (++next == last)
+            return ar(first->_j, out);
+
+        json_type batch = json_type::make_array();
+
+        for (; first != last; ++first) {
+            batch.push_back(json_type());
+            batch[batch.size() - 1].swap(first->_j);
+        }
+
+        return ar(batch, out);
+    }
+
+    /**
+     * @brief Deserializes single entity or batch of entities
+     *        from @a bytes and appends them to @a batch.
+     */
+    template <typename Entity>
+    static pfs::error_code deserialize_batch (pfs::byte_string const & bytes
+            , pfs::vector<Entity> & batch)
+    {
+        serializer_type ar;
+        json_type j;
+        pfs::error_code ec = ar(bytes, j);
+
+        if (ec)
+            return ec;
+
+        if (j.is_object()) {
+            batch.push_back(Entity());
+            batch.back()._j.swap(j);
+        } else if (j.is_array() && !j.empty()) {
+            for (size_type i = 0, n = j.size(); i < n; ++i) {
+                if (!j[i].is_object())
+                    return make_error_code(rpc_errc::invalid_request);
+
+                batch.push_back(Entity());
+                batch.back()._j.swap(j[i]);
+            }
+        } else {
+            return make_error_code(rpc_errc::invalid_request);
+        }
+
+        return pfs::error_code();
+    }
+
+#if __cplusplus >= 201103L
+    /**
+     * @brief Pipelined JSON-RPC client.
+     *
+     * @details Calls are queued by call()/notify() and sent by flush():
+     *          single request is sent as is, several requests are sent
+     *          as one batch. Any number of requests (up to table capacity)
+     *          may be outstanding, responses are correlated with requests
+     *          by id and may arrive in any order and in any batches.
+     *
+     *          Completions of outstanding requests are kept in the table
+     *          indexed by request id modulo capacity, ids are allocated
+     *          from free slots (the table is full only if all slots are
+     *          busy). Slots are claimed and released by atomic operations,
+     *          so dispatch()/process() may be called from another thread
+     *          than call()/flush() without locking.
+     *
+     *          Transport must provide:
+     *          @code
+     *          ssize_t send (pfs::byte_string const &, pfs::error_code &);
+     *          ssize_t recv (pfs::byte_string &, pfs::error_code &);
+     *          @endcode
+     */
+    template <typename Transport>
+    class client : noncopyable
+    {
+    public:
+        typedef Transport transport_type;
+        typedef pfs::function<void (pfs::error_code const &, response const &)> completion_type;
+
+    private:
+        enum { slot_free, slot_busy, slot_pending };
+
+        struct slot
+        {
+            atomic<int>     state;
+            id_type         id;
+            completion_type completion;
+
+            slot () : state(slot_free), id(0) {}
+        };
+
+        transport_type &       _transport;
+        size_t                 _next_id;
+        pfs::vector<slot>      _slots;
+        size_t                 _mask;
+        atomic<size_t>         _outstanding;
+        pfs::vector<request>   _queue;
+        pfs::vector<id_type>   _queue_ids;
+        pfs::byte_string       _buffer;
+
+    private:
+        static size_t round_capacity (size_t n)
+        {
+            size_t result = 1;
+
+            while (result < n)
+                result <<= 1;
+
+            return result;
+        }
+
+        slot & slot_for (id_type id)
+        {
+            return _slots[static_cast<size_t>(id) & _mask];
+        }
+
+        /**
+         * @brief Claims free slot for new request and returns id
+         *        mapped to it.
+         *
+         * @details Ids are increasing, the first free slot starting from
+         *          the slot of the next id is claimed, so new request fails
+         *          only if all slots are busy.
+         */
+        bool acquire (completion_type const & completion, id_type & id)
+        {
+            for (size_t k = 0; k < _slots.size(); ++k) {
+                id_type candidate = static_cast<id_type>(_next_id + k);
+                slot & s = slot_for(candidate);
+                int expected = slot_free;
+
+                if (!s.state.compare_exchange_strong(expected, slot_busy
+                        , std::memory_order_acquire))
+                    continue;
+
+                s.id = candidate;
+                s.completion = completion;
+                ++_outstanding;
+                s.state.store(slot_pending, std::memory_order_release);
+
+                _next_id += k + 1;
+                id = candidate;
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Releases slot of request @a id and returns its completion.
+         */
+        bool release (id_type id, completion_type & completion)
+        {
+            slot & s = slot_for(id);
+            int expected = slot_pending;
+
+            if (!s.state.compare_exchange_strong(expected, slot_busy
+                    , std::memory_order_acquire))
+                return false;
+
+            if (s.id != id) {
+                s.state.store(slot_pending, std::memory_order_release);
+                return false;
+            }
+
+            completion.swap(s.completion);
+            s.completion = completion_type();
+            --_outstanding;
+            s.state.store(slot_free, std::memory_order_release);
+            return true;
+        }
+
+        void fail (id_type id, pfs::error_code const & ec)
+        {
+            completion_type completion;
+
+            if (release(id, completion) && completion)
+                completion(ec, response());
+        }
+
+    public:
+        /**
+         * @param capacity Maximum number of outstanding requests
+         *        (rounded up to the power of two).
+         */
+        client (transport_type & transport, size_t capacity = 1024)
+            : _transport(transport)
+            , _next_id(1)
+            , _slots(round_capacity(capacity))
+            , _mask(round_capacity(capacity) - 1)
+            , _outstanding(0)
+        {}
+
+        /**
+         * @brief Queues method call @a rq (id is assigned by client).
+         *
+         * @details @a completion is called from dispatch()/process() with
+         *          received response (success or failure) or with error
+         *          code if request failed to send or response is invalid.
+         *
+         * @return @c errc::resource_unavailable_try_again if table
+         *         of outstanding requests is full.
+         */
+        pfs::error_code call (request & rq, completion_type const & completion)
+        {
+            id_type id;
+
+            if (!acquire(completion, id))
+                return pfs::make_error_code(pfs::errc::resource_unavailable_try_again);
+
+            rq._j["id"] = id;
+
+            _queue.push_back(request());
+            _queue.back()._j.swap(rq._j);
+            _queue_ids.push_back(id);
+            return pfs::error_code();
+        }
+
+        /**
+         * @brief Queues method call @a rq.
+         *
+         * @return Future which receives response or rpc_exception.
+         */
+        std::future<response> call (request & rq)
+        {
+            std::shared_ptr<std::promise<response> > p
+                    = std::make_shared<std::promise<response> >();
+            std::future<response> result = p->get_future();
+
+            pfs::error_code ec = call(rq, [p] (pfs::error_code const & ec, response const & rp) {
+                if (ec)
+                    p->set_exception(std::make_exception_ptr(rpc_exception(ec)));
+                else
+                    p->set_value(rp);
+            });
+
+            if (ec)
+                p->set_exception(std::make_exception_ptr(rpc_exception(ec)));
+
+            return result;
+        }
+
+        /**
+         * @brief Queues notification @a rq (no response is expected).
+         */
+        void notify (request & rq)
+        {
+            request::make_notification(rq, rq.name());
+            _queue.push_back(request());
+            _queue.back()._j.swap(rq._j);
+        }
+
+        /**
+         * @brief Sends queued requests by one transport write.
+         */
+        pfs::error_code flush ()
+        {
+            if (_queue.empty())
+                return pfs::error_code();
+
+            pfs::error_code ec = serialize_batch(_queue.begin(), _queue.end(), _buffer);
+
+            if (!ec) {
+                ssize_t n = _transport.send(_buffer, ec);
+
+                if (!ec && n < 0)
+                    ec = make_error_code(rpc_errc::internal_error);
+            }
+
+            if (ec) {
+                for (size_t i = 0; i < _queue_ids.size(); i++)
+                    fail(_queue_ids[i], ec);
+            }
+
+            _queue.clear();
+            _queue_ids.clear();
+            return ec;
+        }
+
+        /**
+         * @brief Receives data from transport and completes
+         *        corresponding requests.
+         */
+        pfs::error_code dispatch ()
+        {
+            pfs::error_code ec;
+            pfs::byte_string payload;
+            ssize_t n = _transport.recv(payload, ec);
+
+            if (n < 0 || ec)
+                return ec ? ec : make_error_code(rpc_errc::internal_error);
+
+            if (n == 0)
+                return pfs::error_code();
+
+            return process(payload);
+        }
+
+        /**
+         * @brief Completes requests by response (or batch of responses)
+         *        @a payload.
+         */
+        pfs::error_code process (pfs::byte_string const & payload)
+        {
+            pfs::vector<response> batch;
+            pfs::error_code ec = deserialize_batch(payload, batch);
+
+            if (ec)
+                return ec;
+
+            for (size_t i = 0; i < batch.size(); i++) {
+                response const & rp = batch[i];
+
+                // Response without id (e.g. parse error reported by server)
+                // can't be correlated with request
+                if (!rp._j.contains("id") || !rp._j["id"].is_integer()) {
+                    ec = make_error_code(rpc_errc::invalid_response);
+                    continue;
+                }
+
+                completion_type completion;
+
+                if (!release(rp.id(), completion)) {
+                    ec = make_error_code(rpc_errc::id_not_match);
+                    continue;
+                }
+
+                if (!completion)
+                    continue;
+
+                if (!rp.version_match(Major, Minor))
+                    completion(make_error_code(rpc_errc::bad_version), rp);
+                else
+                    completion(pfs::error_code(), rp);
+            }
+
+            return ec;
+        }
+
+        /**
+         * @return Number of requests waiting for response.
+         */
+        size_t outstanding () const
+        {
+            return _outstanding.load();
+        }
+
+        /**
+         * @return Number of queued (not sent yet) requests.
+         */
+        size_t queued () const
+        {
+            return _queue.size();
+        }
+    };
+
+    /**
+     * @brief JSON-RPC server executing requests in thread pool.
+     *
+     * @details Method names are interned into open addressing hash table
+     *          at registration (bind()) time, so lookup of the handler
+     *          for received request does not compare strings except
+     *          of the final match. Requests of received payload (single
+     *          request or batch) are executed concurrently by pool's
+     *          workers. Response (or batch of responses) for payload is
+     *          sent when all its requests are executed, either in order
+     *          of receiving payloads (in_order) or as soon as ready
+     *          (out_of_order), so slow handler does not block other
+     *          requests.
+     *
+     *          Handlers must be bound before serving starts.
+     *
+     *          Transport must provide (send() is called from workers,
+     *          calls are serialized by server):
+     *          @code
+     *          ssize_t send (pfs::byte_string const &, pfs::error_code &);
+     *          ssize_t recv (pfs::byte_string &, pfs::error_code &);
+     *          @endcode
+     */
+    template <typename Transport>
+    class server : noncopyable
+    {
+    public:
+        typedef Transport transport_type;
+        typedef pfs::function<response (request const &)> handler_type;
+
+        enum ordering_enum {
+              in_order
+            , out_of_order
+        };
+
+    private:
+        struct method_entry
+        {
+            size_t       hash;
+            method_type  name;
+            handler_type handler;
+            bool         used;
+
+            method_entry () : hash(0), used(false) {}
+        };
+
+        // Requests of one received payload
+        struct unit
+        {
+            uint64_t                            seq;
+            pfs::vector<request>                requests;
+            pfs::vector<response>               responses;
+            pfs::vector<handler_type const *>   handlers;
+            atomic<size_t>                      remaining;
+
+            unit () : seq(0), remaining(0) {}
+        };
+
+        typedef pfs::map<uint64_t, unit *> ready_map;
+
+        transport_type &          _transport;
+        thread_pool &             _pool;
+        ordering_enum             _ordering;
+        pfs::vector<method_entry> _methods;
+        size_t                    _method_count;
+        uint64_t                  _next_seq;      // Sequence number of next received unit
+        uint64_t                  _next_send_seq; // Sequence number of next unit to send
+        ready_map                 _ready;
+        pfs::mutex                _send_mutex;
+        atomic<size_t>            _unfinished;
+        pfs::mutex                _idle_mutex;
+        condition_variable        _idle_cond;
+
+    private:
+        // FNV-1a
+        static size_t hash_name (method_type const & name)
+        {
+            char const * p = name.data();
+            size_t h = sizeof(size_t) > 4
+                    ? static_cast<size_t>(14695981039346656037ULL)
+                    : static_cast<size_t>(2166136261UL);
+
+            for (size_t i = 0, n = name.size(); i < n; ++i) {
+                h ^= static_cast<unsigned char>(p[i]);
+                h *= sizeof(size_t) > 4
+                        ? static_cast<size_t>(1099511628211ULL)
+                        : static_cast<size_t>(16777619UL);
+            }
+
+            return h;
+        }
+
+        method_entry * lookup (pfs::vector<method_entry> & table
+                , method_type const & name
+                , size_t hash)
+        {
+            size_t mask = table.size() - 1;
+
+            for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+                method_entry & e = table[i];
+
+                if (!e.used || (e.hash == hash && e.name == name))
+                    return & e;
+            }
+        }
+
+        void rehash (size_t capacity)
+        {
+            pfs::vector<method_entry> table(capacity);
+
+            for (size_t i = 0; i < _methods.size(); ++i) {
+                if (_methods[i].used)
+                    *lookup(table, _methods[i].name, _methods[i].hash) = _methods[i];
+            }
+
+            _methods.swap(table);
+        }
+
+        handler_type const * find_handler (method_type const & name)
+        {
+            if (_method_count == 0)
+                return 0;
+
+            method_entry * e = lookup(_methods, name, hash_name(name));
+            return e->used ? & e->handler : 0;
+        }
+
+        static response failure (int code, string_type const & msg, request const & rq)
+        {
+            return rq.is_method()
+                    ? response::make_failure(code, msg, rq)
+                    : response();
+        }
+
+        void execute (unit * u, size_t index)
+        {
+            request const & rq = u->requests[index];
+            handler_type const * h = u->handlers[index];
+
+            if (h) {
+                try {
+                    response rp = (*h)(rq);
+
+                    if (rq.is_method())
+                        u->responses[index] = rp;
+                } catch (json_exception const &) {
+                    u->responses[index] = failure(INVALID_PARAMS, "Invalid params", rq);
+                } catch (...) {
+                    u->responses[index] = failure(INTERNAL_ERROR, "Internal error", rq);
+                }
+            }
+
+            if (--u->remaining == 0)
+                complete(u);
+        }
+
+        void send (unit * u)
+        {
+            pfs::vector<response> responses;
+
+            // Notifications have no responses (except of invalid ones)
+            for (size_t i = 0; i < u->responses.size(); ++i) {
+                if (u->requests[i].is_method() || !u->responses[i].empty())
+                    responses.push_back(u->responses[i]);
+            }
+
+            if (!responses.empty()) {
+                pfs::byte_string bytes;
+                pfs::error_code ec = serialize_batch(responses.begin(), responses.end(), bytes);
+
+                if (!ec)
+                    _transport.send(bytes, ec);
+            }
+
+            delete u;
+        }
+
+        void complete (unit * u)
+        {
+            {
+                unique_lock<pfs::mutex> locker(_send_mutex);
+
+                if (_ordering == out_of_order) {
+                    send(u);
+                } else {
+                    _ready.insert(u->seq, u);
+
+                    for (;;) {
+                        typename ready_map::iterator it = _ready.find(_next_send_seq);
+
+                        if (it == _ready.end())
+                            break;
+
+                        send(ready_map::mapped_reference(it));
+                        _ready.erase(it);
+                        ++_next_send_seq;
+                    }
+                }
+            }
+
+            // Decrement under lock: wait_idle() must not return (and server
+            // must not be destroyed) before the notification
+            unique_lock<pfs::mutex> locker(_idle_mutex);
+
+            if (--_unfinished == 0)
+                _idle_cond.notify_all();
+        }
+
+    public:
+        server (transport_type & transport
+                , thread_pool & pool = thread_pool::default_pool()
+                , ordering_enum ordering = in_order)
+            : _transport(transport)
+            , _pool(pool)
+            , _ordering(ordering)
+            , _method_count(0)
+            , _next_seq(0)
+            , _next_send_seq(0)
+            , _unfinished(0)
+        {}
+
+        ~server ()
+        {
+            wait_idle();
+        }
+
+        /**
+         * @brief Binds handler @a h to method @a name (replaces previously
+         *        bound one).
+         */
+        void bind (method_type const & name, handler_type const & h)
+        {
+            if ((_method_count + 1) * 2 > _methods.size())
+                rehash(_methods.empty() ? 16 : _methods.size() * 2);
+
+            size_t hash = hash_name(name);
+            method_entry * e = lookup(_methods, name, hash);
+
+            if (!e->used) {
+                e->used = true;
+                e->hash = hash;
+                e->name = name;
+                ++_method_count;
+            }
+
+            e->handler = h;
+        }
+
+        /**
+         * @brief Receives payload from transport and submits its requests
+         *        for execution (see process()).
+         */
+        pfs::error_code dispatch ()
+        {
+            pfs::error_code ec;
+            pfs::byte_string payload;
+            ssize_t n = _transport.recv(payload, ec);
+
+            if (n < 0 || ec)
+                return ec ? ec : make_error_code(rpc_errc::internal_error);
+
+            if (n == 0)
+                return pfs::error_code();
+
+            return process(payload);
+        }
+
+        /**
+         * @brief Submits requests of @a payload (single request or batch)
+         *        for execution.
+         *
+         * @details Requests for unknown methods and invalid requests are
+         *          answered by failure responses without execution.
+         *
+         * @return Error code if @a payload could not be decoded
+         *         (nothing is sent in this case).
+         */
+        pfs::error_code process (pfs::byte_string const & payload)
+        {
+            unit * u = new unit;
+            pfs::error_code ec = deserialize_batch(payload, u->requests);
+
+            if (ec) {
+                delete u;
+                return ec;
+            }
+
+            size_t n = u->requests.size();
+            u->responses.resize(n);
+            u->handlers.resize(n, 0);
+            u->remaining.store(n + 1);
+
+            ++_unfinished;
+
+            {
+                unique_lock<pfs::mutex> locker(_send_mutex);
+                u->seq = _next_seq++;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                request const & rq = u->requests[i];
+
+                if (rq.name().empty()) {
+                    // Invalid request is answered even if it has no id
+                    // (null id as required by JSON-RPC 2.0)
+                    u->responses[i] = rq.is_method() && rq._j["id"].is_integer()
+                            ? response::make_failure(INVALID_REQUEST, "Invalid request", rq)
+                            : response::make_failure(INVALID_REQUEST, "Invalid request");
+                } else {
+                    u->handlers[i] = find_handler(rq.name());
+
+                    if (!u->handlers[i])
+                        u->responses[i] = failure(METHOD_NOT_FOUND, "Method not found", rq);
+                }
+
+                if (u->handlers[i])
+                    _pool.push_method(& server::execute, this, u, i);
+                else if (--u->remaining == 0)
+                    complete(u);
+            }
+
+            // Extra reference prevents completion while submitting
+            if (--u->remaining == 0)
+                complete(u);
+
+            return pfs::error_code();
+        }
+
+        /**
+         * @brief Blocks until responses for all submitted requests are sent.
+         */
+        void wait_idle ()
+        {
+            unique_lock<pfs::mutex> locker(_idle_mutex);
+
+            while (_unfinished.load() != 0)
+                _idle_cond.wait(locker);
+        }
+    };
+#endif
 };
 
 }} // namespace pfs::json
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstring>
+#include <pfs/types.hpp>
+
+namespace pfs {
+namespace json {
+
+/**
+ * @brief Non-owning reference to UTF-8 encoded character sequence.
+ *
+ * @details Used by parser to pass names and string values to SAX handlers
+ *          without copying (see parser). Referenced sequence is valid only
+ *          during the callback call.
+ */
+class string_view
+{
+public:
+    typedef char         value_type;
+    typedef size_t       size_type;
+    typedef char const * const_pointer;
+    typedef char const * const_iterator;
+
+private:
+    const_pointer _data;
+    size_type     _size;
+
+public:
+    string_view ()
+        : _data(0)
+        , _size(0)
+    {}
+
+    string_view (const_pointer s, size_type n)
+        : _data(s)
+        , _size(n)
+    {}
+
+    string_view (const_pointer s)
+        : _data(s)
+        , _size(std::strlen(s))
+    {}
+
+    const_pointer data () const
+    {
+        return _data;
+    }
+
+    size_type size () const
+    {
+        return _size;
+    }
+
+    bool empty () const
+    {
+        return _size == 0;
+    }
+
+    const_iterator begin () const
+    {
+        return _data;
+    }
+
+    const_iterator end () const
+    {
+        return _data + _size;
+    }
+
+    /**
+     * @brief Assigns referenced sequence to @a s.
+     */
+    template <typename StringType>
+    void assign_to (StringType & s) const
+    {
+        s.assign(_data, _size);
+    }
+
+    bool operator == (string_view const & rhs) const
+    {
+        return _size == rhs._size
+                && (_size == 0 || std::memcmp(_data, rhs._data, _size) == 0);
+    }
+
+    bool operator != (string_view const & rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+}} // pfs::json
@@ -0,0 +1,466 @@
+#pragma once
+#include <cstring>
+#include <pfs/byte_string.hpp>
+#include <pfs/limits.hpp>
+#include <pfs/json/json.hpp>
+
+//
+// [Universal Binary JSON Specification](http://ubjson.org)
+//
+
+namespace pfs {
+namespace json {
+
+/**
+ * @brief UBJSON encoder writing into contiguous buffer.
+ *
+ * @details Encoding is performed in two passes: exact size of the encoded
+ *          value is computed first (see encoded_size()), then buffer is
+ *          resized once and value is written by raw stores. Buffer passed
+ *          to encode() can be reused between calls (its capacity is kept).
+ *
+ *          If type optimization is requested (UBJSON_FULL_OPTIMIZED) arrays
+ *          and objects which values have the same JSON type are written as
+ *          strongly-typed containers ([$type#count): integers use the width
+ *          of the widest value, one-character and longer strings use
+ *          string type.
+ *
+ *          Numeric values are written in Big-Endian order as required
+ *          by specification. Output is readable by ubjson_istream.
+ */
+template <typename JsonType>
+class ubjson_encoder
+{
+    enum flags_enum {
+          type_optimized  = 0x01
+        , count_optimized = 0x02
+    };
+
+public:
+    typedef JsonType                         json_type;
+    typedef typename json_type::integer_type integer_type;
+    typedef typename json_type::real_type    real_type;
+    typedef typename json_type::string_type  string_type;
+
+private:
+    typedef typename json_type::const_iterator const_iterator;
+
+public:
+    explicit ubjson_encoder (int flags = 0)
+        : _flags(flags)
+    {}
+
+    /**
+     * @return Exact size in bytes of encoded value @a j.
+     */
+    size_t encoded_size (json_type const & j) const
+    {
+        return value_size(j, UBJSON_CHAR_UNSPEC);
+    }
+
+    /**
+     * @brief Encodes @a j replacing content of @a out.
+     */
+    pfs::error_code encode (json_type const & j, byte_string & out) const
+    {
+        if (sizeof(real_type) != sizeof(real32_t) && sizeof(real_type) != sizeof(real64_t))
+            return make_error_code(json_errc::range);
+
+        out.resize(encoded_size(j));
+
+        if (!out.empty()) {
+            byte_t * p = write_value(& out[0], j, UBJSON_CHAR_UNSPEC);
+            PFS_ASSERT(p == & out[0] + out.size());
+        }
+
+        return pfs::error_code();
+    }
+
+    /**
+     * @brief Encodes @a j into buffer @a buf and writes it into
+     *        device @a dev (see io::details::device) by one call.
+     *
+     * @return Number of bytes written or -1 on error.
+     */
+    template <typename Device>
+    ssize_t encode (json_type const & j
+            , Device & dev
+            , byte_string & buf
+            , pfs::error_code & ec) const
+    {
+        ec = encode(j, buf);
+
+        if (ec)
+            return -1;
+
+        return dev.write(buf.data(), buf.size(), ec);
+    }
+
+private:
+    static bool is_integer (int8_t t)
+    {
+        return t == UBJSON_CHAR_INT8
+                || t == UBJSON_CHAR_UINT8
+                || t == UBJSON_CHAR_INT16
+                || t == UBJSON_CHAR_INT32
+                || t == UBJSON_CHAR_INT64;
+    }
+
+    static bool is_string (int8_t t)
+    {
+        return t == UBJSON_CHAR_CHAR || t == UBJSON_CHAR_STRING;
+    }
+
+    static size_t payload_size (int8_t t)
+    {
+        switch (t) {
+        case UBJSON_CHAR_INT8:
+        case UBJSON_CHAR_UINT8:
+            return 1;
+        case UBJSON_CHAR_INT16:
+            return 2;
+        case UBJSON_CHAR_INT32:
+        case UBJSON_CHAR_REAL32:
+            return 4;
+        case UBJSON_CHAR_INT64:
+        case UBJSON_CHAR_REAL64:
+            return 8;
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+    static int8_t integer_prefix (integer_type n)
+    {
+        if (pfs::numeric_limits<int8_t>::max() < n && n <= pfs::numeric_limits<uint8_t>::max())
+            return UBJSON_CHAR_UINT8;
+        else if (pfs::numeric_limits<int8_t>::min() <= n && n <= pfs::numeric_limits<int8_t>::max())
+            return UBJSON_CHAR_INT8;
+        else if (pfs::numeric_limits<int16_t>::min() <= n && n <= pfs::numeric_limits<int16_t>::max())
+            return UBJSON_CHAR_INT16;
+        else if (pfs::numeric_limits<int32_t>::min() <= n && n <= pfs::numeric_limits<int32_t>::max())
+            return UBJSON_CHAR_INT32;
+
+        return UBJSON_CHAR_INT64;
+    }
+
+    static int8_t real_prefix ()
+    {
+        return sizeof(real_type) == sizeof(real32_t)
+                ? UBJSON_CHAR_REAL32
+                : UBJSON_CHAR_REAL64;
+    }
+
+    static int8_t string_prefix (string_type const & s)
+    {
+        return s.size() == 1 && static_cast<unsigned char>(*s.data()) < 0x80
+                ? UBJSON_CHAR_CHAR
+                : UBJSON_CHAR_STRING;
+    }
+
+    static int8_t prefix (json_type const & j)
+    {
+        switch (j.type()) {
+        case data_type::null:
+            return UBJSON_CHAR_NULL;
+        case data_type::boolean:
+            return j.boolean_data() ? UBJSON_CHAR_TRUE : UBJSON_CHAR_FALSE;
+        case data_type::integer:
+            return integer_prefix(j.integer_data());
+        case data_type::real:
+            return real_prefix();
+        case data_type::string:
+            return string_prefix(j.string_data());
+        case data_type::array:
+            return UBJSON_CHAR_ARRAY_BEGIN;
+        case data_type::object:
+            return UBJSON_CHAR_OBJECT_BEGIN;
+        }
+
+        return UBJSON_CHAR_UNSPEC;
+    }
+
+    /**
+     * @return Integer type that can hold values of both types @a a and @a b.
+     */
+    static int8_t widen (int8_t a, int8_t b)
+    {
+        if (a == b)
+            return a;
+
+        if (payload_size(a) < payload_size(b))
+            return b;
+
+        if (payload_size(b) < payload_size(a))
+            return a;
+
+        // UINT8 and INT8
+        return UBJSON_CHAR_INT16;
+    }
+
+    bool use_count (json_type const & j) const
+    {
+        return (_flags & count_optimized) && !j.empty();
+    }
+
+    /**
+     * @return Type of values for strongly-typed container @a j
+     *         or UBJSON_CHAR_UNSPEC if container can't be (or must not be)
+     *         strongly-typed.
+     */
+    int8_t container_type (json_type const & j) const
+    {
+        // If a type is specified, a count must also be specified.
+        if (!(_flags & type_optimized) || !use_count(j))
+            return UBJSON_CHAR_UNSPEC;
+
+        const_iterator first = j.cbegin();
+        const_iterator last  = j.cend();
+        int8_t result = prefix(*first);
+
+        for (++first; first != last && result != UBJSON_CHAR_UNSPEC; ++first) {
+            int8_t t = prefix(*first);
+
+            if (t == result)
+                continue;
+
+            if (is_integer(result) && is_integer(t))
+                result = widen(result, t);
+            else if (is_string(result) && is_string(t))
+                result = UBJSON_CHAR_STRING;
+            else
+                result = UBJSON_CHAR_UNSPEC;
+        }
+
+        return result;
+    }
+
+    /**
+     * @return Size of string value excluding type marker.
+     */
+    size_t string_size (string_type const & s, int8_t type) const
+    {
+        if (type == UBJSON_CHAR_CHAR)
+            return 1;
+
+        return 1 + payload_size(integer_prefix(static_cast<integer_type>(s.size())))
+                + s.size();
+    }
+
+    /**
+     * @return Size of container excluding begin marker.
+     */
+    size_t container_size (json_type const & j, bool is_object) const
+    {
+        bool with_count = use_count(j);
+        int8_t type = container_type(j);
+        size_t result = 0;
+
+        if (type != UBJSON_CHAR_UNSPEC)
+            result += 2;
+
+        if (with_count)
+            result += 1 + 1 + payload_size(integer_prefix(static_cast<integer_type>(j.size())));
+        else
+            result += 1; // end marker
+
+        const_iterator first = j.cbegin();
+        const_iterator last  = j.cend();
+
+        for (; first != last; ++first) {
+            if (is_object)
+                result += string_size(first.key(), UBJSON_CHAR_STRING);
+
+            result += value_size(*first, type);
+        }
+
+        return result;
+    }
+
+    /**
+     * @param type Type of values of strongly-typed container (value
+     *        is written without type marker) or UBJSON_CHAR_UNSPEC.
+     */
+    size_t value_size (json_type const & j, int8_t type) const
+    {
+        size_t marker = type == UBJSON_CHAR_UNSPEC ? 1 : 0;
+
+        switch (j.type()) {
+        case data_type::null:
+        case data_type::boolean:
+            return marker;
+
+        case data_type::integer:
+            return marker + payload_size(marker
+                    ? integer_prefix(j.integer_data())
+                    : type);
+
+        case data_type::real:
+            return marker + sizeof(real_type);
+
+        case data_type::string:
+            return marker + string_size(j.string_data(), marker
+                    ? string_prefix(j.string_data())
+                    : type);
+
+        case data_type::array:
+            return marker + container_size(j, false);
+
+        case data_type::object:
+            return marker + container_size(j, true);
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Stores @a n low bytes of @a v in Big-Endian order.
+     */
+    static byte_t * store (byte_t * p, uintmax_t v, size_t n)
+    {
+        for (size_t i = n; i > 0; --i) {
+            p[i - 1] = static_cast<byte_t>(v & 0xFF);
+            v >>= 8;
+        }
+
+        return p + n;
+    }
+
+    static byte_t * write_integer (byte_t * p, integer_type n, int8_t type)
+    {
+        return store(p, static_cast<uintmax_t>(n), payload_size(type));
+    }
+
+    static byte_t * write_real (byte_t * p, real_type f)
+    {
+        if (sizeof(real_type) == sizeof(real32_t)) {
+            uint32_t d;
+            std::memcpy(& d, & f, sizeof(d));
+            return store(p, d, sizeof(d));
+        }
+
+        uint64_t d;
+        std::memcpy(& d, & f, sizeof(d));
+        return store(p, d, sizeof(d));
+    }
+
+    static byte_t * write_count (byte_t * p, size_t n)
+    {
+        int8_t t = integer_prefix(static_cast<integer_type>(n));
+        *p++ = t;
+        return write_integer(p, static_cast<integer_type>(n), t);
+    }
+
+    static byte_t * write_string (byte_t * p, string_type const & s, int8_t type)
+    {
+        if (type == UBJSON_CHAR_CHAR) {
+            *p++ = static_cast<byte_t>(*s.data());
+            return p;
+        }
+
+        p = write_count(p, s.size());
+
+        if (!s.empty()) {
+            std::memcpy(p, s.data(), s.size());
+            p += s.size();
+        }
+
+        return p;
+    }
+
+    byte_t * write_container (byte_t * p
+            , json_type const & j
+            , bool is_object
+            , bool with_marker) const
+    {
+        bool with_count = use_count(j);
+        int8_t type = container_type(j);
+
+        if (with_marker)
+            *p++ = is_object ? UBJSON_CHAR_OBJECT_BEGIN : UBJSON_CHAR_ARRAY_BEGIN;
+
+        if (type != UBJSON_CHAR_UNSPEC) {
+            *p++ = UBJSON_CHAR_TYPE;
+            *p++ = type;
+        }
+
+        if (with_count) {
+            *p++ = UBJSON_CHAR_SIZE;
+            p = write_count(p, j.size());
+        }
+
+        const_iterator first = j.cbegin();
+        const_iterator last  = j.cend();
+
+        for (; first != last; ++first) {
+            // The [S] (string) marker is omitted from each of the names
+            // in the name/value pairings inside the object.
+            if (is_object)
+                p = write_string(p, first.key(), UBJSON_CHAR_STRING);
+
+            p = write_value(p, *first, type);
+        }
+
+        // If a count is specified the container must not specify
+        // an end-marker.
+        if (!with_count)
+            *p++ = is_object ? UBJSON_CHAR_OBJECT_END : UBJSON_CHAR_ARRAY_END;
+
+        return p;
+    }
+
+    byte_t * write_value (byte_t * p, json_type const & j, int8_t type) const
+    {
+        bool with_marker = type == UBJSON_CHAR_UNSPEC;
+
+        switch (j.type()) {
+        case data_type::null:
+        case data_type::boolean:
+            // Values of strongly-typed containers of null and boolean
+            // values have no payload
+            if (with_marker)
+                *p++ = prefix(j);
+            break;
+
+        case data_type::integer:
+            if (with_marker) {
+                type = integer_prefix(j.integer_data());
+                *p++ = type;
+            }
+            p = write_integer(p, j.integer_data(), type);
+            break;
+
+        case data_type::real:
+            if (with_marker)
+                *p++ = real_prefix();
+            p = write_real(p, j.real_data());
+            break;
+
+        case data_type::string:
+            if (with_marker) {
+                type = string_prefix(j.string_data());
+                *p++ = type;
+            }
+            p = write_string(p, j.string_data(), type);
+            break;
+
+        // Container begin marker is the type marker itself
+        case data_type::array:
+            p = write_container(p, j, false, with_marker);
+            break;
+
+        case data_type::object:
+            p = write_container(p, j, true, with_marker);
+            break;
+        }
+
+        return p;
+    }
+
+private:
+    int _flags;
+};
+
+}} // pfs::json
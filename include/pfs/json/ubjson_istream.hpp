@@ -1,4 +1,6 @@
 #pragma once
+#include <cstring>
+#include <vector>
 #include <pfs/endian.hpp>
 #include <pfs/byte_string.hpp>
 #include <pfs/byte_string_istream.hpp>
@@ -40,12 +42,25 @@ struct ubjson_istream
 
 private:
     int8_t read_type (bool ignore_noop = true);
+    bool can_read (integer_type count, size_t size) const;
+    error_code read_bytes (char * p, size_t n);
     error_code read_integer (integer_type & n, int8_t type);
     error_code read_string (string_type & s, int8_t type);
     error_code read_key (string_type & s, int8_t type);
     error_code read_array (json_type & j);
     error_code read_nonoptimized_array (json_type & j, int8_t ch);
     error_code read_optimized_array (json_type & j, integer_type count, int8_t type);
+
+    template <typename T>
+    error_code read_payload (std::vector<T> & buf, integer_type count);
+
+    template <typename T>
+    error_code read_integer_array (json_type & j, integer_type count);
+
+    template <typename RealT, typename T>
+    error_code read_real_array (json_type & j, integer_type count);
+
+    static void assign_array (json_type & j, array_type & a);
     error_code read_object (json_type & j);
     error_code read_nonoptimized_object (json_type & j, int8_t ch);
     error_code read_optimized_object (json_type & j, integer_type count, int8_t type);
@@ -67,6 +82,37 @@ int8_t ubjson_istream<IStreamType, JsonType>::read_type (bool ignore_noop)
     return type;
 }
 
+/**
+ * @return @c true if stream contains at least @a count elements
+ *         of @a size bytes. Lengths are read from untrusted input, so
+ *         buffers are sized only after this check.
+ */
+template <typename IStreamType, typename JsonType>
+bool ubjson_istream<IStreamType, JsonType>::can_read (integer_type count, size_t size) const
+{
+    if (count < 0)
+        return false;
+
+    ssize_t avail = static_cast<ssize_t>(_is.available());
+
+    if (avail < 0)
+        avail = 0;
+
+    return static_cast<uintmax_t>(count) <= static_cast<uintmax_t>(avail) / size;
+}
+
+/**
+ * @brief Reads exactly @a n bytes.
+ */
+template <typename IStreamType, typename JsonType>
+pfs::error_code ubjson_istream<IStreamType, JsonType>::read_bytes (char * p, size_t n)
+{
+    if (n > 0 && _is.read_wait(p, n) != static_cast<ssize_t>(n))
+        return make_error_code(json_errc::ubjson_parse);
+
+    return pfs::error_code();
+}
+
 template <typename IStreamType, typename JsonType>
 pfs::error_code ubjson_istream<IStreamType, JsonType>::read (json_type & j, int8_t type)
 {
@@ -116,7 +162,11 @@ pfs::error_code ubjson_istream<IStreamType, JsonType>::read (json_type & j, int8
     case UBJSON_CHAR_CHAR:
     case UBJSON_CHAR_STRING: {
         string_type s;
-        read_string(s, type);
+        pfs::error_code ec = read_string(s, type);
+
+        if (ec)
+            return ec;
+
         j = s;
         break;
     }
@@ -201,22 +251,12 @@ pfs::error_code ubjson_istream<IStreamType, JsonType>::read_string (string_type
         break;
     }
 
-    case UBJSON_CHAR_STRING: {
-        integer_type n;
-        read_integer(n, UBJSON_CHAR_UNSPEC);
+    case UBJSON_CHAR_STRING:
+        return read_key(s, UBJSON_CHAR_UNSPEC);
 
-        byte_string bs;
-
-        while (n--) {
-            byte_t c;
-            _is >> c;
-            bs.push_back(c);
-        }
-
-        s = string_type(bs.c_str());
-
-        break;
-    }}
+    default:
+        return make_error_code(json_errc::ubjson_parse);
+    }
 
     return pfs::error_code();
 }
@@ -233,17 +273,16 @@ pfs::error_code ubjson_istream<IStreamType, JsonType>::read_key (string_type & s
     if (ex)
         return ex;
 
-    byte_string bs;
-    byte_t c = 0;
-
-    while (n--) {
-        _is >> c;
-        bs.push_back(c);
-    }
+    if (!can_read(n, 1))
+        return make_error_code(json_errc::ubjson_parse);
 
-    s = string_type(bs.c_str());
+    // Read string content directly into destination by one read
+    // (string may contain NUL characters)
+    s.resize(static_cast<size_t>(n));
 
-    return pfs::error_code();
+    return n > 0
+            ? read_bytes(& s[0], static_cast<size_t>(n))
+            : pfs::error_code();
 }
 
 template <typename IStreamType, typename JsonType>
@@ -310,6 +349,9 @@ ubjson_istream<IStreamType, JsonType>::read_optimized_array (json_type & j
 {
     // Special cases: strongly-typed arrays of null, no-op and boolean values
 
+    if (count < 0)
+        return make_error_code(json_errc::ubjson_parse);
+
     // Ignore values
     if (type == UBJSON_CHAR_NOOP)
         return pfs::error_code();
@@ -329,6 +371,35 @@ ubjson_istream<IStreamType, JsonType>::read_optimized_array (json_type & j
         while (count-- > 0)
             j.push_back(json_type(false));
     } else {
+        switch (type) {
+        case UBJSON_CHAR_INT8:
+            return read_integer_array<int8_t>(j, count);
+        case UBJSON_CHAR_UINT8:
+            return read_integer_array<uint8_t>(j, count);
+        case UBJSON_CHAR_INT16:
+            return read_integer_array<int16_t>(j, count);
+        case UBJSON_CHAR_INT32:
+            return read_integer_array<int32_t>(j, count);
+#if PFS_HAVE_INT64
+        case UBJSON_CHAR_INT64:
+            return read_integer_array<int64_t>(j, count);
+#endif
+        case UBJSON_CHAR_REAL32:
+            return read_real_array<real32_t, int32_t>(j, count);
+#if PFS_HAVE_INT64
+        case UBJSON_CHAR_REAL64:
+            return read_real_array<real64_t, int64_t>(j, count);
+#endif
+        default:
+            break;
+        }
+
+        array_type a;
+
+        // Each value takes at least one byte
+        if (count > 0 && can_read(count, 1))
+            a.reserve(static_cast<size_t>(count));
+
         while (count-- > 0) {
             json_type child;
 
@@ -337,13 +408,104 @@ ubjson_istream<IStreamType, JsonType>::read_optimized_array (json_type & j
             if (ex)
                 return ex;
 
-            j.push_back(child);
+            a.push_back(json_type());
+            a.back().swap(child);
         }
+
+        assign_array(j, a);
     }
 
     return pfs::error_code();
 }
 
+/**
+ * @brief Reads payload of strongly-typed array of @a count numeric values
+ *        into contiguous buffer by one read and converts byte order of all
+ *        values at once.
+ */
+template <typename IStreamType, typename JsonType>
+template <typename T>
+pfs::error_code
+ubjson_istream<IStreamType, JsonType>::read_payload (std::vector<T> & buf
+        , integer_type count)
+{
+    if (!can_read(count, sizeof(T)))
+        return make_error_code(json_errc::ubjson_parse);
+
+    buf.resize(static_cast<size_t>(count));
+
+    if (count > 0) {
+        pfs::error_code ec = read_bytes(reinterpret_cast<char *>(& buf[0])
+                , buf.size() * sizeof(T));
+
+        if (ec)
+            return ec;
+
+        _order.convert(& buf[0], buf.size());
+    }
+
+    return pfs::error_code();
+}
+
+template <typename IStreamType, typename JsonType>
+template <typename T>
+pfs::error_code
+ubjson_istream<IStreamType, JsonType>::read_integer_array (json_type & j
+        , integer_type count)
+{
+    std::vector<T> buf;
+    pfs::error_code ec = read_payload(buf, count);
+
+    if (ec)
+        return ec;
+
+    array_type a;
+    a.reserve(buf.size());
+
+    for (size_t i = 0, n = buf.size(); i < n; ++i)
+        a.push_back(json_type(static_cast<integer_type>(buf[i])));
+
+    assign_array(j, a);
+    return pfs::error_code();
+}
+
+template <typename IStreamType, typename JsonType>
+template <typename RealT, typename T>
+pfs::error_code
+ubjson_istream<IStreamType, JsonType>::read_real_array (json_type & j
+        , integer_type count)
+{
+    std::vector<T> buf;
+    pfs::error_code ec = read_payload(buf, count);
+
+    if (ec)
+        return ec;
+
+    array_type a;
+    a.reserve(buf.size());
+
+    for (size_t i = 0, n = buf.size(); i < n; ++i) {
+        RealT f;
+        std::memcpy(& f, & buf[i], sizeof(f));
+        a.push_back(json_type(f));
+    }
+
+    assign_array(j, a);
+    return pfs::error_code();
+}
+
+template <typename IStreamType, typename JsonType>
+void ubjson_istream<IStreamType, JsonType>::assign_array (json_type & j
+        , array_type & a)
+{
+#if __cplusplus >= 201103L
+    json_type tmp(std::move(a));
+#else
+    json_type tmp(a);
+#endif
+    j.swap(tmp);
+}
+
 template <typename IStreamType, typename JsonType>
 pfs::error_code ubjson_istream<IStreamType, JsonType>::read_object (json_type & j)
 {
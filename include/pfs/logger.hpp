@@ -9,7 +9,16 @@
 #include <pfs/filesystem.hpp>
 #include <pfs/string.hpp>
 #include <pfs/list.hpp>
+#include <pfs/vector.hpp>
 #include <pfs/integral.hpp>
+#include <pfs/thread.hpp>
+#include <pfs/io/file.hpp>
+
+#if __cplusplus >= 201103L
+#   include <pfs/atomic.hpp>
+#   include <pfs/condition_variable.hpp>
+#   include <pfs/mpmc_queue.hpp>
+#endif
 
 namespace pfs {
 
@@ -86,7 +95,7 @@ public:
         _d->_priority = priority::trace;
     }
 
-    ~logger ()
+    virtual ~logger ()
     {
         typename appender_sequence::iterator it   = _d->_appenders.begin();
         typename appender_sequence::iterator last = _d->_appenders.end();
@@ -179,7 +188,7 @@ public:
 //#	error "Need to implement `add_appender` using variadic templates"
 //#endif
 
-    void print (priority level, datetime const & dt, string_type const & msg)
+    virtual void print (priority level, datetime const & dt, string_type const & msg)
     {
         if ( level.value >= _d->_priority && level.value != priority::no_priority )
             _d->_emitters[level](level, dt, msg);
@@ -290,6 +299,269 @@ public:
     }
 };
 
+#if __cplusplus >= 201103L
+
+struct overflow_policy
+{
+    enum type {
+          block        // Producer waits until writer frees space
+        , drop_newest  // New record is discarded
+        , drop_oldest  // Oldest queued record is discarded
+    };
+};
+
+/**
+ * @brief Logger that moves formatting and writing to a dedicated thread.
+ *
+ * @details Producers push (priority, datetime, message) records into
+ *          a bounded lock-free queue, writer thread pops them in batches
+ *          and emits them to the connected appenders.
+ *          Appenders are called from the writer thread only.
+ */
+class async_logger : public logger
+{
+    struct record
+    {
+        priority    level;
+        datetime    dt;
+        string_type msg;
+    };
+
+    typedef mpmc_queue<record> queue_type;
+
+    queue_type            _queue;
+    typename overflow_policy::type _policy;
+    size_t                _batch_size;
+    atomic<size_t>        _dropped;
+    atomic<size_t>        _processed;       // popped by writer or discarded as oldest
+    atomic<size_t>        _waiters;         // blocked producers and flush callers
+    atomic<bool>          _writer_waiting;
+    atomic<bool>          _quit;
+    atomic<bool>          _running;         // writer accepts records
+    mutex                 _mutex;
+    condition_variable    _writer_cond;
+    condition_variable    _waiters_cond;
+    thread                _writer;
+
+private:
+    void wake_writer ()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (_writer_waiting.load()) {
+            lock_guard<mutex> locker(_mutex);
+            _writer_cond.notify_one();
+        }
+    }
+
+    void wake_waiters ()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (_waiters.load() > 0) {
+            lock_guard<mutex> locker(_mutex);
+            _waiters_cond.notify_all();
+        }
+    }
+
+    void run ()
+    {
+        record r;
+
+        for (;;) {
+            size_t n = 0;
+
+            while (n < _batch_size && _queue.try_pop(r)) {
+                logger::print(r.level, r.dt, r.msg);
+                ++n;
+            }
+
+            if (n > 0) {
+                _processed += n;
+                wake_waiters();
+                continue;
+            }
+
+            // Slot is claimed by producer but not published yet
+            if (!_queue.empty()) {
+                this_thread::yield();
+                continue;
+            }
+
+            if (_quit.load())
+                break;
+
+            unique_lock<mutex> locker(_mutex);
+            _writer_waiting.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            while (_queue.empty() && !_quit.load())
+                _writer_cond.wait(locker);
+
+            _writer_waiting.store(false);
+        }
+    }
+
+    void push (record && r)
+    {
+        for (;;) {
+            if (_queue.try_push(std::move(r))) {
+                wake_writer();
+                return;
+            }
+
+            switch (_policy) {
+            case overflow_policy::drop_newest:
+                ++_dropped;
+                return;
+
+            case overflow_policy::drop_oldest: {
+                record oldest;
+
+                if (_queue.try_pop(oldest)) {
+                    ++_dropped;
+                    ++_processed;
+                    wake_waiters();
+                }
+                break;
+            }
+
+            case overflow_policy::block:
+            default: {
+                // Writer is stopping, nobody will free space
+                if (_quit.load()) {
+                    ++_dropped;
+                    return;
+                }
+
+                wake_writer();
+                unique_lock<mutex> locker(_mutex);
+                ++_waiters;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                while (_queue.size() >= _queue.capacity() && !_quit.load())
+                    _waiters_cond.wait(locker);
+
+                --_waiters;
+                break;
+            }
+            }
+        }
+    }
+
+public:
+    /**
+     * @param capacity Maximum number of records waiting for the writer
+     *        (rounded up to the power of two).
+     * @param policy Behaviour of producers when queue is full.
+     * @param batch_size Maximum number of records processed by writer
+     *        before it notifies producers waiting for free space or flush.
+     */
+    async_logger (size_t capacity = 8192
+            , typename overflow_policy::type policy = overflow_policy::block
+            , size_t batch_size = 256)
+        : logger()
+        , _queue(capacity)
+        , _policy(policy)
+        , _batch_size(batch_size > 0 ? batch_size : 1)
+        , _dropped(0)
+        , _processed(0)
+        , _waiters(0)
+        , _writer_waiting(false)
+        , _quit(false)
+        , _running(true)
+        , _writer(& async_logger::run, this)
+    {}
+
+    virtual ~async_logger ()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Pushes record into the queue.
+     *
+     * @details After stop() is called records are emitted synchronously.
+     *          Fatal records wait for writer to process all
+     *          preceding records (@c critical() aborts the process).
+     */
+    virtual void print (priority level, datetime const & dt, string_type const & msg) override
+    {
+        if (level.value < this->get_priority() || level.value == priority::no_priority)
+            return;
+
+        if (!_running.load()) {
+            logger::print(level, dt, msg);
+            return;
+        }
+
+        record r;
+        r.level = level;
+        r.dt    = dt;
+        r.msg   = msg;
+
+        push(std::move(r));
+
+        if (level.value >= priority::fatal)
+            flush();
+    }
+
+    /**
+     * @brief Blocks until all records pushed before the call are written.
+     */
+    void flush ()
+    {
+        if (!_running.load())
+            return;
+
+        size_t target = _queue.enqueued();
+
+        unique_lock<mutex> locker(_mutex);
+        ++_waiters;
+        _writer_cond.notify_one();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        while (_processed.load() < target && !_quit.load())
+            _waiters_cond.wait(locker);
+
+        --_waiters;
+    }
+
+    /**
+     * @brief Writes all queued records and stops the writer thread.
+     */
+    void stop ()
+    {
+        // Writer thread is joined here, so other threads check the flag only
+        if (!_running.exchange(false))
+            return;
+
+        {
+            lock_guard<mutex> locker(_mutex);
+            _quit.store(true);
+            _writer_cond.notify_one();
+            _waiters_cond.notify_all();
+        }
+
+        _writer.join();
+    }
+
+    /**
+     * @return Number of records discarded due to queue overflow.
+     */
+    size_t dropped () const
+    {
+        return _dropped.load();
+    }
+
+    typename overflow_policy::type policy () const
+    {
+        return _policy;
+    }
+};
+
+#endif
+
 class appender : public sigslot_ns::has_slots
 {
     friend class logger;
@@ -297,18 +569,81 @@ class appender : public sigslot_ns::has_slots
 public:
     typedef pfs::string string_type;
 
+protected:
+    typedef typename sigslot_ns::mutex_type mutex_type;
+
+    /**
+     * Date format pre-parsed into a sequence of fields.
+     * Field with `spec` equal to '\0' is a literal run stored in `text`.
+     */
+    struct date_field
+    {
+        char        spec;
+        string_type text;
+    };
+
+    struct date_format
+    {
+        pfs::vector<date_field> fields;
+        bool                    fallback; // format contains specifiers not supported by compiler
+        string_type             fspec;    // source format (used if fallback)
+    };
+
+    /**
+     * Pattern compiled into a flat sequence of formatting operations.
+     */
+    struct pattern_op
+    {
+        enum type {
+              literal_op
+            , message_op
+            , priority_op
+            , date_op
+        };
+
+        type        kind;
+        bool        left_justify;
+        size_t      min_width;
+        size_t      max_width;
+        string_type text;   // literal run (literal_op)
+        date_format dfmt;   // pre-parsed date format (date_op)
+    };
+
+    typedef pfs::vector<pattern_op> pattern_op_sequence;
+
 protected:
     string_type _pattern;
     string_type _priority_text[static_cast<size_t>(priority::count) - 1]; // excluding no_priority
 
+    pattern_op_sequence _ops;
+    bool                _pattern_valid;
+    string_type         _buffer;       // reusable output buffer
+    mutex_type          _buffer_mutex;
+
 protected:
     virtual void print (priority level, datetime const & dt, string_type const & msg) = 0;
 
     void print_helper (priority level, datetime const & dt, string_type const & msg)
     {
-        print(level, dt, _pattern.empty()
-                ? msg
-                : patternify(this, level, dt, _pattern, msg));
+        // Empty pattern or pattern equivalent to "%m"
+        if (_ops.empty() || is_message_only()) {
+            print(level, dt, msg);
+            return;
+        }
+
+        lock_guard<mutex_type> locker(_buffer_mutex);
+        _buffer.clear();
+        render(level, dt, msg, _buffer);
+        print(level, dt, _buffer);
+    }
+
+    bool is_message_only () const
+    {
+        return _pattern_valid
+                && _ops.size() == 1
+                && _ops[0].kind == pattern_op::message_op
+                && _ops[0].min_width == 0
+                && _ops[0].max_width == 0;
     }
 
     void init ()
@@ -319,6 +654,7 @@ protected:
         set_priority_text(priority::warn , "W");
         set_priority_text(priority::error, "E");
         set_priority_text(priority::fatal, "F");
+        compile_pattern();
     }
 
     /**
@@ -366,12 +702,13 @@ protected:
 
         struct parse_context
         {
-            appender *          appender_ptr;
-            priority            level;
-            datetime            dt;
-            string_type         result;
-            string_type const * msg_ptr;
-            specifier           spec;
+            appender *            appender_ptr;
+            priority              level;
+            datetime              dt;
+            string_type           result;
+            string_type const *   msg_ptr;
+            specifier             spec;
+            pattern_op_sequence * ops_ptr; // not null if pattern is compiling
         };
 
         pattern_grammar ();
@@ -393,6 +730,12 @@ protected:
         {
             if (context) {
                 parse_context * ctx = static_cast<parse_context *>(context);
+
+                if (ctx->ops_ptr) {
+                    compile_spec(*ctx->ops_ptr, ctx->spec);
+                    return true;
+                }
+
                 string_type result;
 
                 switch (to_ascii(ctx->spec.spec_char)) {
@@ -458,7 +801,11 @@ protected:
         {
             if (context) {
                 parse_context * ctx = static_cast<parse_context *>(context);
-                ctx->result.append(string_type(first, last));
+
+                if (ctx->ops_ptr)
+                    append_literal(*ctx->ops_ptr, string_type(first, last), 0, 0, false);
+                else
+                    ctx->result.append(string_type(first, last));
             }
             return true;
         }
@@ -545,6 +892,7 @@ protected:
         context.level        = level;
         context.msg_ptr      = & text;
         context.dt           = dt;
+        context.ops_ptr      = 0;
 
         fsm_type fsm(grammar.p_pattern_tr, & context);
         typename fsm_type::result_type r = fsm.exec(0, pattern.cbegin(), pattern.cend());
@@ -557,6 +905,302 @@ protected:
         return broken_msg;
     }
 
+    static void append_literal (pattern_op_sequence & ops
+        , string_type const & text
+        , size_t min_width
+        , size_t max_width
+        , bool left_justify)
+    {
+        // Merge adjacent literal runs without format modifiers
+        if (min_width == 0 && max_width == 0
+                && !ops.empty()
+                && ops.back().kind == pattern_op::literal_op
+                && ops.back().min_width == 0
+                && ops.back().max_width == 0) {
+            ops.back().text.append(text);
+            return;
+        }
+
+        ops.push_back(pattern_op());
+        pattern_op & op = ops.back();
+        op.kind         = pattern_op::literal_op;
+        op.left_justify = left_justify;
+        op.min_width    = min_width;
+        op.max_width    = max_width;
+        op.text         = text;
+        op.dfmt.fallback = false;
+    }
+
+    static void compile_spec (pattern_op_sequence & ops
+        , typename pattern_grammar::specifier const & spec)
+    {
+        typename pattern_op::type kind;
+
+        switch (to_ascii(spec.spec_char)) {
+        case 'n':
+            append_literal(ops, string_type(1, '\n'), spec.min_width, spec.max_width, spec.left_justify);
+            return;
+        case 't':
+            append_literal(ops, string_type(1, '\t'), spec.min_width, spec.max_width, spec.left_justify);
+            return;
+        case 'p':
+            kind = pattern_op::priority_op;
+            break;
+        case 'm':
+            kind = pattern_op::message_op;
+            break;
+        case 'd':
+            kind = pattern_op::date_op;
+            break;
+        default:
+            return;
+        }
+
+        ops.push_back(pattern_op());
+        pattern_op & op = ops.back();
+        op.kind         = kind;
+        op.left_justify = spec.left_justify;
+        op.min_width    = spec.min_width;
+        op.max_width    = spec.max_width;
+        op.dfmt.fallback = false;
+
+        if (kind == pattern_op::date_op)
+            compile_date_format(op.dfmt, spec.fspec);
+    }
+
+    /**
+     * Pre-parses date format specifier into fields.
+     * Specifiers that are not supported here (and double percent sign,
+     * that has special meaning for chained date/time conversions)
+     * force fallback to pfs::to_string(datetime, format).
+     */
+    static void compile_date_format (date_format & dfmt, string_type const & fspec)
+    {
+        if (fspec == "ABSOLUTE")
+            dfmt.fspec = "%H:%M:%S.%Q";
+        else if (fspec == "DATE")
+            dfmt.fspec = "%d %b %Y %H:%M:%S.%Q";
+        else if (fspec == "ISO8601")
+            dfmt.fspec = "%Y-%m-%d %H:%M:%S.%Q";
+        else
+            dfmt.fspec = fspec;
+
+        dfmt.fallback = false;
+        dfmt.fields.clear();
+
+        typename string_type::const_iterator p   = dfmt.fspec.cbegin();
+        typename string_type::const_iterator end = dfmt.fspec.cend();
+
+        while (p != end) {
+            if (*p != '%') {
+                if (dfmt.fields.empty() || dfmt.fields.back().spec != '\0') {
+                    dfmt.fields.push_back(date_field());
+                    dfmt.fields.back().spec = '\0';
+                }
+
+                dfmt.fields.back().text.push_back(*p);
+                ++p;
+                continue;
+            }
+
+            ++p;
+
+            if (p == end) {
+                dfmt.fallback = true;
+                return;
+            }
+
+            char c = *p;
+
+            switch (c) {
+            case 'n':
+            case 't':
+            case 'C': case 'd': case 'e': case 'F': case 'j':
+            case 'm': case 'b': case 'h': case 'y': case 'Y':
+            case 'H': case 'I': case 'k': case 'l': case 'M':
+            case 'q': case 'Q': case 'S': case 'R': case 'T':
+                dfmt.fields.push_back(date_field());
+                dfmt.fields.back().spec = c;
+                break;
+
+            default:
+                dfmt.fallback = true;
+                return;
+            }
+
+            ++p;
+        }
+    }
+
+    /**
+     * Appends non-negative integer @a n to @a s left padded
+     * with @a fill_char up to @a width characters.
+     */
+    static void append_number (string_type & s, char fill_char, int width, int n)
+    {
+        char buf[16];
+        int i = sizeof(buf);
+
+        do {
+            buf[--i] = '0' + n % 10;
+            n /= 10;
+        } while (n > 0);
+
+        for (int len = sizeof(buf) - i; len < width; ++len)
+            s.push_back(fill_char);
+
+        s.append(buf + i, sizeof(buf) - i);
+    }
+
+    static void render_date (date_format const & dfmt
+        , datetime const & dt
+        , string_type & out)
+    {
+        date d = dt.get_date();
+        time t = dt.get_time();
+        int year = 0, month = 0, day = 0;
+
+        if (!dfmt.fallback && d.valid() && t.valid())
+            date::from_julian_day(d.julian_day(), & year, & month, & day);
+
+        if (dfmt.fallback || !d.valid() || !t.valid() || year < 0 || year > 9999) {
+            out.append(pfs::to_string(dt, dfmt.fspec));
+            return;
+        }
+
+        typename pfs::vector<date_field>::const_iterator it   = dfmt.fields.cbegin();
+        typename pfs::vector<date_field>::const_iterator last = dfmt.fields.cend();
+
+        for (; it != last; ++it) {
+            switch (it->spec) {
+            case '\0': out.append(it->text); break;
+            case 'n': out.push_back('\n'); break;
+            case 't': out.push_back('\t'); break;
+            case 'C': append_number(out, '0', 2, year / 100); break;
+            case 'd': append_number(out, '0', 2, day); break;
+            case 'e': append_number(out, ' ', 2, day); break;
+            case 'F':
+                append_number(out, '0', 4, year);
+                out.push_back('-');
+                append_number(out, '0', 2, month);
+                out.push_back('-');
+                append_number(out, '0', 2, day);
+                break;
+            case 'j': append_number(out, '0', 3, d.day_of_year()); break;
+            case 'm': append_number(out, '0', 2, month); break;
+            case 'b':
+            case 'h': out.append(date::month_abbrev(month)); break;
+            case 'y': append_number(out, '0', 2, year % 100); break;
+            case 'Y': append_number(out, '0', 4, year); break;
+            case 'H': append_number(out, '0', 2, t.hour()); break;
+            case 'I': append_number(out, '0', 2, t.hour() % 12); break;
+            case 'k': append_number(out, ' ', 2, t.hour()); break;
+            case 'l': append_number(out, ' ', 2, t.hour() % 12); break;
+            case 'M': append_number(out, '0', 2, t.minute()); break;
+            case 'q': append_number(out, '0', 0, t.millis()); break;
+            case 'Q': append_number(out, '0', 3, t.millis()); break;
+            case 'S': append_number(out, '0', 2, t.second()); break;
+            case 'R':
+                append_number(out, '0', 2, t.hour());
+                out.push_back(':');
+                append_number(out, '0', 2, t.minute());
+                break;
+            case 'T':
+                append_number(out, '0', 2, t.hour());
+                out.push_back(':');
+                append_number(out, '0', 2, t.minute());
+                out.push_back(':');
+                append_number(out, '0', 2, t.second());
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    /**
+     * Compiles pattern into sequence of formatting operations.
+     */
+    void compile_pattern ()
+    {
+        typedef typename pattern_grammar::fsm_type fsm_type;
+
+        _ops.clear();
+        _pattern_valid = true;
+
+        if (_pattern.empty())
+            return;
+
+        static pattern_grammar grammar;
+        typename pattern_grammar::parse_context context;
+        context.appender_ptr = this;
+        context.msg_ptr      = 0;
+        context.ops_ptr      = & _ops;
+
+        fsm_type fsm(grammar.p_pattern_tr, & context);
+        typename fsm_type::result_type r = fsm.exec(0, _pattern.cbegin(), _pattern.cend());
+
+        if (!r.first) {
+            _ops.clear();
+            _pattern_valid = false;
+            // Keep non-empty sequence to route output through render()
+            append_literal(_ops, string_type(), 0, 0, false);
+        }
+    }
+
+    /**
+     * Runs compiled pattern appending result to @a out.
+     */
+    void render (priority level
+        , datetime const & dt
+        , string_type const & msg
+        , string_type & out) const
+    {
+        if (!_pattern_valid) {
+            out.append("[<!INVALID PATTERN!>]: ");
+            out.append(msg);
+            return;
+        }
+
+        typename pattern_op_sequence::const_iterator it   = _ops.cbegin();
+        typename pattern_op_sequence::const_iterator last = _ops.cend();
+
+        for (; it != last; ++it) {
+            size_t start = out.size();
+
+            switch (it->kind) {
+            case pattern_op::literal_op:
+                out.append(it->text);
+                break;
+            case pattern_op::message_op:
+                out.append(msg);
+                break;
+            case pattern_op::priority_op:
+                out.append(_priority_text[level]);
+                break;
+            case pattern_op::date_op:
+                render_date(it->dfmt, dt, out);
+                break;
+            }
+
+            size_t len = out.size() - start;
+
+            /* truncate */
+            if (it->max_width > 0 && len > it->max_width) {
+                out.erase(start + it->max_width);
+                len = it->max_width;
+            }
+
+            /* pad */
+            if (it->min_width > 0 && len < it->min_width) {
+                if (it->left_justify)
+                    out.append(it->min_width - len, ' ');
+                else
+                    out.insert(start, it->min_width - len, ' ');
+            }
+        }
+    }
+
 public:
     appender ()
         : _pattern ( "%m" )
@@ -583,6 +1227,7 @@ public:
     void set_pattern ( string_type const & pattern )
     {
         _pattern = pattern;
+        compile_pattern();
     }
 
     string_type priority_text (priority pri) const
@@ -659,6 +1304,276 @@ protected:
     }
 };
 
+struct rotation_params
+{
+    size_t max_size;     // Roll over when segment exceeds size in bytes (0 - disabled)
+    int    interval;     // Roll over at multiples of interval in seconds since epoch (0 - disabled)
+    int    max_backups;  // Number of rolled over segments to keep
+    size_t buffer_size;  // Capacity of buffer to coalesce messages
+    bool   compress;     // Compress rolled over segments in background (requires zlib)
+    bool   sync;         // Synchronize file with storage device after each write
+
+    rotation_params ()
+        : max_size(0)
+        , interval(0)
+        , max_backups(5)
+        , buffer_size(64 * 1024)
+        , compress(false)
+        , sync(false)
+    {}
+};
+
+/**
+ * @brief File appender with buffering and size/time based rollover.
+ *
+ * @details Messages are coalesced into buffer that is written to the file
+ *          when full (together with the message that did not fit, using
+ *          single gather write), on rollover, on flush() and on destruction.
+ *          Rolled over segments are named `<path>.1` (the newest) ...
+ *          `<path>.<max_backups>` (the oldest), with `.gz` suffix if compressed.
+ */
+class rotating_file_appender : public appender
+{
+    typedef typename appender::mutex_type mutex_type;
+
+    filesystem::path _path;
+    rotation_params  _params;
+    io::device_ptr   _d;
+    string_type      _buffer;
+    size_t           _size;          // Size of current segment (written and buffered)
+    intmax_t         _next_rollover; // Seconds since epoch
+    error_code       _ec;
+    mutex_type       _mutex;
+    thread           _compressor;
+
+private:
+    filesystem::path backup_path (int index, bool compressed = false) const
+    {
+        std::string s(_path.native());
+        s.push_back('.');
+        s.append(pfs::to_string(index));
+
+        if (compressed)
+            s.append(".gz");
+
+        return filesystem::path(s);
+    }
+
+    intmax_t next_rollover (intmax_t secs) const
+    {
+        return (secs / _params.interval + 1) * _params.interval;
+    }
+
+    void open (bool truncate)
+    {
+        io::open_mode_flags oflags = io::write_only | io::append;
+
+        if (truncate)
+            oflags |= io::truncate;
+
+        _d = io::open_device(io::open_params<io::file>(_path, oflags), _ec);
+        _size = 0;
+
+        if (_d) {
+            ssize_t n = _d->available();
+            _size = n > 0 ? size_t(n) : 0;
+        }
+    }
+
+    void write_all (io::const_buffer * bufs, size_t count)
+    {
+        while (count > 0) {
+            error_code ec;
+            ssize_t n = _d->write_v(bufs, count, ec);
+
+            if (n <= 0) {
+                _ec = ec ? ec : pfs::make_error_code(errc::io_error);
+                return;
+            }
+
+            size_t k = size_t(n);
+
+            while (count > 0 && k >= bufs->size) {
+                k -= bufs->size;
+                ++bufs;
+                --count;
+            }
+
+            if (count > 0) {
+                bufs->data += k;
+                bufs->size -= k;
+            }
+        }
+
+        if (_params.sync)
+            _d->flush();
+    }
+
+    void flush_buffer ()
+    {
+        if (_buffer.empty() || !is_open())
+            return;
+
+        io::const_buffer buf(_buffer.data(), _buffer.size());
+        write_all(& buf, 1);
+        _buffer.clear();
+    }
+
+    static void compress_segment (filesystem::path src, filesystem::path dest)
+    {
+#if HAVE_ZLIB
+        error_code ec = io::gzip(src, dest);
+
+        if (!ec)
+            filesystem::remove(src, ec);
+        else
+            filesystem::remove(dest, ec);
+#else
+        (void)src;
+        (void)dest;
+#endif
+    }
+
+    void rotate_helper ()
+    {
+        error_code ec;
+
+        flush_buffer();
+
+        if (_d) {
+            _d->close();
+            _d.reset();
+        }
+
+        // Wait for compression of previous segment
+        if (_compressor.joinable())
+            _compressor.join();
+
+        if (_params.max_backups > 0) {
+            filesystem::remove(backup_path(_params.max_backups), ec);
+            filesystem::remove(backup_path(_params.max_backups, true), ec);
+
+            for (int i = _params.max_backups - 1; i > 0; --i) {
+                if (filesystem::exists(backup_path(i), ec))
+                    filesystem::rename(backup_path(i), backup_path(i + 1), ec);
+
+                if (filesystem::exists(backup_path(i, true), ec))
+                    filesystem::rename(backup_path(i, true), backup_path(i + 1, true), ec);
+            }
+
+            filesystem::rename(_path, backup_path(1), ec);
+        } else {
+            filesystem::remove(_path, ec);
+        }
+
+        open(true);
+
+#if HAVE_ZLIB
+        if (_params.compress && _params.max_backups > 0) {
+#   if __cplusplus >= 201103L
+            _compressor = thread(compress_segment, backup_path(1), backup_path(1, true));
+#   else
+            // pfs::thread is not movable in C++98, compress in place
+            compress_segment(backup_path(1), backup_path(1, true));
+#   endif
+        }
+#endif
+    }
+
+public:
+    rotating_file_appender (filesystem::path const & path
+            , rotation_params const & params = rotation_params())
+        : appender()
+        , _path(path)
+        , _params(params)
+        , _size(0)
+        , _next_rollover(0)
+    {
+        _buffer.reserve(_params.buffer_size);
+        open(false);
+
+        if (_params.interval > 0)
+            _next_rollover = next_rollover(current_datetime().millis_since_epoch() / 1000);
+    }
+
+    virtual ~rotating_file_appender ()
+    {
+        flush();
+
+        if (_compressor.joinable())
+            _compressor.join();
+    }
+
+    virtual bool is_open () const
+    {
+        return _d && _d->opened();
+    }
+
+    /**
+     * @return Last I/O error.
+     */
+    error_code last_error () const
+    {
+        return _ec;
+    }
+
+    /**
+     * @brief Writes buffered messages to the file.
+     */
+    void flush ()
+    {
+        lock_guard<mutex_type> locker(_mutex);
+        flush_buffer();
+    }
+
+    /**
+     * @brief Forces rollover of the current segment.
+     */
+    void rotate ()
+    {
+        lock_guard<mutex_type> locker(_mutex);
+        rotate_helper();
+    }
+
+protected:
+    virtual void print (priority, datetime const & dt, string_type const & msg) override
+    {
+        lock_guard<mutex_type> locker(_mutex);
+
+        if (_params.interval > 0) {
+            intmax_t secs = dt.millis_since_epoch() / 1000;
+
+            if (secs >= _next_rollover) {
+                rotate_helper();
+                _next_rollover = next_rollover(secs);
+            }
+        }
+
+        size_t n = msg.size() + 1;
+
+        if (_params.max_size > 0 && _size > 0 && _size + n > _params.max_size)
+            rotate_helper();
+
+        if (!is_open())
+            return;
+
+        if (_buffer.size() + n > _params.buffer_size) {
+            // Gather buffered messages and current message into single write
+            io::const_buffer bufs[3];
+            bufs[0] = io::const_buffer(_buffer.data(), _buffer.size());
+            bufs[1] = io::const_buffer(msg.data(), msg.size());
+            bufs[2] = io::const_buffer("\n", 1);
+            write_all(bufs, 3);
+            _buffer.clear();
+        } else {
+            _buffer.append(msg);
+            _buffer.push_back('\n');
+        }
+
+        _size += n;
+    }
+};
+
 }; // log
 
 template <PFS_LOG_TEMPLETE_SIGNATURE>
@@ -752,6 +1667,8 @@ log<PFS_LOG_TEMPLETE_ARGS>::appender::pattern_grammar::pattern_grammar ()
     };
 
     p_pattern_tr = pattern_tr;
+
+    fsm_type::compile(pattern_tr);
 }
 
 } // pfs
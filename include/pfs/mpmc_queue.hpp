@@ -0,0 +1,184 @@
+#pragma once
+#include <pfs/types.hpp>
+#include <pfs/atomic.hpp>
+#include <pfs/utility.hpp>
+#include <pfs/noncopyable.hpp>
+
+#if __cplusplus < 201103L
+#   error "pfs::mpmc_queue requires C++11"
+#endif
+
+#ifndef PFS_CACHE_LINE_SIZE
+#   define PFS_CACHE_LINE_SIZE 64
+#endif
+
+namespace pfs {
+
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer queue.
+ *
+ * @details Ring of slots, each slot carries a sequence number
+ *          that tells producers and consumers whether the slot
+ *          is ready to be written or read (see Dmitry Vyukov's
+ *          "Bounded MPMC queue").
+ *          Capacity is rounded up to the power of two.
+ *          Each slot is padded to the cache line size to avoid
+ *          false sharing between neighbouring producers/consumers.
+ */
+template <typename T>
+class mpmc_queue : noncopyable
+{
+public:
+    typedef T      value_type;
+    typedef size_t size_type;
+
+private:
+    struct slot_base
+    {
+        atomic<size_type> seq;
+        value_type        value;
+    };
+
+    struct slot : slot_base
+    {
+        char pad[PFS_CACHE_LINE_SIZE - sizeof(slot_base) % PFS_CACHE_LINE_SIZE];
+    };
+
+    typedef char cache_line_pad[PFS_CACHE_LINE_SIZE];
+
+    cache_line_pad    _pad0;
+    slot *            _buffer;
+    size_type         _mask;
+    cache_line_pad    _pad1;
+    atomic<size_type> _enqueue_pos;
+    cache_line_pad    _pad2;
+    atomic<size_type> _dequeue_pos;
+    cache_line_pad    _pad3;
+
+private:
+    static size_type round_capacity (size_type n)
+    {
+        size_type r = 2;
+
+        while (r < n)
+            r <<= 1;
+
+        return r;
+    }
+
+    template <typename U>
+    bool push_helper (U && v)
+    {
+        slot * s = 0;
+        size_type pos = _enqueue_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            s = & _buffer[pos & _mask];
+            size_type seq = s->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        s->value = std::forward<U>(v);
+        s->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+public:
+    explicit mpmc_queue (size_type capacity)
+        : _buffer(0)
+        , _mask(round_capacity(capacity) - 1)
+        , _enqueue_pos(0)
+        , _dequeue_pos(0)
+    {
+        _buffer = new slot[_mask + 1];
+
+        for (size_type i = 0; i <= _mask; ++i)
+            _buffer[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    ~mpmc_queue ()
+    {
+        delete [] _buffer;
+    }
+
+    size_type capacity () const
+    {
+        return _mask + 1;
+    }
+
+    /**
+     * @return Approximate number of elements in the queue.
+     */
+    size_type size () const
+    {
+        size_type enq = _enqueue_pos.load(std::memory_order_relaxed);
+        size_type deq = _dequeue_pos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    bool empty () const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @return Number of elements pushed into the queue since construction.
+     */
+    size_type enqueued () const
+    {
+        return _enqueue_pos.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return @c false if queue is full.
+     */
+    bool try_push (value_type const & v)
+    {
+        return push_helper(v);
+    }
+
+    bool try_push (value_type && v)
+    {
+        return push_helper(std::move(v));
+    }
+
+    /**
+     * @return @c false if queue is empty.
+     */
+    bool try_pop (value_type & v)
+    {
+        slot * s = 0;
+        size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            s = & _buffer[pos & _mask];
+            size_type seq = s->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        v = std::move(s->value);
+        s->value = value_type();
+        s->seq.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+} // pfs
@@ -890,6 +890,9 @@ uri_grammar<StringT>::uri_grammar ()
 #endif
     p_uri_tr           = uri_tr;
     p_uri_reference_tr = uri_reference_tr;
+
+    fsm_type::compile(uri_tr);
+    fsm_type::compile(uri_reference_tr);
 }
 
 /**
@@ -1,6 +1,8 @@
 #pragma once
 #include <poll.h>
 #include <cerrno>
+#include <algorithm>
+#include <unistd.h>
 #include <pfs/limits.hpp>
 #include <pfs/mutex.hpp>
 #include <pfs/memory.hpp>
@@ -20,6 +22,15 @@
 
 #define WR_EVENTS_XOR_MASK (POLLOUT | WR_EVENTS_XOR_MASK_XPG42)
 
+// epoll(7) backend is used by default on Linux,
+// define PFS_NO_EPOLL to use portable poll(2) backend.
+#if defined(__linux__) && !defined(PFS_NO_EPOLL)
+#   include <sys/epoll.h>
+#   define PFS_HAVE_EPOLL 1
+#else
+#   define PFS_HAVE_EPOLL 0
+#endif
+
 #if __COMMENT__
 
 |           |           |           |           |
@@ -64,6 +75,8 @@ class device_notifier_pool
     typedef ContigousContainer<pollfd_type>      pollfd_vec_type;
     typedef ContigousContainer<ssize_t>          index_vec_type;
     typedef ContigousContainer<basic_device_ptr> device_vec_type;
+    typedef pfs::pair<basic_device_ptr, short>   modification_type;
+    typedef ContigousContainer<modification_type> modification_vec_type;
 
     class pollfd_map
     {
@@ -72,6 +85,10 @@ class device_notifier_pool
         device_vec_type _devices;
         index_vec_type  _pollfds_indices;
         device_vec_type _deferred_devices; // candidates for insertion before the next iteration of poll
+        short           _deferred_events;
+        modification_vec_type _deferred_modifications; // applied before the next iteration of poll
+
+        pollfd_map () : _deferred_events(notify_all) {}
 
         class revents_iterator
         {
@@ -174,8 +191,6 @@ class device_notifier_pool
 
         typedef pfs::pair<revents_iterator, revents_iterator> poll_result_type;
 
-        pollfd_map () {}
-
         ~pollfd_map () {}
 
         revents_iterator revents_begin ()
@@ -195,20 +210,30 @@ class device_notifier_pool
             _deferred_devices.push_back(pfs::static_pointer_cast<basic_device>(d));
         }
 
-        void insert (basic_device_ptr const & d, short notify_events)
+        void modify_deferred (basic_device_ptr const & d, short notify_events)
+        {
+            _deferred_modifications.push_back(modification_type(d, notify_events));
+        }
+
+        static short poll_events (short notify_events)
         {
-            short poll_events = 0;
+            short events = 0;
 
             // FIXME Allow if Linux version match
             // (since Linux 2.6.17)
-            //poll_events |= POLLRDHUP;
+            //events |= POLLRDHUP;
 
             if (notify_events & notify_read)
-                poll_events |= POLLIN;
+                events |= POLLIN;
 
             if (notify_events & notify_write)
-                poll_events |= POLLOUT;
+                events |= POLLOUT;
+
+            return events;
+        }
 
+        void insert (basic_device_ptr const & d, short notify_events)
+        {
             ssize_t index = -1;
 
             if (! _pollfds_indices.empty()) {
@@ -222,10 +247,18 @@ class device_notifier_pool
             }
 
             _pollfds[index].fd = d->native_handle();
-            _pollfds[index].events = poll_events;
+            _pollfds[index].events = poll_events(notify_events);
             _devices[index] = d;
         }
 
+        void modify (basic_device_ptr const & d, short notify_events)
+        {
+            ssize_t index = find(d);
+
+            if (index >= 0)
+                _pollfds[index].events = poll_events(notify_events);
+        }
+
         poll_result_type poll (int millis, error_code & ec)
         {
             // Insert deferred devices
@@ -234,13 +267,27 @@ class device_notifier_pool
                 typename device_vec_type::iterator last = _deferred_devices.end();
 
                 while (first != last) {
-                    insert(*first, notify_all);
+                    insert(*first, _deferred_events);
                     ++first;
                 }
 
                 _deferred_devices.clear();
             }
 
+            // Apply deferred modifications (after insertion, modified device
+            // may be among just inserted)
+            if (_deferred_modifications.size() > 0) {
+                typename modification_vec_type::iterator first = _deferred_modifications.begin();
+                typename modification_vec_type::iterator last = _deferred_modifications.end();
+
+                while (first != last) {
+                    modify(first->first, first->second);
+                    ++first;
+                }
+
+                _deferred_modifications.clear();
+            }
+
             size_t n = _pollfds.size();
             pollfd_type * pfds = _pollfds.data();
 
@@ -303,13 +350,414 @@ class device_notifier_pool
         }
     };
 
+
+#if PFS_HAVE_EPOLL
+    // epoll(7) based implementation with the same interface as pollfd_map.
+    // Cost of poll() is proportional to the number of ready devices
+    // instead of total number of devices.
+    //
+    // EPOLLIN, EPOLLPRI, EPOLLOUT, EPOLLERR and EPOLLHUP have the same values
+    // as corresponding poll(2) events, so event handlers receive
+    // poll-compatible events.
+    //
+    // Regular files (and some character devices) can not be added into epoll
+    // set (EPERM), they are considered always ready as poll(2) does.
+    class epoll_map
+    {
+    public:
+        typedef struct ::epoll_event        epoll_event_type;
+        typedef ContigousContainer<epoll_event_type> event_vec_type;
+
+        static int const MAX_EVENTS = 1024;
+
+        int             _epfd;
+        bool            _edge_triggered;
+        device_vec_type _devices;
+        index_vec_type  _events;         // Requested events indexed by slot
+        index_vec_type  _fds;            // File descriptors indexed by slot
+        index_vec_type  _free_indices;
+        index_vec_type  _fd_indices;     // Slot indexed by file descriptor
+        index_vec_type  _always_ready;   // Slots of devices not supported by epoll
+        event_vec_type  _ready;          // Result of the last poll
+        size_t          _ready_count;
+        device_vec_type _deferred_devices;
+        short           _deferred_events;
+        modification_vec_type _deferred_modifications;
+
+        class revents_iterator
+        {
+        public:
+            epoll_map * map;
+            size_t      index;
+
+            revents_iterator (epoll_map * m, size_t i)
+                : map(m)
+                , index(i)
+            {}
+
+            void set_begin ()
+            {
+                while (index < map->_ready_count && !valid())
+                    ++index;
+            }
+
+            bool valid () const
+            {
+                return map->_devices[map->_ready[index].data.u64] ? true : false;
+            }
+
+            size_t slot () const
+            {
+                return static_cast<size_t>(map->_ready[index].data.u64);
+            }
+
+            bool is_server () const
+            {
+                return map->_devices[slot()]->is_server();
+            }
+
+            basic_device const * basic_device_ptr () const
+            {
+                return map->_devices[slot()].get();
+            }
+
+            short operator * () const
+            {
+                // Device may be erased by the handler of the previous event
+                return valid()
+                        ? static_cast<short>(map->_ready[index].events & 0xFFFF)
+                        : 0;
+            }
+
+            device_ptr device () const
+            {
+                PFS_ASSERT(!map->_devices[slot()]->is_server());
+                return pfs::static_pointer_cast<details::device>(map->_devices[slot()]);
+            }
+
+            server_ptr server () const
+            {
+                PFS_ASSERT(map->_devices[slot()]->is_server());
+                return pfs::static_pointer_cast<details::server>(map->_devices[slot()]);
+            }
+
+            revents_iterator & operator ++ ()
+            {
+                if (index < map->_ready_count)
+                    ++index;
+
+                set_begin();
+                return *this;
+            }
+
+            revents_iterator operator ++ (int)
+            {
+                revents_iterator r = *this;
+                ++(*this);
+                return r;
+            }
+
+            bool operator == (revents_iterator const & rhs) const
+            {
+                return index == rhs.index;
+            }
+
+            bool operator != (revents_iterator const & rhs) const
+            {
+                return index != rhs.index;
+            }
+        };
+
+        typedef pfs::pair<revents_iterator, revents_iterator> poll_result_type;
+
+        epoll_map ()
+            : _epfd(::epoll_create1(EPOLL_CLOEXEC))
+            , _edge_triggered(false)
+            , _ready_count(0)
+            , _deferred_events(notify_all)
+        {
+            PFS_ASSERT(_epfd >= 0);
+            _ready.resize(MAX_EVENTS);
+        }
+
+        ~epoll_map ()
+        {
+            if (_epfd >= 0)
+                ::close(_epfd);
+        }
+
+        revents_iterator revents_begin ()
+        {
+            revents_iterator it(this, 0);
+            it.set_begin();
+            return it;
+        }
+
+        revents_iterator revents_end ()
+        {
+            return revents_iterator(this, _ready_count);
+        }
+
+        void insert_deferred (device_ptr const & d)
+        {
+            _deferred_devices.push_back(pfs::static_pointer_cast<basic_device>(d));
+        }
+
+        void modify_deferred (basic_device_ptr const & d, short notify_events)
+        {
+            _deferred_modifications.push_back(modification_type(d, notify_events));
+        }
+
+        uint32_t epoll_events (short notify_events) const
+        {
+            uint32_t events = 0;
+
+            if (notify_events & notify_read)
+                events |= EPOLLIN | EPOLLPRI;
+
+            if (notify_events & notify_write)
+                events |= EPOLLOUT;
+
+            if (_edge_triggered)
+                events |= EPOLLET;
+
+            return events;
+        }
+
+        void insert (basic_device_ptr const & d, short notify_events)
+        {
+            int fd = d->native_handle();
+
+            if (fd < 0)
+                return;
+
+            // File descriptor may be reused after device was closed
+            // without erasing
+            ssize_t stale = find(fd);
+
+            if (stale >= 0)
+                clear(pfs::integral_cast_check<size_t>(stale));
+
+            ssize_t index = -1;
+
+            if (! _free_indices.empty()) {
+                index = _free_indices.back();
+                _free_indices.pop_back();
+            } else {
+                _devices.push_back(basic_device_ptr());
+                _events.push_back(0);
+                _fds.push_back(-1);
+                index = _devices.size() - 1;
+            }
+
+            if (static_cast<size_t>(fd) >= _fd_indices.size())
+                _fd_indices.resize(fd + 1, -1);
+
+            _devices[index] = d;
+            _events[index] = epoll_events(notify_events);
+            _fds[index] = fd;
+            _fd_indices[fd] = index;
+
+            epoll_event_type ev;
+            ev.events = static_cast<uint32_t>(_events[index]);
+            ev.data.u64 = static_cast<uint64_t>(index);
+
+            if (::epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, & ev) < 0) {
+                if (errno == EPERM)
+                    _always_ready.push_back(index);
+                else if (errno == EEXIST)
+                    ::epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, & ev);
+            }
+        }
+
+        void modify (basic_device_ptr const & d, short notify_events)
+        {
+            ssize_t index = find(d);
+
+            if (index < 0)
+                return;
+
+            _events[index] = epoll_events(notify_events);
+
+            epoll_event_type ev;
+            ev.events = static_cast<uint32_t>(_events[index]);
+            ev.data.u64 = static_cast<uint64_t>(index);
+
+            // Fails with EPERM for always ready devices, it's OK
+            ::epoll_ctl(_epfd, EPOLL_CTL_MOD, static_cast<int>(_fds[index]), & ev);
+        }
+
+        poll_result_type poll (int millis, error_code & ec)
+        {
+            // Insert deferred devices
+            if (_deferred_devices.size() > 0) {
+                typename device_vec_type::iterator first = _deferred_devices.begin();
+                typename device_vec_type::iterator last = _deferred_devices.end();
+
+                while (first != last) {
+                    insert(*first, _deferred_events);
+                    ++first;
+                }
+
+                _deferred_devices.clear();
+            }
+
+            // Apply deferred modifications (after insertion, modified device
+            // may be among just inserted)
+            if (_deferred_modifications.size() > 0) {
+                typename modification_vec_type::iterator first = _deferred_modifications.begin();
+                typename modification_vec_type::iterator last = _deferred_modifications.end();
+
+                while (first != last) {
+                    modify(first->first, first->second);
+                    ++first;
+                }
+
+                _deferred_modifications.clear();
+            }
+
+            size_t nalways = _always_ready.size();
+            int max_events = static_cast<int>(_ready.size() - nalways);
+
+            if (max_events <= 0) {
+                _ready.resize(nalways + MAX_EVENTS);
+                max_events = MAX_EVENTS;
+            }
+
+            int r = 0;
+
+            do {
+                r = ::epoll_wait(_epfd, _ready.data(), max_events
+                        , nalways > 0 ? 0 : millis);
+            } while (r < 0 && errno == EINTR);
+
+            if (r < 0) {
+                _ready_count = 0;
+                ec = get_last_system_error();
+                return pfs::make_pair(revents_end(), revents_end());
+            }
+
+            _ready_count = static_cast<size_t>(r);
+
+            for (size_t i = 0; i < nalways; ++i) {
+                ssize_t index = _always_ready[i];
+                epoll_event_type & ev = _ready[_ready_count++];
+                ev.events = static_cast<uint32_t>(_events[index])
+                        & (EPOLLIN | EPOLLOUT);
+                ev.data.u64 = static_cast<uint64_t>(index);
+            }
+
+            if (_ready_count == 0)
+                return pfs::make_pair(revents_end(), revents_end());
+
+            return pfs::make_pair(revents_begin(), revents_end());
+        }
+
+        ssize_t find (int fd)
+        {
+            if (fd >= 0 && static_cast<size_t>(fd) < _fd_indices.size()) {
+                ssize_t index = _fd_indices[fd];
+
+                if (index >= 0 && _fds[index] == fd && _devices[index])
+                    return index;
+            }
+
+            return -1;
+        }
+
+        ssize_t find (basic_device_ptr const & d)
+        {
+            return find(d->native_handle());
+        }
+
+        void erase (revents_iterator pos)
+        {
+            clear(pos.slot());
+        }
+
+        void erase (basic_device_ptr const & d)
+        {
+            ssize_t index = find(d);
+            if (index >= 0) clear(pfs::integral_cast_check<size_t>(index));
+        }
+
+    private:
+        void clear (size_t index)
+        {
+            if (!_devices[index])
+                return;
+
+            // Device may be already closed, so use stored descriptor
+            int fd = static_cast<int>(_fds[index]);
+
+            if (fd >= 0) {
+                // Fails with EBADF if device already closed (in this case
+                // descriptor was removed from epoll set automatically)
+                epoll_event_type ev;
+                ::epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, & ev);
+
+                if (_fd_indices[fd] == static_cast<ssize_t>(index))
+                    _fd_indices[fd] = -1;
+            }
+
+            typename index_vec_type::iterator it = std::find(_always_ready.begin()
+                    , _always_ready.end()
+                    , static_cast<ssize_t>(index));
+
+            if (it != _always_ready.end()) {
+                *it = _always_ready.back();
+                _always_ready.pop_back();
+            }
+
+            _events[index] = 0;
+            _fds[index] = -1;
+            _free_indices.push_back(index);
+
+            basic_device_ptr tmp;
+            _devices[index].swap(tmp);
+        }
+    };
+
+    typedef epoll_map poll_map_type;
+#else
+    typedef pollfd_map poll_map_type;
+#endif
+
 public:
-    typedef typename pollfd_map::revents_iterator revents_iterator;
-    typedef typename pollfd_map::poll_result_type poll_result_type;
+    typedef typename poll_map_type::revents_iterator revents_iterator;
+    typedef typename poll_map_type::poll_result_type poll_result_type;
 
 public:
     device_notifier_pool () {}
 
+#if PFS_HAVE_EPOLL
+    /**
+     * @brief Sets edge-triggered (@a true) or level-triggered (@a false,
+     *        default) notification mode for devices inserted after this call.
+     *
+     * @details In edge-triggered mode event handler is notified only
+     *          when device's state changes, so ready_read() handler
+     *          must read all available data.
+     */
+    void set_edge_triggered (bool enable)
+    {
+        pfs::lock_guard<mutex_type> locker(_mtx);
+        _pollfds._edge_triggered = enable;
+    }
+#else
+    void set_edge_triggered (bool) {}
+#endif
+
+    /**
+     * @brief Sets notification events for accepted (peer) devices
+     *        (notify_all by default).
+     */
+    void set_accepted_events (short notify_events)
+    {
+        pfs::lock_guard<mutex_type> locker(_mtx);
+        _pollfds._deferred_events = notify_events;
+    }
+
     void insert (server_ptr const & s, short notify_events = notify_all)
     {
         pfs::lock_guard<mutex_type> locker(_mtx);
@@ -322,6 +770,18 @@ public:
         _pollfds.insert(pfs::static_pointer_cast<basic_device>(d), notify_events);
     }
 
+    /**
+     * @brief Changes notification events for device.
+     *
+     * @details Does not lock pool, so it can be called from event handler
+     *          (inside dispatch()), changes are applied before the next poll.
+     *          Must be called from the dispatching thread.
+     */
+    void modify_deferred (device_ptr const & d, short notify_events)
+    {
+        _pollfds.modify_deferred(pfs::static_pointer_cast<basic_device>(d), notify_events);
+    }
+
     // Do not use this method directly
     void erase (device_ptr const & d)
     {
@@ -576,8 +1036,8 @@ private:
     }
 
 private:
-    mutex_type _mtx;
-    pollfd_map _pollfds;
+    mutex_type    _mtx;
+    poll_map_type _pollfds;
 };
 
 }}} // namespace pfs::io::details
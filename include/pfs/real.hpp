@@ -146,7 +146,7 @@ namespace details {
 template <typename Iter>
 struct char_iterator_wrapper
 {
-    typedef typename Iter::value_type value_type;
+    typedef typename iterator_traits<Iter>::value_type value_type;
 
     Iter pos;
     Iter last;
@@ -0,0 +1,282 @@
+#pragma once
+#include <string>
+#include <pfs/types.hpp>
+#include <pfs/vector.hpp>
+#include <pfs/sql/data_view.hpp>
+
+namespace pfs {
+namespace sql {
+
+/**
+ * @brief Typed row cursor over the result of sqlite3 or psql statement.
+ *
+ * @details Column names and types are resolved once on construction.
+ *          Cells are accessed by typed methods without value type checks,
+ *          TEXT and BLOB cells are referenced without copying (see
+ *          data_view for validity of the data).
+ *
+ *          Rows can be fetched by blocks into caller-supplied column
+ *          buffers (struct of arrays), buffers are bound to columns by
+ *          bind_column() once:
+ * @code
+ * cursor_type c(db.exec("SELECT id, name FROM item"));
+ * intmax_t ids[BLOCK];
+ * std::string names;          // concatenated values
+ * size_t offsets[BLOCK + 1];  // name of the row i is
+ *                             // [offsets[i], offsets[i + 1])
+ *
+ * c.bind_column(c.column_index("id"), ids);
+ * c.bind_column(c.column_index("name"), & names, offsets);
+ *
+ * while (size_t n = c.fetch(BLOCK)) {
+ *     ...
+ * }
+ * @endcode
+ *          Buffers are reused by subsequent fetch() calls, so reading
+ *          of the result does not allocate memory for each cell.
+ */
+template <typename ResultT>
+class cursor
+{
+public:
+    typedef ResultT                           result_type;
+    typedef typename result_type::string_type string_type;
+
+private:
+    enum buffer_enum {
+          no_buffer
+        , integer_buffer
+        , real_buffer
+        , data_buffer
+    };
+
+    struct column_buffer
+    {
+        buffer_enum   type;
+        intmax_t *    integers;
+        double *      reals;
+        std::string * data;
+        size_t *      offsets;
+        char *        nulls;
+    };
+
+    result_type                     _res;
+    int                             _column_count;
+    pfs::vector<string_type>        _names;
+    pfs::vector<column_type_enum>   _types;
+    pfs::vector<column_buffer>      _buffers;
+
+private:
+    void bind_buffer (int column, column_buffer const & b)
+    {
+        if (_buffers.empty()) {
+            column_buffer nb;
+            nb.type = no_buffer;
+            nb.integers = 0;
+            nb.reals = 0;
+            nb.data = 0;
+            nb.offsets = 0;
+            nb.nulls = 0;
+            _buffers.resize(_column_count, nb);
+        }
+
+        _buffers[column] = b;
+    }
+
+    static column_buffer make_buffer (buffer_enum type, char * nulls)
+    {
+        column_buffer b;
+        b.type = type;
+        b.integers = 0;
+        b.reals = 0;
+        b.data = 0;
+        b.offsets = 0;
+        b.nulls = nulls;
+        return b;
+    }
+
+public:
+    cursor (result_type const & res)
+        : _res(res)
+        , _column_count(res ? _res.column_count() : 0)
+    {
+        _names.reserve(_column_count);
+        _types.reserve(_column_count);
+
+        for (int i = 0; i < _column_count; i++) {
+            _names.push_back(_res.column_name(i));
+            _types.push_back(_res.column_type(i));
+        }
+    }
+
+    result_type const & result () const
+    {
+        return _res;
+    }
+
+    int column_count () const
+    {
+        return _column_count;
+    }
+
+    /**
+     * @return Index of the column with @a name or -1 if not found.
+     */
+    int column_index (string_type const & name) const
+    {
+        for (int i = 0; i < _column_count; i++) {
+            if (_names[i] == name)
+                return i;
+        }
+
+        return -1;
+    }
+
+    string_type const & column_name (int column) const
+    {
+        return _names[column];
+    }
+
+    column_type_enum column_type (int column) const
+    {
+        return _types[column];
+    }
+
+    bool has_more () const
+    {
+        return _res.has_more();
+    }
+
+    cursor & operator ++ ()
+    {
+        ++_res;
+        return *this;
+    }
+
+    bool is_null (int column) const
+    {
+        return _res.is_null(column);
+    }
+
+    intmax_t integer (int column) const
+    {
+        return _res.integer(column);
+    }
+
+    double real (int column) const
+    {
+        return _res.real(column);
+    }
+
+    data_view text (int column) const
+    {
+        return _res.text(column);
+    }
+
+    data_view blob (int column) const
+    {
+        return _res.blob(column);
+    }
+
+    /**
+     * @brief Binds buffer for integer values (@c 0 for NULL)
+     *        of the @a column.
+     *
+     * @param nulls Optional buffer for NULL indicators.
+     */
+    void bind_column (int column, intmax_t * values, char * nulls = 0)
+    {
+        column_buffer b = make_buffer(integer_buffer, nulls);
+        b.integers = values;
+        bind_buffer(column, b);
+    }
+
+    /**
+     * @brief Binds buffer for real values (@c 0.0 for NULL)
+     *        of the @a column.
+     */
+    void bind_column (int column, double * values, char * nulls = 0)
+    {
+        column_buffer b = make_buffer(real_buffer, nulls);
+        b.reals = values;
+        bind_buffer(column, b);
+    }
+
+    /**
+     * @brief Binds buffers for TEXT or BLOB values of the @a column.
+     *
+     * @param data Concatenated values of the fetched rows.
+     * @param offsets Offsets of values in @a data, must have room
+     *        for one more element than the rows fetched by block.
+     */
+    void bind_column (int column, std::string * data, size_t * offsets, char * nulls = 0)
+    {
+        column_buffer b = make_buffer(data_buffer, nulls);
+        b.data = data;
+        b.offsets = offsets;
+        bind_buffer(column, b);
+    }
+
+    /**
+     * @brief Fetches up to @a max_rows rows starting from the current one
+     *        into bound buffers.
+     *
+     * @return Number of fetched rows, @c 0 if there are no more rows.
+     */
+    size_t fetch (size_t max_rows)
+    {
+        int nbuffers = static_cast<int>(_buffers.size());
+
+        for (int j = 0; j < nbuffers; j++) {
+            if (_buffers[j].type == data_buffer) {
+                _buffers[j].data->clear();
+                _buffers[j].offsets[0] = 0;
+            }
+        }
+
+        size_t i = 0;
+
+        for (; i < max_rows && _res.has_more(); ++i, ++_res) {
+            for (int j = 0; j < nbuffers; j++) {
+                column_buffer & b = _buffers[j];
+
+                if (b.type == no_buffer)
+                    continue;
+
+                bool null = _res.is_null(j);
+
+                if (b.nulls)
+                    b.nulls[i] = null ? 1 : 0;
+
+                switch (b.type) {
+                case integer_buffer:
+                    b.integers[i] = null ? 0 : _res.integer(j);
+                    break;
+
+                case real_buffer:
+                    b.reals[i] = null ? 0.0 : _res.real(j);
+                    break;
+
+                case data_buffer: {
+                    if (!null) {
+                        data_view v = _types[j] == blob_column
+                                ? _res.blob(j)
+                                : _res.text(j);
+                        b.data->append(v.data(), v.size());
+                    }
+
+                    b.offsets[i + 1] = b.data->size();
+                    break;
+                }
+
+                default:
+                    break;
+                }
+            }
+        }
+
+        return i;
+    }
+};
+
+}} // pfs::sql
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstring>
+#include <pfs/types.hpp>
+
+namespace pfs {
+namespace sql {
+
+enum column_type_enum {
+      null_column
+    , integer_column
+    , real_column
+    , text_column
+    , blob_column
+};
+
+/**
+ * @brief Non-owning reference to the TEXT (UTF-8 encoded) or BLOB cell data.
+ *
+ * @details Referenced data is owned by the result: it is valid until
+ *          the result is moved to the next row (sqlite3) or destroyed.
+ */
+class data_view
+{
+public:
+    typedef char         value_type;
+    typedef size_t       size_type;
+    typedef char const * const_pointer;
+    typedef char const * const_iterator;
+
+private:
+    const_pointer _data;
+    size_type     _size;
+
+public:
+    data_view ()
+        : _data(0)
+        , _size(0)
+    {}
+
+    data_view (const_pointer s, size_type n)
+        : _data(s)
+        , _size(n)
+    {}
+
+    const_pointer data () const
+    {
+        return _data;
+    }
+
+    uint8_t const * bytes () const
+    {
+        return reinterpret_cast<uint8_t const *>(_data);
+    }
+
+    size_type size () const
+    {
+        return _size;
+    }
+
+    bool empty () const
+    {
+        return _size == 0;
+    }
+
+    const_iterator begin () const
+    {
+        return _data;
+    }
+
+    const_iterator end () const
+    {
+        return _data + _size;
+    }
+
+    /**
+     * @brief Assigns referenced data to @a s.
+     */
+    template <typename StringType>
+    void assign_to (StringType & s) const
+    {
+        s.assign(_data, _size);
+    }
+
+    bool operator == (data_view const & rhs) const
+    {
+        return _size == rhs._size
+                && (_size == 0 || std::memcmp(_data, rhs._data, _size) == 0);
+    }
+
+    bool operator != (data_view const & rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    bool operator == (char const * s) const
+    {
+        return *this == data_view(s, std::strlen(s));
+    }
+
+    bool operator != (char const * s) const
+    {
+        return !(*this == s);
+    }
+};
+
+}} // pfs::sql
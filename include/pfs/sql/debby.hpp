@@ -4,6 +4,7 @@
 #include <pfs/stringlist.hpp>
 #include <pfs/system_error.hpp>
 #include <pfs/sql/exception.hpp>
+#include <pfs/sql/cursor.hpp>
 
 namespace pfs {
 namespace sql {
@@ -82,8 +83,25 @@ struct debby
          *     T get (int column) const
          * @brief
          */
+
+        /**
+         * @fn column_type_enum column_type (int column) const
+         * @fn bool is_null (int column) const
+         * @fn intmax_t integer (int column) const
+         * @fn double real (int column) const
+         * @fn data_view text (int column) const
+         * @fn data_view blob (int column) const
+         * @brief Typed access to the current row's cells without copying
+         *        (see cursor).
+         */
     };
 
+////////////////////////////////////////////////////////////////////////////////
+// Cursor                                                                     //
+////////////////////////////////////////////////////////////////////////////////
+
+    typedef pfs::sql::cursor<result> cursor;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Statement                                                                  //
 ////////////////////////////////////////////////////////////////////////////////
@@ -247,6 +265,110 @@ struct debby
             return stmt;
         }
 
+        /**
+         * @brief Returns prepared statement from the backend's cache
+         *        of prepared statements (sqlite3).
+         */
+        statement prepare_cached (string_type const & sql
+                , pfs::error_code & ec
+                , string_type & errstr)
+        {
+            statement stmt(base_class::prepare_cached(sql, ec, errstr));
+            return stmt;
+        }
+
+        statement prepare_cached (string_type const & sql)
+        {
+            pfs::error_code ec;
+            string_type errstr;
+            statement stmt = this->prepare_cached(sql, ec, errstr);
+
+            if (ec) PFS_THROW(sql_exception(ec, errstr));
+
+            return stmt;
+        }
+
+    private:
+        template <typename Binder>
+        struct statement_binder
+        {
+            Binder binder;
+
+            statement_binder (Binder b) : binder(b) {}
+
+            template <typename StatementRepT, typename Row>
+            bool operator () (StatementRepT & stmt
+                    , Row const & row
+                    , pfs::error_code & ec
+                    , string_type & errstr)
+            {
+                statement s(stmt);
+                return binder(s, row, ec, errstr);
+            }
+        };
+
+    public:
+        /**
+         * @brief Executes statement prepared for @a sql for each row
+         *        in range [@a first, @a last) in one transaction (sqlite3).
+         *
+         * @details Row is bound by @a binder:
+         *          bool binder (statement & stmt, Row const & row
+         *                  , pfs::error_code & ec, string_type & errstr)
+         */
+        template <typename InputIt, typename Binder>
+        bool exec_batch (string_type const & sql
+                , InputIt first
+                , InputIt last
+                , Binder binder
+                , pfs::error_code & ec
+                , string_type & errstr)
+        {
+            return base_class::exec_batch(sql, first, last
+                    , statement_binder<Binder>(binder), ec, errstr);
+        }
+
+        template <typename InputIt, typename Binder>
+        bool exec_batch (string_type const & sql
+                , InputIt first
+                , InputIt last
+                , Binder binder)
+        {
+            pfs::error_code ec;
+            string_type errstr;
+            bool r = this->exec_batch(sql, first, last, binder, ec, errstr);
+
+            if (ec) PFS_THROW(sql_exception(ec, errstr));
+
+            return r;
+        }
+
+        /**
+         * @brief Inserts rows (containers of values or tuples)
+         *        in range [@a first, @a last) in one transaction (sqlite3).
+         */
+        template <typename InputIt>
+        bool insert_many (string_type const & sql
+                , InputIt first
+                , InputIt last
+                , pfs::error_code & ec
+                , string_type & errstr)
+        {
+            return base_class::insert_many(sql, first, last, ec, errstr);
+        }
+
+        template <typename InputIt>
+        bool insert_many (string_type const & sql, InputIt first, InputIt last)
+        {
+            pfs::error_code ec;
+            string_type errstr;
+            bool r = this->insert_many(sql, first, last, ec, errstr);
+
+            if (ec) PFS_THROW(sql_exception(ec, errstr));
+
+            return r;
+        }
+
         /**
          * @fn result exec (string_type const & sql, pfs::error_code & ec, string_type & errstr)
          */
@@ -0,0 +1,323 @@
+#pragma once
+#include <future>
+#include <utility>
+#include <pfs/types.hpp>
+#include <pfs/assert.hpp>
+#include <pfs/functional.hpp>
+#include <pfs/memory.hpp>
+#include <pfs/mutex.hpp>
+#include <pfs/thread.hpp>
+#include <pfs/condition_variable.hpp>
+#include <pfs/deque.hpp>
+#include <pfs/vector.hpp>
+#include <pfs/noncopyable.hpp>
+#include <pfs/system_error.hpp>
+#include <pfs/sql/exception.hpp>
+
+#if __cplusplus < 201103L
+#   error "pfs::sql::connection_pool requires C++11"
+#endif
+
+namespace pfs {
+namespace sql {
+
+/**
+ * @brief Pool of database connections, each served by its own thread.
+ *
+ * @details Queries are submitted as jobs (callables accepting
+ *          database_type &) to the common queue and executed by the first
+ *          free connection, so read-only queries are executed concurrently.
+ *          Results are passed to the handler (exec()) or to the future
+ *          (submit()) from the connection's thread.
+ *
+ *          DebbyNs is pfs::sql::debby<> specialization (sqlite3 or psql).
+ *          For sqlite3 each thread has its own connection to the database
+ *          file, WAL journal mode (concurrent readers with one writer),
+ *          shared cache and busy timeout are configured by options.
+ *
+ * @code
+ * pfs::sql::connection_pool<debby_ns> pool;
+ * pool.open("sqlite3:/data/items.db", options);
+ *
+ * std::future<int> count = pool.submit([] (debby_ns::database & db) {
+ *     debby_ns::result res = db.exec("SELECT COUNT(*) FROM item");
+ *     return res.get<int>(0);
+ * });
+ * @endcode
+ */
+template <typename DebbyNs>
+class connection_pool : noncopyable
+{
+public:
+    typedef typename DebbyNs::database     database_type;
+    typedef typename DebbyNs::result       result_type;
+    typedef typename DebbyNs::string_type  string_type;
+    typedef pfs::function<void (database_type &)> job_type;
+    typedef size_t                         size_type;
+
+    struct options
+    {
+        size_type connections;   // Number of connections, if zero
+                                 // pfs::thread::hardware_concurrency()
+        bool      wal;           // sqlite3: PRAGMA journal_mode = WAL
+        bool      shared_cache;  // sqlite3: cache=shared (URI parameter)
+        int       busy_timeout;  // sqlite3: busy timeout in milliseconds,
+                                 // negative value keeps default one
+
+        options ()
+            : connections(0)
+            , wal(false)
+            , shared_cache(false)
+            , busy_timeout(-1)
+        {}
+    };
+
+private:
+    typedef pfs::mutex mutex_type;
+
+    pfs::vector<pfs::unique_ptr<database_type> > _connections;
+    pfs::vector<pfs::thread> _threads;
+    pfs::deque<job_type>     _jobs;
+    size_type                _unfinished; // Jobs in queue and in progress
+    bool                     _stopped;
+    mutex_type               _mutex;
+    condition_variable       _work_cond;
+    condition_variable       _idle_cond;
+
+private:
+    void run (size_type index)
+    {
+        database_type & db = *_connections[index];
+
+        for (;;) {
+            job_type job;
+
+            {
+                unique_lock<mutex_type> locker(_mutex);
+
+                while (_jobs.empty() && !_stopped)
+                    _work_cond.wait(locker);
+
+                // Queue is drained before stop
+                if (_jobs.empty())
+                    return;
+
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+
+            job(db);
+
+            unique_lock<mutex_type> locker(_mutex);
+
+            if (--_unfinished == 0)
+                _idle_cond.notify_all();
+        }
+    }
+
+    static bool is_sqlite3 (string_type const & uri)
+    {
+        return uri.starts_with("sqlite3:");
+    }
+
+    static bool configure (database_type & db
+            , string_type const & uri
+            , options const & opts
+            , pfs::error_code & ec
+            , string_type & errstr)
+    {
+        if (!is_sqlite3(uri))
+            return true;
+
+        if (opts.busy_timeout >= 0) {
+            string_type sql("PRAGMA busy_timeout = ");
+            sql += pfs::to_string(opts.busy_timeout);
+
+            if (!db.exec(sql, ec, errstr))
+                return false;
+        }
+
+        if (opts.wal && !db.exec("PRAGMA journal_mode = WAL", ec, errstr))
+            return false;
+
+        return true;
+    }
+
+public:
+    connection_pool ()
+        : _unfinished(0)
+        , _stopped(false)
+    {}
+
+    ~connection_pool ()
+    {
+        close();
+    }
+
+    /**
+     * @brief Opens connections to database @a uri (see debby::database::open())
+     *        and starts threads.
+     */
+    bool open (string_type const & uri
+            , options const & opts
+            , pfs::error_code & ec
+            , string_type & errstr)
+    {
+        if (!_connections.empty()) {
+            ec = make_error_code(sql_errc::open_fail);
+            errstr = "connection pool is already opened";
+            return false;
+        }
+
+        size_type n = opts.connections;
+
+        if (n == 0)
+            n = pfs::thread::hardware_concurrency();
+
+        if (n == 0)
+            n = 1;
+
+        string_type db_uri(uri);
+
+        if (opts.shared_cache && is_sqlite3(uri))
+            db_uri += db_uri.find('?') == string_type::npos ? "?cache=shared" : "&cache=shared";
+
+        pfs::vector<pfs::unique_ptr<database_type> > connections;
+        connections.reserve(n);
+
+        for (size_type i = 0; i < n; ++i) {
+            connections.push_back(pfs::make_unique<database_type>());
+
+            if (!connections.back()->open(db_uri, ec, errstr))
+                return false;
+
+            if (!configure(*connections.back(), db_uri, opts, ec, errstr))
+                return false;
+        }
+
+        _connections.swap(connections);
+        _stopped = false;
+        _threads.reserve(n);
+
+        for (size_type i = 0; i < n; ++i)
+            _threads.push_back(pfs::thread(& connection_pool::run, this, i));
+
+        return true;
+    }
+
+    /**
+     * @throw sql_exception.
+     */
+    void open (string_type const & uri, options const & opts = options())
+    {
+        pfs::error_code ec;
+        string_type errstr;
+
+        if (!open(uri, opts, ec, errstr)) {
+            if (errstr.empty())
+                PFS_THROW(sql_exception(ec));
+            else
+                PFS_THROW(sql_exception(ec, uri + ": " + errstr));
+        }
+    }
+
+    /**
+     * @brief Executes all submitted jobs, stops threads and closes
+     *        connections.
+     */
+    void close ()
+    {
+        {
+            unique_lock<mutex_type> locker(_mutex);
+            _stopped = true;
+            _work_cond.notify_all();
+        }
+
+        for (size_type i = 0; i < _threads.size(); ++i) {
+            if (_threads[i].joinable())
+                _threads[i].join();
+        }
+
+        _threads.clear();
+        _connections.clear();
+    }
+
+    bool opened () const
+    {
+        return !_connections.empty();
+    }
+
+    /**
+     * @brief Number of connections.
+     */
+    size_type size () const
+    {
+        return _connections.size();
+    }
+
+    /**
+     * @brief Blocks until all submitted jobs are executed.
+     */
+    void wait_idle ()
+    {
+        unique_lock<mutex_type> locker(_mutex);
+
+        while (_unfinished != 0)
+            _idle_cond.wait(locker);
+    }
+
+    /**
+     * @brief Submits job executed by the first free connection.
+     *
+     * @note Job must not throw (use submit() to get exception).
+     */
+    void push (job_type job)
+    {
+        PFS_ASSERT(!_connections.empty());
+
+        unique_lock<mutex_type> locker(_mutex);
+        _jobs.push_back(std::move(job));
+        ++_unfinished;
+        _work_cond.notify_one();
+    }
+
+    /**
+     * @brief Submits job @a f (callable accepting database_type &).
+     *
+     * @return Future for the result of the job (or exception thrown
+     *         by it).
+     */
+    template <typename F>
+    std::future<typename std::result_of<F (database_type &)>::type> submit (F f)
+    {
+        typedef typename std::result_of<F (database_type &)>::type value_type;
+        typedef std::packaged_task<value_type (database_type &)> task_type;
+
+        pfs::shared_ptr<task_type> task = pfs::make_shared<task_type>(std::move(f));
+        std::future<value_type> result = task->get_future();
+
+        push([task] (database_type & db) { (*task)(db); });
+
+        return result;
+    }
+
+    /**
+     * @brief Executes @a sql by the first free connection and passes
+     *        the result to @a handler in the connection's thread:
+     *        void handler (result_type & res
+     *                , pfs::error_code const & ec
+     *                , string_type const & errstr)
+     */
+    template <typename Handler>
+    void exec (string_type const & sql, Handler handler)
+    {
+        push([sql, handler] (database_type & db) mutable {
+            pfs::error_code ec;
+            string_type errstr;
+            result_type res = db.exec(sql, ec, errstr);
+            handler(res, ec, errstr);
+        });
+    }
+};
+
+}} // pfs::sql
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdlib>
+#include <string>
 #include <pfs/string.hpp>
+#include <pfs/vector.hpp>
 #include <pfs/sql/cast.hpp>
+#include <pfs/sql/data_view.hpp>
 #include <pfs/sql/psql/private_data.hpp>
 
 namespace pfs {
@@ -10,12 +14,15 @@ namespace psql {
 template <typename StringT = pfs::string>
 class result
 {
-    typedef StringT string_type;
+public:
+    typedef StringT                   string_type;
     typedef result_native_handle_type native_handle_type;
 
+private:
     result_handle_shared _pd;
     int _nrows;
     int _irow;  // current row
+    mutable pfs::vector<std::string> _blobs; // Decoded bytea values by column
 
 private:
     template <typename T>
@@ -34,6 +41,11 @@ public:
 
     ~result () {}
 
+    native_handle_type native_handle () const
+    {
+        return _pd.get();
+    }
+
     operator bool () const
     {
         return _pd.get() != 0;
@@ -79,6 +91,96 @@ public:
         return cast_traits<T>::cast(string_type(value));
     }
 
+    /**
+     * @brief Returns type of the column by its type OID (built-in types only).
+     */
+    column_type_enum column_type (int column) const
+    {
+        // OIDs of built-in types (see catalog/pg_type.h)
+        switch (PQftype(_pd.get(), column)) {
+        case 16:   // bool
+        case 20:   // int8
+        case 21:   // int2
+        case 23:   // int4
+        case 26:   // oid
+            return integer_column;
+        case 700:  // float4
+        case 701:  // float8
+            return real_column;
+        case 17:   // bytea
+            return blob_column;
+        default:  // numeric (1700) too, to keep its precision
+            break;
+        }
+
+        return text_column;
+    }
+
+    //
+    // Typed access to the current row's cells without copying. Values are
+    // in text format: integers and reals are converted from text, BLOB
+    // (bytea) values are decoded (see blob()).
+    //
+
+    bool is_null (int column) const
+    {
+        return PQgetisnull(_pd.get(), _irow, column) != 0;
+    }
+
+    intmax_t integer (int column) const
+    {
+        char const * value = PQgetvalue(_pd.get(), _irow, column);
+
+        // Boolean values are represented by 't' and 'f'
+        if (value[0] == 't')
+            return 1;
+
+        return static_cast<intmax_t>(std::strtoll(value, 0, 10));
+    }
+
+    double real (int column) const
+    {
+        return std::strtod(PQgetvalue(_pd.get(), _irow, column), 0);
+    }
+
+    /**
+     * @note Data is valid until the result is destroyed.
+     */
+    data_view text (int column) const
+    {
+        return data_view(PQgetvalue(_pd.get(), _irow, column)
+                , size_t(PQgetlength(_pd.get(), _irow, column)));
+    }
+
+    /**
+     * @brief Returns bytes of the bytea cell.
+     *
+     * @note Values in binary format are referenced as is, data is valid
+     *       until the result is destroyed. Values in text format are decoded
+     *       into the result's buffer, data is valid until the next call
+     *       for the same column.
+     */
+    data_view blob (int column) const
+    {
+        if (PQfformat(_pd.get(), column) == 1)
+            return text(column);
+
+        size_t n = 0;
+        unsigned char * bytes = PQunescapeBytea(reinterpret_cast<unsigned char const *>(
+                PQgetvalue(_pd.get(), _irow, column)), & n);
+
+        if (!bytes)
+            return data_view();
+
+        if (_blobs.size() <= size_t(column))
+            _blobs.resize(column + 1);
+
+        _blobs[column].assign(reinterpret_cast<char const *>(bytes), n);
+        PQfreemem(bytes);
+
+        return data_view(_blobs[column].data(), _blobs[column].size());
+    }
+
     string_type column_name (int column)
     {
         string_type name(PQfname(_pd.get(), column));
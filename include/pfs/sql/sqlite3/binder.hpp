@@ -92,6 +92,20 @@ struct binder<long, StringT>
 
 #endif
 
+template <typename StringT>
+struct binder<double, StringT>
+{
+    bool operator () (stmt_native_handle_type sth
+            , int index
+            , double const & value
+            , pfs::error_code & ec
+            , StringT & errstr)
+    {
+        int rc = sqlite3_bind_double(sth, index, value);
+        return (rc != SQLITE_OK) ? binder_fail<StringT>(sth, rc, ec, errstr) : true;
+    }
+};
+
 template <typename StringT>
 struct binder<StringT, StringT>
 {
@@ -1,4 +1,5 @@
 #pragma once
+#include <iterator>
 #include <pfs/sql/sqlite3/sqlite3.h>
 #include <pfs/string.hpp>
 #include <pfs/stringlist.hpp>
@@ -8,6 +9,7 @@
 #include <pfs/net/uri.hpp>
 #include <pfs/sql/exception.hpp>
 #include <pfs/sql/sqlite3/statement.hpp>
+#include <pfs/sql/sqlite3/statement_cache.hpp>
 #include <pfs/sql/sqlite3/result.hpp>
 #include <pfs/sql/sqlite3/private_data.hpp>
 
@@ -29,12 +31,14 @@ class database
 public:
     typedef StringT               string_type;
     typedef StringListT           stringlist_type;
-    typedef statement<StringT>    statement_type;
-    typedef result<StringT>       result_type;
-    typedef db_native_handle_type native_handle_type;
+    typedef statement<StringT>       statement_type;
+    typedef result<StringT>          result_type;
+    typedef statement_cache<StringT> statement_cache_type;
+    typedef db_native_handle_type    native_handle_type;
 
 private:
-    db_handle_shared _pd;
+    db_handle_shared     _pd;
+    statement_cache_type _cache;
 
 private:
     static bool query (db_native_handle_type dbh
@@ -62,6 +66,30 @@ private:
         return query(_pd.get(), sql, ec, errstr);
     }
 
+    stmt_native_handle_type prepare (string_type const & sql
+            , unsigned int prep_flags
+            , pfs::error_code & ec
+            , string_type & errstr)
+    {
+        stmt_native_handle_type sth;
+        std::string utf8_query(sql.utf8());
+
+        int rc = sqlite3_prepare_v3(_pd.get() // Database handle
+                , utf8_query.c_str()          // SQL statement, UTF-8 encoded
+                , utf8_query.size()           // Maximum length of zSql in bytes
+                , prep_flags                  // Zero or more SQLITE_PREPARE_ flags
+                , & sth                       // OUT: Statement handle
+                , NULL);                      // OUT: Pointer to unused portion of zSql (unsigned)
+
+        if (rc != SQLITE_OK) {
+            ec = pfs::make_error_code(pfs::sql_errc::query_fail);
+            errstr = result_code<string_type>::errorstr(sqlite3_errmsg(_pd.get()), rc);
+            return 0;
+        }
+
+        return sth;
+    }
+
 public:
     database () {}
 
@@ -186,6 +214,7 @@ public:
 
     void close ()
     {
+        _cache.clear();
         db_handle_shared pd;
         _pd.swap(pd);
     }
@@ -220,6 +249,12 @@ public:
         return query(_pd.get(), string_type("PRAGMA foreign_keys = ON"), ec, errstr);
     }
 
+    /**
+     * @brief Executes @a sql.
+     *
+     * @note Statement is not cached, use prepare_cached() for statements
+     *       executed repeatedly.
+     */
     result_type exec (string_type const & sql, pfs::error_code & ec, string_type & errstr)
     {
         statement_type stmt = prepare(sql, ec, errstr);
@@ -242,24 +277,119 @@ public:
             , pfs::error_code & ec
             , string_type & errstr)
     {
-        unsigned int prep_flags = 0;
-        stmt_native_handle_type sth;
-        std::string utf8_query(sql.utf8());
+        stmt_native_handle_type sth = prepare(sql, 0, ec, errstr);
+        return sth ? statement_type(sth) : statement_type();
+    }
 
-        int rc = sqlite3_prepare_v3(_pd.get() // Database handle
-                , utf8_query.c_str()          // SQL statement, UTF-8 encoded
-                , utf8_query.size()           // Maximum length of zSql in bytes
-                , prep_flags                  // Zero or more SQLITE_PREPARE_ flags
-                , & sth                       // OUT: Statement handle
-                , NULL);                      // OUT: Pointer to unused portion of zSql (unsigned)
+    /**
+     * @brief Returns prepared statement for @a sql from the cache
+     *        (preparing and caching it if needed).
+     *
+     * @note Statement is reset and its bindings are cleared when the last
+     *       copy of it (including results) is destroyed.
+     */
+    statement_type prepare_cached (string_type const & sql
+            , pfs::error_code & ec
+            , string_type & errstr)
+    {
+        statement_type stmt = _cache.lease(sql);
 
-        if (rc != SQLITE_OK) {
-            ec = pfs::make_error_code(pfs::sql_errc::query_fail);
-            errstr = result_code<string_type>::errorstr(sqlite3_errmsg(_pd.get()), rc);
-            return statement_type();
+        if (stmt)
+            return stmt;
+
+        stmt_native_handle_type sth = prepare(sql
+                , _cache.capacity() > 0 ? SQLITE_PREPARE_PERSISTENT : 0
+                , ec
+                , errstr);
+
+        return sth ? _cache.insert(sql, sth) : statement_type();
+    }
+
+    size_t statement_cache_capacity () const
+    {
+        return _cache.capacity();
+    }
+
+    /**
+     * @brief Sets maximum number of cached prepared statements,
+     *        @c 0 disables cache.
+     */
+    void set_statement_cache_capacity (size_t capacity)
+    {
+        _cache.set_capacity(capacity);
+    }
+
+    /**
+     * @brief Executes statement prepared for @a sql for each row
+     *        in range [@a first, @a last).
+     *
+     * @details Row is bound to the statement by @a binder:
+     *          bool binder (statement_type & stmt, Row const & row
+     *                  , pfs::error_code & ec, string_type & errstr)
+     *          Rows are processed in one transaction if there is no
+     *          transaction started already.
+     *
+     * @return @c false if some row failed, changes are rolled back in this
+     *         case (if the transaction was started by this call).
+     */
+    template <typename InputIt, typename Binder>
+    bool exec_batch (string_type const & sql
+            , InputIt first
+            , InputIt last
+            , Binder binder
+            , pfs::error_code & ec
+            , string_type & errstr)
+    {
+        statement_type stmt = prepare_cached(sql, ec, errstr);
+
+        if (!stmt)
+            return false;
+
+        // Implicit transaction
+        bool autocommit = sqlite3_get_autocommit(_pd.get()) != 0;
+
+        if (autocommit && !begin_transaction(ec, errstr))
+            return false;
+
+        bool ok = true;
+
+        for (; ok && first != last; ++first) {
+            ok = binder(stmt, *first, ec, errstr)
+                    && stmt.exec(ec, errstr)
+                    && stmt.reset(ec, errstr)
+                    && stmt.clear_bindings(ec, errstr);
+        }
+
+        if (!ok) {
+            // Keep the error of failed row
+            pfs::error_code ec1;
+            string_type errstr1;
+            stmt.reset(ec1, errstr1);
+
+            if (autocommit)
+                rollback(ec1, errstr1);
+
+            return false;
         }
 
-        return statement_type(sth);
+        return autocommit ? commit(ec, errstr) : true;
+    }
+
+    /**
+     * @brief Inserts rows in range [@a first, @a last).
+     *
+     * @details Row is a container of values or tuple (C++11). Its elements
+     *          are bound to statement parameters in order.
+     */
+    template <typename InputIt>
+    bool insert_many (string_type const & sql
+            , InputIt first
+            , InputIt last
+            , pfs::error_code & ec
+            , string_type & errstr)
+    {
+        typedef typename std::iterator_traits<InputIt>::value_type row_type;
+        return exec_batch(sql, first, last, details::row_binder<row_type>(), ec, errstr);
     }
 
     bool begin_transaction (pfs::error_code & ec, string_type & errstr)
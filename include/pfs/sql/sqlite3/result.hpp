@@ -1,10 +1,13 @@
 #pragma once
+#include <cctype>
+#include <string>
 #include <pfs/sql/sqlite3/sqlite3.h>
 #include <pfs/string.hpp>
 #include <pfs/system_error.hpp>
 #include <pfs/sql/sqlite3/id.hpp>
 #include <pfs/sql/sqlite3/private_data.hpp>
 #include <pfs/sql/cast.hpp>
+#include <pfs/sql/data_view.hpp>
 
 namespace pfs {
 namespace sql {
@@ -13,8 +16,11 @@ namespace sqlite3 {
 template <typename StringT = pfs::string>
 class result
 {
-    typedef StringT string_type;
+public:
+    typedef StringT                 string_type;
+    typedef stmt_native_handle_type native_handle_type;
 
+private:
     stmt_handle_shared _pd;
     int _rc;
 
@@ -32,6 +38,11 @@ public:
 
     ~result () {}
 
+    native_handle_type native_handle () const
+    {
+        return _pd.get();
+    }
+
     operator bool () const
     {
         return _pd.get() != 0;
@@ -74,8 +85,14 @@ public:
     T get (int column) const
     {
         switch (sqlite3_column_type(_pd.get(), column)) {
-        case SQLITE_TEXT:
-            return cast_traits<T>::cast(string_type(reinterpret_cast<char const *>(sqlite3_column_text(_pd.get(), column))));
+        case SQLITE_TEXT: {
+            data_view v = text(column);
+            return cast_traits<T>::cast(string_type(v.data(), v.size()));
+        }
+        case SQLITE_BLOB: {
+            data_view v = blob(column);
+            return cast_traits<T>::cast(string_type(v.data(), v.size()));
+        }
         case SQLITE_INTEGER:
 #if PFS_HAVE_INT64
             return cast_traits<T>::cast(static_cast<intmax_t>(sqlite3_column_int64(_pd.get(), column)));
@@ -85,14 +102,6 @@ public:
         case SQLITE_FLOAT:
             return cast_traits<T>::cast(sqlite3_column_double(_pd.get(), column));
 
-        case SQLITE_BLOB:
-            // TODO Implement
-//             const char * bytes = reinterpret_cast<const char*>(sqlite3_column_blob(s3_sth->_native_handler, i));
-//             int nbytes = sqlite3_column_bytes(s3_sth->_native_handler, i);
-//             PFS_ASSERT(nbytes >= 0);
-//             row.append(pfs::unitype(pfs::bytearray(bytes, size_t(nbytes))));
-            break;
-
         case SQLITE_NULL:
             return T();
 
@@ -104,6 +113,92 @@ public:
         return T();
     }
 
+    /**
+     * @brief Returns type of the column: declared type affinity if column
+     *        is a table column, or type of the value in the current row
+     *        otherwise.
+     */
+    column_type_enum column_type (int column) const
+    {
+        char const * decltype_str = sqlite3_column_decltype(_pd.get(), column);
+
+        // Affinity rules (see "Datatypes In SQLite")
+        if (decltype_str) {
+            std::string t(decltype_str);
+
+            for (size_t i = 0; i < t.size(); i++)
+                t[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(t[i])));
+
+            if (t.find("INT") != std::string::npos)
+                return integer_column;
+
+            if (t.find("CHAR") != std::string::npos
+                    || t.find("CLOB") != std::string::npos
+                    || t.find("TEXT") != std::string::npos)
+                return text_column;
+
+            if (t.empty() || t.find("BLOB") != std::string::npos)
+                return blob_column;
+
+            return real_column;
+        }
+
+        switch (sqlite3_column_type(_pd.get(), column)) {
+        case SQLITE_INTEGER: return integer_column;
+        case SQLITE_FLOAT:   return real_column;
+        case SQLITE_TEXT:    return text_column;
+        case SQLITE_BLOB:    return blob_column;
+        default: break;
+        }
+
+        return null_column;
+    }
+
+    //
+    // Typed access to the current row's cells without value type checks
+    // and copying (values are converted by SQLite if needed).
+    //
+
+    bool is_null (int column) const
+    {
+        return sqlite3_column_type(_pd.get(), column) == SQLITE_NULL;
+    }
+
+    intmax_t integer (int column) const
+    {
+#if PFS_HAVE_INT64
+        return static_cast<intmax_t>(sqlite3_column_int64(_pd.get(), column));
+#else
+        return static_cast<intmax_t>(sqlite3_column_int(_pd.get(), column));
+#endif
+    }
+
+    double real (int column) const
+    {
+        return sqlite3_column_double(_pd.get(), column);
+    }
+
+    /**
+     * @note Data is valid until the result is moved to the next row.
+     */
+    data_view text (int column) const
+    {
+        // sqlite3_column_bytes() must be called after sqlite3_column_text()
+        char const * data = reinterpret_cast<char const *>(sqlite3_column_text(_pd.get(), column));
+        int nbytes = sqlite3_column_bytes(_pd.get(), column);
+        return data ? data_view(data, size_t(nbytes)) : data_view();
+    }
+
+    /**
+     * @note Data is valid until the result is moved to the next row.
+     */
+    data_view blob (int column) const
+    {
+        char const * data = reinterpret_cast<char const *>(sqlite3_column_blob(_pd.get(), column));
+        int nbytes = sqlite3_column_bytes(_pd.get(), column);
+        return data ? data_view(data, size_t(nbytes)) : data_view();
+    }
+
     string_type column_name (int column)
     {
         string_type name(sqlite3_column_name(_pd.get(), column));
@@ -2,6 +2,7 @@
 #include <pfs/sql/sqlite3/sqlite3.h>
 #include <pfs/utility.hpp>
 #include <pfs/string.hpp>
+#include <pfs/tuple.hpp>
 #include <pfs/system_error.hpp>
 #include <pfs/sql/sqlite3/result_code.hpp>
 #include <pfs/sql/sqlite3/result.hpp>
@@ -25,6 +26,7 @@ class statement
 public:
     statement () {}
     statement (native_handle_type sth) : _pd(sth, stmt_handle_deleter()) {}
+    statement (stmt_handle_shared const & pd) : _pd(pd) {}
 
     native_handle_type native_handle () const
     {
@@ -89,6 +91,16 @@ public:
         return (rc != SQLITE_OK) ? details::binder_fail<StringT>(_pd.get(), rc, ec, errstr) : true;
     }
 
+    /**
+     * @brief Resets all bindings to NULL.
+     */
+    bool clear_bindings (pfs::error_code & /*ec*/, string_type & /*errstr*/)
+    {
+        // sqlite3_clear_bindings() always returns SQLITE_OK
+        sqlite3_clear_bindings(_pd.get());
+        return true;
+    }
+
     bool reset (pfs::error_code & ec, string_type & errstr)
     {
         int rc = sqlite3_reset(_pd.get());
@@ -104,4 +116,78 @@ public:
     }
 };
 
+namespace details {
+
+//
+// Binds elements of the row (container of values of the bindable type)
+// to statement parameters in order.
+//
+template <typename Row>
+struct row_binder
+{
+    template <typename StatementT, typename StringT>
+    bool operator () (StatementT & stmt
+            , Row const & row
+            , pfs::error_code & ec
+            , StringT & errstr) const
+    {
+        int index = 0;
+        typename Row::const_iterator it = row.begin();
+        typename Row::const_iterator last = row.end();
+
+        for (; it != last; ++it, ++index) {
+            if (!stmt.bind(index, *it, ec, errstr))
+                return false;
+        }
+
+        return true;
+    }
+};
+
+#if __cplusplus >= 201103L
+
+template <std::size_t I, std::size_t N>
+struct tuple_binder
+{
+    template <typename StatementT, typename Tuple, typename StringT>
+    static bool bind (StatementT & stmt
+            , Tuple const & row
+            , pfs::error_code & ec
+            , StringT & errstr)
+    {
+        return stmt.bind(static_cast<int>(I), pfs::get<I>(row), ec, errstr)
+                && tuple_binder<I + 1, N>::bind(stmt, row, ec, errstr);
+    }
+};
+
+template <std::size_t N>
+struct tuple_binder<N, N>
+{
+    template <typename StatementT, typename Tuple, typename StringT>
+    static bool bind (StatementT &, Tuple const &, pfs::error_code &, StringT &)
+    {
+        return true;
+    }
+};
+
+//
+// Binds elements of the tuple to statement parameters in order.
+//
+template <typename... Types>
+struct row_binder<pfs::tuple<Types...>>
+{
+    template <typename StatementT, typename StringT>
+    bool operator () (StatementT & stmt
+            , pfs::tuple<Types...> const & row
+            , pfs::error_code & ec
+            , StringT & errstr) const
+    {
+        return tuple_binder<0, sizeof...(Types)>::bind(stmt, row, ec, errstr);
+    }
+};
+
+#endif
+
+} // details
+
 }}} // pfs::sql::sqlite3
@@ -0,0 +1,171 @@
+#pragma once
+#include <pfs/sql/sqlite3/sqlite3.h>
+#include <pfs/map.hpp>
+#include <pfs/list.hpp>
+#include <pfs/string.hpp>
+#include <pfs/sql/sqlite3/private_data.hpp>
+#include <pfs/sql/sqlite3/statement.hpp>
+
+namespace pfs {
+namespace sql {
+namespace sqlite3 {
+
+/**
+ * @brief LRU cache of prepared statements keyed by SQL text.
+ *
+ * @details Cache owns statements. Statement returned by lease() (and results
+ *          of its execution) shares the native handle with the cache, when
+ *          the last copy of it is destroyed the statement is reset and its
+ *          bindings are cleared, so idle statements do not hold locks.
+ *          Statement which is in use is never leased twice: caller prepares
+ *          a new one in that case.
+ */
+template <typename StringT = pfs::string>
+class statement_cache
+{
+public:
+    typedef StringT                string_type;
+    typedef statement<string_type> statement_type;
+    typedef size_t                 size_type;
+
+private:
+    struct lease_deleter
+    {
+        mutable stmt_handle_shared owner;
+
+        lease_deleter (stmt_handle_shared const & o) : owner(o) {}
+
+        void operator () (stmt_native_handle_type sth) const
+        {
+            sqlite3_reset(sth);
+            sqlite3_clear_bindings(sth);
+
+            // Release ownership here: shared_ptr implementations are not
+            // obliged to destroy deleter right after the call
+            stmt_handle_shared empty;
+            owner.swap(empty);
+        }
+    };
+
+    typedef pfs::list<string_type> lru_list_type;
+
+    struct entry
+    {
+        stmt_handle_shared               owner;
+        typename lru_list_type::iterator lru_pos;
+    };
+
+    typedef pfs::map<string_type, entry> map_type;
+
+    map_type      _map;
+    lru_list_type _lru; // Keys, most recently used first
+    size_type     _capacity;
+
+private:
+    statement_type make_lease (entry & e)
+    {
+        _lru.splice(_lru.begin(), _lru, e.lru_pos);
+        return statement_type(stmt_handle_shared(e.owner.get(), lease_deleter(e.owner)));
+    }
+
+    /**
+     * @brief Removes least recently used idle statement.
+     *
+     * @details Statements in use are skipped, so only the number of them
+     *          limits the scan.
+     */
+    bool evict ()
+    {
+        typename lru_list_type::iterator it = _lru.end();
+
+        while (it != _lru.begin()) {
+            --it;
+
+            typename map_type::iterator pos = _map.find(*it);
+            entry const & e = map_type::mapped_reference(pos);
+
+            if (e.owner.unique()) {
+                _map.erase(pos);
+                _lru.erase(it);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+public:
+    statement_cache (size_type capacity = 32)
+        : _capacity(capacity)
+    {}
+
+    size_type capacity () const
+    {
+        return _capacity;
+    }
+
+    void set_capacity (size_type capacity)
+    {
+        _capacity = capacity;
+
+        while (_map.size() > _capacity && evict())
+            ;
+    }
+
+    size_type size () const
+    {
+        return _map.size();
+    }
+
+    void clear ()
+    {
+        _map.clear();
+        _lru.clear();
+    }
+
+    /**
+     * @return Cached statement for @a sql or invalid statement if it is not
+     *         cached or is in use now.
+     */
+    statement_type lease (string_type const & sql)
+    {
+        typename map_type::iterator it = _map.find(sql);
+
+        if (it == _map.end())
+            return statement_type();
+
+        entry & e = map_type::mapped_reference(it);
+
+        if (!e.owner.unique())
+            return statement_type();
+
+        return make_lease(e);
+    }
+
+    /**
+     * @brief Caches statement @a sth prepared for @a sql.
+     *
+     * @return Leased statement or statement owning @a sth if it can't be
+     *         cached (cache is full of statements in use or statement
+     *         for @a sql is in use).
+     */
+    statement_type insert (string_type const & sql, stmt_native_handle_type sth)
+    {
+        if (_capacity == 0 || _map.find(sql) != _map.end())
+            return statement_type(sth);
+
+        if (_map.size() >= _capacity && !evict())
+            return statement_type(sth);
+
+        _lru.push_front(sql);
+
+        entry e;
+        e.owner = stmt_handle_shared(sth, stmt_handle_deleter());
+        e.lru_pos = _lru.begin();
+
+        typename map_type::iterator it = _map.insert(sql, e).first;
+        return make_lease(map_type::mapped_reference(it));
+    }
+};
+
+}}} // pfs::sql::sqlite3
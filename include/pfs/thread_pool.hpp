@@ -0,0 +1,678 @@
+#pragma once
+#include <pfs/types.hpp>
+#include <pfs/atomic.hpp>
+#include <pfs/mutex.hpp>
+#include <pfs/thread.hpp>
+#include <pfs/condition_variable.hpp>
+#include <pfs/deque.hpp>
+#include <pfs/vector.hpp>
+#include <pfs/memory.hpp>
+#include <pfs/noncopyable.hpp>
+#include <pfs/inplace_binder.hpp>
+
+#if __cplusplus < 201103L
+#   error "pfs::thread_pool requires C++11"
+#endif
+
+namespace pfs {
+
+/**
+ * @brief Pool of worker threads executing binder-based jobs
+ *        (the same jobs as accepted by active_queue).
+ *
+ * @details Each worker owns a deque of jobs. Jobs pushed from outside
+ *          of the pool are distributed between workers in round-robin
+ *          order, jobs pushed from inside a job go to the deque of the
+ *          current worker. Worker takes jobs from the front of its own
+ *          deque, idle worker steals jobs from the back of other
+ *          workers' deques.
+ *
+ *          Jobs pushed after shutdown() are executed by the calling
+ *          thread.
+ */
+class thread_pool : noncopyable
+{
+public:
+    typedef inplace_binder<void> callable_type;
+    typedef size_t               size_type;
+
+    struct statistics
+    {
+        size_type           executed; // Number of jobs executed by worker
+        size_type           steals;   // Number of jobs stolen from other workers
+        chrono::nanoseconds idle;     // Time spent waiting for jobs
+
+        statistics () : executed(0), steals(0), idle(0) {}
+    };
+
+private:
+    typedef pfs::mutex                 mutex_type;
+    typedef pfs::deque<callable_type>  deque_type;
+    typedef std::chrono::steady_clock  clock_type;
+
+    struct worker
+    {
+        mutable mutex_type  mutex;
+        deque_type          jobs;
+        atomic<size_type>   executed;
+        atomic<size_type>   steals;
+        atomic<int64_t>     idle_ns;
+        pfs::thread         thread;
+
+        worker () : executed(0), steals(0), idle_ns(0) {}
+    };
+
+    struct context
+    {
+        thread_pool * pool;
+        size_type     index;
+    };
+
+    pfs::vector<pfs::unique_ptr<worker> > _workers;
+    atomic<size_type>  _next;       // Round-robin index for external pushes
+    atomic<size_type>  _pending;    // Jobs in deques
+    atomic<size_type>  _unfinished; // Jobs in deques and jobs in progress
+    atomic<size_type>  _sleeping;   // Workers waiting for jobs
+    atomic<bool>       _stopped;
+    mutex_type         _mutex;
+    condition_variable _work_cond;
+    condition_variable _idle_cond;
+
+private:
+    static context & current ()
+    {
+        static thread_local context ctx = { 0, 0 };
+        return ctx;
+    }
+
+    template <typename Binder>
+    void push_helper (Binder const & b)
+    {
+        if (_stopped.load()) {
+            b();
+            return;
+        }
+
+        context & ctx = current();
+        size_type index = ctx.pool == this
+                ? ctx.index
+                : _next.fetch_add(1) % _workers.size();
+
+        worker & w = *_workers[index];
+
+        {
+            unique_lock<mutex_type> locker(w.mutex);
+
+            // Checked again under worker's lock: shutdown() drains deques
+            // after the flag is set, so the job is either drained
+            // by shutdown() or executed here
+            if (_stopped.load()) {
+                locker.unlock();
+                b();
+                return;
+            }
+
+            ++_unfinished;
+            w.jobs.push_back(callable_type());
+            w.jobs.back().assign(b);
+            ++_pending;
+        }
+
+        // Do not touch common mutex while all workers are busy
+        if (_sleeping.load() > 0) {
+            unique_lock<mutex_type> locker(_mutex);
+            _work_cond.notify_one();
+        }
+    }
+
+    bool pop (size_type index, callable_type & job)
+    {
+        worker & w = *_workers[index];
+        unique_lock<mutex_type> locker(w.mutex);
+
+        if (w.jobs.empty())
+            return false;
+
+        job = std::move(w.jobs.front());
+        w.jobs.pop_front();
+        return true;
+    }
+
+    bool steal (size_type index, callable_type & job)
+    {
+        size_type n = _workers.size();
+
+        for (size_type i = 1; i < n; ++i) {
+            worker & victim = *_workers[(index + i) % n];
+            unique_lock<mutex_type> locker(victim.mutex);
+
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.back());
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void run (size_type index)
+    {
+        worker & w = *_workers[index];
+        context & ctx = current();
+        ctx.pool = this;
+        ctx.index = index;
+
+        for (;;) {
+            callable_type job;
+            bool stolen = false;
+
+            if (_pending.load() > 0) {
+                if (!pop(index, job))
+                    stolen = steal(index, job);
+            }
+
+            if (!job.empty()) {
+                --_pending;
+                job();
+                job.reset();
+
+                ++w.executed;
+
+                if (stolen)
+                    ++w.steals;
+
+                if (--_unfinished == 0) {
+                    unique_lock<mutex_type> locker(_mutex);
+                    _idle_cond.notify_all();
+                }
+
+                continue;
+            }
+
+            unique_lock<mutex_type> locker(_mutex);
+
+            if (_stopped.load() && _pending.load() == 0)
+                break;
+
+            clock_type::time_point start = clock_type::now();
+
+            ++_sleeping;
+
+            while (_pending.load() == 0 && !_stopped.load())
+                _work_cond.wait(locker);
+
+            --_sleeping;
+
+            w.idle_ns += std::chrono::duration_cast<chrono::nanoseconds>(
+                    clock_type::now() - start).count();
+        }
+    }
+
+public:
+    /**
+     * @param nworkers Number of worker threads, if zero
+     *        pfs::thread::hardware_concurrency() workers are created.
+     */
+    explicit thread_pool (size_type nworkers = 0)
+        : _next(0)
+        , _pending(0)
+        , _unfinished(0)
+        , _sleeping(0)
+        , _stopped(false)
+    {
+        if (nworkers == 0)
+            nworkers = pfs::thread::hardware_concurrency();
+
+        if (nworkers == 0)
+            nworkers = 1;
+
+        _workers.reserve(nworkers);
+
+        for (size_type i = 0; i < nworkers; ++i)
+            _workers.push_back(pfs::make_unique<worker>());
+
+        for (size_type i = 0; i < nworkers; ++i)
+            _workers[i]->thread = pfs::thread(& thread_pool::run, this, i);
+    }
+
+    ~thread_pool ()
+    {
+        shutdown();
+    }
+
+    /**
+     * @brief Default pool (used by thread_pool_queue).
+     */
+    static thread_pool & default_pool ()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    size_type size () const
+    {
+        return _workers.size();
+    }
+
+    /**
+     * @return Number of jobs queued or in progress.
+     */
+    size_type count () const
+    {
+        return _unfinished.load();
+    }
+
+    bool stopped () const
+    {
+        return _stopped.load();
+    }
+
+    /**
+     * @brief Blocks until all pushed jobs are executed.
+     *
+     * @note Must not be called from a job.
+     */
+    void wait_idle ()
+    {
+        unique_lock<mutex_type> locker(_mutex);
+
+        while (_unfinished.load() != 0)
+            _idle_cond.wait(locker);
+    }
+
+    /**
+     * @brief Executes all pushed jobs and joins workers.
+     */
+    void shutdown ()
+    {
+        {
+            unique_lock<mutex_type> locker(_mutex);
+
+            if (_stopped.load())
+                return;
+
+            _stopped.store(true);
+            _work_cond.notify_all();
+        }
+
+        for (size_type i = 0; i < _workers.size(); ++i) {
+            if (_workers[i]->thread.joinable())
+                _workers[i]->thread.join();
+        }
+
+        // Execute jobs pushed concurrently with shutdown
+        for (size_type i = 0; i < _workers.size(); ++i) {
+            callable_type job;
+
+            while (pop(i, job)) {
+                --_pending;
+                job();
+                job.reset();
+
+                if (--_unfinished == 0) {
+                    unique_lock<mutex_type> locker(_mutex);
+                    _idle_cond.notify_all();
+                }
+            }
+        }
+    }
+
+    statistics stats (size_type index) const
+    {
+        worker const & w = *_workers[index];
+        statistics result;
+        result.executed = w.executed.load();
+        result.steals   = w.steals.load();
+        result.idle     = chrono::nanoseconds(w.idle_ns.load());
+        return result;
+    }
+
+    /**
+     * @brief Pushes job @a b, binder derived from binder_base<void>.
+     */
+    template <typename Binder>
+    void push (Binder const & b)
+    {
+        push_helper(b);
+    }
+
+//#if __cplusplus >= 201103L
+//#   error Implement using variadic templates
+//#else
+    void push_function (void (* f) ())
+    {
+        push_helper(binder_function0<void>(f));
+    }
+
+    template <typename Arg1>
+    void push_function (void (* f) (Arg1), Arg1 a1)
+    {
+        push_helper(binder_function1<void, Arg1>(f, a1));
+    }
+
+    template <typename Arg1, typename Arg2>
+    void push_function (void (* f) (Arg1, Arg2), Arg1 a1, Arg2 a2)
+    {
+        push_helper(binder_function2<void, Arg1, Arg2>(f, a1, a2));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3>
+    void push_function (void (* f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push_helper(binder_function3<void, Arg1, Arg2, Arg3>(f, a1, a2, a3));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
+    {
+        push_helper(binder_function4<void, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
+    {
+        push_helper(binder_function5<void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
+    {
+        push_helper(binder_function6<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, a1, a2, a3, a4, a5, a6));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
+    {
+        push_helper(binder_function7<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, a1, a2, a3, a4, a5, a6, a7));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
+    {
+        push_helper(binder_function8<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, a1, a2, a3, a4, a5, a6, a7, a8));
+    }
+
+    template <typename C>
+    void push_method (void (C::* f) (), C * c)
+    {
+        push_helper(binder_method0<C, void>(f, c));
+    }
+
+    template <typename C, typename Arg1>
+    void push_method (void (C::* f) (Arg1), C * c, Arg1 a1)
+    {
+        push_helper(binder_method1<C, void, Arg1>(f, c, a1));
+    }
+
+    template <typename C, typename Arg1, typename Arg2>
+    void push_method (void (C::* f) (Arg1, Arg2), C * c, Arg1 a1, Arg2 a2)
+    {
+        push_helper(binder_method2<C, void, Arg1, Arg2>(f, c, a1, a2));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3), C * c, Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push_helper(binder_method3<C, void, Arg1, Arg2, Arg3>(f, c, a1, a2, a3));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
+    {
+        push_helper(binder_method4<C, void, Arg1, Arg2, Arg3, Arg4>(f, c, a1, a2, a3, a4));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
+    {
+        push_helper(binder_method5<C, void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, c, a1, a2, a3, a4, a5));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
+    {
+        push_helper(binder_method6<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, c, a1, a2, a3, a4, a5, a6));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
+    {
+        push_helper(binder_method7<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, c, a1, a2, a3, a4, a5, a6, a7));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
+    {
+        push_helper(binder_method8<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, c, a1, a2, a3, a4, a5, a6, a7, a8));
+    }
+//#endif
+};
+
+/**
+ * @brief Adapter for thread_pool with active_queue's interface, used as
+ *        sigslot's ActiveQueue to execute async slots by pool workers:
+ *        `pfs::sigslot<pfs::thread_pool_queue>`.
+ *
+ * @details Default constructed adapter pushes jobs into
+ *          thread_pool::default_pool(). Jobs are executed by
+ *          pool workers, so `call*` methods do nothing.
+ *
+ *          Jobs still queued when the adapter is cancelled or destroyed
+ *          are dropped, and cancel() waits for jobs in progress.
+ *          The adapter is owned by has_async_slots base, so it is
+ *          destroyed after the receiver's own members: receiver whose
+ *          slots may still be executing must call cancel() for its
+ *          callback_queue() and priority_callback_queue() at the start
+ *          of its destructor. cancel() must not be called from the
+ *          receiver's slot.
+ */
+class thread_pool_queue : noncopyable
+{
+    struct state
+    {
+        pfs::mutex         mutex;
+        condition_variable cond;
+        size_t             running;
+        bool               cancelled;
+
+        state () : running(0), cancelled(false) {}
+    };
+
+    template <typename Binder>
+    class guarded_binder : public binder_base<void>
+    {
+        pfs::shared_ptr<state> _state;
+        Binder                 _b;
+
+    public:
+        guarded_binder (pfs::shared_ptr<state> const & st, Binder const & b)
+            : binder_base<void>(sizeof(guarded_binder))
+            , _state(st)
+            , _b(b)
+        {}
+
+        virtual void operator () () const
+        {
+            {
+                unique_lock<pfs::mutex> locker(_state->mutex);
+
+                if (_state->cancelled)
+                    return;
+
+                ++_state->running;
+            }
+
+            _b();
+
+            unique_lock<pfs::mutex> locker(_state->mutex);
+
+            if (--_state->running == 0)
+                _state->cond.notify_all();
+        }
+    };
+
+    thread_pool *          _pool;
+    pfs::shared_ptr<state> _state;
+
+private:
+    template <typename Binder>
+    void push (Binder const & b)
+    {
+        _pool->push(guarded_binder<Binder>(_state, b));
+    }
+
+public:
+    thread_pool_queue ()
+        : _pool(& thread_pool::default_pool())
+        , _state(pfs::make_shared<state>())
+    {}
+
+    explicit thread_pool_queue (thread_pool & pool)
+        : _pool(& pool)
+        , _state(pfs::make_shared<state>())
+    {}
+
+    ~thread_pool_queue ()
+    {
+        cancel();
+    }
+
+    thread_pool & pool () { return *_pool; }
+
+    /**
+     * @brief Drops queued jobs and waits for jobs in progress.
+     *        Jobs pushed after cancel() are dropped too.
+     */
+    void cancel ()
+    {
+        unique_lock<pfs::mutex> locker(_state->mutex);
+        _state->cancelled = true;
+
+        while (_state->running > 0)
+            _state->cond.wait(locker);
+    }
+
+    bool empty () const
+    {
+        return _pool->count() == 0;
+    }
+
+    size_t count () const
+    {
+        return _pool->count();
+    }
+
+    void call () {}
+    void call (int) {}
+    void call_all () {}
+
+    void push_function (void (* f) ())
+    {
+        push(binder_function0<void>(f));
+    }
+
+    template <typename Arg1>
+    void push_function (void (* f) (Arg1), Arg1 a1)
+    {
+        push(binder_function1<void, Arg1>(f, a1));
+    }
+
+    template <typename Arg1, typename Arg2>
+    void push_function (void (* f) (Arg1, Arg2), Arg1 a1, Arg2 a2)
+    {
+        push(binder_function2<void, Arg1, Arg2>(f, a1, a2));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3>
+    void push_function (void (* f) (Arg1, Arg2, Arg3), Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push(binder_function3<void, Arg1, Arg2, Arg3>(f, a1, a2, a3));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
+    {
+        push(binder_function4<void, Arg1, Arg2, Arg3, Arg4>(f, a1, a2, a3, a4));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
+    {
+        push(binder_function5<void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, a1, a2, a3, a4, a5));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
+    {
+        push(binder_function6<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, a1, a2, a3, a4, a5, a6));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
+    {
+        push(binder_function7<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, a1, a2, a3, a4, a5, a6, a7));
+    }
+
+    template <typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
+    void push_function (void (* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
+    {
+        push(binder_function8<void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, a1, a2, a3, a4, a5, a6, a7, a8));
+    }
+
+    template <typename C>
+    void push_method (void (C::* f) (), C * c)
+    {
+        push(binder_method0<C, void>(f, c));
+    }
+
+    template <typename C, typename Arg1>
+    void push_method (void (C::* f) (Arg1), C * c, Arg1 a1)
+    {
+        push(binder_method1<C, void, Arg1>(f, c, a1));
+    }
+
+    template <typename C, typename Arg1, typename Arg2>
+    void push_method (void (C::* f) (Arg1, Arg2), C * c, Arg1 a1, Arg2 a2)
+    {
+        push(binder_method2<C, void, Arg1, Arg2>(f, c, a1, a2));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3), C * c, Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push(binder_method3<C, void, Arg1, Arg2, Arg3>(f, c, a1, a2, a3));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4)
+    {
+        push(binder_method4<C, void, Arg1, Arg2, Arg3, Arg4>(f, c, a1, a2, a3, a4));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5)
+    {
+        push(binder_method5<C, void, Arg1, Arg2, Arg3, Arg4, Arg5>(f, c, a1, a2, a3, a4, a5));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6)
+    {
+        push(binder_method6<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6>(f, c, a1, a2, a3, a4, a5, a6));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7)
+    {
+        push(binder_method7<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7>(f, c, a1, a2, a3, a4, a5, a6, a7));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8), C * c, Arg1 a1, Arg2 a2, Arg3 a3, Arg4 a4, Arg5 a5, Arg6 a6, Arg7 a7, Arg8 a8)
+    {
+        push(binder_method8<C, void, Arg1, Arg2, Arg3, Arg4, Arg5, Arg6, Arg7, Arg8>(f, c, a1, a2, a3, a4, a5, a6, a7, a8));
+    }
+};
+
+} // pfs
@@ -0,0 +1,500 @@
+#pragma once
+#include <time.h>
+#include <vector>
+#include <pfs/types.hpp>
+#include <pfs/assert.hpp>
+#include <pfs/noncopyable.hpp>
+#include <pfs/bits/timer.h>
+
+namespace pfs {
+
+/**
+ * @brief Hierarchical timing wheel.
+ *
+ * @details Timers are stored in four wheels of 256 slots each (the first
+ *          wheel keeps timers expiring during next 256 ticks, the second
+ *          during next 256^2 ticks and so on), so arming and cancelling
+ *          of timer takes constant time independently of number of timers.
+ *          Timers of upper wheels are cascaded down when the lower wheel
+ *          wraps around. Timeouts longer than 256^4 ticks are re-cascaded
+ *          through the top wheel.
+ *
+ *          Timing wheel does not use signals or background threads:
+ *          the owner (event loop) sleeps for next_timeout() seconds
+ *          (on poll(), condition variable etc.) and then calls expire().
+ *
+ *          Timing wheel is not thread-safe.
+ *
+ * @tparam T Type of value associated with timer.
+ */
+template <typename T = int>
+class timer_wheel : noncopyable
+{
+public:
+    typedef T        value_type;
+    typedef uint64_t id_type;
+    typedef uint64_t tick_type;
+    typedef size_t   size_type;
+
+    static id_type const invalid_id = 0;
+
+private:
+    static int      const wheel_count = 4;
+    static int      const wheel_bits  = 8;
+    static uint32_t const wheel_size  = 1 << wheel_bits;
+    static uint32_t const wheel_mask  = wheel_size - 1;
+    static uint32_t const nil         = 0xFFFFFFFF;
+
+    struct node
+    {
+        uint32_t   next;
+        uint32_t   prev;
+        uint32_t   generation;
+        uint8_t    wheel;
+        uint8_t    slot;
+        bool       active;
+        tick_type  expire;
+        tick_type  period;   // Zero for one-shot timer
+        value_type value;
+    };
+
+    std::vector<node>     _nodes;
+    uint32_t              _free;     // Head of free nodes list (linked by `next`)
+    uint32_t              _slots[wheel_count][wheel_size];
+    size_type             _count;
+    uint32_t              _resolution; // Tick duration in microseconds
+    tick_type             _now;        // Last processed tick
+
+private:
+    static id_type make_id (uint32_t index, uint32_t generation)
+    {
+        return (static_cast<id_type>(generation) << 32) | (static_cast<id_type>(index) + 1);
+    }
+
+    node * find (id_type id)
+    {
+        uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+
+        if (index == 0 || index > _nodes.size())
+            return 0;
+
+        node * n = & _nodes[index - 1];
+
+        if (!n->active || n->generation != static_cast<uint32_t>(id >> 32))
+            return 0;
+
+        return n;
+    }
+
+    node const * find (id_type id) const
+    {
+        return const_cast<timer_wheel *>(this)->find(id);
+    }
+
+    uint32_t index_of (node const * n) const
+    {
+        return static_cast<uint32_t>(n - & _nodes[0]);
+    }
+
+    void link (uint32_t index)
+    {
+        node & n = _nodes[index];
+        tick_type delta = n.expire > _now ? n.expire - _now : 0;
+        tick_type e = n.expire;
+        int w = 0;
+
+        // Find the lowest wheel which covers the delta
+        while (w < wheel_count - 1 && delta >= (tick_type(1) << (wheel_bits * (w + 1))))
+            ++w;
+
+        // Timeout is out of range: place timer into the farthest slot,
+        // it will be re-cascaded.
+        if (w == wheel_count - 1 && delta >= (tick_type(1) << (wheel_bits * wheel_count)))
+            e = _now + (tick_type(1) << (wheel_bits * wheel_count)) - 1;
+
+        n.wheel = static_cast<uint8_t>(w);
+        n.slot  = static_cast<uint8_t>((e >> (wheel_bits * w)) & wheel_mask);
+
+        uint32_t & head = _slots[w][n.slot];
+        n.prev = nil;
+        n.next = head;
+
+        if (head != nil)
+            _nodes[head].prev = index;
+
+        head = index;
+    }
+
+    void unlink (uint32_t index)
+    {
+        node & n = _nodes[index];
+
+        if (n.prev != nil)
+            _nodes[n.prev].next = n.next;
+        else
+            _slots[n.wheel][n.slot] = n.next;
+
+        if (n.next != nil)
+            _nodes[n.next].prev = n.prev;
+
+        n.next = nil;
+        n.prev = nil;
+    }
+
+    void release (uint32_t index)
+    {
+        node & n = _nodes[index];
+        n.active = false;
+        n.value  = value_type();
+        ++n.generation;
+        n.next = _free;
+        _free = index;
+        --_count;
+    }
+
+    void cascade (int w)
+    {
+        uint32_t & head = _slots[w][(_now >> (wheel_bits * w)) & wheel_mask];
+        uint32_t index = head;
+
+        head = nil;
+
+        while (index != nil) {
+            uint32_t next = _nodes[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    tick_type to_ticks (double seconds) const
+    {
+        double ticks = seconds * 1000000.0 / _resolution;
+        return ticks < 1.0 ? 1 : static_cast<tick_type>(ticks + 0.5);
+    }
+
+public:
+    /**
+     * @param resolution Tick duration in microseconds.
+     */
+    explicit timer_wheel (uint32_t resolution = 1000)
+        : _free(nil)
+        , _count(0)
+        , _resolution(resolution > 0 ? resolution : 1)
+        , _now(0)
+    {
+        for (int w = 0; w < wheel_count; ++w)
+            for (uint32_t i = 0; i < wheel_size; ++i)
+                _slots[w][i] = nil;
+
+        _now = clock();
+    }
+
+    /**
+     * @return Current value of the monotonic clock in ticks.
+     */
+    tick_type clock () const
+    {
+        struct timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, & ts);
+        return (static_cast<tick_type>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000) / _resolution;
+    }
+
+    /**
+     * @return Last processed tick.
+     */
+    tick_type now () const
+    {
+        return _now;
+    }
+
+    uint32_t resolution () const
+    {
+        return _resolution;
+    }
+
+    size_type size () const
+    {
+        return _count;
+    }
+
+    bool empty () const
+    {
+        return _count == 0;
+    }
+
+    /**
+     * @brief Reserves storage for @a n timers.
+     */
+    void reserve (size_type n)
+    {
+        _nodes.reserve(n);
+    }
+
+    /**
+     * @brief Arms new timer.
+     *
+     * @param type Timer type (Timer_OneShot or Timer_Periodic).
+     * @param seconds Timeout (period for periodic timer).
+     * @param value Value associated with timer.
+     * @return Timer identifier or invalid_id if @a type is invalid.
+     */
+    id_type start (timer_type_enum type
+            , double seconds
+            , value_type const & value = value_type())
+    {
+        tick_type ticks = to_ticks(seconds);
+        tick_type current = clock();
+
+        // Timeout is counted from the current time
+        // (not from the last processed tick)
+        if (current > _now)
+            ticks += current - _now;
+
+        id_type id = start_after(type, ticks, value);
+
+        if (id != invalid_id && type == Timer_Periodic)
+            find(id)->period = to_ticks(seconds);
+
+        return id;
+    }
+
+    /**
+     * @brief Arms new timer with timeout specified in ticks
+     *        counting from the last processed tick (see now()).
+     */
+    id_type start_after (timer_type_enum type
+            , tick_type ticks
+            , value_type const & value = value_type())
+    {
+        if (type != Timer_OneShot && type != Timer_Periodic)
+            return invalid_id;
+
+        if (ticks == 0)
+            ticks = 1;
+
+        uint32_t index = _free;
+
+        if (index != nil) {
+            _free = _nodes[index].next;
+        } else {
+            PFS_ASSERT(_nodes.size() < nil);
+            index = static_cast<uint32_t>(_nodes.size());
+            _nodes.push_back(node());
+            _nodes[index].generation = 0;
+        }
+
+        node & n  = _nodes[index];
+        n.active  = true;
+        n.expire  = _now + ticks;
+        n.period  = type == Timer_Periodic ? ticks : 0;
+        n.value   = value;
+
+        link(index);
+        ++_count;
+
+        return make_id(index, n.generation);
+    }
+
+    /**
+     * @brief Cancels timer.
+     * @return @c false if timer is not active (already expired or cancelled).
+     */
+    bool stop (id_type id)
+    {
+        node * n = find(id);
+
+        if (!n)
+            return false;
+
+        uint32_t index = index_of(n);
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /**
+     * @brief Cancels all timers.
+     */
+    void clear ()
+    {
+        for (uint32_t i = 0; i < _nodes.size(); ++i) {
+            if (_nodes[i].active) {
+                unlink(i);
+                release(i);
+            }
+        }
+    }
+
+    bool is_active (id_type id) const
+    {
+        return find(id) != 0;
+    }
+
+    bool is_periodic (id_type id) const
+    {
+        node const * n = find(id);
+        return n && n->period > 0;
+    }
+
+    /**
+     * @return Pointer to value associated with timer or @c null
+     *         if timer is not active.
+     */
+    value_type * value (id_type id)
+    {
+        node * n = find(id);
+        return n ? & n->value : 0;
+    }
+
+    /**
+     * @brief Returns number of ticks until the nearest timer expiration.
+     *
+     * @details Result may be less than real value if the nearest timer
+     *          resides in upper wheel (at the moment of its cascading).
+     *
+     * @return @c true if there are armed timers.
+     */
+    bool next_expiration (tick_type & ticks) const
+    {
+        if (_count == 0)
+            return false;
+
+        bool found = false;
+
+        for (int w = 0; w < wheel_count; ++w) {
+            int shift = wheel_bits * w;
+            tick_type base = _now >> shift;
+
+            // For the first wheel it is the nearest expiration,
+            // for upper wheels - the nearest cascading
+            // (slots equal to the current ones are already processed).
+            for (uint32_t i = 1; i <= wheel_size; ++i) {
+                tick_type t = base + i;
+
+                if (_slots[w][t & wheel_mask] != nil) {
+                    t <<= shift;
+                    tick_type d = t > _now ? t - _now : 0;
+
+                    if (!found || d < ticks)
+                        ticks = d;
+
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    /**
+     * @brief Returns time in seconds until the nearest timer expiration
+     *        (according to the current time).
+     * @return Zero if one or more timers already expired,
+     *         negative value if there are no armed timers.
+     */
+    double next_timeout () const
+    {
+        tick_type ticks = 0;
+
+        if (!next_expiration(ticks))
+            return -1.0;
+
+        tick_type deadline = _now + ticks;
+        tick_type current = clock();
+
+        if (deadline <= current)
+            return 0.0;
+
+        return static_cast<double>(deadline - current) * _resolution / 1000000.0;
+    }
+
+    /**
+     * @brief Processes timers expired up to the current time.
+     *
+     * @details For each expired timer calls @a f (id, value).
+     *          Callback can start and stop timers (including the expired
+     *          one). One-shot timer is released before calling callback
+     *          (is_active(id) returns @c false), periodic timer is re-armed.
+     *
+     * @return Number of expired timers.
+     */
+    template <typename Callback>
+    size_type expire (Callback & f)
+    {
+        return expire_until(clock(), f);
+    }
+
+    /**
+     * @brief Processes timers expired up to the @a tick.
+     */
+    template <typename Callback>
+    size_type expire_until (tick_type tick, Callback & f)
+    {
+        size_type result = 0;
+
+        while (_now < tick) {
+            // Nothing to do, skip ticks
+            if (_count == 0) {
+                _now = tick;
+                break;
+            }
+
+            ++_now;
+
+            uint32_t slot = static_cast<uint32_t>(_now & wheel_mask);
+
+            // Cascade timers from upper wheels
+            if (slot == 0) {
+                for (int w = 1; w < wheel_count; ++w) {
+                    cascade(w);
+
+                    if (((_now >> (wheel_bits * w)) & wheel_mask) != 0)
+                        break;
+                }
+            }
+
+            uint32_t & head = _slots[0][slot];
+
+            while (head != nil) {
+                uint32_t index = head;
+                unlink(index);
+
+                node & n = _nodes[index];
+                id_type id = make_id(index, n.generation);
+
+                // Out-of-range timer placed into first wheel
+                // after cascading must wait yet
+                if (n.expire > _now) {
+                    link(index);
+                    continue;
+                }
+
+                ++result;
+
+                // Callback can start new timers (and reallocate nodes),
+                // so pass copy of value.
+                value_type value = n.value;
+
+                // Re-arm periodic timer before calling callback,
+                // so callback can stop it. One-shot timer is released
+                // before calling callback.
+                if (n.period > 0) {
+                    n.expire = _now + n.period;
+                    link(index);
+                } else {
+                    release(index);
+                }
+
+                f(id, value);
+            }
+        }
+
+        return result;
+    }
+};
+
+template <typename T>
+typename timer_wheel<T>::id_type const timer_wheel<T>::invalid_id;
+
+} // pfs
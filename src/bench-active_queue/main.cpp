@@ -0,0 +1,162 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include "pfs/test.hpp"
+#include "pfs/deque.hpp"
+#include "pfs/memory.hpp"
+#include "pfs/mutex.hpp"
+#include "pfs/active_queue.hpp"
+
+//
+// Compares push+call throughput of callables stored as heap-allocated
+// binders held by shared_ptr (storage used by active_queue before
+// inplace_binder) and binders stored in place (inplace_binder).
+// Results for active_queue itself are given for reference.
+//
+
+static int const BATCH_SIZE = 64;
+
+static int counter = 0;
+
+static void func1 (int a)
+{
+    counter += a;
+}
+
+class A
+{
+public:
+    int value;
+
+    A () : value(0) {}
+
+    void method3 (int a, int b, double c)
+    {
+        value += a + b + static_cast<int>(c);
+    }
+};
+
+// Mutex protected FIFO of callables, `Callable` is either shared_ptr
+// to heap-allocated binder (former storage of active_queue) or
+// inplace_binder.
+template <typename Callable>
+class locked_queue
+{
+    typedef Callable value_type;
+
+    pfs::deque<value_type> _q;
+    pfs::mutex _mutex;
+
+private:
+    template <typename Binder>
+    static void assign (pfs::shared_ptr<pfs::binder_base<void> > & target, Binder const & b)
+    {
+        target = pfs::shared_ptr<pfs::binder_base<void> >(new Binder(b));
+    }
+
+    template <typename Binder>
+    static void assign (pfs::inplace_binder<void> & target, Binder const & b)
+    {
+        target.assign(b);
+    }
+
+    template <typename Binder>
+    void push_helper (Binder const & b)
+    {
+        pfs::unique_lock<pfs::mutex> locker(_mutex);
+        _q.push_back(value_type());
+        assign(_q.back(), b);
+    }
+
+    static void invoke (pfs::shared_ptr<pfs::binder_base<void> > const & c)
+    {
+        (*c)();
+    }
+
+    static void invoke (pfs::inplace_binder<void> const & c)
+    {
+        c();
+    }
+
+public:
+    template <typename Arg1>
+    void push_function (void (* f) (Arg1), Arg1 a1)
+    {
+        push_helper(pfs::binder_function1<void, Arg1>(f, a1));
+    }
+
+    template <typename C, typename Arg1, typename Arg2, typename Arg3>
+    void push_method (void (C::* f) (Arg1, Arg2, Arg3), C * c, Arg1 a1, Arg2 a2, Arg3 a3)
+    {
+        push_helper(pfs::binder_method3<C, void, Arg1, Arg2, Arg3>(f, c, a1, a2, a3));
+    }
+
+    void call_all ()
+    {
+        pfs::unique_lock<pfs::mutex> locker(_mutex);
+
+        while (!_q.empty()) {
+            value_type c;
+            std::swap(c, _q.front());
+            _q.pop_front();
+
+            locker.unlock();
+            invoke(c);
+            locker.lock();
+        }
+    }
+};
+
+template <typename Queue>
+static double bench (Queue & q, int n)
+{
+    A a;
+    pfs::test::profiler sw;
+
+    for (int i = 0; i < n; i += BATCH_SIZE) {
+        for (int j = 0; j < BATCH_SIZE; j += 2) {
+            q.push_function(& func1, j);
+            q.push_method(& A::method3, & a, i, j, 1.0);
+        }
+
+        q.call_all();
+    }
+
+    return sw.ellapsed();
+}
+
+static void print (char const * title, int n, double sec, double base_sec)
+{
+    std::cout << '\t' << title << ": "
+            << static_cast<long>(n / sec) << " calls/s"
+            << " (x" << base_sec / sec << ")\n";
+}
+
+int main (int argc, char * argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 2000000;
+
+    locked_queue<pfs::shared_ptr<pfs::binder_base<void> > > q0;
+    locked_queue<pfs::inplace_binder<void> > q1;
+    pfs::active_queue<pfs::deque> q2;
+
+    double shared_sec  = bench(q0, n);
+    double inplace_sec = bench(q1, n);
+    double deque_sec   = bench(q2, n);
+
+    std::cout << "Push+call (single thread, batch " << BATCH_SIZE << "):\n";
+    print("shared_ptr binder             ", n, shared_sec, shared_sec);
+    print("inplace_binder                ", n, inplace_sec, shared_sec);
+    print("active_queue<pfs::deque>      ", n, deque_sec, shared_sec);
+
+#if __cplusplus >= 201103L
+    pfs::active_queue<pfs::mpmc_queue> q3;
+    double mpmc_sec = bench(q3, n);
+    print("active_queue<pfs::mpmc_queue> ", n, mpmc_sec, shared_sec);
+#endif
+
+    std::cout << "\tsizeof(inplace_binder<void>): "
+            << sizeof(pfs::inplace_binder<void>) << " bytes\n";
+
+    return EXIT_SUCCESS;
+}
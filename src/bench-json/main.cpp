@@ -0,0 +1,240 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include "pfs/test.hpp"
+#include "pfs/string.hpp"
+#include "pfs/json/json.hpp"
+
+//
+// Compares throughput (MB/s) and number of memory allocations of JSON
+// parsing by:
+//      - FSM-based grammar (rfc7159.hpp, used by json::parse() before
+//        pfs::json::parser);
+//      - pfs::json::parser with copying SAX interface (sax_context,
+//        dom_builder_context);
+//      - pfs::json::parser with dom_builder (json::parse()).
+//
+// Corpora are generated to resemble well-known benchmark files:
+//      twitter - objects with many short strings (including non-ASCII
+//                and escaped characters) and large integers;
+//      citm    - deeply nested objects with integer values and short keys;
+//      canada  - arrays of floating point coordinates.
+//
+// Real files can be given in command line instead:
+//      pfs-bench-json [FILE...]
+//
+
+typedef pfs::json::json<> json_type;
+typedef json_type::string_type string_type;
+
+static int const ITERATIONS = 20;
+
+static size_t allocations = 0;
+
+void * operator new (size_t n)
+{
+    ++allocations;
+    void * p = std::malloc(n ? n : 1);
+
+    if (!p)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete (void * p) throw()
+{
+    std::free(p);
+}
+
+static pfs::error_code fsm_parse (json_type & j, string_type const & s)
+{
+    typedef pfs::json::grammar<json_type> grammar_type;
+    typedef grammar_type::fsm_type fsm_type;
+
+    static grammar_type grammar;
+
+    pfs::json::dom_builder_context<json_type> sax(j);
+    grammar_type::parse_context context;
+    context.sax = & sax;
+
+    fsm_type fsm(grammar.p_json_tr, & context);
+    fsm_type::result_type r = fsm.exec(0, s.cbegin(), s.cend());
+
+    if (r.first && r.second == s.cend())
+        return pfs::error_code();
+
+    return context.ec ? context.ec : pfs::make_error_code(pfs::json_errc::bad_json);
+}
+
+static pfs::error_code sax_parse (json_type & j, string_type const & s)
+{
+    typedef pfs::json::sax_context_adapter<json_type> adapter_type;
+
+    pfs::json::dom_builder_context<json_type> sax(j);
+    adapter_type adapter(sax);
+    pfs::json::parser<adapter_type> p;
+
+    return p.parse(adapter, s.data(), s.data() + s.size());
+}
+
+static pfs::error_code parser_parse (json_type & j, string_type const & s)
+{
+    return j.parse(s);
+}
+
+static string_type twitter_corpus (int n)
+{
+    std::ostringstream os;
+    os << "{\"statuses\":[";
+
+    for (int i = 0; i < n; ++i) {
+        if (i > 0)
+            os << ',';
+
+        os << "{\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\""
+           << ",\"id\":" << 505874924095815681ULL + i
+           << ",\"id_str\":\"" << 505874924095815681ULL + i << "\""
+           << ",\"text\":\"@aym0566x \\n\\n\u540d\u524d:\u524d\u7530\u3042\u3086\u307f"
+              "\\n\u7b2c\u4e00\u5370\u8c61:\u306a\u3093\u304b\u6016\u3063\uff01 http:\\/\\/t.co\\/abc #" << i << "\""
+           << ",\"source\":\"<a href=\\\"https://mobile.twitter.com\\\" rel=\\\"nofollow\\\">Mobile Web (M2)</a>\""
+           << ",\"truncated\":false"
+           << ",\"in_reply_to_status_id\":null"
+           << ",\"user\":{\"id\":" << 1186275104 + i
+           << ",\"name\":\"AYUMI\",\"screen_name\":\"ayuu0123\",\"location\":\"\""
+           << ",\"description\":\"\u5143\u91ce\u7403\u90e8\u30de\u30cd\u30fc\u30b8\u30e3\u30fc\u2764\ufe0e\u2026 \\u2606\""
+           << ",\"followers_count\":262,\"friends_count\":252,\"verified\":false"
+           << ",\"lang\":\"ja\",\"profile_background_color\":\"C0DEED\"}"
+           << ",\"retweet_count\":" << i % 100
+           << ",\"favorite_count\":" << i % 7
+           << ",\"entities\":{\"hashtags\":[],\"symbols\":[],\"urls\":[]"
+           << ",\"user_mentions\":[{\"screen_name\":\"aym0566x\",\"indices\":[0,9]}]}"
+           << ",\"favorited\":false,\"retweeted\":false,\"lang\":\"ja\"}";
+    }
+
+    os << "]}";
+    return string_type(os.str());
+}
+
+static string_type citm_corpus (int n)
+{
+    std::ostringstream os;
+    os << "{\"events\":{";
+
+    for (int i = 0; i < n; ++i) {
+        if (i > 0)
+            os << ',';
+
+        os << "\"" << 138586341 + i << "\":{"
+           << "\"description\":null,\"id\":" << 138586341 + i
+           << ",\"logo\":null,\"name\":\"30th Anniversary Tour\""
+           << ",\"subTopicIds\":[337184284,337184263,337184298,337184269]"
+           << ",\"subjectCode\":null,\"subtitle\":null"
+           << ",\"topicIds\":[324846099,107888604,324846100]"
+           << ",\"seatCategories\":[{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]}"
+           << ",{\"areaId\":205705998,\"blockIds\":[]}],\"seatCategoryId\":338937295}]"
+           << ",\"prices\":[{\"amount\":90250,\"audienceSubCategoryId\":337100890"
+           << ",\"seatCategoryId\":338937295}]}";
+    }
+
+    os << "}}";
+    return string_type(os.str());
+}
+
+static string_type canada_corpus (int n)
+{
+    std::ostringstream os;
+    os.precision(15);
+    os << "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\""
+       << ",\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\""
+       << ",\"coordinates\":[[";
+
+    for (int i = 0; i < n; ++i) {
+        if (i > 0)
+            os << ',';
+
+        os << '[' << -65.613616999999977 + i * 0.000123456789
+           << ',' << 43.420273000000009 - i * 0.000987654321 << ']';
+    }
+
+    os << "]]}}]}";
+    return string_type(os.str());
+}
+
+static double bench (pfs::error_code (* parse) (json_type &, string_type const &)
+        , string_type const & s
+        , bool & ok
+        , size_t & allocs)
+{
+    pfs::test::profiler sw;
+    size_t saved = allocations;
+
+    for (int i = 0; i < ITERATIONS; ++i) {
+        json_type j;
+        ok = !parse(j, s);
+    }
+
+    double result = sw.ellapsed();
+    allocs = (allocations - saved) / ITERATIONS;
+    return result;
+}
+
+static void print (char const * title
+        , double mb
+        , double sec
+        , double base_sec
+        , bool ok
+        , size_t allocs)
+{
+    std::cout << '\t' << title << ": " << mb / sec << " MB/s"
+            << " (x" << base_sec / sec << "), "
+            << allocs << " allocations"
+            << (ok ? "" : " (parse error)") << "\n";
+}
+
+static void run (char const * title, string_type const & s)
+{
+    bool fsm_ok = false;
+    bool sax_ok = false;
+    bool parser_ok = false;
+    size_t fsm_allocs = 0;
+    size_t sax_allocs = 0;
+    size_t parser_allocs = 0;
+    double mb = static_cast<double>(s.size()) * ITERATIONS / (1024 * 1024);
+
+    double fsm_sec    = bench(fsm_parse, s, fsm_ok, fsm_allocs);
+    double sax_sec    = bench(sax_parse, s, sax_ok, sax_allocs);
+    double parser_sec = bench(parser_parse, s, parser_ok, parser_allocs);
+
+    std::cout << title << " (" << s.size() / 1024 << " KB):\n";
+    print("fsm grammar           ", mb, fsm_sec, fsm_sec, fsm_ok, fsm_allocs);
+    print("parser + sax_context  ", mb, sax_sec, fsm_sec, sax_ok, sax_allocs);
+    print("parser + dom_builder  ", mb, parser_sec, fsm_sec, parser_ok, parser_allocs);
+}
+
+int main (int argc, char * argv[])
+{
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            std::ifstream ifs(argv[i], std::ios::binary);
+
+            if (!ifs) {
+                std::cerr << "Failed to open file: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            std::ostringstream os;
+            os << ifs.rdbuf();
+            run(argv[i], string_type(os.str()));
+        }
+    } else {
+        run("twitter", twitter_corpus(1000));
+        run("citm"   , citm_corpus(2000));
+        run("canada" , canada_corpus(20000));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cstdlib>
+#include "pfs/test.hpp"
+#include "pfs/string.hpp"
+#include "pfs/logger.hpp"
+
+typedef pfs::log<>  log_ns;
+typedef pfs::string string_t;
+
+//
+// Compares throughput of pattern interpreter (reparses pattern for every
+// line) and precompiled pattern (pattern compiled once by `set_pattern`).
+//
+
+class null_appender : public log_ns::appender
+{
+public:
+    size_t nbytes;
+
+    null_appender () : log_ns::appender(), nbytes(0) {}
+
+    virtual bool is_open () const
+    {
+        return true;
+    }
+
+    void print_interpreted (log_ns::priority level
+            , pfs::datetime const & dt
+            , string_t const & msg)
+    {
+        print(level, dt, patternify(this, level, dt, _pattern, msg));
+    }
+
+    void print_compiled (log_ns::priority level
+            , pfs::datetime const & dt
+            , string_t const & msg)
+    {
+        print_helper(level, dt, msg);
+    }
+
+protected:
+    virtual void print (log_ns::priority, pfs::datetime const &, string_t const & msg)
+    {
+        nbytes += msg.size();
+    }
+};
+
+static void bench (char const * pattern, int nlines)
+{
+    null_appender a;
+    a.set_pattern(pattern);
+
+    pfs::datetime dt = pfs::current_datetime();
+    string_t msg("The quick brown fox jumps over the lazy dog");
+    log_ns::priority pri(log_ns::priority::info);
+
+    pfs::test::profiler sw;
+
+    for (int i = 0; i < nlines; ++i)
+        a.print_interpreted(pri, dt, msg);
+
+    double interpreted_sec = sw.ellapsed();
+
+    sw.start();
+
+    for (int i = 0; i < nlines; ++i)
+        a.print_compiled(pri, dt, msg);
+
+    double compiled_sec = sw.ellapsed();
+
+    std::cout << "Pattern \"" << pattern << "\":\n"
+            << "\tinterpreted: " << static_cast<long>(nlines / interpreted_sec) << " lines/s\n"
+            << "\tcompiled   : " << static_cast<long>(nlines / compiled_sec) << " lines/s\n"
+            << "\tspeedup    : " << interpreted_sec / compiled_sec << "\n";
+}
+
+int main (int argc, char * argv[])
+{
+    int nlines = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    bench("%m", nlines);
+    bench("[%p]: %m", nlines);
+    bench("%d{ABSOLUTE} [%p]: %m", nlines);
+    bench("%d{ISO8601} [%p]: %m", nlines);
+    bench("%d{%d/%m/%Y %H:%M:%S} [%-5p]: %20.30m", nlines);
+
+    return EXIT_SUCCESS;
+}
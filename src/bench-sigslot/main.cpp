@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cstdlib>
+#include "pfs/test.hpp"
+#include "pfs/atomic.hpp"
+#include "pfs/thread.hpp"
+#include "pfs/sigslot.hpp"
+
+//
+// Compares emission throughput (millions of emissions per second) of
+// signal with one argument connected to several slots by many threads:
+//      - pfs::sigslot - emission locks the signal's mutex;
+//      - pfs::snapshot_sigslot - emission reads immutable snapshot
+//        of connections without locking.
+//
+// Each case is run without writers and with one thread which connects
+// and disconnects slot continuously.
+//
+//      pfs-bench-sigslot [EMISSIONS_PER_THREAD]
+//
+
+static int const SLOTS = 4;
+static int const MAX_THREADS = 16;
+
+static int emissions = 200000;
+
+template <typename Sigslot>
+class slot : public Sigslot::has_slots
+{
+public:
+    slot () {}
+
+    ~slot ()
+    {
+        this->disconnect_all();
+    }
+
+    void on_value (int v)
+    {
+        // Do not share anything between emitters, only emission
+        // itself is measured.
+        int volatile x = v;
+        (void)x;
+    }
+};
+
+template <typename Sigslot>
+struct bench
+{
+    typedef typename Sigslot::template signal1<int> signal_type;
+    typedef slot<Sigslot> slot_type;
+
+    static void emitter (signal_type * sig)
+    {
+        for (int i = 0; i < emissions; ++i)
+            sig->emit_(i);
+    }
+
+    static void writer (signal_type * sig, pfs::atomic_int * stop, int * changes)
+    {
+        int n = 0;
+
+        while (!stop->load()) {
+            slot_type s;
+            sig->connect(& s, & slot_type::on_value);
+            sig->disconnect(& s);
+            ++n;
+        }
+
+        *changes = n;
+    }
+
+    static double run (int nthreads, bool with_writer, int & changes)
+    {
+        signal_type sig;
+        slot_type slots[SLOTS];
+        pfs::thread threads[MAX_THREADS];
+        pfs::thread writer_thread;
+        pfs::atomic_int stop(0);
+
+        changes = 0;
+
+        for (int i = 0; i < SLOTS; ++i)
+            sig.connect(& slots[i], & slot_type::on_value);
+
+        if (with_writer)
+            writer_thread = pfs::thread(writer, & sig, & stop, & changes);
+
+        pfs::test::profiler sw;
+
+        for (int i = 0; i < nthreads; ++i)
+            threads[i] = pfs::thread(emitter, & sig);
+
+        for (int i = 0; i < nthreads; ++i)
+            threads[i].join();
+
+        double sec = sw.ellapsed();
+
+        if (with_writer) {
+            stop.store(1);
+            writer_thread.join();
+        }
+
+        return sec;
+    }
+};
+
+static void print (char const * title, int nthreads, double sec, int changes)
+{
+    double memits = static_cast<double>(nthreads) * emissions / sec / 1000000;
+
+    std::cout << '\t' << title << ": " << memits << " M emissions/s";
+
+    if (changes)
+        std::cout << ", " << changes << " connect/disconnect";
+
+    std::cout << "\n";
+}
+
+static void run (bool with_writer)
+{
+    typedef bench<pfs::sigslot<> > locked_bench;
+    typedef bench<pfs::snapshot_sigslot<> > snapshot_bench;
+
+    std::cout << (with_writer ? "With writer:\n" : "Without writer:\n");
+
+    for (int nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2) {
+        int locked_changes = 0;
+        int snapshot_changes = 0;
+        double locked_sec = locked_bench::run(nthreads, with_writer, locked_changes);
+        double snapshot_sec = snapshot_bench::run(nthreads, with_writer, snapshot_changes);
+
+        std::cout << nthreads << " thread(s):\n";
+        print("sigslot (mutex)  ", nthreads, locked_sec, locked_changes);
+        print("snapshot_sigslot ", nthreads, snapshot_sec, snapshot_changes);
+    }
+}
+
+int main (int argc, char * argv[])
+{
+    if (argc > 1)
+        emissions = std::atoi(argv[1]);
+
+    if (emissions <= 0) {
+        std::cerr << "Bad number of emissions\n";
+        return EXIT_FAILURE;
+    }
+
+    run(false);
+    run(true);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+#include <iostream>
+#include <cstdlib>
+#include "pfs/test.hpp"
+#include "pfs/string.hpp"
+#include "pfs/vector.hpp"
+#include "pfs/filesystem.hpp"
+#include "pfs/sql/sqlite3/id.hpp"
+#include "pfs/sql/sqlite3/database.hpp"
+#include "pfs/sql/sqlite3/statement.hpp"
+#include "pfs/sql/sqlite3/result.hpp"
+#include "pfs/sql/debby.hpp"
+
+#if __cplusplus >= 201103L
+#   include "pfs/atomic.hpp"
+#   include "pfs/sql/pool.hpp"
+#endif
+
+//
+// Compares SQLite insertion throughput (rows/s) of:
+//      - prepare() for each row (statement is compiled for each row);
+//      - prepare_cached() for each row (statement is taken from the cache);
+//      - insert_many() (one statement is reset and rebound for each row).
+//
+// All rows are inserted in one transaction in each case, so only
+// statement preparation and binding costs are compared.
+//
+// Then compares reading rate of inserted rows by:
+//      - result::get<T>() (value type check and copy for each cell);
+//      - cursor::fetch() by blocks into column buffers.
+//
+// And rate of point queries (SELECT by primary key) executed by
+// connection_pool with 1 (all queries on the single handle) to 8
+// connections (C++11).
+//
+//      pfs-bench-sql [ROWS]
+//
+
+typedef pfs::sql::debby<pfs::sql::sqlite3::id
+        , pfs::sql::sqlite3::database
+        , pfs::sql::sqlite3::statement
+        , pfs::sql::sqlite3::result> debby_ns;
+
+typedef pfs::vector<std::string> row_type;
+
+static char const * INSERT_SQL = "INSERT INTO item VALUES ($1, $2, $3)";
+
+static int rows_count = 200000;
+
+static void prepare_each (debby_ns::database & db, pfs::vector<row_type> const & rows)
+{
+    db.begin_transaction();
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        debby_ns::statement stmt = db.prepare(INSERT_SQL);
+        stmt.bind(0, rows[i][0]);
+        stmt.bind(1, rows[i][1]);
+        stmt.bind(2, rows[i][2]);
+        stmt.exec();
+    }
+
+    db.commit();
+}
+
+static void prepare_cached_each (debby_ns::database & db, pfs::vector<row_type> const & rows)
+{
+    db.begin_transaction();
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        debby_ns::statement stmt = db.prepare_cached(INSERT_SQL);
+        stmt.bind(0, rows[i][0]);
+        stmt.bind(1, rows[i][1]);
+        stmt.bind(2, rows[i][2]);
+        stmt.exec();
+    }
+
+    db.commit();
+}
+
+static void insert_many (debby_ns::database & db, pfs::vector<row_type> const & rows)
+{
+    db.insert_many(INSERT_SQL, rows.begin(), rows.end());
+}
+
+static double bench (void (* f) (debby_ns::database &, pfs::vector<row_type> const &)
+        , debby_ns::database & db
+        , pfs::vector<row_type> const & rows)
+{
+    db.exec("DELETE FROM item");
+
+    pfs::test::profiler sw;
+    f(db, rows);
+    return sw.ellapsed();
+}
+
+static char const * SELECT_SQL = "SELECT id, value, name FROM item";
+
+static size_t read_by_get (debby_ns::database & db)
+{
+    size_t n = 0;
+    debby_ns::result res = db.exec(SELECT_SQL);
+
+    for (; res.has_more(); ++res) {
+        intmax_t id = res.get<intmax_t>(0);
+        intmax_t value = res.get<intmax_t>(1);
+        debby_ns::string_type name = res.get<debby_ns::string_type>(2);
+        n += static_cast<size_t>(id + value) + name.size();
+    }
+
+    return n;
+}
+
+static size_t read_by_cursor (debby_ns::database & db)
+{
+    static size_t const BLOCK = 256;
+
+    size_t n = 0;
+    intmax_t ids[BLOCK];
+    intmax_t values[BLOCK];
+    std::string names;
+    size_t offsets[BLOCK + 1];
+
+    debby_ns::cursor c(db.exec(SELECT_SQL));
+    c.bind_column(0, ids);
+    c.bind_column(1, values);
+    c.bind_column(2, & names, offsets);
+
+    while (size_t count = c.fetch(BLOCK)) {
+        for (size_t i = 0; i < count; ++i)
+            n += static_cast<size_t>(ids[i] + values[i]) + offsets[i + 1] - offsets[i];
+    }
+
+    return n;
+}
+
+static double bench_read (size_t (* f) (debby_ns::database &)
+        , debby_ns::database & db
+        , size_t & checksum)
+{
+    pfs::test::profiler sw;
+    checksum = f(db);
+    return sw.ellapsed();
+}
+
+#if __cplusplus >= 201103L
+
+typedef pfs::sql::connection_pool<debby_ns> pool_type;
+
+static int const QUERIES = 100000;
+static int const QUERIES_PER_JOB = 100;
+
+static double bench_pool (pfs::string const & dburi, size_t connections)
+{
+    pool_type::options opts;
+    opts.connections = connections;
+    opts.wal = true;
+    opts.busy_timeout = 10000;
+
+    pool_type pool;
+    pool.open(dburi, opts);
+
+    pfs::atomic_int found(0);
+    pfs::test::profiler sw;
+
+    for (int j = 0; j < QUERIES / QUERIES_PER_JOB; ++j) {
+        pool.push([j, & found] (debby_ns::database & db) {
+            int n = 0;
+
+            for (int i = 0; i < QUERIES_PER_JOB; ++i) {
+                debby_ns::statement stmt = db.prepare_cached("SELECT name FROM item WHERE id = $1");
+                stmt.bind(0, (j * QUERIES_PER_JOB + i) * 7919 % rows_count);
+                debby_ns::result res = stmt.exec();
+
+                if (res.has_more() && !res.text(0).empty())
+                    ++n;
+            }
+
+            found += n;
+        });
+    }
+
+    pool.wait_idle();
+    double sec = sw.ellapsed();
+
+    if (found.load() != QUERIES)
+        std::cerr << "Not all rows found\n";
+
+    return sec;
+}
+
+#endif
+
+static void print (char const * title, double sec, double base_sec)
+{
+    std::cout << '\t' << title << ": "
+            << static_cast<double>(rows_count) / sec << " rows/s"
+            << " (x" << base_sec / sec << ")\n";
+}
+
+int main (int argc, char * argv[])
+{
+    if (argc > 1)
+        rows_count = std::atoi(argv[1]);
+
+    if (rows_count <= 0) {
+        std::cerr << "Bad number of rows\n";
+        return EXIT_FAILURE;
+    }
+
+    pfs::vector<row_type> rows;
+    rows.reserve(rows_count);
+
+    for (int i = 0; i < rows_count; ++i) {
+        row_type row;
+        row.push_back(pfs::to_string(i).utf8());
+        row.push_back(pfs::to_string(i * 7 % 1000).utf8());
+        row.push_back("name of the item to be inserted");
+        rows.push_back(row);
+    }
+
+    pfs::error_code ec;
+    pfs::filesystem::path path = pfs::filesystem::temp_directory_path();
+    path /= "pfs-bench-sql.sqlite3";
+
+    if (pfs::filesystem::exists(path, ec))
+        pfs::filesystem::remove(path, ec);
+
+    try {
+        pfs::string dburi("sqlite3:");
+        dburi.append(pfs::to_string(path));
+        dburi.append("?mode=rwc");
+
+        debby_ns::database db;
+        db.open(dburi);
+        db.exec("CREATE TABLE item (id INTEGER PRIMARY KEY, value INTEGER, name TEXT)");
+
+        double prepare_sec = bench(prepare_each, db, rows);
+        double cached_sec  = bench(prepare_cached_each, db, rows);
+        double batch_sec   = bench(insert_many, db, rows);
+
+        std::cout << rows_count << " rows:\n";
+        print("prepare() for each row        ", prepare_sec, prepare_sec);
+        print("prepare_cached() for each row ", cached_sec, prepare_sec);
+        print("insert_many()                 ", batch_sec, prepare_sec);
+
+        size_t get_checksum = 0;
+        size_t cursor_checksum = 0;
+        double get_sec    = bench_read(read_by_get, db, get_checksum);
+        double cursor_sec = bench_read(read_by_cursor, db, cursor_checksum);
+
+        std::cout << "Reading:\n";
+        print("result::get<T>()              ", get_sec, get_sec);
+        print("cursor::fetch()               ", cursor_sec, get_sec);
+
+        if (get_checksum != cursor_checksum) {
+            std::cerr << "Read results are different\n";
+            pfs::filesystem::remove(path, ec);
+            return EXIT_FAILURE;
+        }
+
+#if __cplusplus >= 201103L
+        db.close();
+
+        std::cout << "Point queries (" << QUERIES << "):\n";
+        double single_sec = 0;
+
+        for (size_t n = 1; n <= 8; n *= 2) {
+            double sec = bench_pool(dburi, n);
+
+            if (n == 1)
+                single_sec = sec;
+
+            std::cout << '\t' << n << " connection(s): "
+                    << static_cast<double>(QUERIES) / sec << " queries/s"
+                    << " (x" << single_sec / sec << ")\n";
+        }
+#endif
+    } catch (pfs::exception const & ex) {
+        std::cerr << "Exception: " << ex.message() << std::endl;
+        pfs::filesystem::remove(path, ec);
+        return EXIT_FAILURE;
+    }
+
+    pfs::filesystem::remove(path, ec);
+
+    return EXIT_SUCCESS;
+}
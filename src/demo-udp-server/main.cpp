@@ -1,12 +1,8 @@
 #include <iostream>
 #include <pfs/byte_string.hpp>
 #include <pfs/string.hpp>
-#include <pfs/traits/stdcxx/string.hpp>
-#include <pfs/traits/stdcxx/list.hpp>
-#include <pfs/traits/stdcxx/vector.hpp>
-#include <pfs/traits/stdcxx/map.hpp>
 #include <pfs/safeformat.hpp>
-#include <pfs/v2/sigslot.hpp>
+#include <pfs/sigslot.hpp>
 #include <pfs/io/device_manager.hpp>
 #include <pfs/io/inet_server.hpp>
 #include <pfs/net/inet4_addr.hpp>
@@ -15,16 +11,16 @@ using std::cout;
 using std::cerr;
 using std::endl;
 
-typedef pfs::string<pfs::stdcxx::string> string;
-typedef pfs::safeformat<string> fmt;
-typedef pfs::io::device_manager<pfs::stdcxx::list
-        , pfs::stdcxx::vector
-        , pfs::stdcxx::map> device_manager;
+typedef pfs::safeformat fmt;
+typedef pfs::io::device_manager<> device_manager;
+
 //
 // Use this command (netcat) to test UDP server work properly
 //
 // $ echo -n "hello" | nc -w 1 -u -4 localhost 10000
 //
+// or client.sh script to flood the server.
+//
 
 #define __SIMPLE_SERVER__ 0
 #define __POLL_SERVER__   0
@@ -32,73 +28,76 @@ typedef pfs::io::device_manager<pfs::stdcxx::list
 extern "C" int simple_udp_server (int argc, char ** argv);
 extern "C" int poll_udp_server (int argc, char ** argv);
 
-struct handlers : pfs::has_slots<>
-{
-    void device_ready_read (pfs::io::device d)
-    {
-        //cout << fmt("%s: device ready to read)")(d.url()).str() << endl;
-        pfs::byte_string data;
-
-        if (! d.read(data)) {
-            cerr << fmt("read device error: %s") % pfs::to_string<string>(d.errorcode())
-                  << endl;
-        } else {
-            cout << "read: " << pfs::to_string<string>(data) << endl;
-        }
-    }
+// Maximum number of datagrams received by single system call
+static size_t const BATCH_SIZE = 64;
 
-    void device_opened (pfs::io::device d)
-    {
-        cout << fmt("%s: device successfully opened/connected") % d.url() << endl;
-    }
+// Maximum UDP payload
+static size_t const DATAGRAM_SIZE = 65536;
 
-    void device_opening (pfs::io::device d)
+struct handlers : pfs::sigslot<>::has_slots
+{
+    byte_t                     buffers[BATCH_SIZE][DATAGRAM_SIZE];
+    pfs::io::mutable_buffer    bufs[BATCH_SIZE];
+    size_t                     sizes[BATCH_SIZE];
+    size_t                     total;
+    bool                       quiet;
+
+    handlers (bool q)
+        : total(0)
+        , quiet(q)
     {
-        cout << fmt("%s: open/connection device in progress") % d.url() << endl;
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+            bufs[i] = pfs::io::mutable_buffer(buffers[i], DATAGRAM_SIZE);
     }
 
-    void device_open_failed (pfs::io::device d, pfs::error_code ex)
+    // UDP server produces peer device for incoming data,
+    // drain all available datagrams by batches
+    void device_accepted (pfs::io::device_ptr d, pfs::io::server_ptr)
     {
-        if (! d.is_null()) {
-            cerr << fmt("%s: open/connection device error: %s")
-                    (d.url())(pfs::to_string<string>(ex)).str() << endl;
-        } else {
-            cerr << fmt("open device error: %s") % pfs::to_string<string>(ex) << endl;
+        pfs::error_code ec;
+        ssize_t n = 0;
+
+        while ((n = d->recv_batch(bufs, sizes, BATCH_SIZE, ec)) > 0) {
+            total += size_t(n);
+
+            if (!quiet) {
+                for (ssize_t i = 0; i < n; ++i) {
+                    cout << "read: "
+                            << std::string(reinterpret_cast<char const *>(buffers[i]), sizes[i])
+                            << endl;
+                }
+            }
+
+            if (size_t(n) < BATCH_SIZE)
+                break;
         }
-    }
 
-    void device_disconnected (pfs::io::device d)
-    {
-        cerr << fmt("%s: device closed/disconnected") % d.url() << endl;
+        if (n < 0)
+            cerr << fmt("read device error: %s")(pfs::to_string(ec)).str() << endl;
     }
 
-    void server_opened (pfs::io::server s)
+    void server_opened (pfs::io::server_ptr s)
     {
-        cout << fmt("%s: server successfully opened") % s.url() << endl;
+        cout << fmt("%s: server successfully opened")(s->url()).str() << endl;
     }
 
-    void server_opening (pfs::io::server s)
+    void server_open_failed (pfs::io::server_ptr s, pfs::error_code const & ex)
     {
-        cout << fmt("%s: open server in progress") % s.url() << endl;
-    }
-
-    void server_open_failed (pfs::io::server s, pfs::error_code ex)
-    {
-        if (! s.is_null()) {
+        if (s) {
             cerr << fmt("%s: open server error: %s")
-                    % s.url() % pfs::to_string<string>(ex) << endl;
+                    (s->url())(pfs::to_string(ex)).str() << endl;
         } else {
-            cerr << fmt("open server error: %s") % pfs::to_string<string>(ex) << endl;
+            cerr << fmt("open server error: %s")(pfs::to_string(ex)).str() << endl;
         }
     }
 
-    void error (pfs::error_code ex)
+    void error (pfs::error_code const & ex)
     {
-        cerr << fmt("I/O error: %s") % pfs::to_string<string>(ex) << endl;
+        cerr << fmt("I/O error: %s")(pfs::to_string(ex)).str() << endl;
     }
 };
 
-int main ()
+int main (int argc, char ** argv)
 {
 #if __SIMPLE_SERVER__
 
@@ -110,28 +109,29 @@ int main ()
 
 #else
     int const millis = 100;
-    device_manager devman(millis);
+    device_manager devman;
     pfs::net::inet4_addr ip(pfs::net::inet4_addr::any_addr_value);
     uint16_t port = 10000;
-    handlers h;
-
-    devman.ready_read.connect(& h, & handlers::device_ready_read);
-    devman.opened.connect(& h, & handlers::device_opened);
-    devman.opening.connect(& h, & handlers::device_opening);
-    devman.open_failed.connect(& h, & handlers::device_open_failed);
-    devman.disconnected.connect(& h, & handlers::device_disconnected);
-    devman.server_opened.connect(& h, & handlers::server_opened);
-    devman.server_opening.connect(& h, & handlers::server_opening);
-    devman.server_open_failed.connect(& h, & handlers::server_open_failed);
-    devman.error.connect(& h, & handlers::error);
+    bool quiet = argc > 1 && std::string(argv[1]) == "-q";
+    handlers * h = new handlers(quiet); // Too large for stack
 
+    devman.accepted.connect(h, & handlers::device_accepted);
+    devman.server_opened.connect(h, & handlers::server_opened);
+    devman.server_open_failed.connect(h, & handlers::server_open_failed);
+    devman.error.connect(h, & handlers::error);
+
+    pfs::error_code ec;
     devman.new_server(pfs::io::open_params<pfs::io::udp_server>(ip, port
-        , pfs::io::read_write | pfs::io::non_blocking));
+        , pfs::io::read_write | pfs::io::non_blocking), ec);
+
+    if (ec)
+        return -1;
 
     while (true) {
-        devman.dispatch();
+        devman.dispatch(millis);
     }
 
+    delete h;
     return 0;
 
 #endif
@@ -85,6 +85,89 @@ ssize_t device::read_wait (byte_string & bytes, size_t n, error_code  & ec, int
     return is_error(ec) ? -1 : total;
 }
 
+ssize_t device::write_v (const_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    ssize_t total = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (bufs[i].size == 0)
+            continue;
+
+        ssize_t sz = this->write(bufs[i].data, bufs[i].size, ec);
+
+        if (sz < 0)
+            return total > 0 ? total : -1;
+
+        total += sz;
+
+        if (size_t(sz) < bufs[i].size)
+            break;
+    }
+
+    return total;
+}
+
+ssize_t device::read_v (mutable_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    ssize_t total = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (bufs[i].size == 0)
+            continue;
+
+        ssize_t sz = this->read(bufs[i].data, bufs[i].size, ec);
+
+        if (sz < 0)
+            return total > 0 ? total : -1;
+
+        total += sz;
+
+        if (size_t(sz) < bufs[i].size)
+            break;
+    }
+
+    return total;
+}
+
+ssize_t device::recv_batch (mutable_buffer const * bufs
+        , size_t * sizes
+        , size_t count
+        , error_code & ec) noexcept
+{
+    ssize_t nmsgs = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (this->available() <= 0)
+            break;
+
+        ssize_t sz = this->read(bufs[i].data, bufs[i].size, ec);
+
+        if (sz < 0)
+            return nmsgs > 0 ? nmsgs : -1;
+
+        sizes[i] = size_t(sz);
+        ++nmsgs;
+    }
+
+    return nmsgs;
+}
+
+ssize_t device::send_batch (const_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    ssize_t nmsgs = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        ssize_t sz = this->write(bufs[i].data, bufs[i].size, ec);
+
+        if (sz < 0)
+            return nmsgs > 0 ? nmsgs : -1;
+
+        ++nmsgs;
+    }
+
+    return nmsgs;
+}
+
 } // namespace details
 
 /**
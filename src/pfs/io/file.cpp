@@ -1,6 +1,10 @@
 #include <pfs/io/exception.hpp>
 #include "pfs/io/file.hpp"
 
+#if HAVE_ZLIB
+#   include <zlib.h>
+#endif
+
 namespace pfs {
 namespace io {
 
@@ -44,4 +48,46 @@ string u8_read_all (filesystem::path const & path, error_code & ec)
     return result;
 }
 
+#if HAVE_ZLIB
+error_code gzip (filesystem::path const & src, filesystem::path const & dest)
+{
+    static size_t const CHUNK_SIZE = 0x10000;
+
+    error_code ec;
+    device_ptr in = open_device(open_params<file>(src, pfs::io::read_only), ec);
+
+    if (ec)
+        return ec;
+
+    gzFile out = gzopen(dest.native().c_str(), "wb");
+
+    if (!out) {
+        ec = get_last_system_error();
+        return ec ? ec : pfs::make_error_code(errc::io_error);
+    }
+
+    byte_t buffer[CHUNK_SIZE];
+
+    for (;;) {
+        ssize_t n = in->read(buffer, CHUNK_SIZE, ec);
+
+        if (n < 0)
+            break;
+
+        if (n == 0)
+            break;
+
+        if (gzwrite(out, buffer, static_cast<unsigned>(n)) != n) {
+            ec = pfs::make_error_code(errc::io_error);
+            break;
+        }
+    }
+
+    if (gzclose(out) != Z_OK && !ec)
+        ec = pfs::make_error_code(errc::io_error);
+
+    return ec;
+}
+#endif
+
 }} // pfs::io
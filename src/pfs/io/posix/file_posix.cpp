@@ -4,6 +4,8 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <climits>
 #include "pfs/compiler.hpp"
 #include "pfs/io/file.hpp"
 #include "pfs/compiler.hpp"
@@ -79,6 +81,76 @@ struct basic_file : public details::device
 
         return sz;
     }
+
+    virtual ssize_t read_v (mutable_buffer const * bufs, size_t count, error_code & ec) noexcept override
+    {
+        static size_t const MAX_IOV = 64 < IOV_MAX ? 64 : IOV_MAX;
+        struct iovec iov[MAX_IOV];
+        ssize_t total = 0;
+
+        while (count > 0) {
+            size_t n = count < MAX_IOV ? count : MAX_IOV;
+            size_t expected = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                iov[i].iov_base = bufs[i].data;
+                iov[i].iov_len  = bufs[i].size;
+                expected += bufs[i].size;
+            }
+
+            ssize_t sz = ::readv(_fd, iov, static_cast<int>(n));
+
+            if (sz < 0) {
+                ec = get_last_system_error();
+                return total > 0 ? total : -1;
+            }
+
+            total += sz;
+
+            if (size_t(sz) < expected)
+                break;
+
+            bufs  += n;
+            count -= n;
+        }
+
+        return total;
+    }
+
+    virtual ssize_t write_v (const_buffer const * bufs, size_t count, error_code & ec) noexcept override
+    {
+        static size_t const MAX_IOV = 64 < IOV_MAX ? 64 : IOV_MAX;
+        struct iovec iov[MAX_IOV];
+        ssize_t total = 0;
+
+        while (count > 0) {
+            size_t n = count < MAX_IOV ? count : MAX_IOV;
+            size_t expected = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                iov[i].iov_base = const_cast<byte_t *>(bufs[i].data);
+                iov[i].iov_len  = bufs[i].size;
+                expected += bufs[i].size;
+            }
+
+            ssize_t sz = ::writev(_fd, iov, static_cast<int>(n));
+
+            if (sz < 0) {
+                ec = get_last_system_error();
+                return total > 0 ? total : -1;
+            }
+
+            total += sz;
+
+            if (size_t(sz) < expected)
+                break;
+
+            bufs  += n;
+            count -= n;
+        }
+
+        return total;
+    }
 };
 
 struct standard_stream : basic_file
@@ -335,6 +407,9 @@ device_ptr open_device<file> (open_params<file> const & op, error_code & ec)
     if (op.oflags & truncate)
         native_oflags |= O_TRUNC;
 
+    if (op.oflags & append)
+        native_oflags |= O_APPEND;
+
 
     details::file * f = new details::file;
 
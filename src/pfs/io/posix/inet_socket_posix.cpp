@@ -21,10 +21,14 @@
  */
 
 #include <cerrno>
+#include <climits>
+#include <cstring>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include "inet_socket_posix.hpp"
 
@@ -110,6 +114,224 @@ error_code inet_socket::set_socket_options (uint32_t sso)
     return error_code();
 }
 
+static size_t const MAX_IOV = 64 < IOV_MAX ? 64 : IOV_MAX;
+
+bool inet_socket::wait_writable (error_code & ec) noexcept
+{
+    pollfd pfd = { _fd, POLLOUT, 0 };
+    int rc = 0;
+
+    do {
+        rc = ::poll(& pfd, 1, -1);
+    } while (rc < 0 && errno == EINTR);
+
+    if (rc < 0) {
+        ec = get_last_system_error();
+        return false;
+    }
+
+    return true;
+}
+
+// Sends data waiting (without spinning) for socket readiness
+// if it is in non-blocking mode.
+//
+ssize_t inet_socket::waiting_write (byte_t const * bytes, size_t nbytes, error_code & ec) noexcept
+{
+    ssize_t r = 0; // total sent
+
+    while (nbytes) {
+        ssize_t n = send_once(bytes + r, nbytes, false, ec);
+
+        if (n < 0)
+            return -1;
+
+        if (n == 0) {
+            if (!wait_writable(ec))
+                return -1;
+
+            continue;
+        }
+
+        r += n;
+        nbytes -= n;
+    }
+
+    return r;
+}
+
+// Sends as many bytes as possible and stores the rest into outbound queue.
+// Always accepts all bytes (if no error occurred).
+//
+ssize_t inet_socket::queued_write (byte_t const * bytes, size_t nbytes, error_code & ec) noexcept
+{
+    size_t n = nbytes;
+
+    // Keep order of bytes
+    if (_outq.empty()) {
+        ssize_t r = send_once(bytes, n, true, ec);
+
+        if (r < 0)
+            return -1;
+
+        bytes += r;
+        n -= integral_cast_check<size_t>(r);
+    }
+
+    if (n > 0) {
+        _outq.push_back(byte_string(bytes, n));
+        _pending += n;
+
+        if (_high_watermark > 0 && _pending >= _high_watermark)
+            _congested = true;
+    }
+
+    return integral_cast_check<ssize_t>(nbytes);
+}
+
+ssize_t inet_socket::read_v (mutable_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    PFS_ASSERT(_fd >= 0);
+
+    iovec iov[MAX_IOV];
+    size_t n = count < MAX_IOV ? count : MAX_IOV;
+
+    for (size_t i = 0; i < n; ++i) {
+        iov[i].iov_base = bufs[i].data;
+        iov[i].iov_len  = bufs[i].size;
+    }
+
+    msghdr msg;
+    ::memset(& msg, 0, sizeof(msg));
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = n;
+
+    sockaddr_in * addr = datagram_addr();
+
+    if (addr) {
+        msg.msg_name    = addr;
+        msg.msg_namelen = sizeof(*addr);
+    }
+
+    ssize_t r = 0;
+
+    do {
+        r = ::recvmsg(_fd, & msg, MSG_DONTWAIT);
+    } while (r < 0 && errno == EINTR);
+
+    if (r < 0) {
+        if (errno == EAGAIN
+                || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK))
+            return 0;
+
+        ec = get_last_system_error();
+    }
+
+    return r;
+}
+
+// Sends buffers by sendmsg(2) (writev(2) does not accept MSG_NOSIGNAL flag),
+// waits for socket readiness like write()
+//
+ssize_t inet_socket::write_v (const_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    PFS_ASSERT(_fd >= 0);
+
+    // Outbound queue stores data by chunks
+    if (_write_queue)
+        return device::write_v(bufs, count, ec);
+
+    iovec iov[MAX_IOV];
+    ssize_t total = 0;
+    size_t offset = 0; // Number of sent bytes of the first buffer
+
+    while (count > 0) {
+        size_t n = count < MAX_IOV ? count : MAX_IOV;
+
+        for (size_t i = 0; i < n; ++i) {
+            size_t skip = i == 0 ? offset : 0;
+            iov[i].iov_base = const_cast<byte_t *>(bufs[i].data) + skip;
+            iov[i].iov_len  = bufs[i].size - skip;
+        }
+
+        msghdr msg;
+        ::memset(& msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = n;
+
+        sockaddr_in * addr = datagram_addr();
+
+        if (addr) {
+            msg.msg_name    = addr;
+            msg.msg_namelen = sizeof(*addr);
+        }
+
+        ssize_t sz = 0;
+
+        do {
+            sz = ::sendmsg(_fd, & msg, MSG_NOSIGNAL);
+        } while (sz < 0 && errno == EINTR);
+
+        if (sz < 0) {
+            if (errno == EAGAIN
+                    || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK)) {
+                if (wait_writable(ec))
+                    continue;
+            } else {
+                ec = get_last_system_error();
+            }
+
+            return total > 0 ? total : -1;
+        }
+
+        total += sz;
+
+        // Skip sent buffers
+        size_t k = size_t(sz);
+
+        while (count > 0 && k >= bufs->size - offset) {
+            k -= bufs->size - offset;
+            offset = 0;
+            ++bufs;
+            --count;
+        }
+
+        offset += k;
+    }
+
+    return total;
+}
+
+ssize_t inet_socket::flush_pending (error_code & ec) noexcept
+{
+    ssize_t total = 0;
+
+    while (!_outq.empty()) {
+        byte_string const & chunk = _outq.front();
+        ssize_t r = send_once(chunk.data() + _outq_pos, chunk.size() - _outq_pos, true, ec);
+
+        if (r < 0)
+            return -1;
+
+        if (r == 0)
+            break;
+
+        total += r;
+        _outq_pos += integral_cast_check<size_t>(r);
+        _pending -= integral_cast_check<size_t>(r);
+
+        if (_outq_pos == chunk.size()) {
+            _outq.pop_front();
+            _outq_pos = 0;
+        }
+    }
+
+    if (_congested && _pending <= _low_watermark)
+        _congested = false;
+
+    return total;
+}
+
 error_code tcp_socket::connect (uint32_t addr, uint16_t port)
 {
     memset(& _sockaddr, 0, sizeof (_sockaddr));
@@ -214,35 +436,32 @@ ssize_t tcp_socket::read (byte_t * bytes, size_t n, error_code & ec) noexcept
     return r;
 }
 
-ssize_t tcp_socket::write (byte_t const * bytes, size_t nbytes, error_code & ec) noexcept
+ssize_t tcp_socket::send_once (byte_t const * bytes
+        , size_t n
+        , bool nowait
+        , error_code & ec) noexcept
 {
     PFS_ASSERT(_fd >= 0);
 
-    int r = 0; // total sent
-
-    while (nbytes) {
-        // MSG_NOSIGNAL flag means:
-        // requests not to send SIGPIPE on errors on stream oriented sockets
-        // when the other end breaks the connection.
-        // The EPIPE error is still returned.
-        //
-        ssize_t n = send(_fd, bytes + r, nbytes, MSG_NOSIGNAL);
-
-        if (n < 0) {
-            if (errno == EAGAIN
-                    || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK))
-                continue;
+    // MSG_NOSIGNAL flag means:
+    // requests not to send SIGPIPE on errors on stream oriented sockets
+    // when the other end breaks the connection.
+    // The EPIPE error is still returned.
+    //
+    int flags = MSG_NOSIGNAL | (nowait ? MSG_DONTWAIT : 0);
+    ssize_t r = 0;
 
-            r = -1;
-            break;
-        }
+    do {
+        r = send(_fd, bytes, n, flags);
+    } while (r < 0 && errno == EINTR);
 
-        r += n;
-        nbytes -= n;
-    }
+    if (r < 0) {
+        if (errno == EAGAIN
+                || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK))
+            return 0;
 
-    if (r < 0)
         ec = get_last_system_error();
+    }
 
     return r;
 }
@@ -283,37 +502,163 @@ ssize_t udp_socket::read (byte_t * bytes, size_t n, error_code & ec) noexcept
     return r;
 }
 
-ssize_t udp_socket::write (byte_t const * bytes, size_t nbytes, error_code & ec) noexcept
+#if defined(__linux__)
+
+static size_t const MAX_BATCH = 64;
+
+ssize_t udp_socket::recv_batch (mutable_buffer const * bufs
+        , size_t * sizes
+        , size_t count
+        , error_code & ec) noexcept
 {
     PFS_ASSERT(_fd >= 0);
 
-    int r = 0; // total sent
-    sockaddr * serveraddrptr = reinterpret_cast<sockaddr *>(& _sockaddr);
-    socklen_t serveraddrlen = sizeof(_sockaddr);
+    mmsghdr msgs[MAX_BATCH];
+    iovec iov[MAX_BATCH];
+    sockaddr_in addrs[MAX_BATCH];
+    ssize_t total = 0;
 
-    while (nbytes) {
-        // MSG_NOSIGNAL flag means:
-        // requests not to send SIGPIPE on errors on stream oriented sockets
-        // when the other end breaks the connection.
-        // The EPIPE error is still returned.
-        //
-        ssize_t n = sendto(_fd, bytes + r, nbytes, MSG_NOSIGNAL, serveraddrptr, serveraddrlen);
-
-        if (n < 0) {
+    while (count > 0) {
+        size_t n = count < MAX_BATCH ? count : MAX_BATCH;
+
+        ::memset(msgs, 0, n * sizeof(msgs[0]));
+
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = bufs[i].data;
+            iov[i].iov_len  = bufs[i].size;
+            msgs[i].msg_hdr.msg_iov     = & iov[i];
+            msgs[i].msg_hdr.msg_iovlen  = 1;
+            msgs[i].msg_hdr.msg_name    = & addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        }
+
+        int r = 0;
+
+        do {
+            r = ::recvmmsg(_fd, msgs, static_cast<unsigned int>(n), MSG_DONTWAIT, 0);
+        } while (r < 0 && errno == EINTR);
+
+        if (r < 0) {
             if (errno == EAGAIN
                     || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK))
-                continue;
+                break;
+
+            ec = get_last_system_error();
+            return total > 0 ? total : -1;
+        }
+
+        for (int i = 0; i < r; ++i)
+            sizes[i] = msgs[i].msg_len;
+
+        // Keep sender of the last datagram as read() does
+        if (r > 0)
+            ::memcpy(& _sockaddr, & addrs[r - 1], sizeof(_sockaddr));
 
-            r = -1;
+        total += r;
+
+        if (size_t(r) < n)
             break;
+
+        bufs  += n;
+        sizes += n;
+        count -= n;
+    }
+
+    return total;
+}
+
+ssize_t udp_socket::send_batch (const_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    PFS_ASSERT(_fd >= 0);
+
+    // Outbound queue stores data by chunks
+    if (_write_queue)
+        return device::send_batch(bufs, count, ec);
+
+    mmsghdr msgs[MAX_BATCH];
+    iovec iov[MAX_BATCH];
+    ssize_t total = 0;
+
+    while (count > 0) {
+        size_t n = count < MAX_BATCH ? count : MAX_BATCH;
+
+        ::memset(msgs, 0, n * sizeof(msgs[0]));
+
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = const_cast<byte_t *>(bufs[i].data);
+            iov[i].iov_len  = bufs[i].size;
+            msgs[i].msg_hdr.msg_iov     = & iov[i];
+            msgs[i].msg_hdr.msg_iovlen  = 1;
+            msgs[i].msg_hdr.msg_name    = & _sockaddr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(_sockaddr);
         }
 
-        r += n;
-        nbytes -= n;
+        int r = 0;
+
+        do {
+            r = ::sendmmsg(_fd, msgs, static_cast<unsigned int>(n), MSG_NOSIGNAL);
+        } while (r < 0 && errno == EINTR);
+
+        if (r < 0) {
+            if (errno == EAGAIN
+                    || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK)) {
+                if (wait_writable(ec))
+                    continue;
+            } else {
+                ec = get_last_system_error();
+            }
+
+            return total > 0 ? total : -1;
+        }
+
+        total += r;
+        bufs  += r;
+        count -= size_t(r);
     }
 
-    if (r < 0)
+    return total;
+}
+
+#else
+
+ssize_t udp_socket::recv_batch (mutable_buffer const * bufs
+        , size_t * sizes
+        , size_t count
+        , error_code & ec) noexcept
+{
+    return device::recv_batch(bufs, sizes, count, ec);
+}
+
+ssize_t udp_socket::send_batch (const_buffer const * bufs, size_t count, error_code & ec) noexcept
+{
+    return device::send_batch(bufs, count, ec);
+}
+
+#endif
+
+ssize_t udp_socket::send_once (byte_t const * bytes
+        , size_t n
+        , bool nowait
+        , error_code & ec) noexcept
+{
+    PFS_ASSERT(_fd >= 0);
+
+    sockaddr * serveraddrptr = reinterpret_cast<sockaddr *>(& _sockaddr);
+    socklen_t serveraddrlen = sizeof(_sockaddr);
+    int flags = MSG_NOSIGNAL | (nowait ? MSG_DONTWAIT : 0);
+    ssize_t r = 0;
+
+    do {
+        r = sendto(_fd, bytes, n, flags, serveraddrptr, serveraddrlen);
+    } while (r < 0 && errno == EINTR);
+
+    if (r < 0) {
+        if (errno == EAGAIN
+                || (EAGAIN != EWOULDBLOCK && errno == EWOULDBLOCK))
+            return 0;
+
         ec = get_last_system_error();
+    }
 
     return r;
 }
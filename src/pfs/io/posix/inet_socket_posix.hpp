@@ -3,6 +3,7 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include "pfs/io/inet_socket.hpp"
+#include "pfs/deque.hpp"
 #include "posix_utils.hpp"
 
 namespace pfs {
@@ -19,6 +20,15 @@ protected:
     native_handle_type _fd;
     sockaddr_in  _sockaddr;
 
+    // Outbound queue (see enable_write_queue())
+    bool                    _write_queue;
+    pfs::deque<byte_string> _outq;
+    size_t                  _outq_pos; // Number of sent bytes of the front chunk
+    size_t                  _pending;
+    size_t                  _high_watermark;
+    size_t                  _low_watermark;
+    bool                    _congested;
+
 private:
     inet_socket (const inet_socket & other);
     inet_socket & operator = (const inet_socket & other);
@@ -26,10 +36,51 @@ private:
 public:
     virtual error_code open (bool non_blocking) = 0;
 
+protected:
+    /**
+     * @brief Sends data by single system call.
+     *
+     * @param nowait Do not block even if socket is in blocking mode.
+     * @return The number of bytes sent, zero if socket is not ready
+     *         for writing or -1 if an error occurred.
+     */
+    virtual ssize_t send_once (byte_t const * bytes, size_t n, bool nowait, error_code & ec) noexcept = 0;
+
+    ssize_t queued_write (byte_t const * bytes, size_t n, error_code & ec) noexcept;
+
+    ssize_t waiting_write (byte_t const * bytes, size_t n, error_code & ec) noexcept;
+
+    // Waits (without spinning) until socket becomes writable
+    bool wait_writable (error_code & ec) noexcept;
+
+    /**
+     * @return Peer address for datagram sockets (used as destination
+     *         address on send and receives source address on receive),
+     *         or null pointer for connection based sockets.
+     */
+    virtual sockaddr_in * datagram_addr ()
+    {
+        return 0;
+    }
+
+    void clear_queue ()
+    {
+        _outq.clear();
+        _outq_pos = 0;
+        _pending = 0;
+        _congested = false;
+    }
+
 public:
     inet_socket ()
         : details::device()
         , _fd(-1)
+        , _write_queue(false)
+        , _outq_pos(0)
+        , _pending(0)
+        , _high_watermark(0)
+        , _low_watermark(0)
+        , _congested(false)
     {}
 
     virtual ~inet_socket ()
@@ -43,12 +94,43 @@ public:
 
     virtual ssize_t available () const override;
 
-    //virtual ssize_t write (const byte_t * bytes, size_t n, error_code & ec) override = 0;
+    virtual ssize_t write (byte_t const * bytes, size_t n, error_code & ec) noexcept override
+    {
+        return _write_queue
+                ? queued_write(bytes, n, ec)
+                : waiting_write(bytes, n, ec);
+    }
+
+    virtual ssize_t read_v (mutable_buffer const * bufs, size_t count, error_code & ec) noexcept override;
+
+    virtual ssize_t write_v (const_buffer const * bufs, size_t count, error_code & ec) noexcept override;
+
+    virtual bool enable_write_queue (size_t high_watermark, size_t low_watermark) override
+    {
+        _write_queue = true;
+        _high_watermark = high_watermark;
+        _low_watermark = pfs::min(low_watermark, high_watermark);
+        return true;
+    }
+
+    virtual size_t pending () const override
+    {
+        return _pending;
+    }
+
+    virtual bool congested () const override
+    {
+        return _congested;
+    }
+
+    virtual ssize_t flush_pending (error_code & ec) noexcept override;
 
     virtual error_code close () override
     {
         error_code ec;
 
+        clear_queue();
+
         if (close_socket(_fd) != 0)
             ec = get_last_system_error();
 
@@ -112,8 +194,10 @@ public:
 
     virtual ssize_t read (byte_t * bytes, size_t n, error_code & ec) noexcept override;
 
-    virtual ssize_t write (const byte_t * bytes, size_t n, error_code & ec) noexcept override;
+protected:
+    virtual ssize_t send_once (byte_t const * bytes, size_t n, bool nowait, error_code & ec) noexcept override;
 
+public:
     virtual device_type type () const override
     {
         return device_tcp_socket;
@@ -167,8 +251,23 @@ public:
     virtual error_code connect (uint32_t addr, uint16_t port) override;
 
     virtual ssize_t read (byte_t * bytes, size_t n, error_code & ec) noexcept override;
-    virtual ssize_t write (byte_t const * bytes, size_t n, error_code & ec) noexcept override;
 
+    virtual ssize_t recv_batch (mutable_buffer const * bufs
+            , size_t * sizes
+            , size_t count
+            , error_code & ec) noexcept override;
+
+    virtual ssize_t send_batch (const_buffer const * bufs, size_t count, error_code & ec) noexcept override;
+
+protected:
+    virtual ssize_t send_once (byte_t const * bytes, size_t n, bool nowait, error_code & ec) noexcept override;
+
+    virtual sockaddr_in * datagram_addr () override
+    {
+        return & _sockaddr;
+    }
+
+public:
     virtual device_type type () const override
     {
         return device_udp_socket;
@@ -210,6 +309,7 @@ public:
         // Really descriptor cannot be closed,
         // it still used by server
         //
+        clear_queue();
         _fd = -1;
         return error_code();
     }
@@ -1,6 +1,11 @@
 #include <pfs/test.hpp>
 #include "test_active_queue.hpp"
 #include "test_consumer_producer.hpp"
+#include "test_inplace_binder.hpp"
+
+#if __cplusplus >= 201103L
+#   include "test_mpmc.hpp"
+#endif
 
 int main ()
 {
@@ -12,6 +17,11 @@ int main ()
     test::active_queue::test3::test();
     test::active_queue::test4::test();
     test::active_queue::consumer_producer::test();
+    test::active_queue::inplace::test();
+
+#if __cplusplus >= 201103L
+    test::active_queue::mpmc::test();
+#endif
 
     return END_TESTS;
 }
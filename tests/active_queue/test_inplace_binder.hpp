@@ -0,0 +1,74 @@
+#include <pfs/test.hpp>
+#include <pfs/inplace_binder.hpp>
+
+namespace test {
+namespace active_queue {
+namespace inplace {
+
+static int sum = 0;
+
+void func2 (int a, int b)
+{
+    sum += a + b;
+}
+
+struct big_arg
+{
+    char data[128];
+    int value;
+};
+
+void func_big (big_arg a)
+{
+    sum += a.value;
+}
+
+void test ()
+{
+    ADD_TESTS(9);
+
+    typedef pfs::inplace_binder<void> callable_type;
+
+    callable_type c1(pfs::binder_function2<void, int, int>(& func2, 1, 2));
+    TEST_OK(c1.is_inplace());
+
+    big_arg a;
+    a.value = 10;
+    callable_type c2(pfs::binder_function1<void, big_arg>(& func_big, a));
+    TEST_OK(!c2.is_inplace() && !c2.empty());
+
+    callable_type c3(c1);
+    callable_type c4;
+    c4 = c2;
+
+    c1();
+    c2();
+    c3();
+    c4();
+    TEST_OK(sum == 3 + 10 + 3 + 10);
+
+    c1.reset();
+    TEST_OK(c1.empty());
+    TEST_OK(!c3.empty() && c3.is_inplace());
+
+#if __cplusplus >= 201103L
+    callable_type c5(std::move(c3));
+    callable_type c6(std::move(c4));
+    TEST_OK(c3.empty() && c5.is_inplace());
+    TEST_OK(c4.empty() && !c6.is_inplace() && !c6.empty());
+
+    sum = 0;
+    c5();
+    c6();
+    TEST_OK(sum == 3 + 10);
+#else
+    TEST_OK(true);
+    TEST_OK(true);
+    TEST_OK(true);
+#endif
+
+    c2.assign(pfs::binder_function2<void, int, int>(& func2, 5, 5));
+    TEST_OK(c2.is_inplace());
+}
+
+}}} // test::active_queue::inplace
@@ -0,0 +1,147 @@
+#include <pfs/test.hpp>
+#include <pfs/thread.hpp>
+#include <pfs/atomic.hpp>
+#include <pfs/active_queue.hpp>
+#include <pfs/memory.hpp>
+
+namespace test {
+namespace active_queue {
+namespace mpmc {
+
+// Small capacity to force usage of overflow container
+typedef pfs::active_queue<pfs::mpmc_queue
+    , pfs::mutex
+    , 256> active_queue_type;
+
+static int const COUNT          = 10000;
+static int const PRODUCER_COUNT = 10;
+static int const CONSUMER_COUNT = 15;
+
+static pfs::atomic_int quit_flag(PRODUCER_COUNT);
+static pfs::atomic_int counter(0);
+
+static int result = 0;
+
+void func0 ()
+{
+    ++counter;
+}
+
+void func1 (int a)
+{
+    result += a;
+}
+
+class A
+{
+public:
+    int value;
+
+    A () : value(0) {}
+
+    void method2 (int a, int b)
+    {
+        value = a + b;
+    }
+};
+
+class producer
+{
+    active_queue_type * _q;
+
+public:
+    producer () : _q(0) {}
+
+    void set_queue (active_queue_type * q) { _q = q; }
+
+    void run ()
+    {
+        for (int i = 0; i < COUNT; ++i)
+            _q->push_function(& func0);
+
+        --quit_flag;
+    }
+};
+
+class consumer
+{
+    active_queue_type * _q;
+
+public:
+    consumer () : _q(0) {}
+
+    void set_queue (active_queue_type * q) { _q = q; }
+
+    void run ()
+    {
+        while (not (quit_flag.load() == 0 && _q->empty()))
+            _q->call_all();
+    }
+};
+
+void test_basic ()
+{
+    ADD_TESTS(7);
+
+    active_queue_type q(4);
+    A a;
+
+    TEST_OK(q.capacity() == 4);
+    TEST_OK(q.empty());
+
+    // More than capacity: tail goes to overflow container
+    for (int i = 1; i <= 10; ++i)
+        q.push_function(& func1, i);
+
+    q.push_method(& A::method2, & a, 10, 20);
+
+    TEST_OK(q.count() == 11);
+
+    q.call(3);
+    TEST_OK(result == 1 + 2 + 3);
+
+    q.call_all();
+    TEST_OK(result == 55);
+    TEST_OK(a.value == 30);
+    TEST_OK(q.empty());
+}
+
+void test_concurrent ()
+{
+    ADD_TESTS(2);
+
+    active_queue_type q(1024);
+
+    producer producers[PRODUCER_COUNT];
+    consumer consumers[CONSUMER_COUNT];
+
+    pfs::unique_ptr<pfs::thread> consumer_threads[CONSUMER_COUNT];
+    pfs::unique_ptr<pfs::thread> producer_threads[PRODUCER_COUNT];
+
+    for (int i = 0; i < CONSUMER_COUNT; ++i) {
+        consumers[i].set_queue(& q);
+        consumer_threads[i] = pfs::make_unique<pfs::thread>(& consumer::run, & consumers[i]);
+    }
+
+    for (int i = 0; i < PRODUCER_COUNT; ++i) {
+        producers[i].set_queue(& q);
+        producer_threads[i] = pfs::make_unique<pfs::thread>(& producer::run, & producers[i]);
+    }
+
+    for (int i = 0; i < PRODUCER_COUNT; ++i)
+        producer_threads[i]->join();
+
+    for (int i = 0; i < CONSUMER_COUNT; ++i)
+        consumer_threads[i]->join();
+
+    TEST_OK(counter.load() == COUNT * PRODUCER_COUNT);
+    TEST_OK(q.empty());
+}
+
+inline void test ()
+{
+    test_basic();
+    test_concurrent();
+}
+
+}}} // test::active_queue::mpmc
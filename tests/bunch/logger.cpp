@@ -0,0 +1,357 @@
+#include <pfs/string.hpp>
+#include <pfs/logger.hpp>
+#include "../catch.hpp"
+
+typedef pfs::log<> log_ns;
+
+class string_appender : public log_ns::appender
+{
+public:
+    pfs::string last;
+
+    string_appender () : log_ns::appender() {}
+
+    virtual bool is_open () const
+    {
+        return true;
+    }
+
+    // Result of legacy (interpreting) pattern processing
+    pfs::string interpret (log_ns::priority level
+            , pfs::datetime const & dt
+            , pfs::string const & msg)
+    {
+        return patternify(this, level, dt, _pattern, msg);
+    }
+
+    void emit (log_ns::priority level
+            , pfs::datetime const & dt
+            , pfs::string const & msg)
+    {
+        print_helper(level, dt, msg);
+    }
+
+protected:
+    virtual void print (log_ns::priority, pfs::datetime const &, pfs::string const & msg)
+    {
+        last = msg;
+    }
+};
+
+TEST_CASE("logger compiled pattern") {
+    static char const * patterns[] = {
+          ""
+        , "%m"
+        , "[%p]: %m"
+        , "%d{ABSOLUTE} [%p]: %m"
+        , "%d{DATE} [%p]: %m"
+        , "%d{ISO8601} [%p]: %m"
+        , "%d{%d/%m/%Y %H:%M:%S} [%p]: %m"
+        , "%d{%F %T %R %j %C %y %e %k %l %I %q %Q}%n%t%m"
+        , "%d{%Z %z %u}: %m"
+        , "%d{ABSOLUTE} [%p]: {%20.30m}"
+        , "%d{ABSOLUTE} [%p]: {%30m}"
+        , "%d{ABSOLUTE} [%p]: {%-30m}"
+        , "%.3m|%-5p|%5p|%3n|%-3t|"
+        , "100% plain text"
+        , 0
+    };
+
+    static char const * messages[] = {
+          ""
+        , "short"
+        , "This is a truncated message of logging with Trace priority"
+        , 0
+    };
+
+    pfs::datetime dates[] = {
+          pfs::datetime(pfs::date(2018, 1, 2), pfs::time(3, 4, 5, 6))
+        , pfs::datetime(pfs::date(1999, 12, 31), pfs::time(23, 59, 59, 999))
+        , pfs::datetime(pfs::date(2020, 2, 29), pfs::time(12, 0, 0, 0))
+    };
+
+    string_appender a;
+
+    for (char const ** p = patterns; *p; ++p) {
+        a.set_pattern(*p);
+
+        for (char const ** m = messages; *m; ++m) {
+            for (size_t i = 0; i < sizeof(dates) / sizeof(dates[0]); ++i) {
+                for (int level = log_ns::priority::trace; level <= log_ns::priority::fatal; ++level) {
+                    log_ns::priority pri(static_cast<log_ns::priority::type>(level));
+                    pfs::string msg(*m);
+
+                    a.emit(pri, dates[i], msg);
+
+                    pfs::string expected = pfs::string(*p).empty()
+                            ? msg
+                            : a.interpret(pri, dates[i], msg);
+
+                    INFO("pattern: \"" << *p << "\", message: \"" << *m << "\"");
+                    CHECK(a.last == expected);
+                }
+            }
+        }
+    }
+}
+
+#if __cplusplus >= 201103L
+
+class counting_appender : public log_ns::appender
+{
+public:
+    pfs::atomic<size_t> count;
+    int                 delay_us;
+
+    counting_appender (int delay = 0) : log_ns::appender(), count(0), delay_us(delay) {}
+
+    virtual bool is_open () const
+    {
+        return true;
+    }
+
+protected:
+    virtual void print (log_ns::priority, pfs::datetime const &, pfs::string const &)
+    {
+        if (delay_us > 0)
+            pfs::this_thread::sleep_for(pfs::chrono::microseconds(delay_us));
+        ++count;
+    }
+};
+
+static void async_producer (log_ns::async_logger * log, int n)
+{
+    for (int i = 0; i < n; ++i)
+        log->info("message");
+}
+
+TEST_CASE("async logger") {
+    int const nthreads = 4;
+    int const nmessages = 10000;
+
+    SECTION("block") {
+        log_ns::async_logger log(64, log_ns::overflow_policy::block);
+        counting_appender & a = static_cast<counting_appender &>(log.add_appender<counting_appender>());
+        log.connect(a);
+
+        pfs::thread threads[nthreads];
+
+        for (int i = 0; i < nthreads; ++i)
+            threads[i] = pfs::thread(async_producer, & log, nmessages);
+
+        for (int i = 0; i < nthreads; ++i)
+            threads[i].join();
+
+        log.flush();
+
+        CHECK(a.count == size_t(nthreads * nmessages));
+        CHECK(log.dropped() == 0);
+    }
+
+    SECTION("drop newest") {
+        log_ns::async_logger log(16, log_ns::overflow_policy::drop_newest);
+        counting_appender & a = static_cast<counting_appender &>(log.add_appender<counting_appender>(10));
+        log.connect(a);
+
+        async_producer(& log, 1000);
+        log.flush();
+
+        CHECK(log.dropped() > 0);
+        CHECK(a.count + log.dropped() == 1000);
+    }
+
+    SECTION("drop oldest") {
+        log_ns::async_logger log(16, log_ns::overflow_policy::drop_oldest);
+        counting_appender & a = static_cast<counting_appender &>(log.add_appender<counting_appender>(10));
+        log.connect(a);
+
+        async_producer(& log, 1000);
+        log.flush();
+
+        CHECK(log.dropped() > 0);
+        CHECK(a.count + log.dropped() == 1000);
+    }
+
+    SECTION("stop") {
+        log_ns::async_logger log;
+        counting_appender & a = static_cast<counting_appender &>(log.add_appender<counting_appender>());
+        log.connect(a);
+
+        async_producer(& log, 1000);
+        log.stop();
+        CHECK(a.count == 1000);
+
+        // Synchronous after stop
+        log.info("message");
+        CHECK(a.count == 1001);
+    }
+
+    SECTION("stop while producers print") {
+        log_ns::async_logger log(64, log_ns::overflow_policy::block);
+        counting_appender & a = static_cast<counting_appender &>(log.add_appender<counting_appender>());
+        log.connect(a);
+
+        pfs::thread threads[nthreads];
+
+        for (int i = 0; i < nthreads; ++i)
+            threads[i] = pfs::thread(async_producer, & log, nmessages);
+
+        log.stop();
+
+        for (int i = 0; i < nthreads; ++i)
+            threads[i].join();
+
+        CHECK(a.count + log.dropped() <= size_t(nthreads * nmessages));
+    }
+}
+
+#endif
+
+TEST_CASE("rotating file appender") {
+    pfs::filesystem::path path(pfs::filesystem::temp_directory_path());
+    path /= "pfs-test-rotating.log";
+
+    log_ns::rotation_params params;
+    params.max_size = 1000;
+    params.max_backups = 3;
+    params.buffer_size = 256;
+
+    pfs::error_code ec;
+    pfs::filesystem::remove(path, ec);
+
+    for (int i = 1; i <= params.max_backups + 1; ++i) {
+        pfs::filesystem::remove(pfs::filesystem::path(path.native() + "." + pfs::to_string(i).utf8()), ec);
+    }
+
+    {
+        log_ns::logger log;
+        log_ns::rotating_file_appender & a
+                = static_cast<log_ns::rotating_file_appender &>(
+                        log.add_appender<log_ns::rotating_file_appender>(path, params));
+        log.connect(a);
+
+        REQUIRE(a.is_open());
+
+        // 99 bytes per line (including new line)
+        pfs::string msg(98, 'x');
+
+        for (int i = 0; i < 45; ++i)
+            log.info(msg);
+
+        a.flush();
+        CHECK(!a.last_error());
+    }
+
+    // 45 lines = 5 segments: 4 full (10 lines each, the oldest one removed)
+    // and current (5 lines)
+    pfs::string content = pfs::io::u8_read_all(path, ec);
+    CHECK(content.size() == 5 * 99);
+
+    for (int i = 1; i <= params.max_backups; ++i) {
+        pfs::filesystem::path backup(path.native() + "." + pfs::to_string(i).utf8());
+        CHECK(pfs::filesystem::exists(backup, ec));
+        CHECK(pfs::io::u8_read_all(backup, ec).size() == 10 * 99);
+        pfs::filesystem::remove(backup, ec);
+    }
+
+    CHECK_FALSE(pfs::filesystem::exists(pfs::filesystem::path(path.native() + "." + pfs::to_string(params.max_backups + 1).utf8()), ec));
+    pfs::filesystem::remove(path, ec);
+}
+
+// Rollover time is taken from record's date, so interval is simulated
+// by records dated in the future
+TEST_CASE("rotating file appender interval rollover") {
+    pfs::filesystem::path path(pfs::filesystem::temp_directory_path());
+    path /= "pfs-test-rotating-interval.log";
+
+    log_ns::rotation_params params;
+    params.interval = 60;
+    params.max_backups = 2;
+    params.buffer_size = 256;
+
+    pfs::filesystem::path backup1(path.native() + ".1");
+    pfs::filesystem::path backup2(path.native() + ".2");
+
+    pfs::error_code ec;
+    pfs::filesystem::remove(path, ec);
+    pfs::filesystem::remove(backup1, ec);
+    pfs::filesystem::remove(backup2, ec);
+
+    {
+        log_ns::logger log;
+        log_ns::rotating_file_appender & a
+                = static_cast<log_ns::rotating_file_appender &>(
+                        log.add_appender<log_ns::rotating_file_appender>(path, params));
+        log.connect(a);
+
+        REQUIRE(a.is_open());
+
+        intmax_t now_ms = pfs::current_datetime().millis_since_epoch();
+        pfs::datetime now = pfs::datetime::from_millis_since_epoch(now_ms);
+        pfs::datetime next = pfs::datetime::from_millis_since_epoch(now_ms + 2 * params.interval * 1000);
+        pfs::datetime after_next = pfs::datetime::from_millis_since_epoch(now_ms + 4 * params.interval * 1000);
+
+        // 99 bytes per line (including new line)
+        pfs::string msg(98, 'x');
+
+        for (int i = 0; i < 3; ++i)
+            log.print(log_ns::priority::info, now, msg);
+
+        // Next interval
+        for (int i = 0; i < 2; ++i)
+            log.print(log_ns::priority::info, next, msg);
+
+        // Interval after next one
+        log.print(log_ns::priority::info, after_next, msg);
+
+        a.flush();
+        CHECK(!a.last_error());
+    }
+
+    CHECK(pfs::io::u8_read_all(path, ec).size() == 1 * 99);
+    CHECK(pfs::io::u8_read_all(backup1, ec).size() == 2 * 99);
+    CHECK(pfs::io::u8_read_all(backup2, ec).size() == 3 * 99);
+
+    pfs::filesystem::remove(path, ec);
+    pfs::filesystem::remove(backup1, ec);
+    pfs::filesystem::remove(backup2, ec);
+}
+
+#if HAVE_ZLIB
+TEST_CASE("rotating file appender with compression") {
+    pfs::filesystem::path path(pfs::filesystem::temp_directory_path());
+    path /= "pfs-test-rotating-gz.log";
+
+    log_ns::rotation_params params;
+    params.max_size = 1000;
+    params.max_backups = 2;
+    params.compress = true;
+
+    pfs::filesystem::path backup1(path.native() + ".1");
+    pfs::filesystem::path backup1_gz(path.native() + ".1.gz");
+    pfs::filesystem::path backup2_gz(path.native() + ".2.gz");
+
+    pfs::error_code ec;
+    pfs::filesystem::remove(path, ec);
+    pfs::filesystem::remove(backup1_gz, ec);
+    pfs::filesystem::remove(backup2_gz, ec);
+
+    {
+        log_ns::logger log;
+        log.connect(log.add_appender<log_ns::rotating_file_appender>(path, params));
+
+        pfs::string msg(98, 'x');
+
+        for (int i = 0; i < 25; ++i)
+            log.info(msg);
+    }
+
+    CHECK_FALSE(pfs::filesystem::exists(backup1, ec));
+    CHECK(pfs::filesystem::exists(backup1_gz, ec));
+    CHECK(pfs::filesystem::exists(backup2_gz, ec));
+
+    pfs::filesystem::remove(path, ec);
+    pfs::filesystem::remove(backup1_gz, ec);
+    pfs::filesystem::remove(backup2_gz, ec);
+}
+#endif
@@ -72,3 +72,164 @@
 // 
 //     return END_TESTS;
 // }
+
+#if __cplusplus >= 201103L
+
+#include <pfs/atomic.hpp>
+#include <pfs/thread.hpp>
+
+typedef pfs::snapshot_sigslot<> snapshot_ns;
+
+class snapshot_slot : public snapshot_ns::has_slots
+{
+public:
+    pfs::atomic_int sum;
+    pfs::atomic_int calls;
+
+    snapshot_slot () : sum(0), calls(0) {}
+
+    ~snapshot_slot ()
+    {
+        disconnect_all();
+    }
+
+    void on_void ()
+    {
+        ++calls;
+    }
+
+    void on_value (int v)
+    {
+        sum += v;
+        ++calls;
+    }
+
+    void on_values (int a, int b, int c)
+    {
+        sum += a + b + c;
+        ++calls;
+    }
+};
+
+TEST_CASE("snapshot_sigslot emit") {
+    snapshot_ns::signal0 sig0;
+    snapshot_ns::signal1<int> sig1;
+    snapshot_ns::signal3<int, int, int> sig3;
+    snapshot_slot a;
+    snapshot_slot b;
+
+    CHECK(!sig1.isConnected());
+
+    sig0.connect(& a, & snapshot_slot::on_void);
+    sig1.connect(& a, & snapshot_slot::on_value);
+    sig1.connect(& b, & snapshot_slot::on_value);
+    sig3.connect(& b, & snapshot_slot::on_values);
+
+    CHECK(sig1.isConnected());
+    CHECK(a.count() == 2);
+    CHECK(b.count() == 2);
+
+    sig0();
+    sig1(10);
+    sig3.emit_(1, 2, 3);
+
+    CHECK(a.calls.load() == 2);
+    CHECK(a.sum.load() == 10);
+    CHECK(b.calls.load() == 2);
+    CHECK(b.sum.load() == 16);
+
+    sig1.disconnect(& a);
+    sig1(5);
+
+    CHECK(a.sum.load() == 10);
+    CHECK(b.sum.load() == 21);
+    CHECK(a.count() == 1);
+
+    // Copy of signal has the same connections
+    snapshot_ns::signal1<int> sig1_copy(sig1);
+    sig1_copy(1);
+
+    CHECK(b.sum.load() == 22);
+    CHECK(b.count() == 3);
+
+    sig0.disconnect_all();
+    sig0();
+
+    CHECK(!sig0.isConnected());
+    CHECK(a.calls.load() == 2);
+    CHECK(a.count() == 0);
+}
+
+TEST_CASE("snapshot_sigslot slot destruction") {
+    snapshot_ns::signal1<int> sig;
+    snapshot_slot a;
+
+    sig.connect(& a, & snapshot_slot::on_value);
+
+    {
+        snapshot_slot b;
+        sig.connect(& b, & snapshot_slot::on_value);
+        sig.connect(& b, & snapshot_slot::on_value);
+        sig(1);
+        CHECK(b.sum.load() == 2);
+
+        // One of two connections is left
+        sig.disconnect(& b);
+        CHECK(b.count() == 1);
+    }
+
+    sig(1);
+    CHECK(a.sum.load() == 2);
+}
+
+static void emit_loop (snapshot_ns::signal1<int> * sig
+        , pfs::atomic_int * stop
+        , int * emitted)
+{
+    int n = 0;
+
+    while (!stop->load()) {
+        sig->emit_(1);
+        ++n;
+    }
+
+    *emitted = n;
+}
+
+TEST_CASE("snapshot_sigslot concurrent emit and connect/disconnect") {
+    static int const NTHREADS = 4;
+
+    snapshot_ns::signal1<int> sig;
+    snapshot_slot permanent;
+    pfs::atomic_int stop(0);
+    int emitted[NTHREADS];
+    pfs::thread threads[NTHREADS];
+
+    sig.connect(& permanent, & snapshot_slot::on_value);
+
+    for (int i = 0; i < NTHREADS; ++i)
+        threads[i] = pfs::thread(emit_loop, & sig, & stop, & emitted[i]);
+
+    // Slots are connected and destroyed while signal is emitted:
+    // disconnection must wait for emitters using the slot.
+    for (int i = 0; i < 200; ++i) {
+        snapshot_slot temporary;
+        sig.connect(& temporary, & snapshot_slot::on_value);
+        pfs::this_thread::yield();
+    }
+
+    stop.store(1);
+
+    int total = 0;
+
+    for (int i = 0; i < NTHREADS; ++i) {
+        threads[i].join();
+        total += emitted[i];
+    }
+
+    CHECK(permanent.sum.load() == total);
+    CHECK(sig.isConnected());
+    CHECK(permanent.count() == 1);
+}
+
+#endif
@@ -0,0 +1,263 @@
+#include "../catch.hpp"
+
+// pfs::thread_pool requires C++11
+#if __cplusplus >= 201103L
+
+#include <pfs/atomic.hpp>
+#include <pfs/thread.hpp>
+#include <pfs/thread_pool.hpp>
+#include <pfs/sigslot.hpp>
+
+static pfs::atomic_int counter(0);
+
+static void inc ()
+{
+    ++counter;
+}
+
+static void add (int a, int b)
+{
+    counter += a + b;
+}
+
+class A
+{
+public:
+    pfs::atomic_int value;
+
+    A () : value(0) {}
+
+    void method (int a)
+    {
+        value += a;
+    }
+};
+
+static pfs::thread_pool * spawn_pool = 0;
+
+// Pushes jobs from inside a worker (they go to the worker's own deque)
+static void spawn (int n)
+{
+    for (int i = 0; i < n; ++i)
+        spawn_pool->push_function(& inc);
+}
+
+TEST_CASE("thread_pool basic") {
+    pfs::thread_pool pool(4);
+    A a;
+
+    CHECK(pool.size() == 4);
+
+    counter = 0;
+
+    for (int i = 0; i < 10000; ++i) {
+        pool.push_function(& inc);
+        pool.push_function(& add, 1, 2);
+        pool.push_method(& A::method, & a, 2);
+    }
+
+    pool.wait_idle();
+
+    CHECK(pool.count() == 0);
+    CHECK(counter.load() == 10000 * 4);
+    CHECK(a.value.load() == 20000);
+
+    pfs::thread_pool::size_type executed = 0;
+
+    for (size_t i = 0; i < pool.size(); ++i)
+        executed += pool.stats(i).executed;
+
+    CHECK(executed == 30000);
+}
+
+TEST_CASE("thread_pool work stealing") {
+    pfs::thread_pool pool(4);
+    spawn_pool = & pool;
+    counter = 0;
+
+    // All jobs are pushed into the deque of a single worker,
+    // others have to steal them.
+    pool.push_function(& spawn, 20000);
+    pool.wait_idle();
+
+    CHECK(counter.load() == 20000);
+
+    pfs::thread_pool::size_type executed = 0;
+    pfs::thread_pool::size_type steals = 0;
+
+    for (size_t i = 0; i < pool.size(); ++i) {
+        executed += pool.stats(i).executed;
+        steals += pool.stats(i).steals;
+    }
+
+    CHECK(executed == 20001);
+    CHECK(steals > 0);
+}
+
+TEST_CASE("thread_pool shutdown") {
+    counter = 0;
+
+    {
+        pfs::thread_pool pool(2);
+
+        for (int i = 0; i < 1000; ++i)
+            pool.push_function(& inc);
+
+        pool.shutdown();
+
+        CHECK(pool.stopped());
+        CHECK(counter.load() == 1000);
+
+        // Executed by the calling thread
+        pool.push_function(& inc);
+        CHECK(counter.load() == 1001);
+    }
+}
+
+static void push_many (pfs::thread_pool * pool, int n)
+{
+    for (int i = 0; i < n; ++i)
+        pool->push_function(& inc);
+}
+
+// Every job pushed concurrently with shutdown() is executed either
+// by the pool or by the pushing thread, so wait_idle() does not hang
+TEST_CASE("thread_pool push concurrently with shutdown") {
+    for (int round = 0; round < 50; ++round) {
+        counter = 0;
+
+        pfs::thread_pool pool(2);
+        pfs::thread pusher1(& push_many, & pool, 2000);
+        pfs::thread pusher2(& push_many, & pool, 2000);
+
+        pool.shutdown();
+
+        pusher1.join();
+        pusher2.join();
+
+        pool.wait_idle();
+
+        CHECK(pool.count() == 0);
+        CHECK(counter.load() == 4000);
+    }
+}
+
+typedef pfs::sigslot<pfs::thread_pool_queue, pfs::mutex> sigslot_ns;
+
+class slot_holder : public sigslot_ns::has_async_slots
+{
+public:
+    pfs::atomic_int sum;
+
+    slot_holder () : sum(0) {}
+
+    void on_value (int v)
+    {
+        sum += v;
+    }
+};
+
+TEST_CASE("thread_pool as sigslot backend") {
+    sigslot_ns::signal1<int> sig;
+    slot_holder h;
+
+    sig.connect(& h, & slot_holder::on_value);
+
+    for (int i = 1; i <= 100; ++i)
+        sig(i);
+
+    h.callback_queue().pool().wait_idle();
+
+    CHECK(h.sum.load() == 5050);
+}
+
+static pfs::atomic_int blocked(0);
+static pfs::atomic_int released(0);
+
+static void block_worker ()
+{
+    ++blocked;
+
+    while (released.load() == 0)
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(1));
+}
+
+class cancelling_holder : public sigslot_ns::has_async_slots
+{
+public:
+    pfs::atomic_int started;
+    pfs::atomic_int finished;
+
+    cancelling_holder () : started(0), finished(0) {}
+
+    ~cancelling_holder ()
+    {
+        this->callback_queue().cancel();
+        this->priority_callback_queue().cancel();
+    }
+
+    void on_value (int)
+    {
+        ++counter;
+    }
+
+    void on_slow (int)
+    {
+        ++started;
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(50));
+        ++finished;
+    }
+};
+
+// Jobs queued for a destroyed receiver are dropped
+TEST_CASE("thread_pool_queue drops jobs of destroyed receiver") {
+    pfs::thread_pool & pool = pfs::thread_pool::default_pool();
+    int nworkers = static_cast<int>(pool.size());
+
+    counter = 0;
+    blocked = 0;
+    released = 0;
+
+    for (int i = 0; i < nworkers; ++i)
+        pool.push_function(& block_worker);
+
+    while (blocked.load() < nworkers)
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(1));
+
+    sigslot_ns::signal1<int> sig;
+
+    {
+        cancelling_holder h;
+        sig.connect(& h, & cancelling_holder::on_value);
+
+        for (int i = 0; i < 100; ++i)
+            sig(i);
+    }
+
+    released = 1;
+    pool.wait_idle();
+
+    CHECK(counter.load() == 0);
+}
+
+// Destruction waits for the slot in progress
+TEST_CASE("thread_pool_queue waits for slot in progress") {
+    sigslot_ns::signal1<int> sig;
+    int finished = 0;
+
+    {
+        cancelling_holder h;
+        sig.connect(& h, & cancelling_holder::on_slow);
+        sig(1);
+
+        while (h.started.load() == 0)
+            pfs::this_thread::sleep_for(pfs::chrono::milliseconds(1));
+
+        h.callback_queue().cancel();
+        finished = h.finished.load();
+    }
+
+    CHECK(finished == 1);
+}
+
+#endif
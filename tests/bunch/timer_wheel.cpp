@@ -0,0 +1,182 @@
+#include <vector>
+#include <pfs/timer_wheel.hpp>
+#include "../catch.hpp"
+
+typedef pfs::timer_wheel<int> timer_wheel;
+
+struct collector
+{
+    std::vector<int> values;
+    std::vector<timer_wheel::id_type> ids;
+
+    void operator () (timer_wheel::id_type id, int value)
+    {
+        ids.push_back(id);
+        values.push_back(value);
+    }
+};
+
+struct stopper
+{
+    timer_wheel * w;
+    timer_wheel::id_type a;
+    timer_wheel::id_type b;
+    int count;
+
+    void operator () (timer_wheel::id_type, int)
+    {
+        ++count;
+        w->stop(a);
+        w->stop(b);
+    }
+};
+
+TEST_CASE("timer_wheel one-shot") {
+    timer_wheel w;
+    timer_wheel::tick_type start = w.now();
+    collector c;
+
+    timer_wheel::id_type id1 = w.start_after(Timer_OneShot, 10, 1);
+    timer_wheel::id_type id2 = w.start_after(Timer_OneShot, 300, 2);     // Second wheel
+    timer_wheel::id_type id3 = w.start_after(Timer_OneShot, 70000, 3);   // Third wheel
+    timer_wheel::id_type id4 = w.start_after(Timer_OneShot, 20000000, 4); // Fourth wheel
+
+    CHECK(w.size() == 4);
+    CHECK(w.is_active(id1));
+    CHECK_FALSE(w.is_periodic(id1));
+    CHECK(*w.value(id2) == 2);
+
+    timer_wheel::tick_type ticks = 0;
+    CHECK(w.next_expiration(ticks));
+    CHECK(ticks == 10);
+
+    CHECK(w.expire_until(start + 9, c) == 0);
+    CHECK(w.expire_until(start + 10, c) == 1);
+    CHECK(c.values.size() == 1);
+    CHECK(c.values[0] == 1);
+    CHECK(c.ids[0] == id1);
+    CHECK_FALSE(w.is_active(id1));
+
+    CHECK(w.expire_until(start + 299, c) == 0);
+    CHECK(w.expire_until(start + 300, c) == 1);
+    CHECK(c.values.back() == 2);
+
+    CHECK(w.expire_until(start + 69999, c) == 0);
+    CHECK(w.expire_until(start + 70000, c) == 1);
+    CHECK(c.values.back() == 3);
+
+    CHECK(w.expire_until(start + 19999999, c) == 0);
+    CHECK(w.expire_until(start + 20000000, c) == 1);
+    CHECK(c.values.back() == 4);
+
+    CHECK(w.empty());
+    CHECK_FALSE(w.next_expiration(ticks));
+    CHECK(w.next_timeout() < 0);
+
+    // Stale identifier
+    CHECK_FALSE(w.stop(id4));
+}
+
+TEST_CASE("timer_wheel periodic and stop") {
+    timer_wheel w;
+    timer_wheel::tick_type start = w.now();
+    collector c;
+
+    timer_wheel::id_type p = w.start_after(Timer_Periodic, 100, 7);
+    timer_wheel::id_type s = w.start_after(Timer_OneShot, 150, 8);
+
+    CHECK(w.is_periodic(p));
+    CHECK(w.stop(s));
+    CHECK_FALSE(w.stop(s));
+
+    CHECK(w.expire_until(start + 1000, c) == 10);
+    CHECK(c.values.size() == 10);
+    CHECK(w.is_active(p));
+
+    for (size_t i = 0; i < c.values.size(); ++i) {
+        CHECK(c.values[i] == 7);
+        CHECK(c.ids[i] == p);
+    }
+
+    // Callback stops itself and other timer expiring at the same tick
+    timer_wheel::id_type a = w.start_after(Timer_Periodic, 5, 1);
+    timer_wheel::id_type b = w.start_after(Timer_OneShot, 5, 2);
+
+    // First expired timer (order is unspecified) stops both
+    stopper st;
+    st.w = & w;
+    st.a = a;
+    st.b = b;
+    st.count = 0;
+
+    w.stop(p);
+    CHECK(w.expire_until(w.now() + 5, st) == 1);
+    CHECK(st.count == 1);
+    CHECK_FALSE(w.is_active(a));
+    CHECK_FALSE(w.is_active(b));
+    CHECK(w.empty());
+}
+
+TEST_CASE("timer_wheel many timers") {
+    timer_wheel w;
+    timer_wheel::tick_type start = w.now();
+    collector c;
+    int const n = 200000;
+
+    w.reserve(n);
+
+    std::vector<timer_wheel::id_type> ids;
+    ids.reserve(n);
+
+    for (int i = 0; i < n; ++i)
+        ids.push_back(w.start_after(Timer_OneShot, 1 + (i * 7919) % 100000, i));
+
+    CHECK(w.size() == size_t(n));
+
+    // Cancel every second timer
+    for (int i = 0; i < n; i += 2)
+        CHECK(w.stop(ids[i]));
+
+    CHECK(w.size() == size_t(n / 2));
+    CHECK(w.expire_until(start + 100000, c) == size_t(n / 2));
+    CHECK(w.empty());
+
+    bool ordered = true;
+    bool odd = true;
+
+    for (size_t i = 0; i < c.values.size(); ++i) {
+        if (c.values[i] % 2 == 0)
+            odd = false;
+
+        if (i > 0) {
+            int prev = 1 + (c.values[i - 1] * 7919) % 100000;
+            int cur  = 1 + (c.values[i] * 7919) % 100000;
+
+            if (prev > cur)
+                ordered = false;
+        }
+    }
+
+    CHECK(odd);
+    CHECK(ordered);
+}
+
+TEST_CASE("timer_wheel clock") {
+    timer_wheel w(1000);
+    collector c;
+
+    timer_wheel::id_type id = w.start(Timer_OneShot, 0.02, 1);
+
+    double timeout = w.next_timeout();
+    CHECK(timeout > 0);
+    CHECK(timeout <= 0.021);
+
+    while (w.is_active(id)) {
+        struct timespec ts = { 0, 1000000 };
+        nanosleep(& ts, 0);
+        w.expire(c);
+    }
+
+    CHECK(c.values.size() == 1);
+    CHECK(w.next_timeout() < 0);
+}
@@ -6,10 +6,14 @@
  * @brief
  */
 
+#include <algorithm>
 #include <pfs/test.hpp>
 #include <pfs/fsm/fsm.hpp>
 #include <pfs/fsm/traits.hpp>
+#include <pfs/fsm/stream.hpp>
 #include <pfs/iterator.hpp>
+#include <pfs/thread.hpp>
+#include <pfs/memory.hpp>
 
 typedef std::string                                string_t;
 typedef pfs::fsm::fsm<string_t::const_iterator> fsm_type;
@@ -478,6 +482,264 @@ void test_rpt ()
 			== fsm_type::result_type(true, rpt_chars.end()));
 }
 
+static fsm_type::result_type match_none (
+                          fsm_type::iterator /*begin*/
+                        , fsm_type::iterator end
+                        , void * /*parse_context*/
+                        , void * /*fn_context*/)
+{
+    return fsm_type::result_type(false, end);
+}
+
+static string_t const DIGIT("0123456789");
+static string_t const ZERO("0");
+static string_t const EXP("eE");
+static string_t const SIGN("-+");
+static string_t const TRUE_S("true");
+static string_t const FALSE_S("false");
+static string_t const NULL_S("null");
+static string_t const PUNCT(":,[]{}");
+
+/*
+ * Tables are instantiated twice: first ones are interpreted,
+ * second ones are compiled.
+ */
+template <int N>
+static fsm_type::transition_type const * token_grammar ()
+{
+    /* 1*DIGIT */
+    static fsm_type::transition_type const digits_tr[] = {
+          { 1,-1, fsm_type::one_of(DIGIT.begin(), DIGIT.end()), fsm_type::accept, 0, 0 }
+        , { 1,-1, fsm_type::one_of(DIGIT.begin(), DIGIT.end()), fsm_type::accept, 0, 0 }
+    };
+
+    /* int = "0" / digit1-9 *DIGIT */
+    static fsm_type::transition_type const int_tr[] = {
+          {-1, 1, fsm_type::seq(ZERO.begin(), ZERO.end())        , fsm_type::accept, 0, 0 }
+        , { 2,-1, fsm_type::range(char_type('1'), char_type('9')), fsm_type::accept, 0, 0 }
+        , {-1,-1, fsm_type::rpt_one_of(DIGIT.begin(), DIGIT.end(), 0, -1), fsm_type::accept, 0, 0 }
+    };
+
+    /* number = [ "-" ] int [ "." 1*DIGIT ] [ ( "e" / "E" ) [ "-" / "+" ] 1*DIGIT ] */
+    static fsm_type::transition_type const number_tr[] = {
+          { 1,-1, fsm_type::opt_eq(char_type('-'))                 , fsm_type::normal, 0, 0 }
+        , { 2,-1, fsm_type::tr(int_tr)                             , fsm_type::accept, 0, 0 }
+        , { 3, 4, fsm_type::eq(char_type('.'))                     , fsm_type::normal, 0, 0 }
+        , { 4,-1, fsm_type::tr(digits_tr)                          , fsm_type::accept, 0, 0 }
+        , { 5,-1, fsm_type::one_of(EXP.begin(), EXP.end())         , fsm_type::normal, 0, 0 }
+        , { 6,-1, fsm_type::opt_one_of(SIGN.begin(), SIGN.end())   , fsm_type::normal, 0, 0 }
+        , {-1,-1, fsm_type::tr(digits_tr)                          , fsm_type::accept, 0, 0 }
+    };
+
+    /* Single-character alternatives chain */
+    static fsm_type::transition_type const punct_tr[] = {
+          {-1, 1, fsm_type::eq(char_type(':'))                           , fsm_type::accept, 0, 0 }
+        , {-1, 2, fsm_type::one_of(PUNCT.begin(), PUNCT.end())           , fsm_type::accept, 0, 0 }
+        , {-1, 3, fsm_type::range(char_type('\x80'), char_type('\xff'))  , fsm_type::accept, 0, 0 }
+        , {-1,-1, fsm_type::range(char_type('a'), char_type('c'))        , fsm_type::normal, 0, 0 }
+    };
+
+    static fsm_type::transition_type const token_tr[] = {
+          {-1, 1, fsm_type::tr(number_tr)                        , fsm_type::accept, 0, 0 }
+        , {-1, 2, fsm_type::seq(TRUE_S.begin(), TRUE_S.end())    , fsm_type::accept, 0, 0 }
+        , {-1, 3, fsm_type::seq(FALSE_S.begin(), FALSE_S.end())  , fsm_type::accept, 0, 0 }
+        , {-1, 4, fsm_type::seq(NULL_S.begin(), NULL_S.end())    , fsm_type::accept, 0, 0 }
+        , {-1,-1, fsm_type::tr(punct_tr)                         , fsm_type::accept, 0, 0 }
+    };
+
+    /* match_func can't be lowered */
+    static fsm_type::transition_type const tokens_tr[] = {
+          { 1,-1, fsm_type::rpt_tr(token_tr, 0, -1), fsm_type::accept, 0, 0 }
+        , {-1, 2, fsm_type::eq(char_type('#'))     , fsm_type::accept, 0, 0 }
+        , {-1,-1, fsm_type::func(match_none, 0)    , fsm_type::accept, 0, 0 }
+    };
+
+    return tokens_tr;
+}
+
+static void test_compile ()
+{
+    static char const * samples[] = {
+          "", "0", "-12.5e+3", "01", "1.", "1e", "-", "123abc", "true"
+        , "nul", "nulltrue", ":,[", "\xC3\xA9", "abcd", "d", "0.25E-10:true"
+        , "#", "12#", "false,null]", "9999999999e9", "\x7f"
+    };
+
+    int count = sizeof(samples) / sizeof(samples[0]);
+
+    ADD_TESTS(count + 1);
+
+    fsm_type::transition_type const * interpreted = token_grammar<0>();
+    fsm_type::transition_type const * compiled = token_grammar<1>();
+
+    TEST_OK(fsm_type::compile(compiled) == false);
+
+    for (int i = 0; i < count; ++i) {
+        string_t const s(samples[i]);
+        fsm_type f1(interpreted);
+        fsm_type f2(compiled);
+        fsm_type::result_type r1 = f1.exec(0, s.begin(), s.end());
+        fsm_type::result_type r2 = f2.exec(0, s.begin(), s.end());
+
+        TEST_OK2(r1.first == r2.first
+                && pfs::distance(s.begin(), r1.second) == pfs::distance(s.begin(), r2.second)
+            , samples[i]);
+    }
+}
+
+#if __cplusplus >= 201103L
+
+static void compile_and_match (bool * ok)
+{
+    string_t s("0.25E-10:true");
+    fsm_type::compile(token_grammar<2>());
+    fsm_type f(token_grammar<2>());
+    fsm_type::result_type r = f.exec(0, s.begin(), s.end());
+    *ok = r.first && r.second == s.end();
+}
+
+/*
+ * Grammars sharing the same static tables are constructed
+ * in different threads.
+ */
+static void test_concurrent_compile ()
+{
+    static int const THREAD_COUNT = 8;
+
+    ADD_TESTS(1);
+
+    bool ok[THREAD_COUNT];
+    pfs::unique_ptr<pfs::thread> threads[THREAD_COUNT];
+
+    for (int i = 0; i < THREAD_COUNT; ++i)
+        threads[i] = pfs::make_unique<pfs::thread>(& compile_and_match, & ok[i]);
+
+    bool all_ok = true;
+
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads[i]->join();
+        all_ok = all_ok && ok[i];
+    }
+
+    TEST_OK2(all_ok, "Tables compiled concurrently are matched in each thread");
+}
+
+#endif
+
+typedef pfs::fsm::stream<fsm_type::iterator, string_t> stream_type;
+
+static stream_type::status_enum feed_by_chunks (stream_type & s
+        , string_t const & input
+        , size_t chunk_size)
+{
+    for (size_t i = 0; i < input.size(); i += chunk_size) {
+        size_t n = std::min(chunk_size, input.size() - i);
+        s.feed(input.begin() + i, input.begin() + i + n);
+    }
+
+    return s.finish();
+}
+
+static bool append_word (fsm_type::iterator first
+        , fsm_type::iterator last
+        , void * context
+        , void const * /*action_args*/)
+{
+    if (!context) return true;
+
+    string_t * words = static_cast<string_t *>(context);
+    words->append(1, '[');
+    words->append(first, last);
+    words->append(1, ']');
+    return true;
+}
+
+static fsm_type::transition_type const word_tr[] = {
+      {-1, 1, fsm_type::seq(TRUE_S.begin(), TRUE_S.end())         , fsm_type::accept, append_word, 0 }
+    , {-1,-1, fsm_type::rpt_one_of(DIGIT.begin(), DIGIT.end(), 1, -1), fsm_type::accept, append_word, 0 }
+};
+
+static fsm_type::transition_type const words_tr[] = {
+      {-1,-1, fsm_type::rpt_tr(word_tr, 0, -1), fsm_type::accept, 0, 0 }
+};
+
+static void test_stream ()
+{
+    static char const * samples[] = {
+          "", "0", "-12.5e+3", "01", "1.", "1e", "-", "123abc", "true"
+        , "nul", "nulltrue", ":,[", "\xC3\xA9", "abcd", "d", "0.25E-10:true"
+        , "#", "12#", "false,null]", "9999999999e9", "\x7f"
+    };
+
+    static size_t const chunk_sizes[] = { 1, 3, 64 };
+
+    int count = sizeof(samples) / sizeof(samples[0]);
+    int nchunks = sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+
+    ADD_TESTS(2 * count * nchunks + 8);
+
+    fsm_type::transition_type const * tables[] = {
+          token_grammar<0>()
+        , token_grammar<1>()
+    };
+
+    // Compiled tables are executed by stream as interpreted ones
+    for (int t = 0; t < 2; ++t) {
+        for (int i = 0; i < count; ++i) {
+            string_t const s(samples[i]);
+            fsm_type f(tables[t]);
+            fsm_type::result_type r = f.exec(0, s.begin(), s.end());
+
+            for (int c = 0; c < nchunks; ++c) {
+                stream_type st(tables[t]);
+                stream_type::status_enum status = feed_by_chunks(st, s, chunk_sizes[c]);
+
+                TEST_OK2(r.first
+                        ? (status == stream_type::accepted
+                            && st.position() == size_t(pfs::distance(s.begin(), r.second)))
+                        : status == stream_type::rejected
+                    , samples[i]);
+            }
+        }
+    }
+
+    // Need more input until the end of token is known
+    {
+        string_t s("tru");
+        stream_type st(token_grammar<0>());
+
+        TEST_OK(st.feed(s) == stream_type::need_more);
+        TEST_OK(st.finish() == stream_type::accepted && st.position() == 0);
+    }
+
+    // Consecutive inputs
+    {
+        string_t s("true12");
+        stream_type st(word_tr);
+
+        TEST_OK(st.feed(s) == stream_type::accepted && st.position() == 4);
+        TEST_OK(st.next() == stream_type::need_more);
+        TEST_OK(st.finish() == stream_type::accepted && st.position() == 2);
+    }
+
+    // Actions are called in the same order with the same arguments
+    {
+        string_t s("true12true7true");
+        string_t words;
+        string_t stream_words;
+
+        fsm_type f(words_tr, & words);
+        fsm_type::result_type r = f.exec(0, s.begin(), s.end());
+
+        stream_type st(words_tr, & stream_words);
+
+        TEST_OK(r.first && r.second == s.end());
+        TEST_OK(feed_by_chunks(st, s, 1) == stream_type::accepted
+                && st.position() == s.size());
+        TEST_OK2(stream_words == words, words.c_str());
+    }
+}
+
 int main(int argc, char *argv[])
 {
 	(void)argc;
@@ -494,6 +756,11 @@ int main(int argc, char *argv[])
     test_repetition_1or2more();
     test_alternatives();
     test_rpt();
+    test_compile();
+#if __cplusplus >= 201103L
+    test_concurrent_compile();
+#endif
+    test_stream();
 
 	return END_TESTS;
 }
@@ -60,6 +60,121 @@ using pfs::io::open_params;
 
 static int const INITIAL_SIZE = 1024;
 
+typedef pfs::io::buffered_device<device_ptr, pfs::io::ring_buffer> ring_buffered_device;
+
+void test_ring_buffer ()
+{
+    ADD_TESTS(6);
+
+    // Non-mirrored buffer with wrapped data
+    pfs::io::ring_buffer rb(8, false);
+    size_t n = 0;
+
+    byte_t * p = rb.prepare(n);
+    TEST_FAIL(n == 8);
+    std::memcpy(p, "abcdef", 6);
+    rb.commit(6);
+    rb.consume(4);
+
+    p = rb.prepare(n);
+    TEST_OK(n == 2); // Up to the end of the buffer
+    std::memcpy(p, "gh", 2);
+    rb.commit(2);
+
+    p = rb.prepare(n);
+    TEST_OK(n == 4);
+    std::memcpy(p, "ijkl", 4);
+    rb.commit(4);
+
+    TEST_OK(rb.full());
+    TEST_OK(rb.contiguous_size() == 4);
+    TEST_OK(std::memcmp(rb.linearize(8), "efghijkl", 8) == 0);
+
+    // Mirrored buffer (if supported): wrapped data is contiguous
+    pfs::io::ring_buffer mrb(1);
+
+    if (mrb.is_mirrored()) {
+        ADD_TESTS(2);
+
+        size_t cap = mrb.capacity();
+        p = mrb.prepare(n);
+        std::memset(p, 'x', cap - 2);
+        mrb.commit(cap - 2);
+        mrb.consume(cap - 4);
+
+        p = mrb.prepare(n);
+        TEST_OK(n == cap - 2);
+        std::memcpy(p, "abcd", 4);
+        mrb.commit(4);
+
+        TEST_OK(mrb.contiguous_size() == 6 && std::memcmp(mrb.data(), "xxabcd", 6) == 0);
+    }
+}
+
+void test_ring_buffered_read ()
+{
+    ADD_TESTS(1);
+
+    size_t chunk_size = 1;
+
+    for (; chunk_size < 128; ++chunk_size) {
+        pfs::byte_string buffer(loremipsum, std::strlen(loremipsum));
+        device_ptr d = open_device(open_params<pfs::io::buffer>(buffer));
+
+        byte_string result;
+        ring_buffered_device bd(d, 256);
+
+        while (!bd.at_end())
+            bd.read(result, chunk_size);
+
+        if (result != loremipsum)
+            break;
+    }
+
+    TEST_OK2(chunk_size == 128, "Ring buffered device: all variants are passed");
+}
+
+// Parse lines in place
+void test_peek_consume ()
+{
+    ADD_TESTS(3);
+
+    pfs::byte_string buffer(loremipsum, std::strlen(loremipsum));
+    device_ptr d = open_device(open_params<pfs::io::buffer>(buffer));
+
+    ring_buffered_device bd(d, 4096);
+    bd.set_high_watermark(256);
+
+    size_t nlines = 0;
+    size_t max_cached = 0;
+    bool backpressure = false;
+    byte_string result;
+
+    for (;;) {
+        pfs::io::const_buffer view = bd.peek(256);
+
+        if (bd.backpressure())
+            backpressure = true;
+
+        if (bd.cached() > max_cached)
+            max_cached = bd.cached();
+
+        if (view.size == 0)
+            break;
+
+        byte_t const * eol = static_cast<byte_t const *>(std::memchr(view.data, '\n', view.size));
+        size_t len = eol ? size_t(eol - view.data) + 1 : view.size;
+
+        result.append(view.data, len);
+        bd.consume(len);
+        ++nlines;
+    }
+
+    TEST_OK(max_cached == 256);
+    TEST_OK(backpressure);
+    TEST_OK2(result == loremipsum && nlines == 40, "Lines parsed in place");
+}
+
 int main ()
 {
     BEGIN_TESTS(1);
@@ -83,5 +198,9 @@ int main ()
 
     TEST_OK2(initial_size == 0, "All variants are passed");
 
+    test_ring_buffer();
+    test_ring_buffered_read();
+    test_peek_consume();
+
     return END_TESTS;
 }
@@ -17,6 +17,8 @@ static pfs::net::inet4_addr const TCP_LISTENER_ADDR(127, 0, 0, 1);
 static uint16_t const             TCP_LISTENER_PORT(9876);
 static pfs::net::inet4_addr const TCP_DEFUNCT_LISTENER_ADDR(127, 0, 0, 1);
 static uint16_t const             TCP_DEFUNCT_LISTENER_PORT(7654);
+static uint16_t const             TCP_QUEUED_LISTENER_PORT(9877);
+static uint16_t const             UDP_LISTENER_PORT(9878);
 
 struct event_handler : pfs::sigslot<>::has_slots
 {
@@ -73,6 +75,197 @@ struct event_handler : pfs::sigslot<>::has_slots
     }
 };
 
+struct write_queue_handler : pfs::sigslot<>::has_slots
+{
+    pfs::io::device_ptr peer;
+    int high_count;
+    int low_count;
+
+    write_queue_handler () : high_count(0), low_count(0) {}
+
+    void device_accepted (pfs::io::device_ptr d, pfs::io::server_ptr)
+    {
+        peer = d;
+    }
+
+    void write_high_watermark (pfs::io::device_ptr)
+    {
+        ++high_count;
+    }
+
+    void write_low_watermark (pfs::io::device_ptr)
+    {
+        ++low_count;
+    }
+};
+
+// Writes a lot of data into accepted peer without blocking,
+// client reads it slowly in the same thread
+void test_write_queue ()
+{
+    ADD_TESTS(6);
+
+    static size_t const HIGH_WATERMARK = 64 * 1024;
+    static size_t const LOW_WATERMARK  = 16 * 1024;
+    static size_t const CHUNK_SIZE     = 16 * 1024;
+    static size_t const CHUNK_COUNT    = 256; // 4 MB total
+
+    pfs::error_code ec;
+    write_queue_handler h;
+    device_manager devman;
+
+    devman.accepted.connect(& h, & write_queue_handler::device_accepted);
+    devman.write_high_watermark.connect(& h, & write_queue_handler::write_high_watermark);
+    devman.write_low_watermark.connect(& h, & write_queue_handler::write_low_watermark);
+
+    pfs::io::server_ptr tcp_server = devman.new_server(
+            pfs::io::open_params<pfs::io::tcp_server>(TCP_LISTENER_ADDR
+                    , TCP_QUEUED_LISTENER_PORT
+                    , TCP_LISTENER_DEFAULT_BACKLOG
+                    , pfs::io::read_write | pfs::io::non_blocking)
+                    , ec);
+
+    TEST_FAIL2(!ec, "TCP listener opened");
+
+    pfs::io::device_ptr client = pfs::io::open_device(
+            pfs::io::open_params<pfs::io::tcp_socket>(TCP_LISTENER_ADDR
+                , TCP_QUEUED_LISTENER_PORT
+                , pfs::io::read_write)
+                , ec);
+
+    TEST_FAIL2(!ec, "TCP client connected");
+
+    time_t t = time(0);
+
+    while (!h.peer && time(0) - t < 5)
+        devman.dispatch(10);
+
+    TEST_FAIL2(h.peer, "Connection accepted");
+    TEST_FAIL(h.peer->enable_write_queue(HIGH_WATERMARK, LOW_WATERMARK));
+
+    pfs::byte_string chunk(CHUNK_SIZE, byte_t('x'));
+    size_t total = CHUNK_SIZE * CHUNK_COUNT;
+    size_t received = 0;
+    bool write_ok = true;
+
+    // All writes are accepted immediately (client does not read yet)
+    for (size_t i = 0; i < CHUNK_COUNT; ++i) {
+        if (devman.write(h.peer, chunk, ec) != static_cast<ssize_t>(CHUNK_SIZE))
+            write_ok = false;
+    }
+
+    TEST_OK2(write_ok && h.high_count == 1 && h.peer->pending() > 0
+            , "Data queued and high watermark reached");
+
+    pfs::byte_string buffer(CHUNK_SIZE, byte_t(0));
+    t = time(0);
+
+    while (received < total && time(0) - t < 10) {
+        devman.dispatch(1);
+
+        ssize_t n = client->available();
+
+        if (n > 0) {
+            n = client->read(& buffer[0], buffer.size(), ec);
+
+            if (n > 0)
+                received += static_cast<size_t>(n);
+        }
+    }
+
+    devman.dispatch(0);
+
+    TEST_OK2(received == total
+            && h.peer->pending() == 0
+            && h.low_count == 1
+            , "All queued data flushed and low watermark reached");
+
+    client->close();
+    devman.close(h.peer);
+}
+
+struct udp_batch_handler : pfs::sigslot<>::has_slots
+{
+    static size_t const BATCH_SIZE = 16;
+
+    char                    buffers[BATCH_SIZE][64];
+    pfs::io::mutable_buffer bufs[BATCH_SIZE];
+    size_t                  sizes[BATCH_SIZE];
+    size_t                  received;
+    bool                    content_ok;
+
+    udp_batch_handler () : received(0), content_ok(true)
+    {
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+            bufs[i] = pfs::io::mutable_buffer(buffers[i], sizeof(buffers[i]));
+    }
+
+    // UDP server produces peer device for incoming data
+    void device_accepted (pfs::io::device_ptr d, pfs::io::server_ptr)
+    {
+        pfs::error_code ec;
+        ssize_t n = 0;
+
+        while ((n = d->recv_batch(bufs, sizes, BATCH_SIZE, ec)) > 0) {
+            for (ssize_t i = 0; i < n; ++i) {
+                if (sizes[i] != 1 || buffers[i][0] != char('a' + received % 26))
+                    content_ok = false;
+                ++received;
+            }
+        }
+    }
+};
+
+// Sends datagrams by batches, receives them by batches
+void test_udp_batch ()
+{
+    ADD_TESTS(4);
+
+    static size_t const COUNT = 100;
+
+    pfs::error_code ec;
+    udp_batch_handler h;
+    device_manager devman;
+
+    devman.accepted.connect(& h, & udp_batch_handler::device_accepted);
+
+    pfs::io::server_ptr udp_server = devman.new_server(
+            pfs::io::open_params<pfs::io::udp_server>(TCP_LISTENER_ADDR
+                    , UDP_LISTENER_PORT
+                    , pfs::io::read_write | pfs::io::non_blocking)
+                    , ec);
+
+    TEST_FAIL2(!ec, "UDP server opened");
+
+    pfs::io::device_ptr client = pfs::io::open_device(
+            pfs::io::open_params<pfs::io::udp_socket>(TCP_LISTENER_ADDR
+                , UDP_LISTENER_PORT
+                , pfs::io::read_write)
+                , ec);
+
+    TEST_FAIL2(!ec, "UDP client opened");
+
+    char letters[26];
+    pfs::io::const_buffer bufs[COUNT];
+
+    for (size_t i = 0; i < 26; ++i)
+        letters[i] = char('a' + i);
+
+    for (size_t i = 0; i < COUNT; ++i)
+        bufs[i] = pfs::io::const_buffer(& letters[i % 26], 1);
+
+    TEST_OK(client->send_batch(bufs, COUNT, ec) == ssize_t(COUNT));
+
+    time_t t = time(0);
+
+    while (h.received < COUNT && time(0) - t < 5)
+        devman.dispatch(10);
+
+    TEST_OK2(h.received == COUNT && h.content_ok, "All datagrams received by batches");
+
+    client->close();
+}
+
 int main ()
 {
     BEGIN_TESTS(3);
@@ -136,5 +329,8 @@ int main ()
 //        std::cout << "watch.ellapsed(): " << watch.ellapsed() << std::endl;
     }
 
+    test_write_queue();
+    test_udp_batch();
+
     return END_TESTS;
 }
@@ -6,6 +6,7 @@ using pfs::io::device_ptr;
 using pfs::io::server_ptr;
 
 #include "test_standard_streams.hpp"
+#include "test_epoll.hpp"
 #include "test_client_server.hpp"
 
 int main ()
@@ -13,6 +14,7 @@ int main ()
     BEGIN_TESTS(0);
 
 //    test_standard_streams::run();
+    test_epoll::run();
     test_client_server::run();
 
     return END_TESTS;
@@ -0,0 +1,227 @@
+#pragma once
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pfs/filesystem.hpp>
+#include "pfs/io/file.hpp"
+
+// Tests of notification modes and slot bookkeeping, performed on FIFOs
+// and regular files, so they do not depend on network.
+namespace test_epoll {
+
+struct event_handler
+{
+    int        ready_read_counter;
+    int        disconnected_counter;
+    device_ptr last_ready;
+
+    event_handler ()
+        : ready_read_counter(0)
+        , disconnected_counter(0)
+    {}
+
+    void accepted (device_ptr, server_ptr) {}
+    void disconnected (device_ptr) { disconnected_counter++; }
+    void ready_read (device_ptr d) { ready_read_counter++; last_ready = d; }
+    void can_write (device_ptr) {}
+    void on_error (pfs::error_code const &) {}
+};
+
+static pfs::filesystem::path temp_path (char const * name)
+{
+    pfs::filesystem::path p = pfs::filesystem::temp_directory_path();
+    p /= name;
+
+    pfs::error_code ec;
+
+    if (pfs::filesystem::exists(p, ec))
+        pfs::filesystem::remove(p, ec);
+
+    return p;
+}
+
+static device_ptr open_fifo (pfs::filesystem::path const & p)
+{
+    pfs::error_code ec;
+
+    if (!pfs::filesystem::exists(p, ec) && ::mkfifo(p.native().c_str(), 0600) != 0)
+        return device_ptr();
+
+    // Opening FIFO for read and write does not block
+    return pfs::io::open_device(pfs::io::open_params<pfs::io::file>(p
+            , pfs::io::read_write | pfs::io::non_blocking), ec);
+}
+
+struct count_device
+{
+    int & n;
+    count_device (int & counter) : n(counter) {}
+    void operator () (device_ptr) { n++; }
+};
+
+static int count_devices (device_notifier_pool & pool)
+{
+    int n = 0;
+    pool.for_each_device(count_device(n));
+    return n;
+}
+
+// Regular files can't be added into epoll set, pool reports them always
+// ready (as poll(2) does) without waiting for timeout
+void test_regular_file ()
+{
+    ADD_TESTS(4);
+
+    pfs::error_code ec;
+    pfs::filesystem::path p = temp_path("pfs-test-notifier-regular");
+
+    {
+        device_ptr w = pfs::io::open_device(pfs::io::open_params<pfs::io::file>(p
+                , pfs::io::write_only | pfs::io::truncate), ec);
+        w->write("0123456789", 10);
+        w->close();
+    }
+
+    device_ptr d = pfs::io::open_device(pfs::io::open_params<pfs::io::file>(p
+            , pfs::io::read_only), ec);
+
+    TEST_FAIL2(d && !ec, "Regular file opened");
+
+    device_notifier_pool pool;
+    event_handler eh;
+
+    pool.insert(d, pfs::io::notify_read);
+
+    pfs::test::profiler sw;
+    pool.dispatch(eh, 5000);
+    double sec = sw.ellapsed();
+
+    TEST_OK2(eh.ready_read_counter == 1, "Regular file is ready for read");
+    TEST_OK2(sec < 1.0, "Dispatch does not wait for timeout");
+
+    pool.dispatch(eh, 5000);
+
+    TEST_OK2(eh.ready_read_counter == 2, "Regular file is still ready for read");
+
+    pool.erase(d);
+    d->close();
+    pfs::filesystem::remove(p, ec);
+}
+
+// Level-triggered mode (default) notifies while data is not read,
+// edge-triggered mode notifies only when new data arrives
+void test_edge_triggered ()
+{
+    ADD_TESTS(7);
+
+    pfs::error_code ec;
+
+    for (int edge = 0; edge < 2; edge++) {
+        pfs::filesystem::path p = temp_path("pfs-test-notifier-fifo");
+        device_ptr d = open_fifo(p);
+
+        TEST_FAIL2(d && d->opened(), "FIFO opened");
+
+        device_notifier_pool pool;
+        event_handler eh;
+
+        pool.set_edge_triggered(edge != 0);
+        pool.insert(d, pfs::io::notify_read);
+
+        pool.dispatch(eh, 10);
+        int idle_counter = eh.ready_read_counter;
+
+        d->write("0123456789", 10);
+
+        // Data is not read by the handler
+        pool.dispatch(eh, 1000);
+        pool.dispatch(eh, 10);
+
+        if (edge == 0) {
+            TEST_OK2(idle_counter == 0 && eh.ready_read_counter == 2
+                    , "Level-triggered: notified by each dispatch while data is not read");
+        } else {
+#if PFS_HAVE_EPOLL
+            TEST_OK2(idle_counter == 0 && eh.ready_read_counter == 1
+                    , "Edge-triggered: notified once while data is not read");
+#else
+            TEST_OK2(idle_counter == 0 && eh.ready_read_counter == 2
+                    , "Edge-triggered mode is not supported by poll(2) backend");
+#endif
+        }
+
+        d->write("0123456789", 10);
+        pool.dispatch(eh, 1000);
+
+        if (edge == 0) {
+            TEST_OK2(eh.ready_read_counter == 3, "Level-triggered: notified for new data");
+        } else {
+#if PFS_HAVE_EPOLL
+            TEST_OK2(eh.ready_read_counter == 2, "Edge-triggered: notified for new data");
+#else
+            TEST_OK2(eh.ready_read_counter == 3, "Edge-triggered mode is not supported by poll(2) backend");
+#endif
+        }
+
+        TEST_OK2(eh.disconnected_counter == 0, "FIFO is not disconnected");
+
+        pool.erase(d);
+        d->close();
+        pfs::filesystem::remove(p, ec);
+    }
+}
+
+// Device closed without erasing from pool keeps its slot until
+// descriptor is reused by the other device, which replaces the stale slot
+void test_reused_descriptor ()
+{
+    ADD_TESTS(6);
+
+    pfs::error_code ec;
+    pfs::filesystem::path p1 = temp_path("pfs-test-notifier-fifo1");
+    pfs::filesystem::path p2 = temp_path("pfs-test-notifier-fifo2");
+
+    device_notifier_pool pool;
+    event_handler eh;
+
+    device_ptr d1 = open_fifo(p1);
+    TEST_FAIL2(d1 && d1->opened(), "First FIFO opened");
+
+    pfs::io::details::native_handle_type fd = d1->native_handle();
+    pool.insert(d1, pfs::io::notify_read);
+    d1->write("0123456789", 10);
+    d1->close();
+
+    // Closed device is not reported
+    pool.dispatch(eh, 10);
+    TEST_OK2(eh.ready_read_counter == 0, "Closed device is not reported");
+
+    device_ptr d2 = open_fifo(p2);
+    TEST_FAIL2(d2 && d2->opened(), "Second FIFO opened");
+    TEST_OK2(d2->native_handle() == fd, "Descriptor is reused");
+
+    pool.insert(d2, pfs::io::notify_read);
+    d2->write("0123456789", 10);
+    pool.dispatch(eh, 1000);
+
+    TEST_OK2(eh.ready_read_counter == 1 && eh.last_ready == d2
+            , "Device with reused descriptor is notified");
+    TEST_OK2(count_devices(pool) == 1, "Stale slot is replaced");
+
+    pool.erase(d2);
+    d2->close();
+    pfs::filesystem::remove(p1, ec);
+    pfs::filesystem::remove(p2, ec);
+}
+
+void run ()
+{
+    std::cout << "///////////////////////////////////////////////////////////////////////////\n";
+    std::cout << "//                  Test notification modes and slots                    //\n";
+    std::cout << "///////////////////////////////////////////////////////////////////////////\n";
+
+    test_regular_file();
+    test_edge_triggered();
+    test_reused_descriptor();
+}
+
+} // namespace test_epoll
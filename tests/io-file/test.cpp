@@ -249,6 +249,43 @@ void test_write_read ()
     TEST_FAIL2(pfs::filesystem::remove(file_path, ec), "Temporary file unlink");
 }
 
+void test_write_read_v ()
+{
+    ADD_TESTS(7);
+    pfs::error_code ec;
+
+    pfs::filesystem::path file_path("/tmp/test_io_file_v.tmp");
+
+    if (pfs::filesystem::exists(file_path, ec))
+        pfs::filesystem::remove(file_path, ec);
+
+    device_ptr d;
+
+    TEST_FAIL((d = open_device(open_params<file>(file_path, pfs::io::write_only), ec)));
+
+    pfs::io::const_buffer out[3];
+    out[0] = pfs::io::const_buffer("Lorem ", 6);
+    out[1] = pfs::io::const_buffer("ipsum ", 6);
+    out[2] = pfs::io::const_buffer("dolor", 5);
+
+    TEST_OK(d->write_v(out, 3) == 17);
+    TEST_FAIL(!pfs::is_error(d->close()));
+
+    TEST_FAIL((d = open_device(open_params<file>(file_path, pfs::io::read_only))));
+
+    char head[8];
+    char tail[16];
+    pfs::io::mutable_buffer in[2];
+    in[0] = pfs::io::mutable_buffer(head, sizeof(head));
+    in[1] = pfs::io::mutable_buffer(tail, sizeof(tail));
+
+    TEST_OK(d->read_v(in, 2) == 17);
+    TEST_OK(::strncmp(head, "Lorem ip", 8) == 0 && ::strncmp(tail, "sum dolor", 9) == 0);
+
+    d->close();
+    TEST_FAIL2(pfs::filesystem::remove(file_path, ec), "Temporary file unlink");
+}
+
 //void test_bytes_available ()
 //{
 //    pfs::fs::path filePath("rc/1234567890.txt");
@@ -461,6 +498,7 @@ int main ()
 
     test_open_absent_file();
     test_write_read();
+    test_write_read_v();
 //    test_bytes_available();
     test_io_iterator();
 
@@ -24,6 +24,10 @@
 //#include "test_erase.hpp"
 #include "test_rpc.hpp"
 
+#if __cplusplus >= 201103L
+#   include "test_arena.hpp"
+#endif
+
 namespace stdcxx {
 
 typedef pfs::string string_type;
@@ -69,6 +73,10 @@ int main ()
     test_serialize::test<stdcxx::json_t>();
     test_rpc::test<stdcxx::json_t>();
 
+#if __cplusplus >= 201103L
+    test_arena::test();
+#endif
+
 // #ifdef HAVE_QT_CORE
 //     std::cout << "===== HAVE_QT_CORE =====" << std::endl;
 //     test_basic::test<qt::json>();
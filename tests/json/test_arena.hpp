@@ -0,0 +1,126 @@
+#pragma once
+#include <pfs/json/arena.hpp>
+
+namespace test_arena {
+
+static char const * document_str = "{"
+        "\"name\": \"A string that does not fit into the string object itself\","
+        "\"id\": 42,"
+        "\"ratio\": 0.5,"
+        "\"flags\": [true, false, null],"
+        "\"nested\": {\"b\": 2, \"a\": 1, \"c\": [1, 2, 3]}"
+    "}";
+
+void test_flat_map ()
+{
+    ADD_TESTS(8);
+
+    pfs::flat_map<int, int> m;
+
+    TEST_OK(m.insert(3, 30).second);
+    TEST_OK(m.insert(1, 10).second);
+    TEST_OK(m.insert(2, 20).second);
+    TEST_OK(!m.insert(2, 200).second);
+
+    TEST_OK(m.size() == 3);
+    TEST_OK(m.begin()->first == 1);
+    TEST_OK(m.erase(2) == 1 && m.find(2) == m.end());
+    TEST_OK(m.find(3)->second == 30);
+}
+
+void test_document ()
+{
+    typedef pfs::json::arena_json json_t;
+
+    ADD_TESTS(16);
+
+    pfs::json::document<> doc;
+    pfs::error_code ec = doc.parse(document_str);
+
+    TEST_OK(!ec);
+    TEST_OK(doc.get_arena().allocated() > 0);
+
+    json_t const & root = doc.root();
+
+    TEST_OK(root.is_object());
+    TEST_OK(root.size() == 5);
+    TEST_OK(root["name"].string_data() == "A string that does not fit into the string object itself");
+    TEST_OK(root["id"].integer_data() == 42);
+    TEST_OK(root["ratio"].real_data() == 0.5);
+    TEST_OK(root["flags"].size() == 3);
+    TEST_OK(root["flags"][0].boolean_data() == true);
+    TEST_OK(root["flags"][2].is_null());
+
+    // Objects are sorted by key
+    json_t::const_iterator it = root["nested"].cbegin();
+    TEST_OK(it.key() == "a");
+    ++it;
+    TEST_OK(it.key() == "b");
+    TEST_OK(root["nested"]["c"][2].integer_data() == 3);
+
+    // Strings are allocated from the arena
+    TEST_OK(root["name"].string_data().get_allocator().get_arena() == & doc.get_arena());
+
+    {
+        pfs::json::document<>::scope s(doc);
+        doc.root()["added"] = json_t("value");
+    }
+
+    TEST_OK(doc.root()["added"].string_data() == "value");
+
+    doc.clear();
+    TEST_OK(doc.root().is_null() && doc.get_arena().allocated() < 64);
+}
+
+// Document reused for many parses must not grow its arena
+void test_reparse ()
+{
+    ADD_TESTS(2);
+
+    pfs::json::document<> doc;
+    bool ok = true;
+    size_t first_capacity = 0;
+    size_t max_capacity = 0;
+
+    for (int i = 0; i < 100; i++) {
+        ok = ok && !doc.parse(document_str) && doc.root()["id"].integer_data() == 42;
+
+        if (i == 0)
+            first_capacity = doc.get_arena().capacity();
+
+        if (doc.get_arena().capacity() > max_capacity)
+            max_capacity = doc.get_arena().capacity();
+    }
+
+    TEST_OK(ok);
+    TEST_OK(max_capacity == first_capacity);
+}
+
+// Arena json values created without current arena use the heap
+void test_heap ()
+{
+    typedef pfs::json::arena_json json_t;
+
+    ADD_TESTS(3);
+
+    json_t j;
+    j["a"] = json_t(1);
+    j["b"] = json_t("Heap allocated string which does not fit into the object");
+    j["c"].push_back(json_t(true));
+
+    json_t copy(j);
+
+    TEST_OK(copy == j);
+    TEST_OK(j["b"].string_data().get_allocator().get_arena() == 0);
+    TEST_OK(copy["c"][0].boolean_data());
+}
+
+void test ()
+{
+    test_flat_map();
+    test_document();
+    test_reparse();
+    test_heap();
+}
+
+} // test_arena
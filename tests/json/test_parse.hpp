@@ -5,6 +5,7 @@
 
 #include "pfs/json/json.hpp"
 #include "pfs/fsm/fsm.hpp"
+#include "pfs/fsm/stream.hpp"
 #include "pfs/fsm/test.hpp"
 #include "pfs/math.hpp"
 
@@ -428,11 +429,192 @@ void test_parse ()
 //	}
 }
 
+template <typename JsonType>
+void test_parser ()
+{
+    typedef typename JsonType::string_type string_type;
+
+    {
+        ADD_TESTS(6);
+
+        JsonType json;
+        TEST_OK(json.parse(" [ 1 , -2 , 18446744073709551615, -9223372036854775808 ] ") == pfs::error_code());
+        TEST_OK(json.is_array() && json.size() == 4);
+        TEST_OK(json[0].template get<int>() == 1);
+        TEST_OK(json[1].template get<int>() == -2);
+        TEST_OK(json[2].template get<uintmax_t>() == pfs::numeric_limits<uintmax_t>::max());
+        TEST_OK(json[3].template get<intmax_t>() == pfs::numeric_limits<intmax_t>::min());
+    }
+
+    {
+        ADD_TESTS(6);
+
+        JsonType json;
+        TEST_OK(json.parse("[1.5e3, -0.25, 1E-2, 123456789012345678901234567890, 0]") == pfs::error_code());
+        TEST_OK(json[0].is_real() && json[0].template get<double>() == 1500.0);
+        TEST_OK(json[1].template get<double>() == -0.25);
+        TEST_OK(pfs::abs(json[2].template get<double>() - 0.01) < 1e-12);
+        TEST_OK(json[3].is_real() && json[3].template get<double>() > 1.2e29);
+        TEST_OK(json[4].is_integer());
+    }
+
+    {
+        ADD_TESTS(4);
+
+        JsonType json;
+        TEST_OK(json.parse("{\"a\\\"b\":\"\\n\\t\\/\\u00e9\\ud83d\\ude00 long enough to be scanned by blocks\"}") == pfs::error_code());
+        TEST_OK(json.is_object() && json.size() == 1);
+        TEST_OK(json.contains("a\"b"));
+        TEST_OK(json["a\"b"].template get<string_type>()
+                == string_type("\n\t/\xC3\xA9\xF0\x9F\x98\x80 long enough to be scanned by blocks"));
+    }
+
+    {
+        ADD_TESTS(3);
+
+        JsonType json;
+        TEST_OK(json.parse("{\"a\": {\"b\": [[], {}, [null, true, false]]}, \"c\": []}") == pfs::error_code());
+        TEST_OK(json["a"]["b"][2][1].template get<bool>() == true);
+        TEST_OK(json["a"]["b"][1].is_object() && json["c"].is_array());
+    }
+
+    {
+        ADD_TESTS(11);
+
+        JsonType json;
+        TEST_OK(json.parse("[1,]") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("{\"a\" 1}") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("{\"a\":1,}") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("[1 2]") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("[\"abc") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("\"\\x\"") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("\"\xC3\x28\"") == pfs::make_error_code(pfs::json_errc::bad_json));
+        TEST_OK(json.parse("[-]") == pfs::make_error_code(pfs::json_errc::bad_number));
+        TEST_OK(json.parse("1.e5") == pfs::make_error_code(pfs::json_errc::bad_number));
+        TEST_OK(json.parse("[1] x") == pfs::make_error_code(pfs::json_errc::excess_source));
+        TEST_OK(json.is_null());
+    }
+}
+
+// Checks that names and string values without escape sequences
+// reference the source
+struct view_checker
+{
+    char const * first;
+    char const * last;
+    int borrowed;
+    int copied;
+
+    void check (pfs::json::string_view v)
+    {
+        if (v.empty())
+            return;
+
+        if (v.data() >= first && v.data() + v.size() <= last)
+            ++borrowed;
+        else
+            ++copied;
+    }
+
+    bool on_begin_json ()                                       { return true; }
+    bool on_end_json (bool)                                     { return true; }
+    bool on_begin_object (pfs::json::string_view n)             { check(n); return true; }
+    bool on_end_object (pfs::json::string_view)                 { return true; }
+    bool on_begin_array (pfs::json::string_view n)              { check(n); return true; }
+    bool on_end_array (pfs::json::string_view)                  { return true; }
+    bool on_null_value (pfs::json::string_view n)               { check(n); return true; }
+    bool on_boolean_value (pfs::json::string_view n, bool)      { check(n); return true; }
+    bool on_integer_value (pfs::json::string_view n, intmax_t)  { check(n); return true; }
+    bool on_uinteger_value (pfs::json::string_view n, uintmax_t){ check(n); return true; }
+    bool on_real_value (pfs::json::string_view n, real_t)       { check(n); return true; }
+
+    bool on_string_value (pfs::json::string_view n, pfs::json::string_view v)
+    {
+        check(n);
+        check(v);
+        return true;
+    }
+};
+
+template <typename JsonType>
+void test_sax ()
+{
+    ADD_TESTS(6);
+
+    static char const * source = "{\"a\": [\"x\", \"y\\n\"], \"b\\tc\": {\"d\": null}, \"Заголовок\": \"Значение\"}";
+    char const * last = source + std::strlen(source);
+
+    view_checker checker;
+    checker.first = source;
+    checker.last = last;
+    checker.borrowed = 0;
+    checker.copied = 0;
+
+    pfs::json::parser<view_checker> p;
+    TEST_OK(p.parse(checker, source, last) == pfs::error_code());
+
+    // "a", "x", "d", "Заголовок", "Значение" are borrowed,
+    // "y\n" and "b\tc" are unescaped
+    TEST_OK(checker.borrowed == 5);
+    TEST_OK(checker.copied == 2);
+
+    // Legacy SAX interface
+    JsonType j1;
+    JsonType j2;
+    pfs::json::dom_builder_context<JsonType> sax(j1);
+    pfs::json::sax_context_adapter<JsonType> adapter(sax);
+    pfs::json::parser<pfs::json::sax_context_adapter<JsonType> > p1;
+
+    TEST_OK(p1.parse(adapter, source, last) == pfs::error_code());
+    TEST_OK(j2.parse(source) == pfs::error_code());
+    TEST_OK(j1 == j2);
+}
+
+template <typename JsonType>
+void test_stream ()
+{
+    typedef typename JsonType::string_type string_type;
+    typedef pfs::json::grammar<JsonType> grammar_type;
+    typedef pfs::fsm::stream<typename grammar_type::iterator, string_type> stream_type;
+
+    ADD_TESTS(6);
+
+    static char const * source = "{\"a\": [1, -2.5e3, 18446744073709551615, -7]"
+            ", \"\xC3\xA9\\u00e9\": {\"b\": [null, true, false, \"xyz\"]}"
+            ", \"c\": 0.125} {\"next\": []}";
+
+    string_type s(source);
+    grammar_type grammar;
+
+    // Input is fed by single octets, UTF-8 sequences are split
+    JsonType j1;
+    pfs::json::dom_builder_context<JsonType> sax(j1);
+    typename grammar_type::parse_context context;
+    context.sax = & sax;
+
+    stream_type st(grammar.p_json_tr, & context);
+    typename stream_type::status_enum status = stream_type::need_more;
+
+    for (size_t i = 0; i < s.size() && status == stream_type::need_more; ++i)
+        status = st.feed(s.begin() + i, s.begin() + i + 1);
+
+    JsonType j2;
+    TEST_OK(j2.parse(s.substr(0, st.position())) == pfs::error_code());
+    TEST_OK(status == stream_type::accepted);
+    TEST_OK(j1 == j2);
+    TEST_OK(j1["a"][1].template get<double>() == -2500.0);
+    TEST_OK(j1["a"][2].template get<uintmax_t>() == pfs::numeric_limits<uintmax_t>::max());
+    TEST_OK(j1["\xC3\xA9\xC3\xA9"]["b"][3].template get<string_type>() == string_type("xyz"));
+}
+
 template <typename JsonType>
 void test ()
 {
 //    test_fsm<JsonType>();
     test_parse<JsonType>();
+    test_parser<JsonType>();
+    test_sax<JsonType>();
+    test_stream<JsonType>();
 }
 
 } // test_parse
@@ -1,4 +1,10 @@
 #pragma once
+#include <deque>
+#if __cplusplus >= 201103L
+#   include <pfs/atomic.hpp>
+#   include <pfs/thread.hpp>
+#   include <pfs/thread_pool.hpp>
+#endif
 #include "pfs/json/rpc.hpp"
 #include "pfs/json/ubjson_istream.hpp"
 #include "pfs/json/ubjson_ostream.hpp"
@@ -6,6 +12,266 @@
 namespace test_rpc
 {
 
+#if __cplusplus >= 201103L
+struct loopback_transport
+{
+    pfs::vector<pfs::byte_string> sent;
+    std::deque<pfs::byte_string>  replies;
+    pfs::atomic<int>              sends;
+
+    loopback_transport () : sends(0) {}
+
+    ssize_t send (pfs::byte_string const & bytes, pfs::error_code &)
+    {
+        sent.push_back(bytes);
+        ++sends;
+        return static_cast<ssize_t>(bytes.size());
+    }
+
+    ssize_t recv (pfs::byte_string & bytes, pfs::error_code &)
+    {
+        if (replies.empty())
+            return 0;
+
+        bytes = replies.front();
+        replies.pop_front();
+        return static_cast<ssize_t>(bytes.size());
+    }
+};
+
+template <typename json_type>
+void test_client ()
+{
+    typedef pfs::json::rpc<json_type> rpc_ns;
+    typedef typename rpc_ns::request  request_t;
+    typedef typename rpc_ns::response response_t;
+    typedef typename rpc_ns::template client<loopback_transport> client_t;
+
+    ADD_TESTS(18);
+
+    loopback_transport transport;
+    client_t client(transport);
+
+    int sum_result = 0;
+    int completions = 0;
+
+    request_t sum = request_t::make_notification("sum").arg(1).arg(2);
+    request_t echo = request_t::make_notification("echo").arg(10);
+    request_t notification = request_t::make_notification("ping");
+
+    pfs::error_code ec = client.call(sum
+            , [& sum_result, & completions] (pfs::error_code const & ec, response_t const & rp) {
+                ++completions;
+
+                if (!ec && rp.is_success())
+                    sum_result = rp.template get<int>();
+            });
+
+    TEST_OK2(!ec, "Queue method call with callback completion");
+
+    std::future<response_t> echo_result = client.call(echo);
+    client.notify(notification);
+
+    TEST_OK2(client.queued() == 3, "Three requests queued");
+    TEST_OK2(client.flush() == pfs::error_code(), "Send queued requests");
+    TEST_OK2(transport.sent.size() == 1, "Requests sent by one write");
+    TEST_OK2(client.outstanding() == 2, "Two requests are waiting for response");
+
+    pfs::vector<request_t> batch;
+    TEST_OK2(rpc_ns::deserialize_batch(transport.sent[0], batch) == pfs::error_code()
+            , "Server received batch");
+    TEST_OK2(batch.size() == 3, "Batch contains three requests");
+    TEST_OK2(batch[0].is_method() && batch[1].is_method() && batch[2].is_notification()
+            , "Batch contains two methods and notification");
+
+    // Responses in reverse order
+    pfs::vector<response_t> responses;
+    responses.push_back(response_t::make_success(batch[1], batch[1].template get<int>(0)));
+    responses.push_back(response_t::make_success(batch[0]
+            , batch[0].template get<int>(0) + batch[0].template get<int>(1)));
+
+    pfs::byte_string reply;
+    TEST_OK2(rpc_ns::serialize_batch(responses.begin(), responses.end(), reply) == pfs::error_code()
+            , "Server serialized batch of responses");
+
+    transport.replies.push_back(reply);
+
+    TEST_OK2(client.dispatch() == pfs::error_code(), "Client received batch of responses");
+    TEST_OK2(completions == 1 && sum_result == 3, "Callback completion called");
+    TEST_OK2(echo_result.get().template get<int>() == 10, "Future completion is ready");
+    TEST_OK2(client.outstanding() == 0, "No requests are waiting for response");
+
+    // Unknown id
+    TEST_OK2(client.process(reply) == pfs::make_error_code(pfs::rpc_errc::id_not_match)
+            , "Response for unknown request is rejected");
+
+    // Slots freed out of order are reused while the older requests
+    // are outstanding
+    {
+        client_t small(transport, 4);
+        pfs::vector<request_t> calls;
+        bool ok = true;
+
+        for (int i = 0; i < 4; i++) {
+            calls.push_back(request_t::make_notification("echo").arg(i));
+            ok = ok && !small.call(calls.back(), typename client_t::completion_type());
+        }
+
+        TEST_OK2(ok && small.outstanding() == 4, "Table is filled");
+
+        request_t extra = request_t::make_notification("echo");
+        TEST_OK2(small.call(extra, typename client_t::completion_type())
+                == pfs::make_error_code(pfs::errc::resource_unavailable_try_again)
+                , "Call fails if all slots are busy");
+
+        small.flush();
+
+        // Complete the second and the third requests only
+        batch.clear();
+        rpc_ns::deserialize_batch(transport.sent.back(), batch);
+
+        responses.clear();
+        responses.push_back(response_t::make_success(batch[1], 1));
+        responses.push_back(response_t::make_success(batch[2], 2));
+        rpc_ns::serialize_batch(responses.begin(), responses.end(), reply);
+
+        TEST_OK(small.process(reply) == pfs::error_code());
+
+        request_t more1 = request_t::make_notification("echo");
+        request_t more2 = request_t::make_notification("echo");
+
+        TEST_OK2(!small.call(more1, typename client_t::completion_type())
+                && !small.call(more2, typename client_t::completion_type())
+                && small.outstanding() == 4
+                , "Freed slots are reused");
+    }
+}
+
+// Waits (no longer than one second) until @a gate becomes non-zero
+inline void wait_gate (pfs::atomic<int> const & gate)
+{
+    for (int i = 0; i < 1000 && gate.load() == 0; i++)
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(1));
+}
+
+template <typename json_type>
+void test_server ()
+{
+    typedef pfs::json::rpc<json_type> rpc_ns;
+    typedef typename rpc_ns::request  request_t;
+    typedef typename rpc_ns::response response_t;
+    typedef typename rpc_ns::id_generator_type id_generator_t;
+    typedef typename rpc_ns::template server<loopback_transport> server_t;
+
+    ADD_TESTS(15);
+
+    pfs::thread_pool pool(2);
+    id_generator_t idgen;
+
+    // Slow method completes after the gate is open, fast method opens
+    // the gate for in-order mode, response sent opens the gate
+    // for out-of-order mode
+    for (int mode = 0; mode < 2; mode++) {
+        loopback_transport transport;
+        pfs::atomic<int> fast_calls(0);
+        pfs::atomic<int> const & gate = mode == 0 ? fast_calls : transport.sends;
+
+        server_t server(transport, pool, mode == 0
+                ? server_t::in_order
+                : server_t::out_of_order);
+
+        server.bind("slow", [& gate] (request_t const & rq) {
+            wait_gate(gate);
+            return response_t::make_success(rq, 1);
+        });
+
+        server.bind("fast", [& fast_calls] (request_t const & rq) {
+            ++fast_calls;
+            return response_t::make_success(rq, 2);
+        });
+
+        request_t slow = request_t::make_method(idgen, "slow");
+        request_t fast = request_t::make_method(idgen, "fast");
+
+        server.process(request_t::serialize(slow));
+        server.process(request_t::serialize(fast));
+        server.wait_idle();
+
+        TEST_OK2(transport.sent.size() == 2, "Two responses sent");
+
+        response_t first;
+        response_t::deserialize(transport.sent[0], first);
+
+        if (mode == 0) {
+            TEST_OK2(first.template get<int>() == 1, "In-order mode: response of slow method is the first");
+        } else {
+            TEST_OK2(first.template get<int>() == 2, "Out-of-order mode: response of fast method is the first");
+        }
+    }
+
+    // Batch with notification and unknown method
+    {
+        loopback_transport transport;
+        pfs::atomic<int> notifications(0);
+        server_t server(transport, pool);
+
+        server.bind("sum", [] (request_t const & rq) {
+            return response_t::make_success(rq
+                    , rq.template get<int>(0) + rq.template get<int>(1));
+        });
+
+        server.bind("notify", [& notifications] (request_t const &) {
+            ++notifications;
+            return response_t();
+        });
+
+        pfs::vector<request_t> batch;
+        batch.push_back(request_t::make_method(idgen, "sum").arg(1).arg(2));
+        batch.push_back(request_t::make_method(idgen, "unknown"));
+        batch.push_back(request_t::make_notification("notify"));
+
+        pfs::byte_string payload;
+        TEST_OK(rpc_ns::serialize_batch(batch.begin(), batch.end(), payload) == pfs::error_code());
+        TEST_OK(server.process(payload) == pfs::error_code());
+        server.wait_idle();
+
+        TEST_OK2(transport.sent.size() == 1, "Batch response sent by one write");
+        TEST_OK2(notifications.load() == 1, "Notification handled");
+
+        pfs::vector<response_t> responses;
+        rpc_ns::deserialize_batch(transport.sent[0], responses);
+
+        TEST_OK2(responses.size() == 2, "No response for notification");
+        TEST_OK2(responses[0].is_success() && responses[0].template get<int>() == 3
+                , "Method `sum` succeeded");
+        TEST_OK2(responses[1].is_failure() && responses[1].code() == rpc_ns::METHOD_NOT_FOUND
+                , "Unknown method failed");
+    }
+
+    // Invalid request without id is answered with null id
+    {
+        loopback_transport transport;
+        server_t server(transport, pool);
+
+        request_t invalid;
+        invalid.arg(1);
+
+        TEST_OK(server.process(request_t::serialize(invalid)) == pfs::error_code());
+        server.wait_idle();
+
+        TEST_OK2(transport.sent.size() == 1, "Response for invalid request sent");
+
+        response_t rp;
+        response_t::deserialize(transport.sent[0], rp);
+
+        TEST_OK2(rp.is_failure() && rp.code() == rpc_ns::INVALID_REQUEST
+                , "Invalid request failed");
+        TEST_OK2(rp.internal_data().contains("id") && rp.internal_data()["id"].is_null()
+                , "Id of response is null");
+    }
+}
+#endif
+
 template <typename json_type>
 void test ()
 {
@@ -117,6 +383,27 @@ void test ()
         TEST_OK2(!response.has_error_data(), "Failure has no addition information about an error");
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Serialize into reusable buffer                                        //
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        ADD_TESTS(5);
+
+        pfs::byte_string buffer;
+
+        request_t m = request_t::make_method(idgen, "method2").arg(1).arg(1000).arg(-5);
+        TEST_OK2(request_t::serialize(m, buffer) == pfs::error_code(), "Serialize request into buffer");
+        TEST_OK2(buffer == request_t::serialize(m), "Serialized into buffer and returned payloads are equal");
+
+        request_t request;
+        TEST_OK2(request_t::deserialize(buffer, request) == pfs::error_code(), "Parse request serialized into buffer");
+        TEST_OK2(request.template get<int>(1) == 1000, "Get second parameter for `method2`");
+
+        response_t ok = response_t::make_success(request, true);
+        TEST_OK2(response_t::serialize(ok, buffer) == pfs::error_code()
+                && buffer == response_t::serialize(ok), "Serialize response into the same buffer");
+    }
+
     // TODO
     ///////////////////////////////////////////////////////////////////////////
     // Call notification with no parameters                                  //
@@ -127,6 +414,11 @@ void test ()
 
     // TODO Check failure with addition error has_error_data
     // TODO Check failure with INTERNAL_ERROR (not a response for method)
+
+#if __cplusplus >= 201103L
+    test_client<json_type>();
+    test_server<json_type>();
+#endif
 }
 
 } // namespace test_rpc
@@ -5,6 +5,7 @@
 #include "pfs/json/json.hpp"
 #include "pfs/json/ubjson_ostream.hpp"
 #include "pfs/json/ubjson_istream.hpp"
+#include "pfs/json/ubjson_encoder.hpp"
 
 namespace test_serialize {
 
@@ -144,7 +145,7 @@ void test_string ()
 {
     typedef typename JsonType::string_type string_type;
 
-    ADD_TESTS(6);
+    ADD_TESTS(11);
 
     TEST_OK(pfs::json::to_ubjson(JsonType(string_type(1, '@')))
             == pfs::byte_string("C@", 2));
@@ -163,6 +164,39 @@ void test_string ()
 
     TEST_OK(pfs::json::from_ubjson<JsonType>(pfs::byte_string("Si\x04\x41\x42\x43\x44", 7))
         == JsonType(string_type("ABCD")));
+
+    // String with embedded NUL character
+    TEST_OK(pfs::json::from_ubjson<JsonType>(pfs::byte_string("Si\x03\x41\x00\x42", 6))
+        == JsonType(string_type("A\0B", 3)));
+
+    // Long string
+    {
+        string_type sample(1000, 'x');
+        pfs::byte_string bs("SI\x03\xe8", 4);
+        bs.append(1000, 'x');
+        TEST_OK(pfs::json::from_ubjson<JsonType>(bs) == JsonType(sample));
+    }
+
+    // Negative length
+    {
+        pfs::error_code ec;
+        pfs::json::from_ubjson<JsonType>(pfs::byte_string("Si\xff", 3), ec);
+        TEST_OK(ec == pfs::make_error_code(pfs::json_errc::ubjson_parse));
+    }
+
+    // Truncated input: length exceeds the rest of data
+    {
+        pfs::error_code ec;
+        pfs::json::from_ubjson<JsonType>(pfs::byte_string("Si\x04\x41\x42", 5), ec);
+        TEST_OK(ec == pfs::make_error_code(pfs::json_errc::ubjson_parse));
+    }
+
+    // Crafted length (2^62) must not allocate
+    {
+        pfs::error_code ec;
+        pfs::json::from_ubjson<JsonType>(pfs::byte_string("SL\x40\x00\x00\x00\x00\x00\x00\x00", 10), ec);
+        TEST_OK(ec == pfs::make_error_code(pfs::json_errc::ubjson_parse));
+    }
 }
 
 template <typename JsonType>
@@ -171,7 +205,7 @@ void test_array ()
     typedef typename JsonType::string_type string_type;
     typedef typename JsonType::array_type array_type;
 
-    ADD_TESTS(21);
+    ADD_TESTS(31);
 
     TEST_OK(pfs::json::to_ubjson(JsonType::make_array())
             == pfs::byte_string("[]", 2));
@@ -264,6 +298,67 @@ void test_array ()
         TEST_OK(pfs::json::to_ubjson(j, pfs::json::UBJSON_FULL_OPTIMIZED) == expected);
         TEST_OK(pfs::json::from_ubjson<JsonType>(expected) == j);
     }
+
+    // Strongly-typed arrays of numeric values (bulk read)
+    {
+        int const n = 1000;
+        pfs::byte_string bs("[$l#I\x03\xe8", 7);
+        JsonType j = JsonType::make_array();
+
+        for (int i = 0; i < n; i++) {
+            int32_t v = (i - n / 2) * 65537;
+            bs.push_back(static_cast<char>((v >> 24) & 0xff));
+            bs.push_back(static_cast<char>((v >> 16) & 0xff));
+            bs.push_back(static_cast<char>((v >> 8) & 0xff));
+            bs.push_back(static_cast<char>(v & 0xff));
+            j.push_back(JsonType(v));
+        }
+
+        TEST_OK(pfs::json::from_ubjson<JsonType>(bs) == j);
+    }
+
+    {
+        pfs::byte_string expected("[$I#i\x03\x00\x01\xff\xfe\x7f\xff", 12);
+        JsonType j;
+        TEST_OK(j.parse("[1, -2, 32767]") == pfs::error_code());
+        TEST_OK(pfs::json::from_ubjson<JsonType>(expected) == j);
+    }
+
+    {
+        pfs::byte_string expected("[$D#i\x02"
+                "\x40\x09\x21\xfb\x3f\xa6\xde\xfc"
+                "\xc0\x09\x21\xfb\x3f\xa6\xde\xfc", 22);
+        JsonType j;
+        TEST_OK(j.parse("[3.1415925, -3.1415925]") == pfs::error_code());
+        TEST_OK(pfs::json::from_ubjson<JsonType>(expected) == j);
+    }
+
+    {
+        pfs::byte_string expected("[$d#i\x02\x3f\xc0\x00\x00\xc0\x20\x00\x00", 14);
+        JsonType j;
+        TEST_OK(j.parse("[1.5, -2.5]") == pfs::error_code());
+        TEST_OK(pfs::json::from_ubjson<JsonType>(expected) == j);
+    }
+
+    {
+        pfs::error_code ec;
+        pfs::json::from_ubjson<JsonType>(pfs::byte_string("[$i#i\xff", 6), ec);
+        TEST_OK(ec == pfs::make_error_code(pfs::json_errc::ubjson_parse));
+    }
+
+    // Truncated payload of strongly-typed array
+    {
+        pfs::error_code ec;
+        pfs::json::from_ubjson<JsonType>(pfs::byte_string("[$I#i\x03\x00\x01\x03", 9), ec);
+        TEST_OK(ec == pfs::make_error_code(pfs::json_errc::ubjson_parse));
+    }
+
+    // Crafted count (2^30 of int64) must not allocate
+    {
+        pfs::error_code ec;
+        pfs::json::from_ubjson<JsonType>(pfs::byte_string("[$L#l\x40\x00\x00\x00", 9), ec);
+        TEST_OK(ec == pfs::make_error_code(pfs::json_errc::ubjson_parse));
+    }
 }
 
 template <typename JsonType>
@@ -446,6 +541,59 @@ void test_object ()
     }
 }
 
+template <typename JsonType>
+void test_encoder ()
+{
+    typedef pfs::json::ubjson_encoder<JsonType> encoder_type;
+
+    ADD_TESTS(14);
+
+    JsonType j;
+    TEST_OK(j.parse("{"
+            "\"ints\": [1, 1000, -5, 200]"
+            ", \"reals\": [1.5, -2.25]"
+            ", \"strings\": [\"a\", \"bc\", \"\"]"
+            ", \"matrix\": [[1, 2], [3, 4], [5, 70000]]"
+            ", \"nulls\": [null, null]"
+            ", \"mixed\": [1, \"x\", true, null, 2.5, {\"k\": false}]"
+            ", \"empty\": []"
+            ", \"object\": {\"a\": 1, \"b\": -300}"
+            ", \"big\": 1099511627776"
+            "}") == pfs::error_code());
+
+    pfs::byte_string buf;
+
+    // Without optimization (or with count optimization only) output
+    // is the same as of ubjson_ostream
+    TEST_OK(encoder_type().encode(j, buf) == pfs::error_code());
+    TEST_OK(buf == pfs::json::to_ubjson(j));
+
+    TEST_OK(encoder_type(pfs::json::UBJSON_COUNT_OPTIMIZED).encode(j, buf) == pfs::error_code());
+    TEST_OK(buf == pfs::json::to_ubjson(j, pfs::json::UBJSON_COUNT_OPTIMIZED));
+
+    encoder_type encoder(pfs::json::UBJSON_FULL_OPTIMIZED);
+
+    TEST_OK(encoder.encode(j, buf) == pfs::error_code());
+    TEST_OK(encoder.encoded_size(j) == buf.size());
+    TEST_OK(pfs::json::from_ubjson<JsonType>(buf) == j);
+
+    // Integers of different width are written using the widest type
+    {
+        JsonType a;
+        TEST_OK(a.parse("[1, 1000, -5]") == pfs::error_code());
+        TEST_OK(encoder.encode(a, buf) == pfs::error_code());
+        TEST_OK(buf == pfs::byte_string("[$I#i\x03\x00\x01\x03\xe8\xff\xfb", 12));
+    }
+
+    // Strings of different length
+    {
+        JsonType a;
+        TEST_OK(a.parse("[\"a\", \"bc\"]") == pfs::error_code());
+        TEST_OK(encoder.encode(a, buf) == pfs::error_code());
+        TEST_OK(buf == pfs::byte_string("[$S#i\x02i\x01" "ai\x02" "bc", 13));
+    }
+}
+
 template <typename JsonType>
 void test ()
 {
@@ -457,6 +605,7 @@ void test ()
     test_string<JsonType>();
     test_array<JsonType>();
     test_object<JsonType>();
+    test_encoder<JsonType>();
 }
 
 }
@@ -192,6 +192,10 @@ static modulus_ns::api_item_type API[] = {
     , { 6 , modulus_ns::make_mapper<bool, char, short, int, long, const char*>(), "SixArgs description" }
 };
 
+#if __cplusplus >= 201103L
+#   include "test_wakeup.hpp"
+#endif
+
 int main ()
 {
     BEGIN_TESTS(19);
@@ -209,5 +213,9 @@ int main ()
     TEST_OK(dispatcher.count() == 3 );
     TEST_OK(dispatcher.exec() == 0 );
 
+#if __cplusplus >= 201103L
+    test_wakeup::run();
+#endif
+
     return END_TESTS;
 }
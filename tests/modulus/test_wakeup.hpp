@@ -0,0 +1,101 @@
+#pragma once
+#include <pfs/atomic.hpp>
+
+// Tests of dispatcher loop wakeup: idle dispatcher waits on condition
+// variable and must be woken by queued callbacks, started timers and quit
+namespace test_wakeup {
+
+static pfs::test::profiler * sw = 0;
+
+static pfs::atomic_int queued_flag(0);
+static pfs::atomic_int timer_flag(0);
+
+static double queued_delay = -1;
+static double timer_delay = -1;
+static double quit_at = -1;
+
+static double queued_called_at = -1;
+static double timer_called_at = -1;
+
+static void on_queued ()
+{
+    queued_called_at = sw->ellapsed();
+    queued_flag.store(1);
+}
+
+static void on_timer ()
+{
+    timer_called_at = sw->ellapsed();
+    timer_flag.store(1);
+}
+
+static bool wait_flag (pfs::atomic_int & flag)
+{
+    for (int i = 0; i < 2000 && flag.load() == 0; i++)
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(1));
+
+    return flag.load() != 0;
+}
+
+class waker_module : public modulus_ns::async_module
+{
+public:
+    waker_module (modulus_ns::dispatcher * pdisp) : modulus_ns::async_module(pdisp)
+    {
+        this->register_thread_function(static_cast<modulus_ns::async_module::thread_function>(& waker_module::run));
+    }
+
+    int run ()
+    {
+        // Let dispatcher become idle (there are no timers, so it waits
+        // without timeout)
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(100));
+
+        double t = sw->ellapsed();
+        get_dispatcher()->callback_queue().push_function(& on_queued);
+
+        if (wait_flag(queued_flag))
+            queued_delay = queued_called_at - t;
+
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(100));
+
+        t = sw->ellapsed();
+        get_dispatcher()->start_timer(Timer_OneShot, 0.05, & on_timer);
+
+        if (wait_flag(timer_flag))
+            timer_delay = timer_called_at - t;
+
+        pfs::this_thread::sleep_for(pfs::chrono::milliseconds(100));
+
+        quit_at = sw->ellapsed();
+        emit_quit();
+
+        return 0;
+    }
+};
+
+void run ()
+{
+    ADD_TESTS(4);
+
+    pfs::test::profiler profiler;
+    sw = & profiler;
+
+    modulus_ns::dispatcher dispatcher(0, 0);
+
+    TEST_FAIL(dispatcher.register_local_module(new waker_module(& dispatcher), "waker_mod"));
+
+    dispatcher.exec();
+    double quit_delay = profiler.ellapsed() - quit_at;
+
+    TEST_OK2(queued_delay >= 0 && queued_delay < 0.05
+            , "Queued callback wakes up idle dispatcher");
+    TEST_OK2(timer_delay >= 0.045 && timer_delay < 0.1
+            , "Started timer wakes up idle dispatcher and expires in time");
+    TEST_OK2(quit_at >= 0 && quit_delay < 0.05
+            , "Quit interrupts dispatcher waiting");
+
+    sw = 0;
+}
+
+} // namespace test_wakeup
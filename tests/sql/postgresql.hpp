@@ -45,7 +45,7 @@ void postgresql_test ()
     }
 
     {
-        ADD_TESTS(29);
+        ADD_TESTS(37);
 
         pfs::string db_uri = pfs::safeformat("postgresql://%s@localhost:5432/pfs-test-db?connect_timeout=10")
                 % user;
@@ -149,6 +149,22 @@ void postgresql_test ()
                 TEST_OK2(count == 6, "6 records in 'employee'");
                 TEST_OK2(res.done(), "Select from 'employee'");
 
+                debby_ns::cursor c(db.exec("select empid, name from employee order by empid"));
+                TEST_OK(c.column_type(0) == pfs::sql::integer_column
+                        && c.column_type(1) == pfs::sql::text_column);
+                TEST_OK(c.has_more() && c.integer(0) == 101 && c.text(1) == "John Smith");
+
+                // bytea is decoded, numeric is not converted to double
+                TEST_FAIL(db.exec("DROP TABLE IF EXISTS payload;"));
+                TEST_OK(db.exec("create table payload(data bytea, amount numeric(30,10));"));
+                TEST_OK(db.exec("insert into payload values('\\x00ff41', 12345678901234567890.0123456789)").done());
+
+                debby_ns::cursor b(db.exec("select data, amount from payload"));
+                TEST_OK(b.column_type(0) == pfs::sql::blob_column
+                        && b.column_type(1) == pfs::sql::text_column);
+                TEST_OK(b.has_more() && b.blob(0) == pfs::sql::data_view("\0\xff" "A", 3));
+                TEST_OK(b.text(1) == "12345678901234567890.0123456789");
+
                 db.clear();
 
             } catch (pfs::exception const & ex) {
@@ -8,6 +8,29 @@ bool sqlite3_is_table_empty (sqlite3_debby_ns::database * db, pfs::string const
     return !res.has_more();
 }
 
+struct sqlite3_item_binder
+{
+    typedef sqlite3_debby_ns debby_ns;
+
+    bool operator () (debby_ns::statement & stmt
+            , int const & value
+            , pfs::error_code & ec
+            , debby_ns::string_type & errstr) const
+    {
+        return stmt.bind(0, value, ec, errstr)
+                && stmt.bind(1, std::string(value % 2 ? "odd" : "even"), ec, errstr);
+    }
+};
+
+int sqlite3_count_rows (sqlite3_debby_ns::database * db, pfs::string const & name)
+{
+    typedef sqlite3_debby_ns debby_ns;
+
+    pfs::string sql(pfs::safeformat("SELECT COUNT(*) FROM \"%s\"") % name);
+    debby_ns::result res = db->exec(sql);
+    return res.has_more() ? res.get<int>(0) : -1;
+}
+
 void sqlite3_test ()
 {
     typedef sqlite3_debby_ns debby_ns;
@@ -220,4 +243,395 @@ void sqlite3_test ()
         TEST_OK2(ok, "Process statements for database");
         TEST_FAIL2(pfs::filesystem::remove(path, ec), "Remove DB file");
     }
+
+////////////////////////////////////////////////////////////////////////////////
+// Prepared statements cache and batch execution                              //
+////////////////////////////////////////////////////////////////////////////////
+    {
+        ADD_TESTS(11);
+
+        pfs::error_code ec;
+        pfs::filesystem::path path = pfs::filesystem::temp_directory_path();
+        path /= "test-db-batch.sqlite3";
+
+        if (pfs::filesystem::exists(path, ec))
+            pfs::filesystem::remove(path, ec);
+
+        bool ok = true;
+
+        try {
+            pfs::string dburi("sqlite3:");
+            dburi.append(pfs::to_string(path));
+            dburi.append("?mode=rwc");
+
+            debby_ns::database db;
+            db.open(dburi);
+
+            db.exec("CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT)");
+
+            // Idle statement is reused, statement in use is not
+            debby_ns::statement stmt1 = db.prepare_cached("SELECT name FROM item");
+            debby_ns::statement stmt2 = db.prepare_cached("SELECT name FROM item");
+            TEST_OK(stmt1.native_handle() != stmt2.native_handle());
+
+            sqlite3_stmt * sth = stmt1.native_handle();
+            stmt1 = debby_ns::statement();
+            stmt2 = debby_ns::statement();
+            TEST_OK(db.prepare_cached("SELECT name FROM item").native_handle() == sth);
+
+            pfs::vector<pfs::vector<std::string> > rows;
+
+            for (int i = 0; i < 100; i++) {
+                pfs::vector<std::string> row;
+                row.push_back(pfs::to_string(i).utf8());
+                row.push_back("item");
+                rows.push_back(row);
+            }
+
+            TEST_OK(db.insert_many("INSERT INTO item VALUES ($1, $2)", rows.begin(), rows.end()));
+            TEST_OK(sqlite3_count_rows(& db, "item") == 100);
+
+            // Duplicate key in the last row: all rows are rolled back
+            pfs::vector<pfs::vector<std::string> > more_rows(rows.begin(), rows.begin() + 10);
+
+            for (size_t i = 0; i < more_rows.size(); i++)
+                more_rows[i][0] = pfs::to_string(int(i) + 100).utf8();
+
+            more_rows.back()[0] = "5";
+            ok = false;
+
+            try {
+                db.insert_many("INSERT INTO item VALUES ($1, $2)", more_rows.begin(), more_rows.end());
+            } catch (pfs::exception const & ex) {
+                std::cerr << "Exception (expected): " << ex.message() << std::endl;
+                ok = true;
+            }
+
+            TEST_OK2(ok, "Batch failed on duplicate key");
+            TEST_OK(sqlite3_count_rows(& db, "item") == 100);
+
+            // Bindings are cleared between rows
+            db.exec("DELETE FROM item");
+            pfs::vector<int> ids;
+
+            for (int i = 0; i < 10; i++)
+                ids.push_back(i);
+
+            TEST_OK(db.exec_batch("INSERT INTO item VALUES ($1, $2)"
+                    , ids.begin(), ids.end(), sqlite3_item_binder()));
+            TEST_OK(sqlite3_count_rows(& db, "item") == 10);
+
+            {
+                debby_ns::result res = db.exec("SELECT name FROM item WHERE id = 3");
+                TEST_OK(res.has_more() && res.get<debby_ns::string_type>(0) == "odd");
+            }
+
+            // Batch inside explicit transaction
+            db.begin_transaction();
+            TEST_OK(db.exec_batch("INSERT INTO item VALUES ($1 + 10, $2)"
+                    , ids.begin(), ids.end(), sqlite3_item_binder()));
+            db.rollback();
+            TEST_OK(sqlite3_count_rows(& db, "item") == 10);
+
+#if __cplusplus >= 201103L
+            {
+                ADD_TESTS(2);
+
+                pfs::vector<pfs::tuple<int, std::string>> tuples;
+                tuples.push_back(pfs::tuple<int, std::string>(100, "tuple"));
+                tuples.push_back(pfs::tuple<int, std::string>(101, "tuple"));
+
+                TEST_OK(db.insert_many("INSERT INTO item VALUES ($1, $2)", tuples.begin(), tuples.end()));
+                TEST_OK(sqlite3_count_rows(& db, "item") == 12);
+            }
+#endif
+
+            ok = true;
+        } catch (pfs::exception const & ex) {
+            std::cerr << "Exception: " << ex.message() << std::endl;
+            ok = false;
+        }
+
+        if (!ok) {
+            TEST_FAIL2(ok, "Prepared statements cache and batch execution");
+        }
+
+        pfs::filesystem::remove(path, ec);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+// Prepared statements cache eviction                                         //
+////////////////////////////////////////////////////////////////////////////////
+    {
+        ADD_TESTS(10);
+
+        typedef pfs::sql::sqlite3::statement_cache<> cache_type;
+
+        sqlite3 * dbh = 0;
+        sqlite3_open_v2(":memory:", & dbh, SQLITE_OPEN_READWRITE, 0);
+
+        char const * sql[] = { "SELECT 1", "SELECT 2", "SELECT 3", "SELECT 4" };
+        sqlite3_stmt * sth[4];
+
+        for (int i = 0; i < 4; i++)
+            sqlite3_prepare_v2(dbh, sql[i], -1, & sth[i], 0);
+
+        {
+            cache_type cache(2);
+
+            cache.insert(sql[0], sth[0]);
+            cache.insert(sql[1], sth[1]);
+            cache.lease(sql[0]);
+            cache.insert(sql[2], sth[2]);
+
+            TEST_OK2(cache.size() == 2, "Cache is not grown over capacity");
+            TEST_OK2(!cache.lease(sql[1]), "Least recently used statement evicted");
+            TEST_OK2(cache.lease(sql[0]).native_handle() == sth[0], "Recently used statement kept");
+
+            // Statement in use is skipped by eviction
+            cache_type::statement_type in_use = cache.lease(sql[0]);
+            cache.lease(sql[2]);
+            cache.insert(sql[3], sth[3]);
+
+            TEST_OK2(cache.size() == 2, "Cache is not grown over capacity");
+            TEST_OK2(!cache.lease(sql[0]), "Statement in use is not leased twice");
+            TEST_OK2(!cache.lease(sql[2]), "Idle statement evicted instead of statement in use");
+            TEST_OK2(cache.lease(sql[3]).native_handle() == sth[3], "Inserted statement cached");
+
+            in_use = cache_type::statement_type();
+            TEST_OK2(cache.lease(sql[0]).native_handle() == sth[0], "Released statement leased again");
+
+            cache.set_capacity(1);
+            TEST_OK2(cache.size() == 1, "Cache shrunk");
+            TEST_OK2(cache.lease(sql[0]).native_handle() == sth[0], "Recently used statement kept on shrink");
+        }
+
+        sqlite3_close(dbh);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+// Typed row cursor                                                           //
+////////////////////////////////////////////////////////////////////////////////
+    {
+        ADD_TESTS(19);
+
+        pfs::error_code ec;
+        pfs::filesystem::path path = pfs::filesystem::temp_directory_path();
+        path /= "test-db-cursor.sqlite3";
+
+        if (pfs::filesystem::exists(path, ec))
+            pfs::filesystem::remove(path, ec);
+
+        bool ok = true;
+
+        try {
+            pfs::string dburi("sqlite3:");
+            dburi.append(pfs::to_string(path));
+            dburi.append("?mode=rwc");
+
+            debby_ns::database db;
+            db.open(dburi);
+
+            db.exec("CREATE TABLE item (id INTEGER, price REAL, name TEXT, data BLOB)");
+            db.exec("INSERT INTO item VALUES (1, 1.5, 'first', X'00FF01')");
+            db.exec("INSERT INTO item VALUES (2, NULL, NULL, NULL)");
+
+            for (int i = 3; i <= 10; i++) {
+                pfs::string sql(pfs::safeformat("INSERT INTO item VALUES (%d, %d.25, 'item%d', X'0%d')") % i % i % i % (i % 10));
+                db.exec(sql);
+            }
+
+            debby_ns::cursor c(db.exec("SELECT id, price, name, data FROM item ORDER BY id"));
+
+            TEST_OK(c.column_count() == 4);
+            TEST_OK(c.column_index("name") == 2);
+            TEST_OK(c.column_index("unknown") == -1);
+            TEST_OK(c.column_type(0) == pfs::sql::integer_column
+                    && c.column_type(1) == pfs::sql::real_column
+                    && c.column_type(2) == pfs::sql::text_column
+                    && c.column_type(3) == pfs::sql::blob_column);
+
+            // Row by row
+            TEST_OK(c.has_more() && c.integer(0) == 1 && c.real(1) == 1.5);
+            TEST_OK(c.text(2) == "first");
+            TEST_OK(c.blob(3).size() == 3 && c.blob(3).bytes()[0] == 0 && c.blob(3).bytes()[1] == 0xFF);
+
+            ++c;
+            TEST_OK(c.is_null(1) && c.is_null(2) && c.text(2).empty());
+
+            ++c;
+
+            // By blocks
+            static size_t const BLOCK = 3;
+            intmax_t ids[BLOCK];
+            double prices[BLOCK];
+            std::string names;
+            size_t name_offsets[BLOCK + 1];
+            std::string data;
+            size_t data_offsets[BLOCK + 1];
+            char data_nulls[BLOCK];
+
+            c.bind_column(0, ids);
+            c.bind_column(1, prices);
+            c.bind_column(c.column_index("name"), & names, name_offsets);
+            c.bind_column(3, & data, data_offsets, data_nulls);
+
+            TEST_OK(c.fetch(BLOCK) == 3);
+            TEST_OK(ids[0] == 3 && ids[1] == 4 && ids[2] == 5);
+            TEST_OK(prices[2] == 5.25);
+            TEST_OK(names == "item3item4item5");
+            TEST_OK(name_offsets[0] == 0 && name_offsets[1] == 5 && name_offsets[3] == 15);
+            TEST_OK(data.size() == 3 && data[1] == 4 && data_offsets[2] == 2 && data_nulls[0] == 0);
+
+            TEST_OK(c.fetch(BLOCK) == 3);
+            TEST_OK(c.fetch(BLOCK) == 2 && ids[1] == 10 && names == "item9item10");
+            TEST_OK(c.fetch(BLOCK) == 0);
+            TEST_OK(!c.has_more());
+        } catch (pfs::exception const & ex) {
+            std::cerr << "Exception: " << ex.message() << std::endl;
+            ok = false;
+        }
+
+        TEST_OK2(ok, "Typed row cursor");
+
+        pfs::filesystem::remove(path, ec);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+// Connection pool                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#if __cplusplus >= 201103L
+    {
+        typedef pfs::sql::connection_pool<debby_ns> pool_type;
+
+        ADD_TESTS(8);
+
+        pfs::error_code ec;
+        pfs::filesystem::path path = pfs::filesystem::temp_directory_path();
+        path /= "test-db-pool.sqlite3";
+
+        if (pfs::filesystem::exists(path, ec))
+            pfs::filesystem::remove(path, ec);
+
+        bool ok = true;
+
+        try {
+            pfs::string dburi("sqlite3:");
+            dburi.append(pfs::to_string(path));
+            dburi.append("?mode=rwc");
+
+            {
+                debby_ns::database db;
+                db.open(dburi);
+                db.exec("CREATE TABLE item (id INTEGER PRIMARY KEY, value INTEGER)");
+
+                pfs::vector<pfs::tuple<int, int>> rows;
+
+                for (int i = 0; i < 100; i++)
+                    rows.push_back(pfs::tuple<int, int>(i, i * 2));
+
+                db.insert_many("INSERT INTO item VALUES ($1, $2)", rows.begin(), rows.end());
+            }
+
+            pool_type::options opts;
+            opts.connections = 4;
+            opts.wal = true;
+            opts.busy_timeout = 10000;
+
+            pool_type pool;
+            pool.open(dburi, opts);
+
+            TEST_OK(pool.size() == 4);
+
+            // Concurrent reads
+            pfs::vector<std::future<int>> values;
+
+            for (int i = 0; i < 100; i++) {
+                values.push_back(pool.submit([i] (debby_ns::database & db) {
+                    debby_ns::statement stmt = db.prepare_cached("SELECT value FROM item WHERE id = $1");
+                    stmt.bind(0, i);
+                    debby_ns::result res = stmt.exec();
+                    return res.has_more() ? res.get<int>(0) : -1;
+                }));
+            }
+
+            int sum = 0;
+
+            for (size_t i = 0; i < values.size(); i++)
+                sum += values[i].get();
+
+            TEST_OK(sum == 9900);
+
+            // Results are passed to the handler
+            pfs::atomic_int nrows(0);
+            pfs::atomic_int nerrors(0);
+
+            for (int i = 0; i < 10; i++) {
+                pool.exec("SELECT id FROM item"
+                        , [& nrows] (debby_ns::result & res
+                                , pfs::error_code const & ec
+                                , debby_ns::string_type const &) {
+                    for (; !ec && res.has_more(); ++res)
+                        ++nrows;
+                });
+            }
+
+            pool.exec("SELECT id FROM nonexistent"
+                    , [& nerrors] (debby_ns::result &
+                            , pfs::error_code const & ec
+                            , debby_ns::string_type const &) {
+                if (ec)
+                    ++nerrors;
+            });
+
+            // Concurrent writes are serialized by SQLite (busy timeout)
+            for (int i = 100; i < 120; i++) {
+                pool.push([i] (debby_ns::database & db) {
+                    pfs::error_code ec;
+                    debby_ns::string_type errstr;
+                    debby_ns::statement stmt = db.prepare_cached("INSERT INTO item VALUES ($1, 0)", ec, errstr);
+                    stmt.bind(0, i, ec, errstr);
+                    stmt.exec(ec, errstr);
+                });
+            }
+
+            pool.wait_idle();
+
+            TEST_OK(nrows.load() == 1000);
+            TEST_OK(nerrors.load() == 1);
+
+            // Exception is passed to the future
+            std::future<int> failed = pool.submit([] (debby_ns::database & db) {
+                db.exec("SELECT * FROM nonexistent");
+                return 0;
+            });
+
+            bool thrown = false;
+
+            try {
+                failed.get();
+            } catch (pfs::exception const &) {
+                thrown = true;
+            }
+
+            TEST_OK(thrown);
+
+            std::future<int> count = pool.submit([] (debby_ns::database & db) {
+                return sqlite3_count_rows(& db, "item");
+            });
+
+            TEST_OK(count.get() == 120);
+
+            pool.close();
+            TEST_OK(!pool.opened());
+        } catch (pfs::exception const & ex) {
+            std::cerr << "Exception: " << ex.message() << std::endl;
+            ok = false;
+        }
+
+        TEST_OK2(ok, "Connection pool");
+
+        pfs::filesystem::remove(path, ec);
+    }
+#endif
 }
@@ -10,6 +10,11 @@
 #include "pfs/sql/sqlite3/result.hpp"
 #include "pfs/sql/debby.hpp"
 
+#if __cplusplus >= 201103L
+#   include "pfs/atomic.hpp"
+#   include "pfs/sql/pool.hpp"
+#endif
+
 typedef pfs::sql::debby<pfs::sql::sqlite3::id
         , pfs::sql::sqlite3::database
         , pfs::sql::sqlite3::statement